@@ -3192,6 +3192,14 @@ unsigned str_quickhash(const char *str)
 	return hash;
 }
 
+unsigned str_quickhash_nocase(const char *str)
+{
+	unsigned hash = 5381;
+	for(; *str; str++)
+		hash = ((hash << 5) + hash) + str_uppercase(*str); /* hash * 33 + C */
+	return hash;
+}
+
 static const char *str_token_get(const char *str, const char *delim, int *length)
 {
 	size_t len = strspn(str, delim);
@@ -1858,6 +1858,7 @@ float str_tofloat(const char *str);
 int str_isspace(char c);
 char str_uppercase(char c);
 unsigned str_quickhash(const char *str);
+unsigned str_quickhash_nocase(const char *str);
 
 struct SKELETON;
 void str_utf8_skeleton_begin(struct SKELETON* skel, const char* str);
@@ -0,0 +1,205 @@
+#include "benchmark.h"
+
+#include <engine/config.h>
+#include <engine/console.h>
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/storage.h>
+#include <engine/server/server.h>
+#include <engine/shared/config.h>
+#include <engine/shared/jsonwriter.h>
+
+#include <game/version.h>
+#include <game/server/gamecontext.h>
+
+#include <algorithm>
+
+// runs the hot paths of the server in isolation and writes the timings as json, so
+// results of different commits can be compared. run it from the build directory.
+
+static const char *s_pUsage =
+	"usage: benchmark [options]\n"
+	"  -o <file>      write the results as json to the file (default stdout)\n"
+	"  -f <filter>    only run benchmarks containing the filter\n"
+	"  -t <ms>        minimum duration of a sample (default 20)\n";
+
+volatile int g_BenchmarkSink;
+
+CBenchmark::CBenchmark(const char *pFilter, int SampleMs)
+{
+	m_pFilter = pFilter;
+	m_SampleTime = time_freq() * SampleMs / 1000;
+	m_NumResults = 0;
+}
+
+bool CBenchmark::Wanted(const char *pName) const
+{
+	return !m_pFilter[0] || str_find(pName, m_pFilter);
+}
+
+void CBenchmark::AddResult(const char *pName, int Iterations, const int64 *pSamples)
+{
+	if(m_NumResults == MAX_RESULTS)
+	{
+		dbg_msg("benchmark", "too many results, dropping %s", pName);
+		return;
+	}
+
+	CResult *pResult = &m_aResults[m_NumResults++];
+	str_copy(pResult->m_aName, pName, sizeof(pResult->m_aName));
+	pResult->m_Iterations = Iterations;
+	mem_copy(pResult->m_aSampleNs, pSamples, sizeof(pResult->m_aSampleNs));
+
+	dbg_msg("benchmark", "%-36s %10lld ns/op (min %lld, %d ops/sample)", pName,
+		MedianNs(pResult), MinNs(pResult), Iterations);
+}
+
+int64 CBenchmark::MedianNs(const CResult *pResult)
+{
+	int64 aSorted[NUM_SAMPLES];
+	mem_copy(aSorted, pResult->m_aSampleNs, sizeof(aSorted));
+	std::sort(aSorted, aSorted + NUM_SAMPLES);
+	return aSorted[NUM_SAMPLES / 2] / pResult->m_Iterations;
+}
+
+int64 CBenchmark::MinNs(const CResult *pResult)
+{
+	int64 Min = pResult->m_aSampleNs[0];
+	for(int i = 1; i < NUM_SAMPLES; i++)
+		Min = min(Min, pResult->m_aSampleNs[i]);
+	return Min / pResult->m_Iterations;
+}
+
+void CBenchmark::WriteJson(IOHANDLE File) const
+{
+	char aTimestamp[64];
+	str_timestamp(aTimestamp, sizeof(aTimestamp));
+
+	CJsonWriter Json(File);
+	Json.BeginObject();
+	Json.WriteAttribute("version");
+	Json.WriteIntValue(1);
+	Json.WriteAttribute("git_revision");
+	Json.WriteStrValue(GIT_SHORTREV_HASH ? GIT_SHORTREV_HASH : "");
+	Json.WriteAttribute("timestamp");
+	Json.WriteStrValue(aTimestamp);
+	Json.WriteAttribute("results");
+	Json.BeginArray();
+	for(int i = 0; i < m_NumResults; i++)
+	{
+		const CResult *pResult = &m_aResults[i];
+		Json.BeginObject();
+		Json.WriteAttribute("name");
+		Json.WriteStrValue(pResult->m_aName);
+		Json.WriteAttribute("ns_per_op");
+		Json.WriteIntValue((int)MedianNs(pResult));
+		Json.WriteAttribute("min_ns_per_op");
+		Json.WriteIntValue((int)MinNs(pResult));
+		Json.WriteAttribute("ops_per_sample");
+		Json.WriteIntValue(pResult->m_Iterations);
+		Json.WriteAttribute("samples");
+		Json.WriteIntValue(NUM_SAMPLES);
+		Json.EndObject();
+	}
+	Json.EndArray();
+	Json.EndObject();
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	const char *pOutput = 0;
+	const char *pFilter = "";
+	int SampleMs = 20;
+
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		const char *pArg = argv[i]; // ignore_convention
+		const char *pValue = i + 1 < argc ? argv[i + 1] : 0; // ignore_convention
+		if(pArg[0] != '-' || !pArg[1] || pArg[2] || !pValue)
+		{
+			dbg_msg("benchmark", "%s", s_pUsage);
+			return -1;
+		}
+		i++;
+
+		switch(pArg[1])
+		{
+		case 'o': pOutput = pValue; break;
+		case 'f': pFilter = pValue; break;
+		case 't': SampleMs = max(1, str_toint(pValue)); break;
+		default:
+			dbg_msg("benchmark", "%s", s_pUsage);
+			return -1;
+		}
+	}
+
+	// keep stdout clean for the json unless it goes to a file
+	if(pOutput)
+		dbg_logger_stdout();
+	else
+		dbg_logger_filehandle(io_stderr());
+
+	if(secure_random_init() != 0)
+	{
+		dbg_msg("secure", "could not initialize secure RNG");
+		return -1;
+	}
+
+	IOHANDLE File = pOutput ? io_open(pOutput, IOFLAG_WRITE) : io_stdout();
+	if(!File)
+	{
+		dbg_msg("benchmark", "could not open '%s'", pOutput);
+		return -1;
+	}
+
+	// the same components as the server, without network and map rotation
+	IKernel *pKernel = IKernel::Create();
+	CServer *pServer = new CServer();
+	IEngineMap *pEngineMap = CreateEngineMap();
+	IGameServer *pGameServer = CreateGameServer();
+	IConsole *pConsole = CreateConsole(CFGFLAG_SERVER|CFGFLAG_ECON);
+	IStorage *pStorage = CreateStorage("Teeworlds", IStorage::STORAGETYPE_SERVER, 1, argv); // ignore_convention
+	IConfigManager *pConfigManager = CreateConfigManager();
+	IEngineAntibot *pEngineAntibot = CreateEngineAntibot();
+
+	{
+		bool RegisterFail = false;
+
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pServer);
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(static_cast<IEngineMap*>(pEngineMap));
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(static_cast<IMap*>(pEngineMap));
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pGameServer);
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pConsole);
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pStorage);
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pConfigManager);
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pEngineAntibot);
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(static_cast<IAntibot*>(pEngineAntibot));
+
+		if(RegisterFail || !pStorage)
+			return -1;
+	}
+
+	pConfigManager->Init(CFGFLAG_SERVER|CFGFLAG_ECON);
+	pConsole->Init();
+	pServer->InitInterfaces(pConfigManager->Values(), pConsole, pGameServer, pEngineMap, pStorage, pEngineAntibot);
+	pServer->RegisterCommands();
+	pConfigManager->RestoreStrings();
+
+	CBenchmark Bench(pFilter, SampleMs);
+	BenchmarkSnapshot(&Bench);
+	BenchmarkCompression(&Bench);
+	BenchmarkCollision(&Bench, pKernel);
+	BenchmarkGameServer(&Bench, pKernel);
+	BenchmarkProfiler(&Bench);
+	Bench.WriteJson(File);
+
+	delete pServer;
+	delete pKernel;
+	delete pEngineMap;
+	delete pGameServer;
+	delete pConsole;
+	delete pStorage;
+	delete pConfigManager;
+
+	return 0;
+}
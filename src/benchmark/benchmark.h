@@ -0,0 +1,87 @@
+#ifndef BENCHMARK_BENCHMARK_H
+#define BENCHMARK_BENCHMARK_H
+
+#include <base/system.h>
+
+// sink for benchmark results so the compiler can't drop the measured work
+extern volatile int g_BenchmarkSink;
+
+class CBenchmark
+{
+public:
+	enum
+	{
+		NUM_SAMPLES=7,
+		MAX_RESULTS=64,
+	};
+
+	class CResult
+	{
+	public:
+		char m_aName[64];
+		int m_Iterations;
+		int64 m_aSampleNs[NUM_SAMPLES];
+	};
+
+private:
+	const char *m_pFilter;
+	int64 m_SampleTime;
+
+	CResult m_aResults[MAX_RESULTS];
+	int m_NumResults;
+
+	void AddResult(const char *pName, int Iterations, const int64 *pSamples);
+
+public:
+	CBenchmark(const char *pFilter, int SampleMs);
+
+	bool Wanted(const char *pName) const;
+
+	// Func is one operation. The iteration count is doubled until a sample
+	// takes at least the sample time, then NUM_SAMPLES samples are taken.
+	template<typename F>
+	void Run(const char *pName, F Func)
+	{
+		if(!Wanted(pName))
+			return;
+
+		Func(); // warm up caches and lazy initialization
+
+		int Iterations = 1;
+		while(true)
+		{
+			int64 Start = time_get();
+			for(int i = 0; i < Iterations; i++)
+				Func();
+			if(time_get() - Start >= m_SampleTime || Iterations >= 1<<30)
+				break;
+			Iterations *= 2;
+		}
+
+		int64 aSamples[NUM_SAMPLES];
+		for(int s = 0; s < NUM_SAMPLES; s++)
+		{
+			int64 Start = time_get();
+			for(int i = 0; i < Iterations; i++)
+				Func();
+			aSamples[s] = (time_get() - Start) * 1000000000 / time_freq();
+		}
+		AddResult(pName, Iterations, aSamples);
+	}
+
+	int NumResults() const { return m_NumResults; }
+	const CResult *GetResult(int Index) const { return &m_aResults[Index]; }
+
+	static int64 MedianNs(const CResult *pResult);
+	static int64 MinNs(const CResult *pResult);
+
+	void WriteJson(IOHANDLE File) const;
+};
+
+void BenchmarkSnapshot(CBenchmark *pBench);
+void BenchmarkCollision(CBenchmark *pBench, class IKernel *pKernel);
+void BenchmarkCompression(CBenchmark *pBench);
+void BenchmarkGameServer(CBenchmark *pBench, class IKernel *pKernel);
+void BenchmarkProfiler(CBenchmark *pBench);
+
+#endif // BENCHMARK_BENCHMARK_H
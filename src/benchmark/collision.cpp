@@ -0,0 +1,97 @@
+#include "benchmark.h"
+
+#include <base/vmath.h>
+
+#include <engine/config.h>
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/storage.h>
+
+#include <game/collision.h>
+#include <game/layers.h>
+
+// one of the menu theme maps that ship with the data directory
+static const char *s_pMapName = "ui/themes/jungle_day.map";
+
+enum
+{
+	NUM_QUERIES=4096,
+};
+
+void BenchmarkCollision(CBenchmark *pBench, IKernel *pKernel)
+{
+	IEngineMap *pMap = pKernel->RequestInterface<IEngineMap>();
+	if(!pMap->Load(s_pMapName, pKernel->RequestInterface<IStorage>()))
+	{
+		dbg_msg("benchmark", "could not load map '%s', skipping collision", s_pMapName);
+		return;
+	}
+
+	static CLayers s_Layers;
+	static CCollision s_Collision;
+	s_Layers.Init(pKernel, pMap);
+	s_Collision.Init(&s_Layers, pKernel->RequestInterface<IConfigManager>()->Values());
+
+	int Width = s_Collision.GetWidth() * 32;
+	int Height = s_Collision.GetHeight() * 32;
+	int Solid = 0;
+	for(int y = 0; y < Height; y += 32)
+		for(int x = 0; x < Width; x += 32)
+			Solid += s_Collision.CheckPoint(x + 16, y + 16);
+	dbg_msg("benchmark", "map %s %dx%d tiles, %d solid", s_pMapName, Width / 32, Height / 32, Solid);
+
+	// rays of laser and hook length, random boxes of tee size
+	static vec2 s_aFrom[NUM_QUERIES];
+	static vec2 s_aTo[NUM_QUERIES];
+	static vec2 s_aVel[NUM_QUERIES];
+	unsigned Seed = 7;
+	for(int i = 0; i < NUM_QUERIES; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		s_aFrom[i] = vec2((Seed >> 8) % Width, (Seed >> 4) % Height);
+		Seed = Seed * 1103515245 + 12345;
+		vec2 Dir = direction((Seed >> 8) % 628 / 100.0f);
+		s_aTo[i] = s_aFrom[i] + Dir * 800.0f;
+		s_aVel[i] = Dir * ((Seed >> 4) % 32);
+	}
+
+	int Query = 0;
+	pBench->Run("collision.intersect_line", [&]() {
+		vec2 Col, Before;
+		g_BenchmarkSink += s_Collision.IntersectLine(s_aFrom[Query], s_aTo[Query], &Col, &Before);
+		Query = (Query + 1) % NUM_QUERIES;
+	});
+
+	pBench->Run("collision.intersect_no_laser", [&]() {
+		vec2 Col, Before;
+		g_BenchmarkSink += s_Collision.IntersectNoLaser(s_aFrom[Query], s_aTo[Query], &Col, &Before);
+		Query = (Query + 1) % NUM_QUERIES;
+	});
+
+	pBench->Run("collision.move_point", [&]() {
+		vec2 Pos = s_aFrom[Query];
+		vec2 Vel = s_aVel[Query];
+		int Bounces;
+		s_Collision.MovePoint(&Pos, &Vel, 0.5f, &Bounces);
+		g_BenchmarkSink += Bounces;
+		Query = (Query + 1) % NUM_QUERIES;
+	});
+
+	pBench->Run("collision.move_box", [&]() {
+		vec2 Pos = s_aFrom[Query];
+		vec2 Vel = s_aVel[Query];
+		s_Collision.MoveBox(&Pos, &Vel, vec2(28.0f, 28.0f), 0.0f, true);
+		g_BenchmarkSink += (int)Pos.x;
+		Query = (Query + 1) % NUM_QUERIES;
+	});
+
+	pBench->Run("collision.test_box", [&]() {
+		g_BenchmarkSink += s_Collision.TestBox(s_aFrom[Query], vec2(28.0f, 28.0f));
+		Query = (Query + 1) % NUM_QUERIES;
+	});
+
+	pBench->Run("collision.check_point", [&]() {
+		g_BenchmarkSink += s_Collision.CheckPoint(s_aFrom[Query]);
+		Query = (Query + 1) % NUM_QUERIES;
+	});
+}
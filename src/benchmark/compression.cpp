@@ -0,0 +1,74 @@
+#include "benchmark.h"
+
+#include <base/math.h>
+
+#include <engine/shared/compression.h>
+#include <engine/shared/huffman.h>
+#include <engine/shared/network.h>
+
+enum
+{
+	NUM_INTS=1024,
+};
+
+// mostly small values with a tail of larger ones, like the fields of a snapshot delta
+static void FillInts(int *pInts, int Num)
+{
+	unsigned Seed = 1;
+	for(int i = 0; i < Num; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		int Value = (Seed >> 8) & 0xffffff;
+		int Kind = (Seed >> 4) % 20;
+		if(Kind < 14)
+			pInts[i] = Value % 128 - 64;
+		else if(Kind < 19)
+			pInts[i] = Value % 16384 - 8192;
+		else
+			pInts[i] = Value - 0x800000;
+	}
+}
+
+void BenchmarkCompression(CBenchmark *pBench)
+{
+	static int s_aInts[NUM_INTS];
+	static int s_aUnpacked[NUM_INTS];
+	static unsigned char s_aPacked[NUM_INTS*5];
+	FillInts(s_aInts, NUM_INTS);
+
+	unsigned char *pEnd = s_aPacked;
+	for(int i = 0; i < NUM_INTS; i++)
+		pEnd = CVariableInt::Pack(pEnd, s_aInts[i]);
+	int PackedSize = pEnd - s_aPacked;
+
+	// one op packs or unpacks all NUM_INTS values
+	pBench->Run("varint.pack", [&]() {
+		unsigned char *pDst = s_aPacked;
+		for(int i = 0; i < NUM_INTS; i++)
+			pDst = CVariableInt::Pack(pDst, s_aInts[i]);
+		g_BenchmarkSink += pDst - s_aPacked;
+	});
+
+	pBench->Run("varint.unpack", [&]() {
+		const unsigned char *pSrc = s_aPacked;
+		for(int i = 0; i < NUM_INTS; i++)
+			pSrc = CVariableInt::Unpack(pSrc, &s_aUnpacked[i]);
+		g_BenchmarkSink += s_aUnpacked[NUM_INTS-1];
+	});
+
+	// one op is a packet sized chunk of the packed data, as the network layer sees it
+	static CHuffman s_Huffman;
+	s_Huffman.Init();
+	static unsigned char s_aCompressed[NET_MAX_PAYLOAD*2];
+	static unsigned char s_aDecompressed[NET_MAX_PAYLOAD];
+	int ChunkSize = min(PackedSize, (int)NET_MAX_PAYLOAD);
+	int CompressedSize = s_Huffman.Compress(s_aPacked, ChunkSize, s_aCompressed, sizeof(s_aCompressed));
+
+	pBench->Run("huffman.compress", [&]() {
+		g_BenchmarkSink += s_Huffman.Compress(s_aPacked, ChunkSize, s_aCompressed, sizeof(s_aCompressed));
+	});
+
+	pBench->Run("huffman.decompress", [&]() {
+		g_BenchmarkSink += s_Huffman.Decompress(s_aCompressed, CompressedSize, s_aDecompressed, sizeof(s_aDecompressed));
+	});
+}
@@ -0,0 +1,391 @@
+#include "benchmark.h"
+
+#include <base/vmath.h>
+
+#include <engine/kernel.h>
+#include <engine/server.h>
+#include <engine/shared/config.h>
+
+#include <game/collision.h>
+#include <game/server/entity.h>
+#include <game/server/gamecontext.h>
+#include <game/server/plotfile.h>
+#include <game/server/plotownerindex.h>
+#include <game/server/snapgrid.h>
+#include <game/server/whoisindex.h>
+
+#include <vector>
+
+enum
+{
+	WORLD_SIZE=500*32,
+	NUM_QUERIES=4096,
+	NUM_ACCOUNTS=1000,
+	NUM_PLOT_OBJECTS=10000,
+	SNAP_ENTITIES=50000,
+	SNAP_CLIENTS=64,
+	FREEZE_MAP_WIDTH=512,
+	FREEZE_MAP_HEIGHT=256,
+	NUM_WHOIS_CONNECTS=1<<21,
+	NUM_SWITCHERS=256,
+	NUM_ACTIVE_SWITCHES=16,
+};
+
+static void BenchmarkFindEntities(CBenchmark *pBench, CGameWorld *pWorld)
+{
+	static const int s_aDensities[] = { 100, 1000, 10000 };
+
+	static vec2 s_aQueries[NUM_QUERIES];
+	unsigned Seed = 11;
+	for(int i = 0; i < NUM_QUERIES; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		s_aQueries[i] = vec2((Seed >> 8) % WORLD_SIZE, (Seed >> 4) % WORLD_SIZE);
+	}
+
+	for(unsigned d = 0; d < sizeof(s_aDensities) / sizeof(s_aDensities[0]); d++)
+	{
+		char aName[64];
+		str_format(aName, sizeof(aName), "world.find_entities.%d", s_aDensities[d]);
+		if(!pBench->Wanted(aName))
+			continue;
+
+		// plain entities, FindEntities only looks at the position and the radius
+		std::vector<CEntity *> vpEnts;
+		for(int i = 0; i < s_aDensities[d]; i++)
+		{
+			Seed = Seed * 1103515245 + 12345;
+			vec2 Pos((Seed >> 8) % WORLD_SIZE, (Seed >> 4) % WORLD_SIZE);
+			CEntity *pEnt = new CEntity(pWorld, CGameWorld::ENTTYPE_MONEY, Pos, 14);
+			pWorld->InsertEntity(pEnt);
+			vpEnts.push_back(pEnt);
+		}
+
+		// the radius of a grenade explosion query
+		int Query = 0;
+		pBench->Run(aName, [&]() {
+			CEntity *apEnts[MAX_CLIENTS];
+			g_BenchmarkSink += pWorld->FindEntities(s_aQueries[Query], 135.0f, apEnts, MAX_CLIENTS, CGameWorld::ENTTYPE_MONEY);
+			Query = (Query + 1) % NUM_QUERIES;
+		});
+
+		for(unsigned i = 0; i < vpEnts.size(); i++)
+			delete vpEnts[i];
+	}
+}
+
+static void BenchmarkAccounts(CBenchmark *pBench, CGameContext *pGameServer)
+{
+	if(!pBench->Wanted("account.lookup"))
+		return;
+
+	// accounts are plain files, write them to a scratch folder next to the binary
+	CConfig *pConfig = pGameServer->Config();
+	char aOldPath[sizeof(pConfig->m_SvAccFilePath)];
+	str_copy(aOldPath, pConfig->m_SvAccFilePath, sizeof(aOldPath));
+	str_format(pConfig->m_SvAccFilePath, sizeof(pConfig->m_SvAccFilePath), "benchmark_accounts-%d", pid());
+	fs_makedir(pConfig->m_SvAccFilePath);
+
+	pGameServer->AddAccount(); // account id 0 means not logged in
+	char aaNames[NUM_ACCOUNTS][32];
+	for(int i = 0; i < NUM_ACCOUNTS; i++)
+	{
+		str_format(aaNames[i], sizeof(aaNames[i]), "benchmark%d", i);
+		int ID = pGameServer->AddAccount();
+		str_copy(pGameServer->m_Accounts[ID].m_Username, aaNames[i], sizeof(pGameServer->m_Accounts[ID].m_Username));
+		pGameServer->m_Accounts[ID].m_Money = i * 1000;
+		pGameServer->WriteAccountStats(ID);
+		pGameServer->FreeAccount(ID);
+	}
+
+	// what /login and the plot owner lookups do for an account that isn't loaded
+	int Query = 0;
+	pBench->Run("account.lookup", [&]() {
+		int ID = pGameServer->GetAccount(aaNames[Query]);
+		g_BenchmarkSink += ID;
+		if(ID >= ACC_START)
+			pGameServer->FreeAccount(ID);
+		Query = (Query * 7 + 1) % NUM_ACCOUNTS;
+	});
+
+	char aBuf[256];
+	for(int i = 0; i < NUM_ACCOUNTS; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "%s/%s.acc", pConfig->m_SvAccFilePath, aaNames[i]);
+		fs_remove(aBuf);
+	}
+	fs_remove(pConfig->m_SvAccFilePath);
+	str_copy(pConfig->m_SvAccFilePath, aOldPath, sizeof(pConfig->m_SvAccFilePath));
+	pGameServer->FreeAccount(0);
+}
+
+static void BenchmarkSnapGrid(CBenchmark *pBench)
+{
+	if(!pBench->Wanted("snap.clip_all") && !pBench->Wanted("snap.grid_build") && !pBench->Wanted("snap.grid_query"))
+		return;
+
+	// a crowded 1000x1000 tiles map, one operation is one snapshot of one of the clients
+	const float Width = 1000 * 32, Height = 1000 * 32;
+	static vec2 s_aPos[SNAP_ENTITIES];
+	static vec2 s_aViews[SNAP_CLIENTS];
+	unsigned Seed = 1;
+	for(int i = 0; i < SNAP_ENTITIES + SNAP_CLIENTS; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		float x = (Seed >> 8) % (int)Width;
+		Seed = Seed * 1103515245 + 12345;
+		float y = (Seed >> 8) % (int)Height;
+		(i < SNAP_ENTITIES ? s_aPos[i] : s_aViews[i - SNAP_ENTITIES]) = vec2(x, y);
+	}
+	vec2 Extent(1000 / 2 + 320, 800 / 2 + 320);
+
+	// the grid never dereferences its entities, so it gets the addresses of the positions
+	int Client = 0;
+	pBench->Run("snap.clip_all", [&]() {
+		vec2 View = s_aViews[Client];
+		int Visible = 0;
+		for(int i = 0; i < SNAP_ENTITIES; i++)
+			Visible += absolute(View.x - s_aPos[i].x) <= Extent.x && absolute(View.y - s_aPos[i].y) <= Extent.y;
+		g_BenchmarkSink += Visible;
+		Client = (Client + 1) % SNAP_CLIENTS;
+	});
+
+	CSnapGrid Grid;
+	Grid.Init(Width, Height, 1);
+	pBench->Run("snap.grid_build", [&]() {
+		Grid.Clear();
+		for(int i = 0; i < SNAP_ENTITIES; i++)
+			Grid.Add((CEntity *)&s_aPos[i], 0, s_aPos[i]);
+		Grid.Build();
+	});
+
+	Grid.Clear();
+	for(int i = 0; i < SNAP_ENTITIES; i++)
+		Grid.Add((CEntity *)&s_aPos[i], 0, s_aPos[i]);
+	Grid.Build();
+	std::vector<CEntity *> vpFound;
+	pBench->Run("snap.grid_query", [&]() {
+		vec2 View = s_aViews[Client];
+		vpFound.clear();
+		Grid.Query(0, View, Extent, &vpFound);
+		int Visible = 0;
+		for(unsigned i = 0; i < vpFound.size(); i++)
+		{
+			vec2 Pos = *(vec2 *)vpFound[i];
+			Visible += absolute(View.x - Pos.x) <= Extent.x && absolute(View.y - Pos.y) <= Extent.y;
+		}
+		g_BenchmarkSink += Visible;
+		Client = (Client + 1) % SNAP_CLIENTS;
+	});
+}
+
+static void BenchmarkFreezeDistance(CBenchmark *pBench)
+{
+	if(!pBench->Wanted("dummy.freeze_distance_build") && !pBench->Wanted("dummy.freeze_probe") && !pBench->Wanted("dummy.freeze_distance"))
+		return;
+
+	// about every 37th tile freezes
+	const int Size = FREEZE_MAP_WIDTH * FREEZE_MAP_HEIGHT;
+	std::vector<unsigned char> vFreeze(Size);
+	unsigned Seed = 2;
+	for(int i = 0; i < Size; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		vFreeze[i] = (Seed >> 16) % 37 == 0;
+	}
+
+	std::vector<unsigned char> vDist(Size);
+	CCollision::ComputeFreezeDistance(&vFreeze[0], FREEZE_MAP_WIDTH, FREEZE_MAP_HEIGHT, &vDist[0]);
+	pBench->Run("dummy.freeze_distance_build", [&]() {
+		CCollision::ComputeFreezeDistance(&vFreeze[0], FREEZE_MAP_WIDTH, FREEZE_MAP_HEIGHT, &vDist[0]);
+		g_BenchmarkSink += vDist[0];
+	});
+
+	static int s_aQueries[NUM_QUERIES];
+	for(int i = 0; i < NUM_QUERIES; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		s_aQueries[i] = (Seed >> 8) % Size;
+	}
+
+	// what AvoidFreeze did per tick before the field and the lookup replacing it
+	int Query = 0;
+	pBench->Run("dummy.freeze_probe", [&]() {
+		g_BenchmarkSink += CCollision::ProbeFreeze(&vFreeze[0], FREEZE_MAP_WIDTH, FREEZE_MAP_HEIGHT, s_aQueries[Query] % FREEZE_MAP_WIDTH, s_aQueries[Query] / FREEZE_MAP_WIDTH, Query % 4);
+		Query = (Query + 1) % NUM_QUERIES;
+	});
+
+	pBench->Run("dummy.freeze_distance", [&]() {
+		g_BenchmarkSink += vDist[s_aQueries[Query]] <= max(2, Query % 4);
+		Query = (Query + 1) % NUM_QUERIES;
+	});
+}
+
+static void BenchmarkPlotFile(CBenchmark *pBench)
+{
+	if(!pBench->Wanted("plot.save") && !pBench->Wanted("plot.load"))
+		return;
+
+	// a plot crammed with objects, written to a scratch file next to the binary
+	CPlotFile::CInfo Info;
+	mem_zero(&Info, sizeof(Info));
+	str_copy(Info.m_aOwner, "owner", sizeof(Info.m_aOwner));
+	str_copy(Info.m_aDisplayName, "display name", sizeof(Info.m_aDisplayName));
+	std::vector<CPlotFile::CObject> vObjects(NUM_PLOT_OBJECTS);
+	for(int i = 0; i < NUM_PLOT_OBJECTS; i++)
+	{
+		mem_zero(&vObjects[i], sizeof(vObjects[i]));
+		vObjects[i].m_Type = i % 2 ? CGameWorld::ENTTYPE_DOOR : CGameWorld::ENTTYPE_SPEEDUP;
+		vObjects[i].m_Pos = vec2(i * 32.f, i * 16.f);
+		for(int a = 0; a < CPlotFile::NUM_OBJECT_ARGS; a++)
+			vObjects[i].m_aArgs[a] = i + a;
+	}
+
+	char aFilename[64];
+	str_format(aFilename, sizeof(aFilename), "benchmark_plot-%d.dat", pid());
+	pBench->Run("plot.save", [&]() {
+		g_BenchmarkSink += CPlotFile::Save(aFilename, &Info, vObjects);
+	});
+
+	CPlotFile::Save(aFilename, &Info, vObjects);
+	std::vector<CPlotFile::CObject> vLoaded;
+	pBench->Run("plot.load", [&]() {
+		vLoaded.clear();
+		g_BenchmarkSink += CPlotFile::Load(aFilename, &Info, &vLoaded);
+	});
+	fs_remove(aFilename);
+}
+
+static void BenchmarkPlotOwners(CBenchmark *pBench)
+{
+	// the lookup cost should stay flat with the number of plots
+	static const int s_aNumPlots[] = { 64, 512, 4096 };
+
+	for(unsigned n = 0; n < sizeof(s_aNumPlots) / sizeof(s_aNumPlots[0]); n++)
+	{
+		char aName[64];
+		str_format(aName, sizeof(aName), "plot.has_plot.%d", s_aNumPlots[n]);
+		if(!pBench->Wanted(aName))
+			continue;
+
+		CPlotOwnerIndex Index;
+		char aBuf[NETADDR_MAXSTRSIZE];
+		NETADDR Cur, Last;
+		for(int i = 0; i < s_aNumPlots[n]; i++)
+		{
+			str_format(aBuf, sizeof(aBuf), "10.0.%d.%d", i / 256, i % 256);
+			net_addr_from_str(&Cur, aBuf);
+			str_format(aBuf, sizeof(aBuf), "11.0.%d.%d", i / 256, i % 256);
+			net_addr_from_str(&Last, aBuf);
+			Index.SetOwner(i + 1, &Cur, &Last);
+		}
+
+		// every other lookup finds a plot
+		NETADDR Miss, Hit;
+		net_addr_from_str(&Miss, "12.0.0.1");
+		net_addr_from_str(&Hit, "11.0.0.1");
+		int Query = 0;
+		pBench->Run(aName, [&]() {
+			g_BenchmarkSink += Index.HasPlot(Query % 2 ? &Hit : &Miss);
+			Query++;
+		});
+	}
+}
+
+static void BenchmarkWhoIs(CBenchmark *pBench)
+{
+	if(!pBench->Wanted("whois.lookup") && !pBench->Wanted("whois.similar"))
+		return;
+
+	// a long running server: names made of a few syllables, most players coming back from a handful of ips
+	static const char *s_apSyllables[] = {
+		"ka", "ro", "mi", "tee", "nu", "zap", "ol", "fi", "der", "xo", "ba", "lin", "ju", "po", "st", "ex",
+		"gor", "wy", "qi", "hel", "vam", "sun", "ek", "ty", "bru", "fox", "im", "dak", "ze", "ch", "ur", "plo",
+		"Ma", "Xx", "_", "Pro", "!", "Ne", "Ro", "-", "Sky", "007", "Ga", "Lu", "Ki", "By", "DJ", "Oz"};
+	CWhoIsIndex Index;
+	char aName[16];
+	char aAddr[16];
+	unsigned Seed = 7;
+	for(int i = 0; i < NUM_WHOIS_CONNECTS; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		unsigned Player = (Seed >> 8) % (NUM_WHOIS_CONNECTS / 2);
+		unsigned Bits = Player * 2654435761u;
+		aName[0] = 0;
+		for(unsigned s = 0; s < 2 + Bits % 3; s++)
+			str_append(aName, s_apSyllables[(Bits >> (4 + s * 6)) % 48], sizeof(aName));
+		str_format(aName + str_length(aName), sizeof(aName) - str_length(aName), "%d", Player % 97);
+		Seed = Seed * 1103515245 + 12345;
+		unsigned Ip = Player * 7 + (Seed >> 28) % 3;
+		str_format(aAddr, sizeof(aAddr), "%d.%d.%d.%d", 10 + Ip % 200, (Ip >> 8) & 255, (Ip >> 16) & 255, Ip & 255);
+		Index.Add(aName, aAddr);
+	}
+
+	int Query = 0;
+	pBench->Run("whois.lookup", [&]() {
+		Query = (Query * 7 + 1) % Index.Num(CWhoIsIndex::TABLE_NAME);
+		int Name = Index.Find(CWhoIsIndex::TABLE_NAME, Index.GetKey(CWhoIsIndex::TABLE_NAME, Query));
+		int Addr = Index.GetLinkEntry(Index.FirstLink(CWhoIsIndex::TABLE_NAME, Name));
+		g_BenchmarkSink += Index.Find(CWhoIsIndex::TABLE_ADDR, Index.GetKey(CWhoIsIndex::TABLE_ADDR, Addr));
+	});
+
+	std::vector<int> vNames;
+	pBench->Run("whois.similar", [&]() {
+		Query = (Query * 7 + 1) % Index.Num(CWhoIsIndex::TABLE_NAME);
+		Index.FindSimilarNames(Index.GetKey(CWhoIsIndex::TABLE_NAME, Query), 10, &vNames);
+		g_BenchmarkSink += vNames.size();
+	});
+}
+
+static void BenchmarkSwitchers(CBenchmark *pBench, CGameContext *pGameServer)
+{
+	if(!pBench->Wanted("switch.tick"))
+		return;
+
+	// a map using every switch number, with a few players in different teams standing on switches
+	CCollision *pCollision = pGameServer->Collision();
+	CCollision::SSwitchers *pOldSwitchers = pCollision->m_pSwitchers;
+	pCollision->m_pSwitchers = new CCollision::SSwitchers[NUM_SWITCHERS];
+	for(int i = 0; i < NUM_SWITCHERS; i++)
+	{
+		for(int j = 0; j < VANILLA_MAX_CLIENTS; j++)
+		{
+			pCollision->m_pSwitchers[i].m_Status[j] = true;
+			pCollision->m_pSwitchers[i].m_EndTick[j] = 0;
+			pCollision->m_pSwitchers[i].m_Type[j] = 0;
+			pCollision->m_pSwitchers[i].m_ClientID[j] = -1;
+			pCollision->m_pSwitchers[i].m_StartTick[j] = 0;
+		}
+	}
+
+	int Tick = pGameServer->Server()->Tick();
+	pBench->Run("switch.tick", [&]() {
+		for(int i = 0; i < NUM_ACTIVE_SWITCHES; i++)
+		{
+			int Number = 1 + i * 13 % (NUM_SWITCHERS - 1);
+			int Team = i * 3 % VANILLA_MAX_CLIENTS;
+			pGameServer->SetSwitch(Number, Team, true, i % 2 ? TILE_SWITCHTIMEDOPEN : TILE_SWITCHOPEN, i % 2 ? Tick + 250 : 0);
+			pGameServer->SetSwitchActivator(Number, Team, i);
+		}
+		pGameServer->UpdateSwitchers();
+		g_BenchmarkSink += pGameServer->m_SwitchTracker.Version();
+	});
+
+	delete[] pCollision->m_pSwitchers;
+	pCollision->m_pSwitchers = pOldSwitchers;
+}
+
+void BenchmarkGameServer(CBenchmark *pBench, IKernel *pKernel)
+{
+	CGameContext *pGameServer = (CGameContext *)pKernel->RequestInterface<IGameServer>();
+	pGameServer->m_World.SetGameServer(pGameServer);
+
+	BenchmarkFindEntities(pBench, &pGameServer->m_World);
+	BenchmarkAccounts(pBench, pGameServer);
+	BenchmarkSnapGrid(pBench);
+	BenchmarkFreezeDistance(pBench);
+	BenchmarkPlotFile(pBench);
+	BenchmarkPlotOwners(pBench);
+	BenchmarkWhoIs(pBench);
+	BenchmarkSwitchers(pBench, pGameServer);
+}
@@ -0,0 +1,24 @@
+#include "benchmark.h"
+
+#include <engine/shared/profiler.h>
+
+void BenchmarkProfiler(CBenchmark *pBench)
+{
+	// what a profiled section costs the tick while sv_profiler is off and while it is on
+	CProfiler Profiler;
+	int Section = Profiler.AddSection("benchmark");
+
+	pBench->Run("profiler.scope_disabled", [&]() {
+		CProfileScope Scope(&Profiler, Section);
+	});
+
+	Profiler.SetEnabled(true);
+	int Scopes = 0;
+	pBench->Run("profiler.scope_enabled", [&]() {
+		{
+			CProfileScope Scope(&Profiler, Section);
+		}
+		if(++Scopes % 1000 == 0)
+			Profiler.EndTick();
+	});
+}
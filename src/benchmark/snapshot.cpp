@@ -0,0 +1,138 @@
+#include "benchmark.h"
+
+#include <base/math.h>
+
+#include <engine/shared/compression.h>
+#include <engine/shared/huffman.h>
+#include <engine/shared/network.h>
+#include <engine/shared/snapshot.h>
+
+#include <generated/protocol.h>
+
+enum
+{
+	SNAP_PLAYERS=64,
+	SNAP_PICKUPS=150,
+	SNAP_PROJECTILES=100,
+	SNAP_LASERS=40,
+};
+
+static CSnapshotBuilder s_Builder;
+static int s_aFrom[CSnapshot::MAX_SIZE/sizeof(int)];
+static int s_aTo[CSnapshot::MAX_SIZE/sizeof(int)];
+static int s_aUnpacked[CSnapshot::MAX_SIZE/sizeof(int)];
+static int s_aDelta[CSnapshot::MAX_SIZE/sizeof(int)];
+static int s_aCompressed[CSnapshot::MAX_SIZE/sizeof(int)];
+
+// a busy server as seen by one client: moving players, static pickups and a few shots
+// that spawn and vanish every tick
+static int BuildSnapshot(int Tick, void *pData)
+{
+	s_Builder.Init();
+
+	for(int i = 0; i < SNAP_PLAYERS; i++)
+	{
+		CNetObj_PlayerInfo *pInfo = (CNetObj_PlayerInfo *)s_Builder.NewItem(NETOBJTYPE_PLAYERINFO, i, sizeof(CNetObj_PlayerInfo));
+		pInfo->m_PlayerFlags = 0;
+		pInfo->m_Score = i * 3;
+		pInfo->m_Latency = 20 + (i + Tick / 50) % 30;
+
+		CNetObj_Character *pChar = (CNetObj_Character *)s_Builder.NewItem(NETOBJTYPE_CHARACTER, i, sizeof(CNetObj_Character));
+		mem_zero(pChar, sizeof(CNetObj_Character));
+		pChar->m_Tick = Tick;
+		pChar->m_X = 1000 + i * 64 + (Tick * (i % 7 + 1)) % 400;
+		pChar->m_Y = 2000 + (i % 8) * 32;
+		pChar->m_VelX = (i % 7 + 1) * 256;
+		pChar->m_Angle = (Tick * 13 + i * 97) % 628;
+		pChar->m_Direction = i % 3 - 1;
+		pChar->m_HookState = i % 4 == 0 ? 3 : 0;
+		pChar->m_HookX = pChar->m_X + 100;
+		pChar->m_HookY = pChar->m_Y - 200;
+		pChar->m_Health = 10;
+		pChar->m_Armor = i % 11;
+		pChar->m_AmmoCount = 10 - (Tick / 10 + i) % 10;
+		pChar->m_Weapon = i % 6;
+	}
+
+	for(int i = 0; i < SNAP_PICKUPS; i++)
+	{
+		CNetObj_Pickup *pPickup = (CNetObj_Pickup *)s_Builder.NewItem(NETOBJTYPE_PICKUP, SNAP_PLAYERS + i, sizeof(CNetObj_Pickup));
+		pPickup->m_X = 500 + (i % 30) * 96;
+		pPickup->m_Y = 800 + (i / 30) * 160;
+		pPickup->m_Type = i % 5;
+	}
+
+	// projectiles are snapped with their start position, only the set changes
+	for(int i = 0; i < SNAP_PROJECTILES; i++)
+	{
+		int ID = Tick + i;
+		CNetObj_Projectile *pProj = (CNetObj_Projectile *)s_Builder.NewItem(NETOBJTYPE_PROJECTILE, 1024 + ID % 4096, sizeof(CNetObj_Projectile));
+		pProj->m_X = 1000 + (ID * 37) % 2000;
+		pProj->m_Y = 1500 + (ID * 11) % 600;
+		pProj->m_VelX = (ID % 5 - 2) * 200;
+		pProj->m_VelY = -100;
+		pProj->m_Type = ID % 3 + 1;
+		pProj->m_StartTick = ID;
+	}
+
+	for(int i = 0; i < SNAP_LASERS; i++)
+	{
+		int ID = Tick / 2 + i;
+		CNetObj_Laser *pLaser = (CNetObj_Laser *)s_Builder.NewItem(NETOBJTYPE_LASER, 8192 + ID % 4096, sizeof(CNetObj_Laser));
+		pLaser->m_X = 1200 + (ID * 53) % 1800;
+		pLaser->m_Y = 1800 + (ID * 7) % 300;
+		pLaser->m_FromX = pLaser->m_X - 300;
+		pLaser->m_FromY = pLaser->m_Y;
+		pLaser->m_StartTick = ID * 2;
+	}
+
+	return s_Builder.Finish(pData);
+}
+
+void BenchmarkSnapshot(CBenchmark *pBench)
+{
+	static CSnapshotDelta s_Delta;
+	CNetObjHandler NetObjHandler;
+	for(int i = 0; i < NUM_NETOBJTYPES; i++)
+		s_Delta.SetStaticsize(i, NetObjHandler.GetObjSize(i));
+
+	BuildSnapshot(1000, s_aFrom);
+	BuildSnapshot(1001, s_aTo);
+	CSnapshot *pFrom = (CSnapshot *)s_aFrom;
+	CSnapshot *pTo = (CSnapshot *)s_aTo;
+	int DeltaSize = s_Delta.CreateDelta(pFrom, pTo, s_aDelta);
+
+	pBench->Run("snapshot.build", [&]() {
+		g_BenchmarkSink += BuildSnapshot(1002, s_aUnpacked);
+	});
+
+	pBench->Run("snapshot.create_delta", [&]() {
+		g_BenchmarkSink += s_Delta.CreateDelta(pFrom, pTo, s_aDelta);
+	});
+
+	pBench->Run("snapshot.unpack_delta", [&]() {
+		g_BenchmarkSink += s_Delta.UnpackDelta(pFrom, (CSnapshot *)s_aUnpacked, s_aDelta, DeltaSize);
+	});
+
+	// what the server does with the delta before it is split into packets
+	pBench->Run("snapshot.compress_delta", [&]() {
+		g_BenchmarkSink += CVariableInt::Compress(s_aDelta, DeltaSize, s_aCompressed, sizeof(s_aCompressed));
+	});
+
+	// the network layer then huffman codes every snapshot part, one op is a full payload
+	static CHuffman s_Huffman;
+	s_Huffman.Init();
+	static unsigned char s_aPacket[NET_MAX_PAYLOAD*2];
+	static unsigned char s_aPayload[NET_MAX_PAYLOAD];
+	int CompressedSize = CVariableInt::Compress(s_aDelta, DeltaSize, s_aCompressed, sizeof(s_aCompressed));
+	int PayloadSize = min(CompressedSize, (int)NET_MAX_PAYLOAD);
+	int PacketSize = s_Huffman.Compress(s_aCompressed, PayloadSize, s_aPacket, sizeof(s_aPacket));
+
+	pBench->Run("snapshot.huffman_compress", [&]() {
+		g_BenchmarkSink += s_Huffman.Compress(s_aCompressed, PayloadSize, s_aPacket, sizeof(s_aPacket));
+	});
+
+	pBench->Run("snapshot.huffman_decompress", [&]() {
+		g_BenchmarkSink += s_Huffman.Decompress(s_aPacket, PacketSize, s_aPayload, sizeof(s_aPayload));
+	});
+}
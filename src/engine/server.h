@@ -61,6 +61,8 @@ public:
 	virtual int *GetIdMap(int ClientID) = 0;
 	virtual int *GetReverseIdMap(int ClientID) = 0;
 
+	virtual class CProfiler *Profiler() = 0;
+
 	virtual void DummyJoin(int DummyID) = 0;
 	virtual void DummyLeave(int DummyID) = 0;
 
@@ -0,0 +1,147 @@
+#include <base/math.h>
+
+#include "mapdownload.h"
+
+CMapDownloadScheduler::CMapDownloadScheduler()
+{
+	mem_zero(m_aDownloads, sizeof(m_aDownloads));
+	m_NumActive = 0;
+	m_NextClient = 0;
+	m_pfnSendChunk = 0;
+	m_pUser = 0;
+	m_BytesPerSecond = 0;
+	m_MaxChunksPerRequest = 1;
+	m_ChunkSize = 1;
+	m_Tokens = 0;
+	m_Reserve = 0;
+	m_LastUpdate = 0;
+	m_RoundTrip = 0;
+}
+
+void CMapDownloadScheduler::Init(FSendChunk pfnSendChunk, void *pUser)
+{
+	m_pfnSendChunk = pfnSendChunk;
+	m_pUser = pUser;
+}
+
+void CMapDownloadScheduler::SetLimits(int BytesPerSecond, int MaxChunksPerRequest, int ChunkSize)
+{
+	m_BytesPerSecond = max(BytesPerSecond, 0);
+	m_MaxChunksPerRequest = max(MaxChunksPerRequest, 1);
+	m_ChunkSize = max(ChunkSize, 1);
+}
+
+int64 CMapDownloadScheduler::BurstSize() const
+{
+	// what is left over from one server tick, but never less than a few chunks
+	return max((int64)m_BytesPerSecond / 20, (int64)m_ChunkSize * 4);
+}
+
+int64 CMapDownloadScheduler::ReserveSize() const
+{
+	return (int64)m_ChunkSize * 2;
+}
+
+void CMapDownloadScheduler::Grant(int ClientID, int NumChunks)
+{
+	CDownload *pDownload = &m_aDownloads[ClientID];
+	if(!pDownload->m_Active)
+	{
+		mem_zero(pDownload, sizeof(*pDownload));
+		pDownload->m_Active = true;
+		m_NumActive++;
+	}
+	pDownload->m_Credit += NumChunks;
+	pDownload->m_NumSent = 0;
+}
+
+void CMapDownloadScheduler::Request(int ClientID, int NumChunks, int64 Now)
+{
+	// the request is the ack for the whole last batch, the time since its last chunk
+	// left is about one round trip plus the time the client needed to take it in
+	CDownload *pDownload = &m_aDownloads[ClientID];
+	if(pDownload->m_Active && pDownload->m_NumSent && !pDownload->m_Credit)
+	{
+		int64 Sample = Now - pDownload->m_LastSendTime;
+		m_RoundTrip = m_RoundTrip ? (m_RoundTrip * 7 + Sample) / 8 : Sample;
+	}
+	Grant(ClientID, NumChunks);
+}
+
+void CMapDownloadScheduler::Stop(int ClientID)
+{
+	if(!m_aDownloads[ClientID].m_Active)
+		return;
+	m_aDownloads[ClientID].m_Active = false;
+	m_NumActive--;
+}
+
+void CMapDownloadScheduler::AddTraffic(int Bytes)
+{
+	// snapshots may run the bucket into debt, but not further than one burst so the
+	// downloads pick up again quickly once things calm down
+	if(m_BytesPerSecond)
+		m_Tokens = max(m_Tokens - Bytes, -BurstSize());
+}
+
+void CMapDownloadScheduler::Update(int64 Now)
+{
+	if(m_BytesPerSecond)
+	{
+		if(m_LastUpdate)
+		{
+			int64 Elapsed = clamp(Now - m_LastUpdate, (int64)0, time_freq());
+			m_Tokens = min(m_Tokens + m_BytesPerSecond * Elapsed / time_freq(), BurstSize());
+			m_Reserve = min(m_Reserve + m_BytesPerSecond / 10 * Elapsed / time_freq(), ReserveSize());
+		}
+		else
+			m_Tokens = BurstSize();
+	}
+	m_LastUpdate = Now;
+
+	// the reserve only steps in while snapshots keep the bucket empty
+	int64 *pBudget = m_Tokens > 0 ? &m_Tokens : &m_Reserve;
+
+	// one chunk per download and pass, until the budget is used up or nobody has credit left
+	for(int Idle = 0; m_NumActive && Idle < MAX_CLIENTS;)
+	{
+		if(m_BytesPerSecond && *pBudget <= 0)
+			break;
+
+		int ClientID = m_NextClient;
+		m_NextClient = (m_NextClient + 1) % MAX_CLIENTS;
+		CDownload *pDownload = &m_aDownloads[ClientID];
+		if(!pDownload->m_Active || pDownload->m_Credit <= 0)
+		{
+			Idle++;
+			continue;
+		}
+
+		int Size = m_pfnSendChunk(ClientID, m_pUser);
+		if(Size <= 0)
+		{
+			Stop(ClientID);
+			Idle++;
+			continue;
+		}
+
+		Idle = 0;
+		pDownload->m_Credit--;
+		pDownload->m_NumSent++;
+		pDownload->m_LastSendTime = Now;
+		if(m_BytesPerSecond)
+			*pBudget -= Size;
+	}
+}
+
+int CMapDownloadScheduler::ChunksPerRequest() const
+{
+	if(!m_BytesPerSecond || !m_RoundTrip)
+		return m_MaxChunksPerRequest;
+
+	// enough to keep the client busy for two round trips at its share of the rate,
+	// the client asking usually isn't downloading yet
+	int64 Share = m_BytesPerSecond / (m_NumActive + 1);
+	int64 Chunks = Share * 2 * m_RoundTrip / time_freq() / m_ChunkSize + 1;
+	return (int)clamp(Chunks, (int64)1, (int64)m_MaxChunksPerRequest);
+}
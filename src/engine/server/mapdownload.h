@@ -0,0 +1,68 @@
+#ifndef ENGINE_SERVER_MAPDOWNLOAD_H
+#define ENGINE_SERVER_MAPDOWNLOAD_H
+
+#include <base/system.h>
+#include <engine/shared/protocol.h>
+
+// Spreads the map data of all running downloads over a shared token bucket. Clients
+// only earn credit by requesting chunks, the scheduler decides when those chunks are
+// actually sent and hands them out round robin so that a mass reconnect neither floods
+// the uplink nor lets a few clients finish at the expense of everyone else.
+// Snapshots are accounted with AddTraffic and always go first, only a small reserve of
+// the rate is kept for downloads so they can't stall completely on a full server.
+class CMapDownloadScheduler
+{
+public:
+	// sends the next chunk for a client, returns the bytes sent or 0 if the download is done
+	typedef int (*FSendChunk)(int ClientID, void *pUser);
+
+private:
+	struct CDownload
+	{
+		bool m_Active;
+		int m_Credit; // chunks the client asked for that weren't sent yet
+		int m_NumSent; // chunks sent since the last request
+		int64 m_LastSendTime;
+	};
+	CDownload m_aDownloads[MAX_CLIENTS];
+	int m_NumActive;
+	int m_NextClient;
+
+	FSendChunk m_pfnSendChunk;
+	void *m_pUser;
+
+	int m_BytesPerSecond; // 0 means unlimited
+	int m_MaxChunksPerRequest;
+	int m_ChunkSize;
+
+	int64 m_Tokens;
+	int64 m_Reserve;
+	int64 m_LastUpdate;
+	int64 m_RoundTrip; // smoothed time from the last chunk of a batch to the next request
+
+	int64 BurstSize() const;
+	int64 ReserveSize() const;
+
+public:
+	CMapDownloadScheduler();
+
+	void Init(FSendChunk pfnSendChunk, void *pUser);
+	void SetLimits(int BytesPerSecond, int MaxChunksPerRequest, int ChunkSize);
+
+	// a client asked for the next batch after it got the previous one
+	void Request(int ClientID, int NumChunks, int64 Now);
+	// gives credit without taking a round trip sample, for sliding windows
+	void Grant(int ClientID, int NumChunks);
+	void Stop(int ClientID);
+
+	// traffic that has priority over map data, e.g. snapshots
+	void AddTraffic(int Bytes);
+	void Update(int64 Now);
+
+	// how many chunks a client should ask for at once to get its share of the rate
+	int ChunksPerRequest() const;
+	int NumDownloads() const { return m_NumActive; }
+	bool IsActive(int ClientID) const { return m_aDownloads[ClientID].m_Active; }
+};
+
+#endif
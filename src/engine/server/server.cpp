@@ -294,6 +294,8 @@ void CServer::CClient::Reset()
 	m_SnapRate = CClient::SNAPRATE_INIT;
 	m_Score = 0;
 	m_MapChunk = 0;
+	m_NextMapChunk = 0;
+	m_MapChunksPerRequest = 1;
 
 	for (int i = 0; i < VANILLA_MAX_CLIENTS; i++)
 		m_aIdMap[i] = -1;
@@ -352,6 +354,11 @@ CServer::CServer() : m_DemoRecorder(&m_SnapshotDelta)
 	m_CurrentGameTick = 0;
 	m_RunServer = UNINITIALIZED;
 
+	m_aProfileSections[PROFILE_TICK] = m_Profiler.AddSection("server.tick");
+	m_aProfileSections[PROFILE_SNAPSHOT] = m_Profiler.AddSection("server.snapshot");
+	m_aProfileSections[PROFILE_NETWORK] = m_Profiler.AddSection("server.network");
+	m_aProfileSections[PROFILE_MASTER] = m_Profiler.AddSection("server.master");
+
 	m_pCurrentMapData = 0;
 	m_CurrentMapSize = 0;
 
@@ -876,8 +883,8 @@ void CServer::DoSnapshot()
 {
 	GameServer()->OnPreSnap();
 
-	// create snapshot for demo recording
-	if(m_DemoRecorder.IsRecording())
+	// create snapshot for demo recording, unless the demo writer is behind and would drop it anyway
+	if(m_DemoRecorder.IsRecording() && m_DemoRecorder.WantSnapshot())
 	{
 		char aData[CSnapshot::MAX_SIZE];
 		int SnapshotSize;
@@ -961,6 +968,7 @@ void CServer::DoSnapshot()
 
 				SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
 				NumPackets = (SnapshotSize+MaxSize-1)/MaxSize;
+				m_MapDownloads.AddTraffic(SnapshotSize);
 
 				for(int n = 0, Left = SnapshotSize; Left > 0; n++)
 				{
@@ -1080,6 +1088,7 @@ int CServer::DelClientCallback(int ClientID, const char *pReason, void *pUser)
 	}
 
 	pThis->m_aClients[ClientID].m_Snapshots.PurgeAll();
+	pThis->m_MapDownloads.Stop(ClientID);
 	pThis->m_aClients[ClientID].ResetContent();
 	pThis->GameServer()->OnClientEngineDrop(ClientID, pReason);
 	pThis->Antibot()->OnEngineClientDrop(ClientID, pReason);
@@ -1142,16 +1151,71 @@ void CServer::LoadUpdateFakeMap()
 
 void CServer::SendFakeMap(int ClientID)
 {
+	StartMapDownload(ClientID);
+
 	CMsgPacker Msg(NETMSG_MAP_CHANGE, true);
 	Msg.AddString(Config()->m_FakeMapName, 0);
 	Msg.AddInt(m_FakeMapCrc);
 	Msg.AddInt(m_FakeMapSize);
 	SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH, ClientID);
+}
 
+void CServer::StartMapDownload(int ClientID)
+{
+	// chunks still owed for an earlier download belong to the old map
+	m_MapDownloads.Stop(ClientID);
 	m_aClients[ClientID].m_MapChunk = 0;
+	m_aClients[ClientID].m_NextMapChunk = 0;
+	m_aClients[ClientID].m_MapChunksPerRequest = m_MapDownloads.ChunksPerRequest();
+}
+
+int CServer::SendMapChunkCallback(int ClientID, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	CClient *pClient = &pThis->m_aClients[ClientID];
+	if (pClient->m_Sevendown)
+		return pThis->SendMapData(ClientID, pClient->m_NextMapChunk++, pClient->m_State == CClient::STATE_FAKE_MAP);
+
+	if (pClient->m_MapChunk < 0)
+		return 0;
+
+	int Chunk = pClient->m_MapChunk;
+	int ChunkSize = MAP_CHUNK_SIZE;
+	unsigned int Offset = Chunk * ChunkSize;
+
+	unsigned char *pMapData = pThis->m_pCurrentMapData;
+	unsigned int Size = pThis->m_CurrentMapSize;
+
+	int Design = pClient->m_CurrentMapDesign;
+	if (pClient->m_DesignChange && Design != -1)
+	{
+		pMapData = pThis->m_aMapDesign[Design].m_pData;
+		Size = pThis->m_aMapDesign[Design].m_Size;
+	}
+
+	// check for last part
+	if(Offset+ChunkSize >= Size)
+	{
+		ChunkSize = Size-Offset;
+		pClient->m_MapChunk = -1;
+	}
+	else
+		pClient->m_MapChunk++;
+
+	CMsgPacker Msg(NETMSG_MAP_DATA, true);
+	Msg.AddRaw(&pMapData[Offset], ChunkSize);
+	pThis->SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH, ClientID);
+
+	if(pThis->Config()->m_Debug)
+	{
+		char aBuf[64];
+		str_format(aBuf, sizeof(aBuf), "sending chunk %d with size %d", Chunk, ChunkSize);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_DEBUG, "server", aBuf);
+	}
+	return Msg.Size();
 }
 
-void CServer::SendMapData(int ClientID, int Chunk, bool FakeMap)
+int CServer::SendMapData(int ClientID, int Chunk, bool FakeMap)
 {
 	unsigned int ChunkSize = 1024-128;
 	unsigned int Offset = Chunk * ChunkSize;
@@ -1177,7 +1241,7 @@ void CServer::SendMapData(int ClientID, int Chunk, bool FakeMap)
 
 	// drop faulty map data requests
 	if(Chunk < 0 || Offset > MapSize)
-		return;
+		return 0;
 
 	if(Offset+ChunkSize >= MapSize)
 	{
@@ -1192,6 +1256,7 @@ void CServer::SendMapData(int ClientID, int Chunk, bool FakeMap)
 	Msg.AddInt(ChunkSize);
 	Msg.AddRaw(&pMapData[Offset], ChunkSize);
 	SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH, ClientID);
+	return Msg.Size();
 }
 
 void CServer::SendMap(int ClientID)
@@ -1205,6 +1270,8 @@ void CServer::SendMap(int ClientID)
 		Msg.AddString(GetHttpsMapURL(), 0);
 		SendMsg(&Msg, MSGFLAG_VITAL, ClientID);
 	}
+
+	StartMapDownload(ClientID);
 	{
 		CMsgPacker Msg(NETMSG_MAP_CHANGE, true);
 		Msg.AddString(GetMapName(), 0);
@@ -1212,14 +1279,12 @@ void CServer::SendMap(int ClientID)
 		Msg.AddInt(m_CurrentMapSize);
 		if (!m_aClients[ClientID].m_Sevendown)
 		{
-			Msg.AddInt(m_MapChunksPerRequest);
+			Msg.AddInt(m_aClients[ClientID].m_MapChunksPerRequest);
 			Msg.AddInt(MAP_CHUNK_SIZE);
 			Msg.AddRaw(&m_CurrentMapSha256, sizeof(m_CurrentMapSha256));
 		}
 		SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH, ClientID);
 	}
-
-	m_aClients[ClientID].m_MapChunk = 0;
 }
 
 void CServer::SendConnectionReady(int ClientID)
@@ -1544,60 +1609,24 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 						return;
 					}
 
+					// the first request opens the send-ahead window, every further one moves it by a chunk
 					if (Chunk == 0)
-					{
-						for (int i = 0; i < Config()->m_SvMapWindow; i++)
-							SendMapData(ClientID, i, SendingFakeMap);
-					}
-					SendMapData(ClientID, Config()->m_SvMapWindow + m_aClients[ClientID].m_MapChunk, SendingFakeMap);
+						m_MapDownloads.Grant(ClientID, min(Config()->m_SvMapWindow, m_aClients[ClientID].m_MapChunksPerRequest) + 1);
+					else
+						m_MapDownloads.Grant(ClientID, 1);
 					m_aClients[ClientID].m_MapChunk++;
 					return;
 				}
 
-				int ChunkSize = MAP_CHUNK_SIZE;
-
-				// send map chunks
-				for(int i = 0; i < m_MapChunksPerRequest && m_aClients[ClientID].m_MapChunk >= 0; ++i)
-				{
-					int Chunk = m_aClients[ClientID].m_MapChunk;
-					unsigned int Offset = Chunk * ChunkSize;
-
-					unsigned char *pMapData = m_pCurrentMapData;
-					unsigned int Size = m_CurrentMapSize;
-
-					int Design = m_aClients[ClientID].m_CurrentMapDesign;
-					if (m_aClients[ClientID].m_DesignChange && Design != -1)
-					{
-						pMapData = m_aMapDesign[Design].m_pData;
-						Size = m_aMapDesign[Design].m_Size;
-					}
-
-					// check for last part
-					if(Offset+ChunkSize >= Size)
-					{
-						ChunkSize = Size-Offset;
-						m_aClients[ClientID].m_MapChunk = -1;
-					}
-					else
-						m_aClients[ClientID].m_MapChunk++;
-
-					CMsgPacker Msg(NETMSG_MAP_DATA, true);
-					Msg.AddRaw(&pMapData[Offset], ChunkSize);
-					SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH, ClientID);
-
-					if(Config()->m_Debug)
-					{
-						char aBuf[64];
-						str_format(aBuf, sizeof(aBuf), "sending chunk %d with size %d", Chunk, ChunkSize);
-						Console()->Print(IConsole::OUTPUT_LEVEL_DEBUG, "server", aBuf);
-					}
-				}
+				// the chunks go out with the next scheduler update
+				m_MapDownloads.Request(ClientID, m_aClients[ClientID].m_MapChunksPerRequest, time_get());
 			}
 		}
 		else if(Msg == NETMSG_READY)
 		{
 			if((pPacket->m_Flags & NET_CHUNKFLAG_VITAL) != 0)
 			{
+				m_MapDownloads.Stop(ClientID);
 				SendConnectionReady(ClientID);
 
 				if (m_aClients[ClientID].m_State == CClient::STATE_CONNECTING || m_aClients[ClientID].m_State == CClient::STATE_CONNECTING_AS_SPEC)
@@ -2683,7 +2712,7 @@ int CServer::Run()
 		dbg_msg("server", "failed to load map. mapname='%s'", Config()->m_SvMap);
 		return -1;
 	}
-	m_MapChunksPerRequest = Config()->m_SvMapDownloadSpeed;
+	m_MapDownloads.Init(SendMapChunkCallback, this);
 
 	// start server
 	NETADDR BindAddr;
@@ -2824,7 +2853,10 @@ int CServer::Run()
 					}
 				}
 
-				GameServer()->OnTick();
+				{
+					CProfileScope Scope(&m_Profiler, m_aProfileSections[PROFILE_TICK]);
+					GameServer()->OnTick();
+				}
 
 				// remove after 24 hours because iphub.info has 1000 free requests within 24 hours
 				// actually lets use 48 hours just to be safe
@@ -2908,7 +2940,10 @@ int CServer::Run()
 			if(NewTicks)
 			{
 				if(Config()->m_SvHighBandwidth || ShouldSnap)
+				{
+					CProfileScope Scope(&m_Profiler, m_aProfileSections[PROFILE_SNAPSHOT]);
 					DoSnapshot();
+				}
 
 				UpdateClientRconCommands();
 				UpdateClientMapListEntries();
@@ -2919,16 +2954,31 @@ int CServer::Run()
 			}
 
 			// master server stuff
-			m_pRegister->Update();
-			if (IsDoubleInfo())
-				m_pRegisterTwo->Update();
+			{
+				CProfileScope Scope(&m_Profiler, m_aProfileSections[PROFILE_MASTER]);
+				m_pRegister->Update();
+				if (IsDoubleInfo())
+					m_pRegisterTwo->Update();
 
-			if (m_ServerInfoNeedsUpdate)
-				UpdateServerInfo();
+				if (m_ServerInfoNeedsUpdate)
+					UpdateServerInfo();
+			}
 
 			Antibot()->OnEngineTick();
 
-			PumpNetwork();
+			{
+				CProfileScope Scope(&m_Profiler, m_aProfileSections[PROFILE_NETWORK]);
+				PumpNetwork();
+
+				// map data goes out at the pace of the shared budget, whatever the snapshots left of it
+				m_MapDownloads.SetLimits(Config()->m_SvMapDownloadRate*1024, Config()->m_SvMapDownloadSpeed, MAP_CHUNK_SIZE);
+				m_MapDownloads.Update(time_get());
+			}
+
+			// everything since the last game tick counts towards the next one
+			if(NewTicks)
+				m_Profiler.EndTick();
+			m_Profiler.SetEnabled(Config()->m_SvProfiler);
 
 			{
 				bool ServerEmpty = true;
@@ -3468,6 +3518,32 @@ void CServer::ConLogout(IConsole::IResult *pResult, void *pUser)
 	}
 }
 
+void CServer::ConProfiler(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	CProfiler *pProfiler = &pThis->m_Profiler;
+	const char *pFilter = pResult->NumArguments() ? pResult->GetString(0) : "";
+	if(!pProfiler->IsEnabled())
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profiler", "profiler is disabled, showing old samples only (sv_profiler 1)");
+
+	char aBuf[256];
+	for(int i = 0; i < pProfiler->NumSections(); i++)
+	{
+		CProfiler::CStats Stats;
+		if(!str_find(pProfiler->SectionName(i), pFilter) || !pProfiler->GetStats(i, &Stats))
+			continue;
+
+		str_format(aBuf, sizeof(aBuf), "%-28s p50=%.3fms p99=%.3fms max=%.3fms samples=%d", pProfiler->SectionName(i),
+			Stats.m_P50 / 1000000.0, Stats.m_P99 / 1000000.0, Stats.m_Max / 1000000.0, Stats.m_NumSamples);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profiler", aBuf);
+	}
+}
+
+void CServer::ConProfilerReset(IConsole::IResult *pResult, void *pUser)
+{
+	((CServer *)pUser)->m_Profiler.Reset();
+}
+
 void CServer::ConShowIps(IConsole::IResult *pResult, void *pUser)
 {
 	CServer *pServer = (CServer *)pUser;
@@ -3673,6 +3749,8 @@ void CServer::RegisterCommands()
 	Console()->Register("shutdown", "?r[message]", CFGFLAG_SERVER, ConShutdown, this, "Shut down", AUTHED_ADMIN);
 	Console()->Register("logout", "", CFGFLAG_SERVER, ConLogout, this, "Logout of rcon", AUTHED_HELPER);
 	Console()->Register("show_ips", "?i[show]", CFGFLAG_SERVER, ConShowIps, this, "Show IP addresses in rcon commands (1 = on, 0 = off)", AUTHED_ADMIN);
+	Console()->Register("profiler", "?s[filter]", CFGFLAG_SERVER|CFGFLAG_ECON, ConProfiler, this, "Show p50/p99/max time per tick of the profiled sections (needs sv_profiler 1)", AUTHED_ADMIN);
+	Console()->Register("profiler_reset", "", CFGFLAG_SERVER|CFGFLAG_ECON, ConProfilerReset, this, "Clear the collected profiler samples", AUTHED_ADMIN);
 
 	Console()->Register("record", "?s[file]", CFGFLAG_SERVER|CFGFLAG_STORE, ConRecord, this, "Record to a file", AUTHED_ADMIN);
 	Console()->Register("stoprecord", "", CFGFLAG_SERVER, ConStopRecord, this, "Stop recording", AUTHED_ADMIN);
@@ -3748,114 +3826,6 @@ void CServer::SnapSetStaticsize(int ItemType, int Size)
 	m_SnapshotDelta.SetStaticsize(ItemType, Size);
 }
 
-static CServer *CreateServer() { return new CServer(); }
-
-int main(int argc, const char **argv) // ignore_convention
-{
-#if defined(CONF_FAMILY_WINDOWS)
-	for(int i = 1; i < argc; i++) // ignore_convention
-	{
-		if(str_comp("-s", argv[i]) == 0 || str_comp("--silent", argv[i]) == 0) // ignore_convention
-		{
-			ShowWindow(GetConsoleWindow(), SW_HIDE);
-			break;
-		}
-	}
-#endif
-
-	bool UseDefaultConfig = false;
-	for(int i = 1; i < argc; i++) // ignore_convention
-	{
-		if(str_comp("-d", argv[i]) == 0 || str_comp("--default", argv[i]) == 0) // ignore_convention
-		{
-			UseDefaultConfig = true;
-			break;
-		}
-	}
-
-	if(secure_random_init() != 0)
-	{
-		dbg_msg("secure", "could not initialize secure RNG");
-		return -1;
-	}
-
-	CServer *pServer = CreateServer();
-	IKernel *pKernel = IKernel::Create();
-
-	// create the components
-	int FlagMask = CFGFLAG_SERVER|CFGFLAG_ECON;
-	IEngine *pEngine = CreateEngine("Teeworlds_Server");
-	IEngineMap *pEngineMap = CreateEngineMap();
-	IGameServer *pGameServer = CreateGameServer();
-	IConsole *pConsole = CreateConsole(CFGFLAG_SERVER|CFGFLAG_ECON);
-	IStorage *pStorage = CreateStorage("Teeworlds", IStorage::STORAGETYPE_SERVER, argc, argv); // ignore_convention
-	IConfigManager *pConfigManager = CreateConfigManager();
-	IEngineAntibot *pEngineAntibot = CreateEngineAntibot();
-
-	{
-		bool RegisterFail = false;
-
-		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pServer); // register as both
-		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pEngine);
-		RegisterFail = RegisterFail || !pKernel->RegisterInterface(static_cast<IEngineMap*>(pEngineMap)); // register as both
-		RegisterFail = RegisterFail || !pKernel->RegisterInterface(static_cast<IMap*>(pEngineMap));
-		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pGameServer);
-		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pConsole);
-		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pStorage);
-		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pConfigManager);
-		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pEngineAntibot);
-		RegisterFail = RegisterFail || !pKernel->RegisterInterface(static_cast<IAntibot*>(pEngineAntibot));
-
-		if(RegisterFail)
-			return -1;
-	}
-
-	pEngine->Init();
-	pConfigManager->Init(FlagMask);
-	pConsole->Init();
-
-	pServer->InitInterfaces(pConfigManager->Values(), pConsole, pGameServer, pEngineMap, pStorage, pEngineAntibot);
-	if(!UseDefaultConfig)
-	{
-		// register all console commands
-		pServer->RegisterCommands();
-
-		// execute autoexec file
-		pConsole->ExecuteFile("autoexec.cfg");
-
-		// parse the command line arguments
-		if(argc > 1) // ignore_convention
-			pConsole->ParseArguments(argc-1, &argv[1]); // ignore_convention
-	}
-
-	// restore empty config strings to their defaults
-	pConfigManager->RestoreStrings();
-
-	// these variables cant be changed ingame
-	pConsole->Register("sv_test_cmds", "", CFGFLAG_SERVER, CServer::ConTestingCommands, pServer, "Turns testing commands aka cheats on/off", AUTHED_ADMIN);
-	pConsole->Register("sv_rescue", "", CFGFLAG_SERVER, CServer::ConRescue, pServer, "Allow /rescue command so players can teleport themselves out of freeze", AUTHED_ADMIN);
-	pConsole->Register("sv_euro_mode", "", CFGFLAG_SERVER, CServer::ConEuroMode, pServer, "Whether euro mode is enabled", AUTHED_ADMIN);
-	pConsole->Register("sv_port", "", CFGFLAG_SERVER, CServer::ConPort, pServer, "Port to use for the server", AUTHED_ADMIN);
-
-	pEngine->InitLogfile();
-
-	// run the server
-	dbg_msg("server", "starting...");
-	int Ret = pServer->Run();
-
-	// free
-	delete pServer;
-	delete pKernel;
-	delete pEngine;
-	delete pEngineMap;
-	delete pGameServer;
-	delete pConsole;
-	delete pStorage;
-	delete pConfigManager;
-
-	return Ret;
-}
-
 // F-DDrace
 
 void CServer::GetClientAddr(int ClientID, NETADDR* pAddr)
@@ -4479,6 +4449,8 @@ void CServer::SendMapDesign(int ClientID, int Design)
 		Msg.AddString(GetHttpsMapURL(Design), 0);
 		SendMsg(&Msg, MSGFLAG_VITAL, ClientID);
 	}
+
+	StartMapDownload(ClientID);
 	{
 		CMsgPacker Msg(NETMSG_MAP_CHANGE, true);
 		Msg.AddString(aName, 0);
@@ -4486,14 +4458,12 @@ void CServer::SendMapDesign(int ClientID, int Design)
 		Msg.AddInt(m_aMapDesign[Design].m_Size);
 		if (!m_aClients[ClientID].m_Sevendown)
 		{
-			Msg.AddInt(m_MapChunksPerRequest);
+			Msg.AddInt(m_aClients[ClientID].m_MapChunksPerRequest);
 			Msg.AddInt(MAP_CHUNK_SIZE);
 			Msg.AddRaw(&m_aMapDesign[Design].m_Sha256, sizeof(m_aMapDesign[Design].m_Sha256));
 		}
 		SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH, ClientID);
 	}
-
-	m_aClients[ClientID].m_MapChunk = 0;
 }
 
 const char *CServer::GetMapDesign(int ClientID)
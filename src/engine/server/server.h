@@ -12,11 +12,13 @@
 #include <engine/shared/econ.h>
 #include <engine/shared/mapchecker.h>
 #include <engine/shared/netban.h>
+#include <engine/shared/profiler.h>
 #include "register.h"
 #include <engine/shared/fifo.h>
 
 #include "antibot.h"
 #include "authmanager.h"
+#include "mapdownload.h"
 #include <engine/engine.h>
 #include <list>
 #include <vector>
@@ -182,6 +184,8 @@ public:
 		int m_AuthTries;
 
 		int m_MapChunk;
+		int m_NextMapChunk; // the next chunk the download scheduler sends a 0.6 client
+		int m_MapChunksPerRequest; // fixed when the download starts
 		bool m_NoRconNote;
 		bool m_Quitting;
 		const IConsole::CCommandInfo *m_pRconCmdToSend;
@@ -276,6 +280,17 @@ public:
 #if defined(CONF_FAMILY_UNIX)
 	CFifo m_Fifo;
 #endif
+
+	CProfiler m_Profiler;
+	enum
+	{
+		PROFILE_TICK,
+		PROFILE_SNAPSHOT,
+		PROFILE_NETWORK,
+		PROFILE_MASTER,
+		NUM_PROFILE_SECTIONS
+	};
+	int m_aProfileSections[NUM_PROFILE_SECTIONS];
 	CServerBan m_ServerBan;
 
 	IEngineMap *m_pMap;
@@ -305,7 +320,9 @@ public:
 	unsigned m_CurrentMapCrc;
 	unsigned char *m_pCurrentMapData;
 	unsigned int m_CurrentMapSize;
-	int m_MapChunksPerRequest;
+	CMapDownloadScheduler m_MapDownloads;
+	static int SendMapChunkCallback(int ClientID, void *pUser);
+	void StartMapDownload(int ClientID);
 
 	// fake map
 	unsigned int m_FakeMapCrc;
@@ -412,7 +429,7 @@ public:
 
 	void SendRconType(int ClientID, bool UsernameReq);
 	void SendCapabilities(int ClientID);
-	void SendMapData(int ClientID, int Chunk, bool FakeMap);
+	int SendMapData(int ClientID, int Chunk, bool FakeMap);
 	void SendMap(int ClientID);
 	void SendFakeMap(int ClientID);
 	void SendConnectionReady(int ClientID);
@@ -480,6 +497,8 @@ public:
 	static void ConchainMapUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 
 	static void ConShowIps(IConsole::IResult* pResult, void* pUser);
+	static void ConProfiler(IConsole::IResult *pResult, void *pUser);
+	static void ConProfilerReset(IConsole::IResult *pResult, void *pUser);
 	void ConchainRconPasswordChangeGeneric(int Level, const char *pCurrent, IConsole::IResult *pResult);
 	static void ConchainRconPasswordChange(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainRconModPasswordChange(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
@@ -579,6 +598,8 @@ public:
 	int *GetIdMap(int ClientID) override;
 	int *GetReverseIdMap(int ClientID) override;
 
+	CProfiler *Profiler() override { return &m_Profiler; }
+
 	void DummyJoin(int DummyID) override;
 	void DummyLeave(int DummyID) override;
 
@@ -90,6 +90,8 @@ MACRO_CONFIG_STR(SvMap, sv_map, 128, "BlmapChill", CFGFLAG_SAVE|CFGFLAG_SERVER,
 MACRO_CONFIG_INT(SvMaxClients, sv_max_clients, 128, 1, MAX_CLIENTS, CFGFLAG_SAVE|CFGFLAG_SERVER, "Maximum number of clients that are allowed on a server", AUTHED_ADMIN)
 MACRO_CONFIG_INT(SvMaxClientsPerIP, sv_max_clients_per_ip, 4, 1, MAX_CLIENTS, CFGFLAG_SAVE|CFGFLAG_SERVER, "Maximum number of clients with the same IP that can connect to the server", AUTHED_ADMIN)
 MACRO_CONFIG_INT(SvMapDownloadSpeed, sv_map_download_speed, 16, 1, 16, CFGFLAG_SAVE|CFGFLAG_SERVER, "Number of map data packages a client gets on each request", AUTHED_ADMIN)
+MACRO_CONFIG_INT(SvMapDownloadRate, sv_map_download_rate, 4096, 0, 1000000, CFGFLAG_SAVE|CFGFLAG_SERVER, "Outgoing KiB/s shared by all map downloads, snapshots take their part first (0 = unlimited)", AUTHED_ADMIN)
+MACRO_CONFIG_INT(SvProfiler, sv_profiler, 0, 0, 1, CFGFLAG_SAVE|CFGFLAG_SERVER, "Measure the time spent in the server tick phases, see 'profiler'", AUTHED_ADMIN)
 MACRO_CONFIG_INT(SvHighBandwidth, sv_high_bandwidth, 0, 0, 1, CFGFLAG_SAVE|CFGFLAG_SERVER, "Use high bandwidth mode. Doubles the bandwidth required for the server. LAN use only", AUTHED_ADMIN)
 MACRO_CONFIG_STR(SvRconPassword, sv_rcon_password, 32, "", CFGFLAG_SAVE|CFGFLAG_SERVER|CFGFLAG_NONTEEHISTORIC, "Remote console password (full access)", AUTHED_ADMIN)
 MACRO_CONFIG_STR(SvRconModPassword, sv_rcon_mod_password, 32, "", CFGFLAG_SAVE|CFGFLAG_SERVER|CFGFLAG_NONTEEHISTORIC, "Remote console password for moderators (limited access)", AUTHED_ADMIN)
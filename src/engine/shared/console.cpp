@@ -381,6 +381,44 @@ bool CConsole::LineIsValid(const char *pStr)
 	return true;
 }
 
+CConsole::CCompiledLine *CConsole::CompiledLineSlot(const char *pLine, int Length)
+{
+	unsigned Hash = 5381;
+	for(int i = 0; i < Length; i++)
+		Hash = ((Hash << 5) + Hash) + pLine[i];
+	return &m_pCompiledLines[Hash%NUM_COMPILED_LINES];
+}
+
+const CConsole::CCompiledLine *CConsole::FindCompiledLine(const char *pLine, int Length)
+{
+	if(!m_pCompiledLines)
+		return 0;
+
+	const CCompiledLine *pCompiled = CompiledLineSlot(pLine, Length);
+	if(pCompiled->m_pCommand && pCompiled->m_Generation == m_CommandGeneration && pCompiled->m_FlagMask == m_FlagMask &&
+		pCompiled->m_Length == Length && mem_comp(pCompiled->m_aLine, pLine, Length) == 0)
+		return pCompiled;
+	return 0;
+}
+
+void CConsole::AddCompiledLine(const char *pLine, int Length, CCommand *pCommand, const CResult *pResult)
+{
+	if(Length >= CONSOLE_MAX_STR_LENGTH)
+		return;
+
+	if(!m_pCompiledLines)
+		m_pCompiledLines = new CCompiledLine[NUM_COMPILED_LINES];
+
+	CCompiledLine *pCompiled = CompiledLineSlot(pLine, Length);
+	mem_copy(pCompiled->m_aLine, pLine, Length);
+	pCompiled->m_aLine[Length] = 0;
+	pCompiled->m_Length = Length;
+	pCompiled->m_FlagMask = m_FlagMask;
+	pCompiled->m_Generation = m_CommandGeneration;
+	pCompiled->m_pCommand = pCommand;
+	pCompiled->m_Result = *pResult;
+}
+
 void CConsole::ExecuteLineStroked(int Stroke, const char* pStr, int ClientID, bool InterpretSemicolons)
 {
 	const char* pWithoutPrefix = str_startswith(pStr, "mc;");
@@ -420,13 +458,24 @@ void CConsole::ExecuteLineStroked(int Stroke, const char* pStr, int ClientID, bo
 			pEnd++;
 		}
 
-		if (ParseStart(&Result, pStr, (pEnd - pStr) + 1) != 0)
-			return;
+		CCommand* pCommand;
+		const CCompiledLine *pCompiled = FindCompiledLine(pStr, pEnd - pStr);
+		if (pCompiled)
+		{
+			Result = pCompiled->m_Result;
+			Result.m_ClientID = ClientID;
+			pCommand = pCompiled->m_pCommand;
+		}
+		else
+		{
+			if (ParseStart(&Result, pStr, (pEnd - pStr) + 1) != 0)
+				return;
 
-		if (!*Result.m_pCommand)
-			return;
+			if (!*Result.m_pCommand)
+				return;
 
-		CCommand* pCommand = FindCommand(Result.m_pCommand, m_FlagMask);
+			pCommand = FindCommand(Result.m_pCommand, m_FlagMask);
+		}
 
 		if (pCommand)
 		{
@@ -473,7 +522,7 @@ void CConsole::ExecuteLineStroked(int Stroke, const char* pStr, int ClientID, bo
 
 				if (Stroke || IsStrokeCommand)
 				{
-					if (ParseArgs(&Result, pCommand->m_pParams))
+					if (!pCompiled && ParseArgs(&Result, pCommand->m_pParams))
 					{
 						char aBuf[256];
 						str_format(aBuf, sizeof(aBuf), "Invalid arguments... Usage: %s %s", pCommand->m_pName, pCommand->m_pParams);
@@ -487,6 +536,10 @@ void CConsole::ExecuteLineStroked(int Stroke, const char* pStr, int ClientID, bo
 					}
 					else
 					{
+						// stroke commands depend on the stroke argument, don't remember them
+						if (!pCompiled && !IsStrokeCommand)
+							AddCompiledLine(pStr, pEnd - pStr, pCommand, &Result);
+
 						if(m_pfnTeeHistorianCommandCallback && !(pCommand->m_Flags&CFGFLAG_NONTEEHISTORIC))
 						{
 							m_pfnTeeHistorianCommandCallback(ClientID, m_FlagMask, pCommand->m_pName, &Result, m_pTeeHistorianCommandUserdata);
@@ -568,7 +621,7 @@ void CConsole::PossibleMaps(const char *pStr, FPossibleCallback pfnCallback, voi
 
 CConsole::CCommand *CConsole::FindCommand(const char *pName, int FlagMask)
 {
-	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	for(CCommand *pCommand = *CommandHashBucket(pName); pCommand; pCommand = pCommand->m_pHashNext)
 	{
 		if(pCommand->m_Flags&FlagMask)
 		{
@@ -947,6 +1000,9 @@ CConsole::CConsole(int FlagMask)
 	m_pLastMapEntry = 0;
 	m_ExecutionQueue.Reset();
 	m_pFirstCommand = 0;
+	mem_zero(m_apCommandHash, sizeof(m_apCommandHash));
+	m_pCompiledLines = 0;
+	m_CommandGeneration = 0;
 	m_pFirstExec = 0;
 	mem_zero(m_aPrintCB, sizeof(m_aPrintCB));
 	m_NumPrintCB = 0;
@@ -991,6 +1047,7 @@ CConsole::~CConsole()
 		delete m_pTempMapListHeap;
 		m_pTempMapListHeap = 0;
 	}
+	delete[] m_pCompiledLines;
 }
 
 void CConsole::Init()
@@ -1053,12 +1110,15 @@ void CConsole::ParseArguments(int NumArgs, const char **ppArguments)
 
 void CConsole::AddCommandSorted(CCommand *pCommand)
 {
+	m_CommandGeneration++;
+
+	CCommand **ppBucket = CommandHashBucket(pCommand->m_pName);
+	pCommand->m_pHashNext = *ppBucket;
+	*ppBucket = pCommand;
+
 	if(!m_pFirstCommand || str_comp(pCommand->m_pName, m_pFirstCommand->m_pName) <= 0)
 	{
-		if(m_pFirstCommand && m_pFirstCommand->m_pNext)
-			pCommand->m_pNext = m_pFirstCommand;
-		else
-			pCommand->m_pNext = 0;
+		pCommand->m_pNext = m_pFirstCommand;
 		m_pFirstCommand = pCommand;
 	}
 	else
@@ -1097,6 +1157,8 @@ void CConsole::Register(const char *pName, const char *pParams,
 
 	if(DoAdd)
 		AddCommandSorted(pCommand);
+	else
+		m_CommandGeneration++;
 
 	//if (pCommand->m_Flags & CFGFLAG_CHAT)
 	//	pCommand->SetAccessLevel(ACCESS_LEVEL_USER);
@@ -1153,6 +1215,21 @@ void CConsole::RegisterTemp(const char *pName, const char *pParams,	int Flags, c
 	AddCommandSorted(pCommand);
 }
 
+void CConsole::RemoveCommandHash(CCommand *pCommand)
+{
+	m_CommandGeneration++;
+
+	for(CCommand **ppCommand = CommandHashBucket(pCommand->m_pName); *ppCommand; ppCommand = &(*ppCommand)->m_pHashNext)
+	{
+		if(*ppCommand == pCommand)
+		{
+			*ppCommand = pCommand->m_pHashNext;
+			break;
+		}
+	}
+	pCommand->m_pHashNext = 0;
+}
+
 void CConsole::DeregisterTemp(const char *pName)
 {
 	if(!m_pFirstCommand)
@@ -1180,6 +1257,7 @@ void CConsole::DeregisterTemp(const char *pName)
 	// add to recycle list
 	if(pRemoved)
 	{
+		RemoveCommandHash(pRemoved);
 		pRemoved->m_pNext = m_pRecycleList;
 		m_pRecycleList = pRemoved;
 	}
@@ -1187,6 +1265,20 @@ void CConsole::DeregisterTemp(const char *pName)
 
 void CConsole::DeregisterTempAll()
 {
+	m_CommandGeneration++;
+
+	// remove temp entries from the lookup
+	for(int i = 0; i < COMMAND_HASH_SIZE; i++)
+	{
+		for(CCommand **ppCommand = &m_apCommandHash[i]; *ppCommand;)
+		{
+			if((*ppCommand)->m_Temp)
+				*ppCommand = (*ppCommand)->m_pHashNext;
+			else
+				ppCommand = &(*ppCommand)->m_pHashNext;
+		}
+	}
+
 	// set non temp as first one
 	for(; m_pFirstCommand && m_pFirstCommand->m_Temp; m_pFirstCommand = m_pFirstCommand->m_pNext);
 
@@ -1305,7 +1397,7 @@ void CConsole::StoreCommands(bool Store)
 
 const IConsole::CCommandInfo *CConsole::GetCommandInfo(const char *pName, int FlagMask, bool Temp)
 {
-	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	for(CCommand *pCommand = *CommandHashBucket(pName); pCommand; pCommand = pCommand->m_pHashNext)
 	{
 		if(pCommand->m_Flags&FlagMask && pCommand->m_Temp == Temp)
 		{
@@ -15,6 +15,7 @@ class CConsole : public IConsole
 	{
 	public:
 		CCommand *m_pNext;
+		CCommand *m_pHashNext;
 		int m_Flags;
 		bool m_Temp;
 		FCommandCallback m_pfnCallback;
@@ -38,7 +39,16 @@ class CConsole : public IConsole
 	int m_FlagMask;
 	bool m_StoreCommands;
 	const char *m_paStrokeStr[2];
-	CCommand *m_pFirstCommand;
+	CCommand *m_pFirstCommand; // sorted, used for listing
+
+	// case insensitive name lookup
+	enum
+	{
+		COMMAND_HASH_SIZE = 1024,
+	};
+	CCommand *m_apCommandHash[COMMAND_HASH_SIZE];
+	CCommand **CommandHashBucket(const char *pName) { return &m_apCommandHash[str_quickhash_nocase(pName)%COMMAND_HASH_SIZE]; }
+	void RemoveCommandHash(CCommand *pCommand);
 
 	class CExecFile
 	{
@@ -114,6 +124,8 @@ class CConsole : public IConsole
 				m_pCommand = m_aStringStorage+(Other.m_pCommand-Other.m_aStringStorage);
 				for(unsigned i = 0; i < Other.m_NumArgs; ++i)
 					m_apArgs[i] = m_aStringStorage+(Other.m_apArgs[i]-Other.m_aStringStorage);
+				m_Victim = Other.m_Victim;
+				mem_copy(m_aArgumentString, Other.m_aArgumentString, sizeof(m_aArgumentString));
 			}
 			return *this;
 		}
@@ -191,6 +203,32 @@ class CConsole : public IConsole
 	void AddCommandSorted(CCommand *pCommand);
 	CCommand *FindCommand(const char *pName, int FlagMask);
 
+	// lines that were parsed before, so executing them again skips tokenizing.
+	// Entries are dropped whenever commands are (de)registered
+	class CCompiledLine
+	{
+	public:
+		char m_aLine[CONSOLE_MAX_STR_LENGTH+1];
+		int m_Length;
+		int m_FlagMask;
+		int m_Generation;
+		CCommand *m_pCommand;
+		CResult m_Result;
+
+		CCompiledLine() { m_pCommand = 0; }
+	};
+
+	enum
+	{
+		NUM_COMPILED_LINES = 32,
+	};
+	CCompiledLine *m_pCompiledLines;
+	int m_CommandGeneration;
+
+	CCompiledLine *CompiledLineSlot(const char *pLine, int Length);
+	const CCompiledLine *FindCompiledLine(const char *pLine, int Length);
+	void AddCompiledLine(const char *pLine, int Length, CCommand *pCommand, const CResult *pResult);
+
 	struct CMapListEntryTemp {
 		CMapListEntryTemp *m_pPrev;
 		CMapListEntryTemp *m_pNext;
@@ -1,5 +1,6 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/lock_scope.h>
 #include <base/math.h>
 #include <base/system.h>
 
@@ -23,6 +24,10 @@ CDemoRecorder::CDemoRecorder(class CSnapshotDelta *pSnapshotDelta)
 	m_File = 0;
 	m_LastTickMarker = -1;
 	m_pSnapshotDelta = pSnapshotDelta;
+	m_pWriterThread = 0;
+	m_pQueue = 0;
+	m_FirstRecordedTick = -1;
+	m_LastRecordedTick = -1;
 	m_Huffman.Init();
 }
 
@@ -112,12 +117,24 @@ int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, con
 	m_LastTickMarker = -1;
 	m_FirstTick = -1;
 	m_NumTimelineMarkers = 0;
+	m_FirstRecordedTick = -1;
+	m_LastRecordedTick = -1;
 
 	char aBuf[256];
 	str_format(aBuf, sizeof(aBuf), "Recording to '%s'", pFilename);
 	m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_recorder", aBuf);
 	m_File = DemoFile;
 
+	// start the writer thread
+	m_pQueue = new TStaticRingBuffer<CQueuedChunk, QUEUE_SIZE>();
+	m_QueueLock = lock_create();
+	sphore_init(&m_QueueSemaphore);
+	m_QueuedSize = 0;
+	m_Stopping = false;
+	m_NumDroppedSnapshots = 0;
+	m_NumDroppedMessages = 0;
+	m_pWriterThread = thread_init(WriterThread, this, "demo recorder");
+
 	return 0;
 }
 
@@ -190,13 +207,13 @@ void CDemoRecorder::Write(int Type, const void *pData, int Size)
 	Size = CVariableInt::Compress(aBuffer2, Size, aBuffer, sizeof(aBuffer)); // buffer2 -> buffer
 	if(Size < 0)
 	{
-		m_pConsole->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "demo_recorder", "error during intpack compression");
+		dbg_msg("demo_recorder", "error during intpack compression");
 		return;
 	}
 	Size = m_Huffman.Compress(aBuffer, Size, aBuffer2, sizeof(aBuffer2)); // buffer -> buffer2
 	if(Size < 0)
 	{
-		m_pConsole->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "demo_recorder", "error during network compression");
+		dbg_msg("demo_recorder", "error during network compression");
 		return;
 	}
 
@@ -227,7 +244,7 @@ void CDemoRecorder::Write(int Type, const void *pData, int Size)
 	io_write(m_File, aBuffer2, Size);
 }
 
-void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
+void CDemoRecorder::WriteSnapshot(int Tick, const void *pData, int Size)
 {
 	char aTmpData[CSnapshot::MAX_SIZE];
 
@@ -259,9 +276,94 @@ void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
 	}
 }
 
+void CDemoRecorder::WriterThread(void *pUser)
+{
+	CDemoRecorder *pSelf = (CDemoRecorder *)pUser;
+
+	while(1)
+	{
+		// one signal per queued chunk and one more when stopping
+		sphore_wait(&pSelf->m_QueueSemaphore);
+
+		CQueuedChunk *pChunk;
+		{
+			CLockScope LockScope(pSelf->m_QueueLock);
+			pChunk = pSelf->m_pQueue->First();
+			if(!pChunk && pSelf->m_Stopping)
+				return;
+		}
+		if(!pChunk)
+			continue;
+
+		// the game thread only appends, so the chunk stays valid until it is popped
+		if(pChunk->m_Type == CHUNKTYPE_SNAPSHOT)
+			pSelf->WriteSnapshot(pChunk->m_Tick, pChunk+1, pChunk->m_Size);
+		else
+			pSelf->Write(CHUNKTYPE_MESSAGE, pChunk+1, pChunk->m_Size);
+
+		CLockScope LockScope(pSelf->m_QueueLock);
+		pSelf->m_QueuedSize -= pChunk->m_Size;
+		pSelf->m_pQueue->PopFirst();
+	}
+}
+
+void CDemoRecorder::Queue(int Type, int Tick, const void *pData, int Size)
+{
+	if(!m_File)
+		return;
+
+	CQueuedChunk *pChunk;
+	{
+		CLockScope LockScope(m_QueueLock);
+
+		// never stall the tick on a slow disk, drop the chunk instead. the
+		// writer deltas against the last snapshot it wrote, so a dropped
+		// snapshot only leaves a gap
+		if(Type == CHUNKTYPE_SNAPSHOT && m_QueuedSize + Size > QUEUE_SIZE/2)
+			pChunk = 0;
+		else
+			pChunk = m_pQueue->Allocate(sizeof(CQueuedChunk) + Size);
+		if(!pChunk)
+		{
+			if(Type == CHUNKTYPE_SNAPSHOT)
+				m_NumDroppedSnapshots++;
+			else
+				m_NumDroppedMessages++;
+			return;
+		}
+		m_QueuedSize += Size;
+	}
+
+	pChunk->m_Type = Type;
+	pChunk->m_Tick = Tick;
+	pChunk->m_Size = Size;
+	mem_copy(pChunk+1, pData, Size);
+	sphore_signal(&m_QueueSemaphore);
+}
+
+bool CDemoRecorder::WantSnapshot()
+{
+	if(!m_File)
+		return false;
+
+	CLockScope LockScope(m_QueueLock);
+	if(m_QueuedSize + CSnapshot::MAX_SIZE <= QUEUE_SIZE/2)
+		return true;
+	m_NumDroppedSnapshots++;
+	return false;
+}
+
+void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
+{
+	if(m_FirstRecordedTick < 0)
+		m_FirstRecordedTick = Tick;
+	m_LastRecordedTick = Tick;
+	Queue(CHUNKTYPE_SNAPSHOT, Tick, pData, Size);
+}
+
 void CDemoRecorder::RecordMessage(const void *pData, int Size)
 {
-	Write(CHUNKTYPE_MESSAGE, pData, Size);
+	Queue(CHUNKTYPE_MESSAGE, m_LastRecordedTick, pData, Size);
 }
 
 int CDemoRecorder::Stop()
@@ -269,10 +371,23 @@ int CDemoRecorder::Stop()
 	if(!m_File)
 		return -1;
 
+	// let the writer thread finish the queue
+	{
+		CLockScope LockScope(m_QueueLock);
+		m_Stopping = true;
+	}
+	sphore_signal(&m_QueueSemaphore);
+	thread_wait(m_pWriterThread);
+	m_pWriterThread = 0;
+	delete m_pQueue;
+	m_pQueue = 0;
+	lock_destroy(m_QueueLock);
+	sphore_destroy(&m_QueueSemaphore);
+
 	// add the demo length to the header
 	io_seek(m_File, gs_LengthOffset, IOSEEK_START);
 	unsigned char aLength[4];
-	uint_to_bytes_be(aLength, Length());
+	uint_to_bytes_be(aLength, (m_LastTickMarker - m_FirstTick)/SERVER_TICK_SPEED);
 	io_write(m_File, aLength, sizeof(aLength));
 
 	// add the timeline markers to the header
@@ -291,23 +406,30 @@ int CDemoRecorder::Stop()
 	m_File = 0;
 	m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_recorder", "Stopped recording");
 
+	if(m_NumDroppedSnapshots || m_NumDroppedMessages)
+	{
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "writer fell behind, dropped %d snapshots and %d messages", m_NumDroppedSnapshots, m_NumDroppedMessages);
+		m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_recorder", aBuf);
+	}
+
 	return 0;
 }
 
 void CDemoRecorder::AddDemoMarker()
 {
-	if(m_LastTickMarker < 0 || m_NumTimelineMarkers >= MAX_TIMELINE_MARKERS)
+	if(m_LastRecordedTick < 0 || m_NumTimelineMarkers >= MAX_TIMELINE_MARKERS)
 		return;
 
 	// not more than 1 marker in a second
 	if(m_NumTimelineMarkers > 0)
 	{
-		int Diff = m_LastTickMarker - m_aTimelineMarkers[m_NumTimelineMarkers-1];
+		int Diff = m_LastRecordedTick - m_aTimelineMarkers[m_NumTimelineMarkers-1];
 		if(Diff < SERVER_TICK_SPEED*1.0f)
 			return;
 	}
 
-	m_aTimelineMarkers[m_NumTimelineMarkers++] = m_LastTickMarker;
+	m_aTimelineMarkers[m_NumTimelineMarkers++] = m_LastRecordedTick;
 
 	m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_recorder", "Added timeline marker");
 }
@@ -7,10 +7,25 @@
 #include <engine/shared/protocol.h>
 
 #include "huffman.h"
+#include "ringbuffer.h"
 #include "snapshot.h"
 
 class CDemoRecorder : public IDemoRecorder
 {
+	enum
+	{
+		// snapshots may fill half of the queue, the rest is kept for messages
+		QUEUE_SIZE=1024*1024*2,
+	};
+
+	// chunks are queued for the writer thread with their data following the header
+	struct CQueuedChunk
+	{
+		int m_Type;
+		int m_Tick;
+		int m_Size;
+	};
+
 	class IConsole *m_pConsole;
 	CHuffman m_Huffman;
 	IOHANDLE m_File;
@@ -22,7 +37,23 @@ class CDemoRecorder : public IDemoRecorder
 	int m_NumTimelineMarkers;
 	int m_aTimelineMarkers[MAX_TIMELINE_MARKERS];
 
+	// delta, compression and file writes happen on the writer thread, the
+	// members above are only touched by it while recording
+	void *m_pWriterThread;
+	TStaticRingBuffer<CQueuedChunk, QUEUE_SIZE> *m_pQueue;
+	LOCK m_QueueLock;
+	SEMAPHORE m_QueueSemaphore;
+	int m_QueuedSize;
+	bool m_Stopping;
+	int m_NumDroppedSnapshots;
+	int m_NumDroppedMessages;
+	int m_FirstRecordedTick;
+	int m_LastRecordedTick;
+
+	static void WriterThread(void *pUser);
+	void Queue(int Type, int Tick, const void *pData, int Size);
 	void WriteTickMarker(int Tick, int Keyframe);
+	void WriteSnapshot(int Tick, const void *pData, int Size);
 	void Write(int Type, const void *pData, int Size);
 public:
 	CDemoRecorder(class CSnapshotDelta *pSnapshotDelta);
@@ -31,12 +62,14 @@ public:
 	int Stop();
 	void AddDemoMarker();
 
+	// false while the writer thread is too far behind, the snapshot counts as dropped then
+	bool WantSnapshot();
 	void RecordSnapshot(int Tick, const void *pData, int Size);
 	void RecordMessage(const void *pData, int Size);
 
 	bool IsRecording() const { return m_File != 0; }
 
-	int Length() const { return (m_LastTickMarker - m_FirstTick)/SERVER_TICK_SPEED; }
+	int Length() const { return (m_LastRecordedTick - m_FirstRecordedTick)/SERVER_TICK_SPEED; }
 };
 
 class CDemoPlayer : public IDemoPlayer
@@ -3,6 +3,8 @@
 #include <base/system.h>
 #include "huffman.h"
 
+#include <stdint.h>
+
 
 static const unsigned gs_aFreqTable[256 + 1] = {
 	1 << 30,4545,2657,431,1950,919,444,482,2244,617,838,542,715,1814,304,240,754,212,647,186,
@@ -110,6 +112,32 @@ void CHuffman::ConstructTree(const unsigned *pFrequencies)
 	Setbits_r(m_pStartNode, 0, 0);
 }
 
+void CHuffman::FillDecodeTable_r(int Table, int TableBits, const CNode *pNode, unsigned Prefix, int Depth)
+{
+	int NodeIndex = (int)(pNode - m_aNodes);
+	if(NodeIndex < HUFFMAN_MAX_SYMBOLS)
+	{
+		// a leaf, every index that starts with its code decodes to it
+		unsigned Entry = NodeIndex | (Depth<<HUFFMAN_ENTRY_BITSSHIFT);
+		for(unsigned i = Prefix; i < (1u<<TableBits); i += 1<<Depth)
+			m_aDecodeTable[Table+i] = Entry;
+		return;
+	}
+
+	if(Depth == TableBits)
+	{
+		// the code is longer than this table, continue in a new one
+		int SubTable = m_DecodeTableSize;
+		m_DecodeTableSize += HUFFMAN_SUBSIZE;
+		m_aDecodeTable[Table+Prefix] = HUFFMAN_ENTRY_SUBTABLE | (Depth<<HUFFMAN_ENTRY_BITSSHIFT) | (SubTable<<HUFFMAN_ENTRY_OFFSETSHIFT);
+		FillDecodeTable_r(SubTable, HUFFMAN_SUBBITS, pNode, 0, 0);
+		return;
+	}
+
+	FillDecodeTable_r(Table, TableBits, &m_aNodes[pNode->m_aLeafs[0]], Prefix, Depth+1);
+	FillDecodeTable_r(Table, TableBits, &m_aNodes[pNode->m_aLeafs[1]], Prefix|(1<<Depth), Depth+1);
+}
+
 void CHuffman::Init(const unsigned *pFrequencies)
 {
 	// make sure to cleanout every thing
@@ -120,98 +148,66 @@ void CHuffman::Init(const unsigned *pFrequencies)
 		pFrequencies = gs_aFreqTable;
 	ConstructTree(pFrequencies);
 
-	// build decode LUT
-	for(int i = 0; i < HUFFMAN_LUTSIZE; i++)
-	{
-		unsigned Bits = i;
-		int k;
-		CNode *pNode = m_pStartNode;
-		for(k = 0; k < HUFFMAN_LUTBITS; k++)
-		{
-			pNode = &m_aNodes[pNode->m_aLeafs[Bits&1]];
-			Bits >>= 1;
-
-			if(!pNode)
-				break;
-
-			if(pNode->m_NumBits)
-			{
-				m_apDecodeLut[i] = pNode;
-				break;
-			}
-		}
-
-		if(k == HUFFMAN_LUTBITS)
-			m_apDecodeLut[i] = pNode;
-	}
-
+	// build the decode tables, there is at most one sub table per inner node
+	m_DecodeTableSize = HUFFMAN_LUTSIZE;
+	FillDecodeTable_r(0, HUFFMAN_LUTBITS, m_pStartNode, 0, 0);
 }
 
 //***************************************************************
 int CHuffman::Compress(const void *pInput, int InputSize, void *pOutput, int OutputSize)
 {
-	// this macro loads a symbol for a byte into bits and bitcount
-#define HUFFMAN_MACRO_LOADSYMBOL(Sym) \
-	Bits |= m_aNodes[Sym].m_Bits << Bitcount; \
-	Bitcount += m_aNodes[Sym].m_NumBits;
-
-	// this macro writes the symbol stored in bits and bitcount to the dst pointer
-#define HUFFMAN_MACRO_WRITE() \
-	while(Bitcount >= 8) \
-	{ \
-		*pDst++ = (unsigned char)(Bits&0xff); \
-		if(pDst == pDstEnd) \
-			return -1; \
-		Bits >>= 8; \
-		Bitcount -= 8; \
-	}
-
 	// setup buffer pointers
 	const unsigned char *pSrc = (const unsigned char *)pInput;
 	const unsigned char *pSrcEnd = pSrc + InputSize;
 	unsigned char *pDst = (unsigned char *)pOutput;
 	unsigned char *pDstEnd = pDst + OutputSize;
 
-	// symbol variables
-	unsigned Bits = 0;
+	// codes are collected in a 64 bit buffer and written 32 bits at a time
+	uint64_t Bits = 0;
 	unsigned Bitcount = 0;
 
-	// make sure that we have data that we want to compress
-	if(InputSize)
+	for(int Last = 0; !Last; )
 	{
-		// {A} load the first symbol
-		int Symbol = *pSrc++;
-
-		while(pSrc != pSrcEnd)
+		int Symbol;
+		if(pSrc != pSrcEnd)
+			Symbol = *pSrc++;
+		else
 		{
-			// {B} load the symbol
-			HUFFMAN_MACRO_LOADSYMBOL(Symbol)
+			Symbol = HUFFMAN_EOF_SYMBOL;
+			Last = 1;
+		}
 
-			// {C} fetch next symbol, this is done here because it will reduce dependency in the code
-			Symbol = *pSrc++;
+		Bits |= (uint64_t)m_aNodes[Symbol].m_Bits << Bitcount;
+		Bitcount += m_aNodes[Symbol].m_NumBits;
 
-			// {B} write the symbol loaded at
-			HUFFMAN_MACRO_WRITE()
+		if(Bitcount >= 32)
+		{
+			// the word and the final byte have to fit
+			if(pDstEnd - pDst < 5)
+				return -1;
+			pDst[0] = (unsigned char)Bits;
+			pDst[1] = (unsigned char)(Bits>>8);
+			pDst[2] = (unsigned char)(Bits>>16);
+			pDst[3] = (unsigned char)(Bits>>24);
+			pDst += 4;
+			Bits >>= 32;
+			Bitcount -= 32;
 		}
-
-		// write the last symbol loaded from {C} or {A} in the case of only 1 byte input buffer
-		HUFFMAN_MACRO_LOADSYMBOL(Symbol)
-		HUFFMAN_MACRO_WRITE()
 	}
 
-	// write EOF symbol
-	HUFFMAN_MACRO_LOADSYMBOL(HUFFMAN_EOF_SYMBOL)
-	HUFFMAN_MACRO_WRITE()
-
-	// write out the last bits
-	*pDst++ = Bits;
+	// write out the last bits, plus one byte for the rest like the byte wise encoder did
+	if(pDstEnd - pDst < (int)(Bitcount/8) + 1)
+		return -1;
+	while(Bitcount >= 8)
+	{
+		*pDst++ = (unsigned char)Bits;
+		Bits >>= 8;
+		Bitcount -= 8;
+	}
+	*pDst++ = (unsigned char)Bits;
 
 	// return the size of the output
 	return (int)(pDst - (const unsigned char *)pOutput);
-
-	// remove macros
-#undef HUFFMAN_MACRO_LOADSYMBOL
-#undef HUFFMAN_MACRO_WRITE
 }
 
 //***************************************************************
@@ -219,78 +215,85 @@ int CHuffman::Decompress(const void *pInput, int InputSize, void *pOutput, int O
 {
 	// setup buffer pointers
 	unsigned char *pDst = (unsigned char *)pOutput;
-	unsigned char *pSrc = (unsigned char *)pInput;
+	const unsigned char *pSrc = (const unsigned char *)pInput;
 	unsigned char *pDstEnd = pDst + OutputSize;
-	unsigned char *pSrcEnd = pSrc + InputSize;
+	const unsigned char *pSrcEnd = pSrc + InputSize;
 
-	unsigned Bits = 0;
+	uint64_t Bits = 0;
 	unsigned Bitcount = 0;
 
-	CNode *pEof = &m_aNodes[HUFFMAN_EOF_SYMBOL];
-	CNode *pNode = 0;
-
-	while(1)
+	// {A} while there are whole words left, load 32 bits at a time. with at least
+	// 32 bits loaded the common codes fit without further checks
+	while(pSrcEnd - pSrc >= 4)
 	{
-		// {A} try to load a node now, this will reduce dependency at location {D}
-		pNode = 0;
-		if(Bitcount >= HUFFMAN_LUTBITS)
-			pNode = m_apDecodeLut[Bits&HUFFMAN_LUTMASK];
-
-		// {B} fill with new bits
-		while(Bitcount < 24 && pSrc != pSrcEnd)
+		if(Bitcount < 32)
 		{
-			Bits |= (*pSrc++) << Bitcount;
-			Bitcount += 8;
+			Bits |= (uint64_t)(pSrc[0] | (pSrc[1]<<8) | (pSrc[2]<<16) | ((unsigned)pSrc[3]<<24)) << Bitcount;
+			pSrc += 4;
+			Bitcount += 32;
 		}
 
-		// {C} load symbol now if we didn't that earlier at location {A}
-		if(!pNode)
-			pNode = m_apDecodeLut[Bits&HUFFMAN_LUTMASK];
+		unsigned Entry = m_aDecodeTable[Bits&HUFFMAN_LUTMASK];
+		while(Entry&HUFFMAN_ENTRY_SUBTABLE)
+		{
+			unsigned NumBits = (Entry>>HUFFMAN_ENTRY_BITSSHIFT)&HUFFMAN_ENTRY_BITSMASK;
+			if(NumBits > Bitcount)
+				return -1;
+			Bits >>= NumBits;
+			Bitcount -= NumBits;
+			Entry = m_aDecodeTable[(Entry>>HUFFMAN_ENTRY_OFFSETSHIFT) + (Bits&HUFFMAN_SUBMASK)];
+		}
+		unsigned NumBits = (Entry>>HUFFMAN_ENTRY_BITSSHIFT)&HUFFMAN_ENTRY_BITSMASK;
+		if(NumBits > Bitcount)
+			return -1;
+		Bits >>= NumBits;
+		Bitcount -= NumBits;
 
-		if(!pNode)
+		int Symbol = Entry&HUFFMAN_ENTRY_SYMBOLMASK;
+		if(Symbol == HUFFMAN_EOF_SYMBOL)
+			return (int)(pDst - (const unsigned char *)pOutput);
+		if(pDst == pDstEnd)
 			return -1;
+		*pDst++ = (unsigned char)Symbol;
+	}
 
-		// {D} check if we hit a symbol already
-		if(pNode->m_NumBits)
+	// {B} the tail, load byte by byte and check for running past the input
+	while(1)
+	{
+		while(Bitcount <= 56 && pSrc != pSrcEnd)
 		{
-			// remove the bits for that symbol
-			Bits >>= pNode->m_NumBits;
-			Bitcount -= pNode->m_NumBits;
+			Bits |= (uint64_t)(*pSrc++) << Bitcount;
+			Bitcount += 8;
 		}
-		else
-		{
-			// remove the bits that the lut checked up for us
-			Bits >>= HUFFMAN_LUTBITS;
-			Bitcount -= HUFFMAN_LUTBITS;
-
-			// walk the tree bit by bit
-			while(1)
-			{
-				// traverse tree
-				pNode = &m_aNodes[pNode->m_aLeafs[Bits&1]];
-
-				// remove bit
-				Bitcount--;
-				Bits >>= 1;
 
-				// check if we hit a symbol
-				if(pNode->m_NumBits)
-					break;
-
-				// no more bits, decoding error
-				if(Bitcount == 0)
-					return -1;
-			}
+		// look up the symbol, following sub tables for long codes
+		unsigned Entry = m_aDecodeTable[Bits&HUFFMAN_LUTMASK];
+		while(Entry&HUFFMAN_ENTRY_SUBTABLE)
+		{
+			unsigned NumBits = (Entry>>HUFFMAN_ENTRY_BITSSHIFT)&HUFFMAN_ENTRY_BITSMASK;
+			if(NumBits > Bitcount)
+				return -1;
+			Bits >>= NumBits;
+			Bitcount -= NumBits;
+			Entry = m_aDecodeTable[(Entry>>HUFFMAN_ENTRY_OFFSETSHIFT) + (Bits&HUFFMAN_SUBMASK)];
 		}
 
+		// remove the bits for that symbol, running past the input is a decoding error
+		unsigned NumBits = (Entry>>HUFFMAN_ENTRY_BITSSHIFT)&HUFFMAN_ENTRY_BITSMASK;
+		if(NumBits > Bitcount)
+			return -1;
+		Bits >>= NumBits;
+		Bitcount -= NumBits;
+
 		// check for eof
-		if(pNode == pEof)
+		int Symbol = Entry&HUFFMAN_ENTRY_SYMBOLMASK;
+		if(Symbol == HUFFMAN_EOF_SYMBOL)
 			break;
 
 		// output character
 		if(pDst == pDstEnd)
 			return -1;
-		*pDst++ = pNode->m_Symbol;
+		*pDst++ = (unsigned char)Symbol;
 	}
 
 	// return the size of the decompressed buffer
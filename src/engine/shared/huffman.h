@@ -14,9 +14,22 @@ class CHuffman
 		HUFFMAN_MAX_SYMBOLS=HUFFMAN_EOF_SYMBOL+1,
 		HUFFMAN_MAX_NODES=HUFFMAN_MAX_SYMBOLS*2-1,
 
-		HUFFMAN_LUTBITS = 10,
+		// decoding looks up HUFFMAN_LUTBITS at once, longer codes continue in
+		// tables of HUFFMAN_SUBBITS hanging off the entries of the first one
+		HUFFMAN_LUTBITS = 12,
 		HUFFMAN_LUTSIZE = (1<<HUFFMAN_LUTBITS),
-		HUFFMAN_LUTMASK = (HUFFMAN_LUTSIZE-1)
+		HUFFMAN_LUTMASK = (HUFFMAN_LUTSIZE-1),
+		HUFFMAN_SUBBITS = 4,
+		HUFFMAN_SUBSIZE = (1<<HUFFMAN_SUBBITS),
+		HUFFMAN_SUBMASK = (HUFFMAN_SUBSIZE-1),
+		HUFFMAN_DECODE_SIZE = HUFFMAN_LUTSIZE+(HUFFMAN_MAX_SYMBOLS-1)*HUFFMAN_SUBSIZE,
+
+		// decode table entries: symbol, bits to consume and the start of the next table
+		HUFFMAN_ENTRY_SYMBOLMASK = 0x1ff,
+		HUFFMAN_ENTRY_BITSSHIFT = 9,
+		HUFFMAN_ENTRY_BITSMASK = 0x1f,
+		HUFFMAN_ENTRY_SUBTABLE = 1<<14,
+		HUFFMAN_ENTRY_OFFSETSHIFT = 16,
 	};
 
 	struct CNode
@@ -33,12 +46,15 @@ class CHuffman
 	};
 
 	CNode m_aNodes[HUFFMAN_MAX_NODES];
-	CNode *m_apDecodeLut[HUFFMAN_LUTSIZE];
 	CNode *m_pStartNode;
 	int m_NumNodes;
 
+	unsigned m_aDecodeTable[HUFFMAN_DECODE_SIZE];
+	int m_DecodeTableSize;
+
 	void Setbits_r(CNode *pNode, int Bits, unsigned Depth);
 	void ConstructTree(const unsigned *pFrequencies);
+	void FillDecodeTable_r(int Table, int TableBits, const CNode *pNode, unsigned Prefix, int Depth);
 
 public:
 	/*
@@ -9,101 +9,181 @@
 #include "protocol.h"
 
 
+unsigned CNetBan::CNetHash::HashStart(int Type)
+{
+	return (2166136261u^Type)*16777619u;
+}
+
 CNetBan::CNetHash::CNetHash(const NETADDR *pAddr)
 {
-	if(pAddr->type==NETTYPE_IPV4)
-		m_Hash = (pAddr->ip[0]+pAddr->ip[1]+pAddr->ip[2]+pAddr->ip[3])&0xFF;
-	else
-		m_Hash = (pAddr->ip[0]+pAddr->ip[1]+pAddr->ip[2]+pAddr->ip[3]+pAddr->ip[4]+pAddr->ip[5]+pAddr->ip[6]+pAddr->ip[7]+
-			pAddr->ip[8]+pAddr->ip[9]+pAddr->ip[10]+pAddr->ip[11]+pAddr->ip[12]+pAddr->ip[13]+pAddr->ip[14]+pAddr->ip[15])&0xFF;
-	m_HashIndex = 0;
+	int Length = pAddr->type==NETTYPE_IPV4 ? NETADDR_SIZE_IPV4 : NETADDR_SIZE_IPV6;
+	unsigned Hash = HashStart(pAddr->type);
+	for(int i = 0; i < Length; ++i)
+		Hash = HashByte(Hash, pAddr->ip[i]);
+	m_Hash = HashFinish(Hash, Length);
+	m_HashIndex = Length;
 }
 
 CNetBan::CNetHash::CNetHash(const CNetRange *pRange)
 {
-	m_Hash = 0;
+	unsigned Hash = HashStart(pRange->m_LB.type);
 	m_HashIndex = 0;
 	for(int i = 0; pRange->m_LB.ip[i] == pRange->m_UB.ip[i]; ++i)
 	{
-		m_Hash += pRange->m_LB.ip[i];
+		Hash = HashByte(Hash, pRange->m_LB.ip[i]);
 		++m_HashIndex;
 	}
-	m_Hash &= 0xFF;
+	m_Hash = HashFinish(Hash, m_HashIndex);
 }
 
 int CNetBan::CNetHash::MakeHashArray(const NETADDR *pAddr, CNetHash aHash[17])
 {
-	int Length = pAddr->type==NETTYPE_IPV4 ? 4 : 16;
-	aHash[0].m_Hash = 0;
-	aHash[0].m_HashIndex = 0;
-	for(int i = 1, Sum = 0; i <= Length; ++i)
+	int Length = pAddr->type==NETTYPE_IPV4 ? NETADDR_SIZE_IPV4 : NETADDR_SIZE_IPV6;
+	unsigned Hash = HashStart(pAddr->type);
+	for(int i = 0; i <= Length; ++i)
 	{
-		Sum += pAddr->ip[i-1];
-		aHash[i].m_Hash = Sum&0xFF;
-		aHash[i].m_HashIndex = i%Length;
+		if(i > 0)
+			Hash = HashByte(Hash, pAddr->ip[i-1]);
+		aHash[i].m_Hash = HashFinish(Hash, i);
+		aHash[i].m_HashIndex = i;
 	}
 	return Length;
 }
 
 
-template<class T, int HashCount>
-typename CNetBan::CBan<T> *CNetBan::CBanPool<T, HashCount>::Add(const T *pData, const CBanInfo *pInfo,  const CNetHash *pNetHash)
+template<class T>
+CNetBan::CBanPool<T>::CBanPool()
 {
-	if(!m_pFirstFree)
-		return 0;
+	m_ppHashList = 0;
+	m_HashSize = 0;
+	m_ppBlocks = 0;
+	m_NumBlocks = 0;
+	Reset();
+}
+
+template<class T>
+CNetBan::CBanPool<T>::~CBanPool()
+{
+	for(int i = 0; i < m_NumBlocks; ++i)
+		mem_free(m_ppBlocks[i]);
+	mem_free(m_ppBlocks);
+	mem_free(m_ppHashList);
+}
+
+template<class T>
+void CNetBan::CBanPool<T>::AllocBlock()
+{
+	CBan<T> *pBlock = (CBan<T> *)mem_alloc(BLOCK_SIZE*sizeof(CBan<T>), 1);
+	mem_zero(pBlock, BLOCK_SIZE*sizeof(CBan<T>));
+
+	CBan<T> **ppBlocks = (CBan<T> **)mem_alloc((m_NumBlocks+1)*sizeof(CBan<T> *), 1);
+	if(m_NumBlocks)
+		mem_copy(ppBlocks, m_ppBlocks, m_NumBlocks*sizeof(CBan<T> *));
+	mem_free(m_ppBlocks);
+	m_ppBlocks = ppBlocks;
+	m_ppBlocks[m_NumBlocks++] = pBlock;
+
+	// chain the new bans into the free list
+	for(int i = 0; i < BLOCK_SIZE; ++i)
+	{
+		pBlock[i].m_pPrev = i > 0 ? &pBlock[i-1] : 0;
+		pBlock[i].m_pNext = i < BLOCK_SIZE-1 ? &pBlock[i+1] : m_pFirstFree;
+	}
+	if(m_pFirstFree)
+		m_pFirstFree->m_pPrev = &pBlock[BLOCK_SIZE-1];
+	m_pFirstFree = &pBlock[0];
+}
+
+template<class T>
+void CNetBan::CBanPool<T>::InsertHash(CBan<T> *pBan)
+{
+	CBan<T> **ppBucket = &m_ppHashList[pBan->m_NetHash.m_Hash&(m_HashSize-1)];
+	if(*ppBucket)
+		(*ppBucket)->m_pHashPrev = pBan;
+	pBan->m_pHashPrev = 0;
+	pBan->m_pHashNext = *ppBucket;
+	*ppBucket = pBan;
+}
+
+template<class T>
+void CNetBan::CBanPool<T>::Rehash(int HashSize)
+{
+	mem_free(m_ppHashList);
+	m_ppHashList = (CBan<T> **)mem_alloc(HashSize*sizeof(CBan<T> *), 1);
+	mem_zero(m_ppHashList, HashSize*sizeof(CBan<T> *));
+	m_HashSize = HashSize;
+	for(CBan<T> *pBan = m_pFirstUsed; pBan; pBan = pBan->m_pNext)
+		InsertHash(pBan);
+}
+
+template<class T>
+void CNetBan::CBanPool<T>::InsertUsed(CBan<T> *pBan)
+{
+	// permanent bans go to the end, the others are inserted behind the last ban
+	// that expires earlier. Bans are mostly added in expiration order (fixed ban
+	// times, banlist files written by bans_save), so the walk is usually short
+	CBan<T> *pPrev;
+	if(pBan->m_Info.m_Expires == CBanInfo::EXPIRES_NEVER)
+		pPrev = m_pLastUsed;
+	else
+	{
+		pPrev = m_pLastExpiring;
+		while(pPrev && pPrev->m_Info.m_Expires > pBan->m_Info.m_Expires)
+			pPrev = pPrev->m_pPrev;
+		if(!m_pLastExpiring || pPrev == m_pLastExpiring)
+			m_pLastExpiring = pBan;
+	}
+
+	pBan->m_pPrev = pPrev;
+	pBan->m_pNext = pPrev ? pPrev->m_pNext : m_pFirstUsed;
+	if(pBan->m_pNext)
+		pBan->m_pNext->m_pPrev = pBan;
+	else
+		m_pLastUsed = pBan;
+	if(pPrev)
+		pPrev->m_pNext = pBan;
+	else
+		m_pFirstUsed = pBan;
+}
+
+template<class T>
+void CNetBan::CBanPool<T>::RemoveUsed(CBan<T> *pBan)
+{
+	if(pBan == m_pLastExpiring)
+		m_pLastExpiring = pBan->m_pPrev;
 
-	// create new ban
-	CBan<T> *pBan = m_pFirstFree;
-	pBan->m_Data = *pData;
-	pBan->m_Info = *pInfo;
-	pBan->m_NetHash = *pNetHash;
 	if(pBan->m_pNext)
 		pBan->m_pNext->m_pPrev = pBan->m_pPrev;
+	else
+		m_pLastUsed = pBan->m_pPrev;
 	if(pBan->m_pPrev)
 		pBan->m_pPrev->m_pNext = pBan->m_pNext;
 	else
-		m_pFirstFree = pBan->m_pNext;
+		m_pFirstUsed = pBan->m_pNext;
+}
 
-	// add it to the hash list
-	if(m_paaHashList[pNetHash->m_HashIndex][pNetHash->m_Hash])
-		m_paaHashList[pNetHash->m_HashIndex][pNetHash->m_Hash]->m_pHashPrev = pBan;
-	pBan->m_pHashPrev = 0;
-	pBan->m_pHashNext = m_paaHashList[pNetHash->m_HashIndex][pNetHash->m_Hash];
-	m_paaHashList[pNetHash->m_HashIndex][pNetHash->m_Hash] = pBan;
+template<class T>
+typename CNetBan::CBan<T> *CNetBan::CBanPool<T>::Add(const T *pData, const CBanInfo *pInfo,  const CNetHash *pNetHash)
+{
+	if(!m_pFirstFree)
+		AllocBlock();
 
-	// insert it into the used list
-	if(m_pFirstUsed)
-	{
-		for(CBan<T> *p = m_pFirstUsed; ; p = p->m_pNext)
-		{
-			if(p->m_Info.m_Expires == CBanInfo::EXPIRES_NEVER || (pInfo->m_Expires != CBanInfo::EXPIRES_NEVER && pInfo->m_Expires <= p->m_Info.m_Expires))
-			{
-				// insert before
-				pBan->m_pNext = p;
-				pBan->m_pPrev = p->m_pPrev;
-				if(p->m_pPrev)
-					p->m_pPrev->m_pNext = pBan;
-				else
-					m_pFirstUsed = pBan;
-				p->m_pPrev = pBan;
-				break;
-			}
+	// create new ban
+	CBan<T> *pBan = m_pFirstFree;
+	pBan->m_Data = *pData;
+	pBan->m_Info = *pInfo;
+	pBan->m_NetHash = *pNetHash;
+	m_pFirstFree = pBan->m_pNext;
+	if(m_pFirstFree)
+		m_pFirstFree->m_pPrev = 0;
 
-			if(!p->m_pNext)
-			{
-				// last entry
-				p->m_pNext = pBan;
-				pBan->m_pPrev = p;
-				pBan->m_pNext = 0;
-				break;
-			}
-		}
-	}
-	else
-	{
-		m_pFirstUsed = pBan;
-		pBan->m_pNext = pBan->m_pPrev = 0;
-	}
+	// keep the load factor of the hash table at most 1
+	if(m_CountUsed >= m_HashSize)
+		Rehash(m_HashSize*2);
+
+	// add it to the hash list and insert it into the used list
+	InsertHash(pBan);
+	InsertUsed(pBan);
 
 	// update ban count
 	++m_CountUsed;
@@ -111,8 +191,8 @@ typename CNetBan::CBan<T> *CNetBan::CBanPool<T, HashCount>::Add(const T *pData,
 	return pBan;
 }
 
-template<class T, int HashCount>
-int CNetBan::CBanPool<T, HashCount>::Remove(CBan<T> *pBan)
+template<class T>
+int CNetBan::CBanPool<T>::Remove(CBan<T> *pBan)
 {
 	if(pBan == 0)
 		return -1;
@@ -123,16 +203,11 @@ int CNetBan::CBanPool<T, HashCount>::Remove(CBan<T> *pBan)
 	if(pBan->m_pHashPrev)
 		pBan->m_pHashPrev->m_pHashNext = pBan->m_pHashNext;
 	else
-		m_paaHashList[pBan->m_NetHash.m_HashIndex][pBan->m_NetHash.m_Hash] = pBan->m_pHashNext;
+		m_ppHashList[pBan->m_NetHash.m_Hash&(m_HashSize-1)] = pBan->m_pHashNext;
 	pBan->m_pHashNext = pBan->m_pHashPrev = 0;
 
 	// remove from used list
-	if(pBan->m_pNext)
-		pBan->m_pNext->m_pPrev = pBan->m_pPrev;
-	if(pBan->m_pPrev)
-		pBan->m_pPrev->m_pNext = pBan->m_pNext;
-	else
-		m_pFirstUsed = pBan->m_pNext;
+	RemoveUsed(pBan);
 
 	// add to recycle list
 	if(m_pFirstFree)
@@ -147,75 +222,47 @@ int CNetBan::CBanPool<T, HashCount>::Remove(CBan<T> *pBan)
 	return 0;
 }
 
-template<class T, int HashCount>
-void CNetBan::CBanPool<T, HashCount>::Update(CBan<CDataType> *pBan, const CBanInfo *pInfo)
+template<class T>
+void CNetBan::CBanPool<T>::Update(CBan<CDataType> *pBan, const CBanInfo *pInfo)
 {
 	pBan->m_Info = *pInfo;
 
-	// remove from used list
-	if(pBan->m_pNext)
-		pBan->m_pNext->m_pPrev = pBan->m_pPrev;
-	if(pBan->m_pPrev)
-		pBan->m_pPrev->m_pNext = pBan->m_pNext;
-	else
-		m_pFirstUsed = pBan->m_pNext;
-
-	// insert it into the used list
-	if(m_pFirstUsed)
-	{
-		for(CBan<T> *p = m_pFirstUsed; ; p = p->m_pNext)
-		{
-			if(p->m_Info.m_Expires == CBanInfo::EXPIRES_NEVER || (pInfo->m_Expires != CBanInfo::EXPIRES_NEVER && pInfo->m_Expires <= p->m_Info.m_Expires))
-			{
-				// insert before
-				pBan->m_pNext = p;
-				pBan->m_pPrev = p->m_pPrev;
-				if(p->m_pPrev)
-					p->m_pPrev->m_pNext = pBan;
-				else
-					m_pFirstUsed = pBan;
-				p->m_pPrev = pBan;
-				break;
-			}
-
-			if(!p->m_pNext)
-			{
-				// last entry
-				p->m_pNext = pBan;
-				pBan->m_pPrev = p;
-				pBan->m_pNext = 0;
-				break;
-			}
-		}
-	}
-	else
-	{
-		m_pFirstUsed = pBan;
-		pBan->m_pNext = pBan->m_pPrev = 0;
-	}
+	// reinsert it into the used list
+	RemoveUsed(pBan);
+	InsertUsed(pBan);
 }
 
-template<class T, int HashCount>
-void CNetBan::CBanPool<T, HashCount>::Reset()
+template<class T>
+void CNetBan::CBanPool<T>::Reset()
 {
-	mem_zero(m_paaHashList, sizeof(m_paaHashList));
-	mem_zero(m_aBans, sizeof(m_aBans));
+	// keep the first block around, the others are released
+	for(int i = 1; i < m_NumBlocks; ++i)
+		mem_free(m_ppBlocks[i]);
+	m_NumBlocks = min(m_NumBlocks, 1);
+
 	m_pFirstUsed = 0;
+	m_pLastUsed = 0;
+	m_pLastExpiring = 0;
+	m_pFirstFree = 0;
 	m_CountUsed = 0;
 
-	for(int i = 1; i < MAX_BANS-1; ++i)
+	if(m_NumBlocks)
 	{
-		m_aBans[i].m_pNext = &m_aBans[i+1];
-		m_aBans[i].m_pPrev = &m_aBans[i-1];
+		CBan<T> *pBlock = m_ppBlocks[0];
+		mem_zero(pBlock, BLOCK_SIZE*sizeof(CBan<T>));
+		for(int i = 0; i < BLOCK_SIZE; ++i)
+		{
+			pBlock[i].m_pPrev = i > 0 ? &pBlock[i-1] : 0;
+			pBlock[i].m_pNext = i < BLOCK_SIZE-1 ? &pBlock[i+1] : 0;
+		}
+		m_pFirstFree = &pBlock[0];
 	}
 
-	m_aBans[0].m_pNext = &m_aBans[1];
-	m_aBans[MAX_BANS-1].m_pPrev = &m_aBans[MAX_BANS-2];
-	m_pFirstFree = &m_aBans[0];
+	Rehash(MIN_HASH_SIZE);
 }
 
-template<class T, int HashCount>
-typename CNetBan::CBan<T> *CNetBan::CBanPool<T, HashCount>::Get(int Index) const
+template<class T>
+typename CNetBan::CBan<T> *CNetBan::CBanPool<T>::Get(int Index) const
 {
 	if(Index < 0 || Index >= Num())
 		return 0;
@@ -476,7 +523,7 @@ bool CNetBan::IsBanned(const NETADDR *pAddr, char *pBuf, unsigned BufferSize, in
 	{
 		for(CBanRange *pBan = m_BanRangePool.First(&aHash[i]); pBan; pBan = pBan->m_pHashNext)
 		{
-			if(NetMatch(&pBan->m_Data, pAddr, i, Length))
+			if(pBan->m_NetHash.m_Hash == aHash[i].m_Hash && pBan->m_NetHash.m_HashIndex == i && NetMatch(&pBan->m_Data, pAddr, i, Length))
 			{
 				MakeBanInfo(pBan, pBuf, BufferSize, MSGTYPE_PLAYER, pLastInfoQuery);
 				return true;
@@ -622,7 +669,9 @@ void CNetBan::ConBansSave(IConsole::IResult *pResult, void *pUser)
 // explicitly instantiate template for src/engine/server/server.cpp
 template void CNetBan::MakeBanInfo<CNetRange>(CBan<CNetRange> *pBan, char *pBuf, unsigned BufferSize, int Type, int *pLastInfoQuery);
 template void CNetBan::MakeBanInfo<NETADDR>(CBan<NETADDR> *pBan, char *pBuf, unsigned BufferSize, int Type, int *pLastInfoQuery);
-template int CNetBan::Ban<CNetBan::CBanPool<NETADDR, 1> >(CNetBan::CBanPool<NETADDR, 1> *pBanPool, const NETADDR *pData, int Seconds, const char *pReason);
-template int CNetBan::Ban<CNetBan::CBanPool<CNetRange, 16> >(CNetBan::CBanPool<CNetRange, 16> *pBanPool, const CNetRange *pData, int Seconds, const char *pReason);
+template int CNetBan::Ban<CNetBan::CBanPool<NETADDR> >(CNetBan::CBanPool<NETADDR> *pBanPool, const NETADDR *pData, int Seconds, const char *pReason);
+template int CNetBan::Ban<CNetBan::CBanPool<CNetRange> >(CNetBan::CBanPool<CNetRange> *pBanPool, const CNetRange *pData, int Seconds, const char *pReason);
 template bool CNetBan::IsBannable<NETADDR>(const NETADDR *pData);
 template bool CNetBan::IsBannable<CNetRange>(const CNetRange *pData);
+template class CNetBan::CBanPool<NETADDR>;
+template class CNetBan::CBanPool<CNetRange>;
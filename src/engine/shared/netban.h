@@ -63,14 +63,19 @@ protected:
 	class CNetHash
 	{
 	public:
-		int m_Hash;
-		int m_HashIndex;	// matching parts for ranges, 0 for addr
+		unsigned m_Hash;
+		int m_HashIndex;	// matching prefix length, full address length for addr
 
-		CNetHash() {}	
+		CNetHash() {}
 		CNetHash(const NETADDR *pAddr);
 		CNetHash(const CNetRange *pRange);
 
 		static int MakeHashArray(const NETADDR *pAddr, CNetHash aHash[17]);
+
+	private:
+		static unsigned HashStart(int Type);
+		static unsigned HashByte(unsigned Hash, unsigned char Byte) { return (Hash^Byte)*16777619u; }
+		static unsigned HashFinish(unsigned Hash, int PrefixLength) { return (Hash^PrefixLength)*16777619u; }
 	};
 
 	struct CBanInfo
@@ -82,7 +87,7 @@ protected:
 		};
 		int m_Expires;
 		int m_LastInfoQuery;
-		char m_aReason[REASON_LENGTH];		
+		char m_aReason[REASON_LENGTH];
 	};
 
 	template<class T> struct CBan
@@ -100,26 +105,31 @@ protected:
 		CBan *m_pPrev;
 	};
 
-	template<class T, int HashCount> class CBanPool
+	// bans are allocated in blocks as needed, the used list is sorted by expiration
+	// and lookups go through a hash table keyed by (type, prefix length, prefix bytes),
+	// so a range lookup costs one probe per prefix length regardless of the ban count
+	template<class T> class CBanPool
 	{
 	public:
 		typedef T CDataType;
 
+		CBanPool();
+		~CBanPool();
+
 		CBan<CDataType> *Add(const CDataType *pData, const CBanInfo *pInfo, const CNetHash *pNetHash);
 		int Remove(CBan<CDataType> *pBan);
 		void Update(CBan<CDataType> *pBan, const CBanInfo *pInfo);
 		void Reset();
-	
+
 		int Num() const { return m_CountUsed; }
-		bool IsFull() const { return m_CountUsed == MAX_BANS; }
 
 		CBan<CDataType> *First() const { return m_pFirstUsed; }
-		CBan<CDataType> *First(const CNetHash *pNetHash) const { return m_paaHashList[pNetHash->m_HashIndex][pNetHash->m_Hash]; }
+		CBan<CDataType> *First(const CNetHash *pNetHash) const { return m_ppHashList[pNetHash->m_Hash&(m_HashSize-1)]; }
 		CBan<CDataType> *Find(const CDataType *pData, const CNetHash *pNetHash) const
 		{
-			for(CBan<CDataType> *pBan = m_paaHashList[pNetHash->m_HashIndex][pNetHash->m_Hash]; pBan; pBan = pBan->m_pHashNext)
+			for(CBan<CDataType> *pBan = First(pNetHash); pBan; pBan = pBan->m_pHashNext)
 			{
-				if(NetComp(&pBan->m_Data, pData) == 0)
+				if(pBan->m_NetHash.m_Hash == pNetHash->m_Hash && NetComp(&pBan->m_Data, pData) == 0)
 					return pBan;
 			}
 
@@ -130,18 +140,29 @@ protected:
 	private:
 		enum
 		{
-			MAX_BANS=1024,
+			BLOCK_SIZE=1024,
+			MIN_HASH_SIZE=256,
 		};
 
-		CBan<CDataType> *m_paaHashList[HashCount][256];
-		CBan<CDataType> m_aBans[MAX_BANS];
+		void AllocBlock();
+		void InsertUsed(CBan<CDataType> *pBan);
+		void RemoveUsed(CBan<CDataType> *pBan);
+		void InsertHash(CBan<CDataType> *pBan);
+		void Rehash(int HashSize);
+
+		CBan<CDataType> **m_ppHashList;
+		int m_HashSize;
+		CBan<CDataType> **m_ppBlocks;
+		int m_NumBlocks;
 		CBan<CDataType> *m_pFirstFree;
 		CBan<CDataType> *m_pFirstUsed;
+		CBan<CDataType> *m_pLastUsed;
+		CBan<CDataType> *m_pLastExpiring;	// last used ban that is not permanent
 		int m_CountUsed;
 	};
 
-	typedef CBanPool<NETADDR, 1> CBanAddrPool;
-	typedef CBanPool<CNetRange, 16> CBanRangePool;
+	typedef CBanPool<NETADDR> CBanAddrPool;
+	typedef CBanPool<CNetRange> CBanRangePool;
 	typedef CBan<NETADDR> CBanAddr;
 	typedef CBan<CNetRange> CBanRange;
 	
@@ -129,9 +129,12 @@ void CNetBase::Init(NETSOCKET Socket, NETSOCKET SocketTwo, CConfig *pConfig, ICo
 
 void CNetBase::Shutdown()
 {
+	// clients pass the same socket for both, only close it once
+	NETSOCKET MainSocket = m_aSocket[SOCKET_MAIN];
 	for (int i = 0; i < NUM_SOCKETS; i++)
 	{
-		net_udp_close(m_aSocket[i]);
+		if(i == SOCKET_MAIN || m_aSocket[i] != MainSocket)
+			net_udp_close(m_aSocket[i]);
 		net_invalidate_socket(&m_aSocket[i]);
 	}
 }
@@ -128,6 +128,8 @@ enum
 	NET_CTRLMSG_KEEPALIVE=0,
 	NET_CTRLMSG_CONNECT=1,
 	NET_CTRLMSG_ACCEPT=2,
+	// 0.6 clients answer the connect accept with this
+	NET_CTRLMSG_SEVENDOWN_ACCEPT=3,
 	NET_CTRLMSG_CLOSE=4,
 	NET_CTRLMSG_TOKEN=5,
 
@@ -135,6 +137,7 @@ enum
 	NET_CONNLIMIT_IPS=16,
 
 	NET_CONN_BUFFERSIZE=1024*128, // F-DDrace changed this, default is 1024*32
+	NET_CONN_BUFFERSIZE_MIN=1024*4, // resend buffers start this small and grow up to NET_CONN_BUFFERSIZE
 
 	NET_ENUM_TERMINATOR
 };
@@ -191,7 +194,7 @@ class CNetChunkResend
 public:
 	int m_Flags;
 	int m_DataSize;
-	unsigned char *m_pData;
+	unsigned char *Data() { return (unsigned char *)(this+1); }
 
 	int m_Sequence;
 	int64 m_LastSendTime;
@@ -352,7 +355,7 @@ private:
 	int m_RemoteClosed;
 	bool m_BlockCloseMsg;
 
-	TStaticRingBuffer<CNetChunkResend, NET_CONN_BUFFERSIZE> m_Buffer;
+	TGrowingRingBuffer<CNetChunkResend, NET_CONN_BUFFERSIZE_MIN, NET_CONN_BUFFERSIZE> m_Buffer;
 
 	int64 m_LastUpdateTime;
 	int64 m_LastRecvTime;
@@ -386,6 +389,7 @@ public:
 	void Reset();
 	void Init(CNetBase *pNetBase, bool BlockCloseMsg);
 	int Connect(NETADDR *pAddr);
+	int ConnectSevendown(NETADDR *pAddr);
 	void Disconnect(const char *pReason);
 
 	void SetToken(TOKEN Token);
@@ -427,10 +431,10 @@ public:
 	void DirectInit(const NETADDR *pAddr, const CNetPacketConstruct *pPacket, SECURITY_TOKEN SecurityToken, bool Sevendown, int Socket);
 
 	int SeqSequence() const { return m_Sequence; }
-	TStaticRingBuffer<CNetChunkResend, NET_CONN_BUFFERSIZE> *ResendBuffer() { return &m_Buffer; };
+	TGrowingRingBuffer<CNetChunkResend, NET_CONN_BUFFERSIZE_MIN, NET_CONN_BUFFERSIZE> *ResendBuffer() { return &m_Buffer; };
 	bool m_TimeoutProtected;
 	bool m_TimeoutSituation;
-	void SetTimedOut(const NETADDR *pAddr, int Sequence, int Ack, TOKEN Token, TStaticRingBuffer<CNetChunkResend, NET_CONN_BUFFERSIZE> *pResendBuffer, TOKEN PeerToken, bool Sevendown, SECURITY_TOKEN SecurityToken);
+	void SetTimedOut(const NETADDR *pAddr, int Sequence, int Ack, TOKEN Token, TGrowingRingBuffer<CNetChunkResend, NET_CONN_BUFFERSIZE_MIN, NET_CONN_BUFFERSIZE> *pResendBuffer, TOKEN PeerToken, bool Sevendown, SECURITY_TOKEN SecurityToken);
 };
 
 class CConsoleNetConnection
@@ -621,6 +625,7 @@ public:
 	// connection state
 	int Disconnect(const char *Reason);
 	int Connect(NETADDR *Addr);
+	int ConnectSevendown(NETADDR *Addr);
 
 	// communication
 	int Recv(CNetChunk *pChunk, TOKEN *pResponseToken = 0);
@@ -58,6 +58,12 @@ int CNetClient::Connect(NETADDR *pAddr)
 	return 0;
 }
 
+int CNetClient::ConnectSevendown(NETADDR *pAddr)
+{
+	m_Connection.ConnectSevendown(pAddr);
+	return 0;
+}
+
 int CNetClient::ResetErrorString()
 {
 	m_Connection.ResetErrorString();
@@ -74,7 +80,7 @@ int CNetClient::Recv(CNetChunk *pChunk, TOKEN *pResponseToken)
 
 		// TODO: empty the recvinfo
 		NETADDR Addr;
-		bool Sevendown;
+		bool Sevendown = m_Connection.m_Sevendown;
 		int Result = UnpackPacket(&Addr, m_RecvUnpacker.m_aBuffer, &m_RecvUnpacker.m_Data, &Sevendown, 0);
 		// no more packets for now
 		if(Result > 0)
@@ -84,7 +90,7 @@ int CNetClient::Recv(CNetChunk *pChunk, TOKEN *pResponseToken)
 		{
 			if(m_Connection.State() != NET_CONNSTATE_OFFLINE && m_Connection.State() != NET_CONNSTATE_ERROR && net_addr_comp(m_Connection.PeerAddress(), &Addr, true) == 0)
 			{
-				if(m_Connection.Feed(&m_RecvUnpacker.m_Data, &Addr, false, 0))
+				if(m_Connection.Feed(&m_RecvUnpacker.m_Data, &Addr, Sevendown, 0))
 				{
 					if(!(m_RecvUnpacker.m_Data.m_Flags&NET_PACKETFLAG_CONNLESS))
 						m_RecvUnpacker.Start(&Addr, &m_Connection, 0);
@@ -151,10 +151,9 @@ int CNetConnection::QueueChunkEx(int Flags, int DataSize, const void *pData, int
 			pResend->m_Sequence = Sequence;
 			pResend->m_Flags = Flags;
 			pResend->m_DataSize = DataSize;
-			pResend->m_pData = (unsigned char *)(pResend+1);
 			pResend->m_FirstSendTime = time_get();
 			pResend->m_LastSendTime = pResend->m_FirstSendTime;
-			mem_copy(pResend->m_pData, pData, DataSize);
+			mem_copy(pResend->Data(), pData, DataSize);
 		}
 		else
 		{
@@ -195,7 +194,7 @@ void CNetConnection::SendControlWithToken(int ControlMsg)
 
 void CNetConnection::ResendChunk(CNetChunkResend *pResend)
 {
-	QueueChunkEx(pResend->m_Flags|NET_CHUNKFLAG_RESEND, pResend->m_DataSize, pResend->m_pData, pResend->m_Sequence);
+	QueueChunkEx(pResend->m_Flags|NET_CHUNKFLAG_RESEND, pResend->m_DataSize, pResend->Data(), pResend->m_Sequence);
 	pResend->m_LastSendTime = time_get();
 }
 
@@ -222,6 +221,22 @@ int CNetConnection::Connect(NETADDR *pAddr)
 	return 0;
 }
 
+int CNetConnection::ConnectSevendown(NETADDR *pAddr)
+{
+	if(State() != NET_CONNSTATE_OFFLINE)
+		return -1;
+
+	// init connection, 0.6 has no token exchange, the security token comes with the accept
+	Reset();
+	m_LastRecvTime = time_get();
+	m_PeerAddr = *pAddr;
+	m_Sevendown = true;
+	mem_zero(m_ErrorString, sizeof(m_ErrorString));
+	m_State = NET_CONNSTATE_CONNECT;
+	SendControl(NET_CTRLMSG_CONNECT, SECURITY_TOKEN_MAGIC, sizeof(SECURITY_TOKEN_MAGIC));
+	return 0;
+}
+
 void CNetConnection::Disconnect(const char *pReason)
 {
 	if(State() == NET_CONNSTATE_OFFLINE)
@@ -392,6 +407,15 @@ int CNetConnection::Feed(CNetPacketConstruct *pPacket, NETADDR *pAddr, bool Seve
 					{
 						m_LastRecvTime = Now;
 						m_State = NET_CONNSTATE_ONLINE;
+						if(m_Sevendown)
+						{
+							// 0.6 connect accept, the security token follows the magic
+							if(pPacket->m_DataSize >= 1 + (int)sizeof(SECURITY_TOKEN_MAGIC) + (int)sizeof(SECURITY_TOKEN) && mem_comp(&pPacket->m_aChunkData[1], SECURITY_TOKEN_MAGIC, sizeof(SECURITY_TOKEN_MAGIC)) == 0)
+								m_SecurityToken = ToSecurityToken(&pPacket->m_aChunkData[1 + sizeof(SECURITY_TOKEN_MAGIC)]);
+							else
+								m_SecurityToken = NET_SECURITY_TOKEN_UNSUPPORTED;
+							SendControl(NET_CTRLMSG_SEVENDOWN_ACCEPT, 0, 0);
+						}
 						if(Config()->m_Debug)
 							dbg_msg("connection", "got accept. connection online");
 					}
@@ -492,7 +516,12 @@ int CNetConnection::Update()
 	else if(State() == NET_CONNSTATE_CONNECT)
 	{
 		if(time_get()-m_LastSendTime > time_freq()/2) // send a new connect every 500ms
-			SendControlWithToken(NET_CTRLMSG_CONNECT);
+		{
+			if(m_Sevendown)
+				SendControl(NET_CTRLMSG_CONNECT, SECURITY_TOKEN_MAGIC, sizeof(SECURITY_TOKEN_MAGIC));
+			else
+				SendControlWithToken(NET_CTRLMSG_CONNECT);
+		}
 	}
 	else if(State() == NET_CONNSTATE_PENDING)
 	{
@@ -534,7 +563,7 @@ void CNetConnection::DummyDrop()
 	Reset();
 }
 
-void CNetConnection::SetTimedOut(const NETADDR *pAddr, int Sequence, int Ack, TOKEN Token, TStaticRingBuffer<CNetChunkResend, NET_CONN_BUFFERSIZE> *pResendBuffer, TOKEN PeerToken, bool Sevendown, SECURITY_TOKEN SecurityToken)
+void CNetConnection::SetTimedOut(const NETADDR *pAddr, int Sequence, int Ack, TOKEN Token, TGrowingRingBuffer<CNetChunkResend, NET_CONN_BUFFERSIZE_MIN, NET_CONN_BUFFERSIZE> *pResendBuffer, TOKEN PeerToken, bool Sevendown, SECURITY_TOKEN SecurityToken)
 {
 	int64 Now = time_get();
 
@@ -553,15 +582,6 @@ void CNetConnection::SetTimedOut(const NETADDR *pAddr, int Sequence, int Ack, TO
 	m_Sevendown = Sevendown;
 	m_PeerToken = PeerToken;
 
-	// copy resend buffer
-	m_Buffer.Init();
-	while (pResendBuffer->First())
-	{
-		CNetChunkResend *First = pResendBuffer->First();
-
-		CNetChunkResend *pResend = m_Buffer.Allocate(sizeof(CNetChunkResend)+First->m_DataSize);
-		mem_copy(pResend, First, sizeof(CNetChunkResend)+First->m_DataSize);
-
-		pResendBuffer->PopFirst();
-	}
+	// take over the resend buffer
+	m_Buffer.TakeFrom(pResendBuffer);
 }
@@ -0,0 +1,85 @@
+#include "profiler.h"
+
+#include <base/math.h>
+
+#include <algorithm>
+#include <chrono>
+
+CProfiler::CProfiler()
+{
+	m_NumSections = 0;
+	m_Enabled = false;
+	Reset();
+}
+
+int CProfiler::AddSection(const char *pName)
+{
+	for(int i = 0; i < m_NumSections; i++)
+		if(str_comp(m_aSections[i].m_aName, pName) == 0)
+			return i;
+
+	if(m_NumSections >= MAX_SECTIONS)
+		return -1;
+
+	CSection *pSection = &m_aSections[m_NumSections];
+	str_copy(pSection->m_aName, pName, sizeof(pSection->m_aName));
+	pSection->m_Current = 0;
+	pSection->m_NumCalls = 0;
+	pSection->m_NumSamples = 0;
+	pSection->m_NextSample = 0;
+	return m_NumSections++;
+}
+
+void CProfiler::Add(int Section, int64 Duration)
+{
+	m_aSections[Section].m_Current += Duration;
+	m_aSections[Section].m_NumCalls++;
+}
+
+void CProfiler::EndTick()
+{
+	for(int i = 0; i < m_NumSections; i++)
+	{
+		CSection *pSection = &m_aSections[i];
+		if(!pSection->m_NumCalls.exchange(0))
+			continue;
+
+		pSection->m_aSamples[pSection->m_NextSample] = pSection->m_Current.exchange(0);
+		pSection->m_NextSample = (pSection->m_NextSample + 1) % NUM_SAMPLES;
+		pSection->m_NumSamples = min(pSection->m_NumSamples + 1, (int)NUM_SAMPLES);
+	}
+}
+
+void CProfiler::Reset()
+{
+	for(int i = 0; i < MAX_SECTIONS; i++)
+	{
+		m_aSections[i].m_Current = 0;
+		m_aSections[i].m_NumCalls = 0;
+		m_aSections[i].m_NumSamples = 0;
+		m_aSections[i].m_NextSample = 0;
+	}
+}
+
+bool CProfiler::GetStats(int Section, CStats *pStats) const
+{
+	if(Section < 0 || Section >= m_NumSections || !m_aSections[Section].m_NumSamples)
+		return false;
+
+	const CSection *pSection = &m_aSections[Section];
+	int64 aSorted[NUM_SAMPLES];
+	int Num = pSection->m_NumSamples;
+	mem_copy(aSorted, pSection->m_aSamples, Num * sizeof(int64));
+	std::sort(aSorted, aSorted + Num);
+
+	pStats->m_P50 = aSorted[(Num - 1) / 2];
+	pStats->m_P99 = aSorted[(Num - 1) * 99 / 100];
+	pStats->m_Max = aSorted[Num - 1];
+	pStats->m_NumSamples = Num;
+	return true;
+}
+
+int64 CProfiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
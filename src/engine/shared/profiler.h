@@ -0,0 +1,87 @@
+#ifndef ENGINE_SHARED_PROFILER_H
+#define ENGINE_SHARED_PROFILER_H
+
+#include <base/system.h>
+
+#include <atomic>
+
+// accumulates the time spent in named sections per tick and keeps the last ticks of every
+// section to report rolling percentiles. Add() may be called from any thread, the rest from
+// the main thread only.
+class CProfiler
+{
+public:
+	enum
+	{
+		MAX_SECTIONS = 128,
+		NUM_SAMPLES = 256,
+		MAX_NAME_LENGTH = 32,
+	};
+
+	struct CStats
+	{
+		// nanoseconds per tick
+		int64 m_P50;
+		int64 m_P99;
+		int64 m_Max;
+		int m_NumSamples;
+	};
+
+private:
+	struct CSection
+	{
+		char m_aName[MAX_NAME_LENGTH];
+		std::atomic<int64> m_Current;
+		std::atomic<int> m_NumCalls;
+		int64 m_aSamples[NUM_SAMPLES];
+		int m_NumSamples;
+		int m_NextSample;
+	};
+
+	CSection m_aSections[MAX_SECTIONS];
+	int m_NumSections;
+	bool m_Enabled;
+
+public:
+	CProfiler();
+
+	void SetEnabled(bool Enabled) { m_Enabled = Enabled; }
+	bool IsEnabled() const { return m_Enabled; }
+
+	// returns the id of the section with this name, adding it if necessary, or -1 if there is no space left
+	int AddSection(const char *pName);
+	int NumSections() const { return m_NumSections; }
+	const char *SectionName(int Section) const { return m_aSections[Section].m_aName; }
+
+	void Add(int Section, int64 Duration);
+	// stores the time of every section that was entered since the last call as one sample
+	void EndTick();
+	void Reset();
+	bool GetStats(int Section, CStats *pStats) const;
+
+	// monotonic nanoseconds
+	static int64 Now();
+};
+
+class CProfileScope
+{
+	CProfiler *m_pProfiler;
+	int m_Section;
+	int64 m_Start;
+
+public:
+	CProfileScope(CProfiler *pProfiler, int Section)
+	{
+		m_pProfiler = pProfiler;
+		m_Section = Section;
+		m_Start = pProfiler && pProfiler->IsEnabled() && Section >= 0 ? CProfiler::Now() : -1;
+	}
+
+	~CProfileScope()
+	{
+		if(m_Start >= 0)
+			m_pProfiler->Add(m_Section, CProfiler::Now() - m_Start);
+	}
+};
+
+#endif
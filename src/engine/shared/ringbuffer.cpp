@@ -1,5 +1,6 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/lock_scope.h>
 #include <base/system.h>
 
 #include "ringbuffer.h"
@@ -192,3 +193,66 @@ void *CRingBufferBase::Last()
 	return Prev(m_pProduce+1);
 }
 
+bool CRingBufferBase::CopyFrom(CRingBufferBase *pOther)
+{
+	for(void *pCurrent = pOther->First(); pCurrent; pCurrent = pOther->Next(pCurrent))
+	{
+		int Size = (((CItem *)pCurrent) - 1)->m_Size - sizeof(CItem);
+		void *pItem = Allocate(Size);
+		if(!pItem)
+			return false;
+		mem_copy(pItem, pCurrent, Size);
+	}
+	return true;
+}
+
+static void *s_apPoolFree[CRingBufferPool::MAX_SIZE_LOG2+1];
+static int s_aPoolNumFree[CRingBufferPool::MAX_SIZE_LOG2+1];
+
+static LOCK PoolLock()
+{
+	static LOCK s_Lock = lock_create();
+	return s_Lock;
+}
+
+static int PoolIndex(int Size)
+{
+	int Index = CRingBufferPool::MIN_SIZE_LOG2;
+	while((1<<Index) < Size)
+		Index++;
+	dbg_assert((1<<Index) == Size && Index <= CRingBufferPool::MAX_SIZE_LOG2, "ring buffer size must be a power of two");
+	return Index;
+}
+
+void *CRingBufferPool::Alloc(int Size)
+{
+	int Index = PoolIndex(Size);
+	{
+		CLockScope ls(PoolLock());
+		void *pMemory = s_apPoolFree[Index];
+		if(pMemory)
+		{
+			// free blocks link to the next one with their first bytes
+			s_apPoolFree[Index] = *(void **)pMemory;
+			s_aPoolNumFree[Index]--;
+			return pMemory;
+		}
+	}
+	return mem_alloc(Size, sizeof(void *));
+}
+
+void CRingBufferPool::Free(void *pMemory, int Size)
+{
+	int Index = PoolIndex(Size);
+	{
+		CLockScope ls(PoolLock());
+		if(s_aPoolNumFree[Index] < MAX_FREE_PER_SIZE)
+		{
+			*(void **)pMemory = s_apPoolFree[Index];
+			s_apPoolFree[Index] = pMemory;
+			s_aPoolNumFree[Index]++;
+			return;
+		}
+	}
+	mem_free(pMemory);
+}
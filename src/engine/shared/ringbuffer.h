@@ -38,6 +38,9 @@ protected:
 
 	void Init(void *pMemory, int Size, int Flags);
 	int PopFirst();
+
+	// appends all items of another buffer in order, fails if they don't fit
+	bool CopyFrom(CRingBufferBase *pOther);
 public:
 	enum
 	{
@@ -64,4 +67,99 @@ public:
 	T *Last() { return (T*)CRingBufferBase::Last(); }
 };
 
+// memory for growing ring buffers, kept in free lists by power of two size so
+// connections that come and go don't hit the allocator every time
+class CRingBufferPool
+{
+public:
+	enum
+	{
+		MIN_SIZE_LOG2=10,
+		MAX_SIZE_LOG2=24,
+		MAX_FREE_PER_SIZE=8,
+	};
+
+	static void *Alloc(int Size);
+	static void Free(void *pMemory, int Size);
+};
+
+// ring buffer that holds no memory while empty. it takes TMINSIZE bytes from the pool on
+// the first allocation and doubles until TMAXSIZE when an item doesn't fit anymore.
+// items are moved when growing, so they must not point into themselves
+template<typename T, int TMINSIZE, int TMAXSIZE, int TFLAGS=0>
+class TGrowingRingBuffer : public CRingBufferBase
+{
+	unsigned char *m_pBuffer;
+	int m_BufferSize;
+
+	bool Grow()
+	{
+		if(m_BufferSize >= TMAXSIZE)
+			return false;
+
+		CRingBufferBase Old = *this;
+		unsigned char *pOldBuffer = m_pBuffer;
+		int OldSize = m_BufferSize;
+
+		m_BufferSize = OldSize*2;
+		m_pBuffer = (unsigned char *)CRingBufferPool::Alloc(m_BufferSize);
+		CRingBufferBase::Init(m_pBuffer, m_BufferSize, TFLAGS);
+		CopyFrom(&Old);
+		CRingBufferPool::Free(pOldBuffer, OldSize);
+		return true;
+	}
+
+public:
+	TGrowingRingBuffer() : m_pBuffer(0), m_BufferSize(0) {}
+	~TGrowingRingBuffer() { Init(); }
+	// a copy would free the pooled memory twice, use TakeFrom() to move the items
+	TGrowingRingBuffer(const TGrowingRingBuffer &) = delete;
+	TGrowingRingBuffer &operator=(const TGrowingRingBuffer &) = delete;
+
+	// empties the buffer and gives the memory back to the pool
+	void Init()
+	{
+		if(m_pBuffer)
+			CRingBufferPool::Free(m_pBuffer, m_BufferSize);
+		m_pBuffer = 0;
+		m_BufferSize = 0;
+	}
+
+	// takes over the items and the memory of another buffer, leaving it empty
+	void TakeFrom(TGrowingRingBuffer *pOther)
+	{
+		Init();
+		if(!pOther->m_pBuffer)
+			return;
+		*static_cast<CRingBufferBase *>(this) = *pOther;
+		m_pBuffer = pOther->m_pBuffer;
+		m_BufferSize = pOther->m_BufferSize;
+		pOther->m_pBuffer = 0;
+		pOther->m_BufferSize = 0;
+	}
+
+	T *Allocate(int Size)
+	{
+		if(!m_pBuffer)
+		{
+			m_BufferSize = TMINSIZE;
+			m_pBuffer = (unsigned char *)CRingBufferPool::Alloc(m_BufferSize);
+			CRingBufferBase::Init(m_pBuffer, m_BufferSize, TFLAGS);
+		}
+
+		void *pItem = CRingBufferBase::Allocate(Size);
+		while(!pItem && Grow())
+			pItem = CRingBufferBase::Allocate(Size);
+		return (T*)pItem;
+	}
+	int PopFirst() { return m_pBuffer ? CRingBufferBase::PopFirst() : 0; }
+
+	T *Prev(T *pCurrent) { return (T*)CRingBufferBase::Prev(pCurrent); }
+	T *Next(T *pCurrent) { return (T*)CRingBufferBase::Next(pCurrent); }
+	T *First() { return m_pBuffer ? (T*)CRingBufferBase::First() : 0; }
+	T *Last() { return m_pBuffer ? (T*)CRingBufferBase::Last() : 0; }
+
+	int BufferSize() const { return m_BufferSize; }
+};
+
 #endif
@@ -204,6 +204,8 @@ void CCollision::Init(class CLayers* pLayers, class CConfig *pConfig)
 			}
 		}
 	}
+
+	InitDummyFields();
 }
 
 void CCollision::FillAntibot(CAntibotMapData *pMapData)
@@ -221,6 +223,97 @@ void CCollision::FillAntibot(CAntibotMapData *pMapData)
 	}
 }
 
+void CCollision::ComputeFreezeDistance(const unsigned char *pFreeze, int Width, int Height, unsigned char *pOut)
+{
+	// two pass chamfer transform with the chebyshev metric
+	for(int i = 0; i < Width * Height; i++)
+		pOut[i] = pFreeze[i] ? 0 : 255;
+
+	for(int y = 0; y < Height; y++)
+	{
+		for(int x = 0; x < Width; x++)
+		{
+			unsigned char *pTile = &pOut[y * Width + x];
+			if(*pTile == 0)
+				continue;
+			int Dist = *pTile;
+			if(x > 0)
+				Dist = min(Dist, pTile[-1] + 1);
+			if(y > 0)
+			{
+				const unsigned char *pAbove = pTile - Width;
+				Dist = min(Dist, pAbove[0] + 1);
+				if(x > 0)
+					Dist = min(Dist, pAbove[-1] + 1);
+				if(x < Width - 1)
+					Dist = min(Dist, pAbove[1] + 1);
+			}
+			*pTile = min(Dist, 255);
+		}
+	}
+
+	for(int y = Height - 1; y >= 0; y--)
+	{
+		for(int x = Width - 1; x >= 0; x--)
+		{
+			unsigned char *pTile = &pOut[y * Width + x];
+			if(*pTile == 0)
+				continue;
+			int Dist = *pTile;
+			if(x < Width - 1)
+				Dist = min(Dist, pTile[1] + 1);
+			if(y < Height - 1)
+			{
+				const unsigned char *pBelow = pTile + Width;
+				Dist = min(Dist, pBelow[0] + 1);
+				if(x > 0)
+					Dist = min(Dist, pBelow[-1] + 1);
+				if(x < Width - 1)
+					Dist = min(Dist, pBelow[1] + 1);
+			}
+			*pTile = min(Dist, 255);
+		}
+	}
+}
+
+void CCollision::InitDummyFields()
+{
+	int Size = m_Width * m_Height;
+	std::vector<unsigned char> vFreeze(Size);
+	for(int i = 0; i < Size; i++)
+	{
+		int Tile = m_pTiles[i].m_Index;
+		int FTile = m_pFront ? m_pFront[i].m_Index : 0;
+		vFreeze[i] = Tile == TILE_FREEZE || Tile == TILE_DFREEZE || FTile == TILE_FREEZE || FTile == TILE_DFREEZE;
+	}
+
+	m_vFreezeDistance.resize(Size);
+	if(Size)
+		ComputeFreezeDistance(&vFreeze[0], m_Width, m_Height, &m_vFreezeDistance[0]);
+}
+
+bool CCollision::ProbeFreeze(const unsigned char *pFreeze, int Width, int Height, int x, int y, int VelY)
+{
+	static const int s_aOffsets[][2] = {
+		{1, 0}, {-1, 0}, {-1, -1}, {1, -1}, {-1, 1}, {1, 1}, {-2, 0}, {2, 0}, {-2, 1}, {2, 1}
+	};
+	for(unsigned i = 0; i < sizeof(s_aOffsets) / sizeof(s_aOffsets[0]); i++)
+	{
+		int Px = clamp(x + s_aOffsets[i][0], 0, Width - 1);
+		int Py = clamp(y + s_aOffsets[i][1], 0, Height - 1);
+		if(pFreeze[Py * Width + Px])
+			return true;
+	}
+	return pFreeze[clamp(y + VelY, 0, Height - 1) * Width + x];
+}
+
+int CCollision::GetFreezeDistance(vec2 Pos)
+{
+	if(m_vFreezeDistance.empty())
+		return 255;
+	return m_vFreezeDistance[GetPureMapIndex(Pos)];
+}
+
 enum
 {
 	MR_DIR_HERE=0,
@@ -827,6 +920,7 @@ void CCollision::Dest()
 	m_apPlotSize = 0;
 	m_NumPlots = 0;
 	m_NumTeleporters = 0;
+	m_vFreezeDistance.clear();
 	for (int i = 0; i < NUM_PLOT_SIZES; i++)
 		m_aNumPlots[i] = 0;
 }
@@ -273,6 +273,18 @@ public:
 
 	// access to plots: PlotID + m_NumSwitchers && PlotID < m_NumPlots + 1
 	SSwitchers *m_pSwitchers;
+
+	// distance in tiles to the nearest freeze tile (0 = freeze, saturates at 255), computed once at map load for the dummies
+	int GetFreezeDistance(vec2 Pos);
+	bool IsFreeze(vec2 Pos) { return GetFreezeDistance(Pos) == 0; }
+
+	static void ComputeFreezeDistance(const unsigned char *pFreeze, int Width, int Height, unsigned char *pOut);
+	// the probe pattern of CDummyBase::AvoidTile() that the distance field replaced, one layer lookup per probe
+	static bool ProbeFreeze(const unsigned char *pFreeze, int Width, int Height, int x, int y, int VelY);
+
+private:
+	void InitDummyFields();
+	std::vector<unsigned char> m_vFreezeDistance;
 };
 
 void ThroughOffset(vec2 Pos0, vec2 Pos1, int* Ox, int* Oy);
@@ -18,6 +18,8 @@ public:
         IConsole::FCommandCallback m_pfnCallback;
         void *m_pContext;
 
+        int m_HashNext;
+
         CCommand()
         {
             m_aName[0] = '\0';
@@ -26,6 +28,7 @@ public:
 
             m_pfnCallback = 0;
             m_pContext = 0;
+            m_HashNext = -1;
         }
 
         CCommand(const char *pName, const char *pHelpText, const char *pArgsFormat, IConsole::FCommandCallback pfnCallback, void *pContext)
@@ -35,6 +38,7 @@ public:
             str_copy(m_aArgsFormat, pArgsFormat, sizeof(m_aArgsFormat));
             m_pfnCallback = pfnCallback;
             m_pContext = pContext;
+            m_HashNext = -1;
         }
     };
 
@@ -42,7 +46,27 @@ public:
     typedef void (*FRemoveCommandHook)(const CCommand *pCommand, void *pContext);
 
 private:
+    enum
+    {
+        COMMAND_HASH_SIZE = 256,
+    };
+
     array<CCommand> m_aCommands;
+    int m_aCommandHash[COMMAND_HASH_SIZE]; // index of the first command in each bucket, -1 if empty
+
+    static int HashBucket(const char *pName) { return str_quickhash_nocase(pName)%COMMAND_HASH_SIZE; }
+
+    void RebuildHash()
+    {
+        for(int i = 0; i < COMMAND_HASH_SIZE; i++)
+            m_aCommandHash[i] = -1;
+        for(int i = 0; i < m_aCommands.size(); i++)
+        {
+            int Bucket = HashBucket(m_aCommands[i].m_aName);
+            m_aCommands[i].m_HashNext = m_aCommandHash[Bucket];
+            m_aCommandHash[Bucket] = i;
+        }
+    }
 
     IConsole *m_pConsole;
     void *m_pHookContext;
@@ -54,6 +78,7 @@ public:
     {
         m_pConsole = 0;
         m_aCommands.clear();
+        RebuildHash();
     }
 
     void Init(IConsole *pConsole, void *pHookContext = 0, FNewCommandHook pfnNewCommandHook = 0, FRemoveCommandHook pfnRemoveCommandHook = 0)
@@ -66,7 +91,7 @@ public:
 
     const CCommand *GetCommand(const char *pCommand)
     {
-        for(int i = 0; i < m_aCommands.size(); i++)
+        for(int i = m_aCommandHash[HashBucket(pCommand)]; i != -1; i = m_aCommands[i].m_HashNext)
             if(!str_comp(m_aCommands[i].m_aName, pCommand))
                 return &m_aCommands[i];
 
@@ -91,6 +116,9 @@ public:
             return 1;
 
         int Index = m_aCommands.add(CCommand(pCommand, pHelpText, pArgsFormat, pfnCallback, pContext));
+        int Bucket = HashBucket(m_aCommands[Index].m_aName);
+        m_aCommands[Index].m_HashNext = m_aCommandHash[Bucket];
+        m_aCommandHash[Bucket] = Index;
         if(m_pfnNewCommandHook)
             m_pfnNewCommandHook(&m_aCommands[Index], m_pHookContext);
 
@@ -107,6 +135,7 @@ public:
                     m_pfnRemoveCommandHook(&m_aCommands[i], m_pHookContext);
 
                 m_aCommands.remove_index(i);
+                RebuildHash();
                 return 0;
             }
         }
@@ -117,6 +146,7 @@ public:
     void ClearCommands()
     {
         m_aCommands.clear();
+        RebuildHash();
     }
 
     int CommandCount() const
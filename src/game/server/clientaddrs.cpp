@@ -0,0 +1,33 @@
+#include "clientaddrs.h"
+
+CClientAddrs::CClientAddrs()
+{
+	for (int i = 0; i < MAX_CLIENTS; i++)
+		OnDropped(i);
+}
+
+void CClientAddrs::OnConnected(int ClientID, const NETADDR *pAddr)
+{
+	m_aAddrs[ClientID] = *pAddr;
+	m_aConnected[ClientID] = true;
+	m_aEntered[ClientID] = false;
+}
+
+void CClientAddrs::OnEntered(int ClientID)
+{
+	m_aEntered[ClientID] = m_aConnected[ClientID];
+}
+
+void CClientAddrs::OnDropped(int ClientID)
+{
+	mem_zero(&m_aAddrs[ClientID], sizeof(m_aAddrs[ClientID]));
+	m_aConnected[ClientID] = false;
+	m_aEntered[ClientID] = false;
+}
+
+bool CClientAddrs::SameAddr(int ClientID, int OtherID) const
+{
+	if (!m_aEntered[ClientID] || !m_aEntered[OtherID])
+		return false;
+	return net_addr_comp(&m_aAddrs[ClientID], &m_aAddrs[OtherID], false) == 0;
+}
@@ -0,0 +1,28 @@
+#ifndef GAME_SERVER_CLIENTADDRS_H
+#define GAME_SERVER_CLIENTADDRS_H
+
+#include <base/system.h>
+
+#include <engine/shared/protocol.h>
+
+// the address of every client from connect until drop, so the player maps don't have to ask the server for it in
+// their same ip checks. clients only count as sharing an ip once both entered, before that their map isn't set up
+class CClientAddrs
+{
+	NETADDR m_aAddrs[MAX_CLIENTS];
+	bool m_aConnected[MAX_CLIENTS];
+	bool m_aEntered[MAX_CLIENTS];
+
+public:
+	CClientAddrs();
+
+	void OnConnected(int ClientID, const NETADDR *pAddr);
+	void OnEntered(int ClientID);
+	void OnDropped(int ClientID);
+
+	bool HasEntered(int ClientID) const { return m_aEntered[ClientID]; }
+	// the port is ignored, false for clients that didn't enter yet
+	bool SameAddr(int ClientID, int OtherID) const;
+};
+
+#endif // GAME_SERVER_CLIENTADDRS_H
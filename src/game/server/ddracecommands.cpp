@@ -1953,7 +1953,7 @@ void CGameContext::ConRedirectPort(IConsole::IResult* pResult, void* pUserData)
 	CGameContext* pSelf = (CGameContext*)pUserData;
 	int Victim = pResult->NumArguments() == 2 ? pResult->GetVictim() : pResult->m_ClientID;
 	CCharacter* pChr = pSelf->GetPlayerChar(Victim);
-	if (pChr) pChr->TrySafelyRedirectClient(pResult->GetInteger(0), true);
+	if (pChr) pChr->TrySavelyRedirectClient(pResult->GetInteger(0));
 }
 
 void CGameContext::ConSaveDrop(IConsole::IResult* pResult, void* pUserData)
@@ -1973,11 +1973,15 @@ void CGameContext::ConListSavedTees(IConsole::IResult* pResult, void* pUserData)
 	CGameContext *pSelf = (CGameContext *)pUserData;
 	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "console", "Listing all saved identities:");
 	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "console", "----------------------------------");
-	for (int i = 0; i < (int)pSelf->m_vSavedIdentities.size(); i++)
+	for (int i = 0; i < pSelf->m_SavedIdentities.NumSlots(); i++)
 	{
+		const SSavedIdentity *pIdentity = pSelf->m_SavedIdentities.Get(i);
+		if (!pIdentity)
+			continue;
+
 		char aBuf[256];
-		str_format(aBuf, sizeof(aBuf), "| %s | %s | '%s' | %s | %d |", pSelf->GetSavedIdentityHash(pSelf->m_vSavedIdentities[i]), pSelf->GetDate(pSelf->m_vSavedIdentities[i].m_ExpireDate),
-			pSelf->m_vSavedIdentities[i].m_aName, pSelf->m_vSavedIdentities[i].m_aAccUsername[0] ? pSelf->m_vSavedIdentities[i].m_aAccUsername : "<no_acc>", pSelf->m_vSavedIdentities[i].m_RedirectTilePort);
+		str_format(aBuf, sizeof(aBuf), "| %s | %s | '%s' | %s | %d |", pSelf->m_SavedIdentities.GetHash(i), pSelf->GetDate(pIdentity->m_ExpireDate),
+			pIdentity->m_aName, pIdentity->m_aAccUsername[0] ? pIdentity->m_aAccUsername : "<no_acc>", pIdentity->m_RedirectTilePort);
 		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "console", aBuf);
 	}
 }
@@ -7,7 +7,6 @@
 #include <game/server/gamecontext.h>
 #include <game/server/teams.h>
 #include <engine/shared/config.h>
-#include <fstream>
 #include <string>
 
 static float s_MaxLength = 10.f;
@@ -1265,15 +1264,18 @@ bool CDrawEditor::TryEnterPresetName(const char *pName)
 
 			char aBuf[128];
 			str_format(aBuf, sizeof(aBuf), "%s/presets/%s.plot", GameServer()->Config()->m_SvPlotFilePath, pName);
-			std::ofstream PresetFile(aBuf);
-
+			std::vector<CPlotFile::CObject> vObjects;
 			for (unsigned int i = 0; i < m_Transform.m_vSelected.size(); i++)
 			{
 				vec2 Pos = m_Transform.m_vSelected[i]->GetPos() - m_Transform.m_Area.BottomRight();
-				GameServer()->WritePlotObject(m_Transform.m_vSelected[i], &PresetFile, &Pos);
+				CPlotFile::CObject Obj;
+				if (GameServer()->GetPlotObject(m_Transform.m_vSelected[i], &Obj, &Pos))
+					vObjects.push_back(Obj);
 			}
+			CPlotFile::Save(aBuf, 0, vObjects);
 
 			GameServer()->m_vPresetList.push_back(pName);
+			GameServer()->m_PresetCache.Add(pName, vObjects);
 			str_format(aBuf, sizeof(aBuf), "Successfully saved preset '%s'", pName);
 			GameServer()->SendChatTarget(GetCID(), aBuf);
 			StopTransform(true);
@@ -1282,21 +1284,29 @@ bool CDrawEditor::TryEnterPresetName(const char *pName)
 		else if (m_Setting == TRANSFORM_LOAD_PRESET)
 		{
 			char aBuf[128];
-			str_format(aBuf, sizeof(aBuf), "%s/presets/%s.plot", GameServer()->Config()->m_SvPlotFilePath, pName);
-			std::fstream PresetFile(aBuf);
-			if (!PresetFile.is_open())
+			const std::vector<CPlotFile::CObject> *pvObjects = GameServer()->m_PresetCache.Find(pName);
+			if (!pvObjects)
 			{
-				str_format(aBuf, sizeof(aBuf), "Couldn't load preset '%s'", pName);
-				GameServer()->SendChatTarget(GetCID(), aBuf);
-				StopTransform(true);
-				return true;
-			}
+				str_format(aBuf, sizeof(aBuf), "%s/presets/%s.plot", GameServer()->Config()->m_SvPlotFilePath, pName);
+				std::vector<CPlotFile::CObject> vObjects;
+				int Result = CPlotFile::Load(aBuf, 0, &vObjects);
+				if (Result == CPlotFile::LOAD_FAILED)
+				{
+					str_format(aBuf, sizeof(aBuf), "Couldn't load preset '%s'", pName);
+					GameServer()->SendChatTarget(GetCID(), aBuf);
+					StopTransform(true);
+					return true;
+				}
 
-			std::string data;
-			getline(PresetFile, data);
-			const char *pData = data.c_str();
+				// one time migration of the old text format
+				if (Result == CPlotFile::LOAD_TEXT)
+					CPlotFile::Save(aBuf, 0, vObjects);
+
+				GameServer()->m_PresetCache.Add(pName, vObjects);
+				pvObjects = GameServer()->m_PresetCache.Find(pName);
+			}
 
-			std::vector<CEntity *> vEntities = GameServer()->ReadPlotObjects(pData, CurrentPlotID());
+			std::vector<CEntity *> vEntities = GameServer()->CreatePlotObjects(*pvObjects, CurrentPlotID());
 			while(vEntities.size())
 			{
 				SSelectedEnt Entity;
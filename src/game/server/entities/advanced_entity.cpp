@@ -21,6 +21,8 @@ CAdvancedEntity::CAdvancedEntity(CGameWorld *pGameWorld, int Objtype, vec2 Pos,
 	m_AllowVipPlus = true;
 	m_Elasticity = 0.5f;
 	m_LastInOutTeleporter = 0;
+	m_Sleeping = false;
+	m_RestTicks = 0;
 }
 
 void CAdvancedEntity::Reset()
@@ -85,6 +87,15 @@ bool CAdvancedEntity::IsGrounded(bool GroundVel, bool AirVel)
 
 void CAdvancedEntity::HandleDropped()
 {
+	// whatever pushed or moved us wakes us up, otherwise we check once a second whether we'd still rest, spread over the ticks by id
+	if (m_Sleeping)
+	{
+		if (m_Vel.x == 0.f && m_Vel.y == 0.f && m_Pos == m_PrevPos && (Server()->Tick() + GetID()) % Server()->TickSpeed())
+			return;
+		if (m_Vel.x != 0.f || m_Vel.y != 0.f || m_Pos != m_PrevPos)
+			Wake();
+	}
+
 	//Gravity
 	if (m_Gravity)
 	{
@@ -167,6 +178,18 @@ void CAdvancedEntity::HandleDropped()
 	}
 	IsGrounded(m_GroundVel, m_AirVel);
 	GameServer()->Collision()->MoveBox(IsSwitchActiveCb, this, &m_Pos, &m_Vel, m_Size, m_Elasticity, !Config()->m_SvStoppersPassthrough, GetMoveRestrictionExtra());
+
+	// gravity keeps bouncing a resting entity by tiny amounts, that's what we look for
+	if (distance(m_Pos, m_PrevPos) < 0.1f && IsGrounded())
+	{
+		if (m_Sleeping || ++m_RestTicks >= ADVANCED_ENTITY_REST_TICKS)
+		{
+			m_Sleeping = true;
+			m_Vel = vec2(0, 0);
+		}
+	}
+	else
+		Wake();
 }
 
 bool CAdvancedEntity::IsSwitchActiveCb(int Number, void* pUser)
@@ -6,6 +6,12 @@
 #include <game/server/entity.h>
 #include <game/server/mask128.h>
 
+enum
+{
+	// ticks an entity has to lie still on the ground before it falls asleep
+	ADVANCED_ENTITY_REST_TICKS = 10,
+};
+
 class CAdvancedEntity : public CEntity
 {
 public:
@@ -20,10 +26,14 @@ public:
 	CCharacter *GetOwner();
 	int GetMoveRestrictions() { return m_MoveRestrictions; }
 	vec2 GetVel() { return m_Vel; }
-	void SetVel(vec2 Vel) { m_Vel = Vel; }
-	void SetPrevPos(vec2 Pos) { m_PrevPos = Pos; }
+	void SetVel(vec2 Vel) { m_Vel = Vel; Wake(); }
+	void SetPrevPos(vec2 Pos) { m_PrevPos = Pos; Wake(); }
 	virtual void ReleaseHooked() {}
 
+	// sleeping entities skip the physics in HandleDropped() until they get moved or woken up
+	void Wake() { m_Sleeping = false; m_RestTicks = 0; }
+	bool IsSleeping() { return m_Sleeping; }
+
 protected:
 	bool IsGrounded(bool GroundVel = false, bool AirVel = false);
 	// HandleDropped() has to be called within the tick function of the child entity whenever the entity is dropped and not being carried
@@ -48,6 +58,9 @@ protected:
 	float m_Elasticity;
 	bool m_AllowVipPlus;
 
+	bool m_Sleeping;
+	int m_RestTicks;
+
 	static bool IsSwitchActiveCb(int Number, void* pUser);
 	void HandleTiles(int Index);
 	int m_TileIndex;
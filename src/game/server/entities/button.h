@@ -27,6 +27,7 @@ public:
 	virtual ~CButton();
 	virtual void ResetCollision(bool Remove = false);
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 };
 
 #endif // GAME_SERVER_ENTITIES_BUTTON_H
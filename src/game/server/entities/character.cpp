@@ -205,9 +205,9 @@ void CCharacter::HandleJetpack()
 	if (FullAuto && (m_LatestInput.m_Fire & 1) && m_aWeapons[GetActiveWeapon()].m_Ammo)
 		WillFire = true;
 
-	for (int i = 0; i < NUM_HOUSES; i++)
-		if (GameServer()->m_pHouses[i]->CanChangePage(m_pPlayer->GetCID()))
-			return;
+	CHouse *pHouse = m_pPlayer->GetCurrentHouse();
+	if (pHouse && pHouse->CanChangePage(m_pPlayer->GetCID()))
+		return;
 
 	if (!WillFire)
 		return;
@@ -447,14 +447,12 @@ void CCharacter::FireWeapon()
 	}
 
 	// shop window
-	for (int i = 0; i < NUM_HOUSES; i++)
+	CHouse *pHouse = m_pPlayer->GetCurrentHouse();
+	if (pHouse && pHouse->CanChangePage(m_pPlayer->GetCID()))
 	{
-		if (GameServer()->m_pHouses[i]->CanChangePage(m_pPlayer->GetCID()))
-		{
-			if (ClickedFire)
-				GameServer()->m_pHouses[i]->DoPageChange(m_pPlayer->GetCID(), GetAimDir());
-			return;
-		}
+		if (ClickedFire)
+			pHouse->DoPageChange(m_pPlayer->GetCID(), GetAimDir());
+		return;
 	}
 
 	if(FullAuto && (m_LatestInput.m_Fire&1) && m_aWeapons[GetActiveWeapon()].m_Ammo && !m_FreezeTime)
@@ -563,9 +561,7 @@ void CCharacter::FireWeapon()
 						}
 						else
 						{
-							GameServer()->Collision()->m_pSwitchers[pDoor->m_Number].m_Status[Team()] = !Status;
-							GameServer()->Collision()->m_pSwitchers[pDoor->m_Number].m_EndTick[Team()] = 0;
-							GameServer()->Collision()->m_pSwitchers[pDoor->m_Number].m_Type[Team()] = Status ? TILE_SWITCHCLOSE : TILE_SWITCHOPEN;
+							GameServer()->SetSwitch(pDoor->m_Number, Team(), !Status, Status ? TILE_SWITCHCLOSE : TILE_SWITCHOPEN, 0);
 						}
 					}
 				}
@@ -2650,24 +2646,6 @@ void CCharacter::HandleTiles(int Index)
 			m_pPlayer->GiveXP(500, "finish the race");
 		}
 
-		//shop
-		for (int i = 0; i < NUM_HOUSES; i++)
-		{
-			int Index = -1;
-			switch (i)
-			{
-			case HOUSE_SHOP: Index = TILE_SHOP; break;
-			case HOUSE_PLOT_SHOP: Index = TILE_PLOT_SHOP; break;
-			case HOUSE_BANK: Index = TILE_BANK; break;
-			}
-
-			if (m_TileIndex == Index || m_TileFIndex == Index)
-			{
-				if (m_LastIndexTile != Index && m_LastIndexFrontTile != Index)
-					GameServer()->m_pHouses[i]->OnEnter(m_pPlayer->GetCID());
-			}
-		}
-
 		bool MoneyTile = m_TileIndex == TILE_MONEY || m_TileFIndex == TILE_MONEY;
 		bool PoliceMoneyTile = m_TileIndex == TILE_MONEY_POLICE || m_TileFIndex == TILE_MONEY_POLICE;
 		bool ExtraMoneyTile = m_TileIndex == TILE_MONEY_EXTRA || m_TileFIndex == TILE_MONEY_EXTRA;
@@ -3113,10 +3091,9 @@ void CCharacter::HandleTiles(int Index)
 		{
 			if (std::find(m_vLastButtonNumbers.begin(), m_vLastButtonNumbers.end(), vButtonNumbers[i]) == m_vLastButtonNumbers.end())
 			{
-				GameServer()->Collision()->m_pSwitchers[vButtonNumbers[i]].m_Status[Team()] ^= 1;
-				GameServer()->Collision()->m_pSwitchers[vButtonNumbers[i]].m_EndTick[Team()] = 0;
-				GameServer()->Collision()->m_pSwitchers[vButtonNumbers[i]].m_ClientID[Team()] = m_pPlayer->GetCID();
-				GameServer()->Collision()->m_pSwitchers[vButtonNumbers[i]].m_StartTick[Team()] = Server()->Tick();
+				CCollision::SSwitchers *pButton = &GameServer()->Collision()->m_pSwitchers[vButtonNumbers[i]];
+				GameServer()->SetSwitch(vButtonNumbers[i], Team(), !pButton->m_Status[Team()], pButton->m_Type[Team()], 0);
+				GameServer()->SetSwitchActivator(vButtonNumbers[i], Team(), m_pPlayer->GetCID());
 
 				// little sound for the button
 				if (GameServer()->Collision()->IsPlotDrawDoor(vButtonNumbers[i]))
@@ -3132,43 +3109,31 @@ void CCharacter::HandleTiles(int Index)
 	CCollision::SSwitchers *pSwitcher = SwitchNumber > 0 ? &GameServer()->Collision()->m_pSwitchers[SwitchNumber] : 0;
 	if (GameServer()->Collision()->IsSwitch(MapIndex) == TILE_SWITCHOPEN && Team() != TEAM_SUPER && SwitchNumber > 0)
 	{
-		pSwitcher->m_Status[Team()] = true;
-		pSwitcher->m_EndTick[Team()] = 0;
-		pSwitcher->m_Type[Team()] = TILE_SWITCHOPEN;
+		GameServer()->SetSwitch(SwitchNumber, Team(), true, TILE_SWITCHOPEN, 0);
 		pSwitcher->m_LastUpdateTick[Team()] = Server()->Tick();
 		// F-DDrace
-		pSwitcher->m_ClientID[Team()] = m_pPlayer->GetCID();
-		pSwitcher->m_StartTick[Team()] = Server()->Tick();
+		GameServer()->SetSwitchActivator(SwitchNumber, Team(), m_pPlayer->GetCID());
 	}
 	else if (GameServer()->Collision()->IsSwitch(MapIndex) == TILE_SWITCHTIMEDOPEN && Team() != TEAM_SUPER && SwitchNumber > 0)
 	{
-		pSwitcher->m_Status[Team()] = true;
-		pSwitcher->m_EndTick[Team()] = Server()->Tick() + 1 + GameServer()->Collision()->GetSwitchDelay(MapIndex) * Server()->TickSpeed();
-		pSwitcher->m_Type[Team()] = TILE_SWITCHTIMEDOPEN;
+		GameServer()->SetSwitch(SwitchNumber, Team(), true, TILE_SWITCHTIMEDOPEN, Server()->Tick() + 1 + GameServer()->Collision()->GetSwitchDelay(MapIndex) * Server()->TickSpeed());
 		pSwitcher->m_LastUpdateTick[Team()] = Server()->Tick();
 		// F-DDrace
-		pSwitcher->m_ClientID[Team()] = m_pPlayer->GetCID();
-		pSwitcher->m_StartTick[Team()] = Server()->Tick();
+		GameServer()->SetSwitchActivator(SwitchNumber, Team(), m_pPlayer->GetCID());
 	}
 	else if (GameServer()->Collision()->IsSwitch(MapIndex) == TILE_SWITCHTIMEDCLOSE && Team() != TEAM_SUPER && SwitchNumber > 0)
 	{
-		pSwitcher->m_Status[Team()] = false;
-		pSwitcher->m_EndTick[Team()] = Server()->Tick() + 1 + GameServer()->Collision()->GetSwitchDelay(MapIndex) * Server()->TickSpeed();
-		pSwitcher->m_Type[Team()] = TILE_SWITCHTIMEDCLOSE;
+		GameServer()->SetSwitch(SwitchNumber, Team(), false, TILE_SWITCHTIMEDCLOSE, Server()->Tick() + 1 + GameServer()->Collision()->GetSwitchDelay(MapIndex) * Server()->TickSpeed());
 		pSwitcher->m_LastUpdateTick[Team()] = Server()->Tick();
 		// F-DDrace
-		pSwitcher->m_ClientID[Team()] = m_pPlayer->GetCID();
-		pSwitcher->m_StartTick[Team()] = Server()->Tick();
+		GameServer()->SetSwitchActivator(SwitchNumber, Team(), m_pPlayer->GetCID());
 	}
 	else if (GameServer()->Collision()->IsSwitch(MapIndex) == TILE_SWITCHCLOSE && Team() != TEAM_SUPER && SwitchNumber > 0)
 	{
-		pSwitcher->m_Status[Team()] = false;
-		pSwitcher->m_EndTick[Team()] = 0;
-		pSwitcher->m_Type[Team()] = TILE_SWITCHCLOSE;
+		GameServer()->SetSwitch(SwitchNumber, Team(), false, TILE_SWITCHCLOSE, 0);
 		pSwitcher->m_LastUpdateTick[Team()] = Server()->Tick();
 		// F-DDrace
-		pSwitcher->m_ClientID[Team()] = m_pPlayer->GetCID();
-		pSwitcher->m_StartTick[Team()] = Server()->Tick();
+		GameServer()->SetSwitchActivator(SwitchNumber, Team(), m_pPlayer->GetCID());
 	}
 	else if (GameServer()->Collision()->IsSwitch(MapIndex) == TILE_FREEZE && Team() != TEAM_SUPER)
 	{
@@ -4213,18 +4178,16 @@ void CCharacter::FDDraceTick()
 
 void CCharacter::HandleLastIndexTiles()
 {
-	for (int i = 0; i < NUM_HOUSES; i++)
+	// the house is looked up once per tick from the tile we ended up on, entering and leaving follow from that
+	int House = CHouse::TileToHouse(m_TileIndex);
+	if (House == -1)
+		House = CHouse::TileToHouse(m_TileFIndex);
+	if (House != m_pPlayer->m_CurrentHouse)
 	{
-		int Index = -1;
-		switch (i)
-		{
-		case HOUSE_SHOP: Index = TILE_SHOP; break;
-		case HOUSE_PLOT_SHOP: Index = TILE_PLOT_SHOP; break;
-		case HOUSE_BANK: Index = TILE_BANK; break;
-		}
-
-		if (m_TileIndex != Index && m_TileFIndex != Index)
-			GameServer()->m_pHouses[i]->OnLeave(m_pPlayer->GetCID());
+		if (m_pPlayer->GetCurrentHouse())
+			m_pPlayer->GetCurrentHouse()->OnLeave(m_pPlayer->GetCID());
+		if (House != -1)
+			GameServer()->m_pHouses[House]->OnEnter(m_pPlayer->GetCID());
 	}
 
 	if (m_MoneyTile)
@@ -4704,9 +4667,8 @@ void CCharacter::UpdateWeaponIndicator()
 	if (!m_pPlayer->m_WeaponIndicator
 		|| (m_pPlayer->m_Minigame == MINIGAME_SURVIVAL && GameServer()->m_SurvivalBackgroundState < BACKGROUND_DEATHMATCH_COUNTDOWN))
 		return;
-	for (int i = 0; i < NUM_HOUSES; i++)
-		if (GameServer()->m_pHouses[i]->IsInside(m_pPlayer->GetCID()))
-			return;
+	if (m_pPlayer->GetCurrentHouse())
+		return;
 
 	CGameContext::AccountInfo *pAccount = &GameServer()->m_Accounts[m_pPlayer->GetAccID()];
 
@@ -4850,7 +4812,7 @@ bool CCharacter::TrySavelyRedirectClient(int Port)
 			str_format(aMsg, sizeof(aMsg), "'%s' has been moved to another map", Server()->ClientName(m_pPlayer->GetCID()));
 			GameServer()->SendChat(-1, CHAT_ALL, -1, aMsg);
 
-			Server()->SendRedirectSaveTeeAdd(m_RedirectTilePort, GameServer()->GetSavedIdentityHash(GameServer()->m_vSavedIdentities[IdentityIndex]));
+			Server()->SendRedirectSaveTeeAdd(m_RedirectTilePort, GameServer()->m_SavedIdentities.GetHash(IdentityIndex));
 			Server()->RedirectClient(m_pPlayer->GetCID(), m_RedirectTilePort);
 			return true;
 		}
@@ -22,6 +22,7 @@ public:
 	virtual void Reset();
 	virtual void Tick();
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 
 private:
 	vec2 m_Core;
@@ -115,9 +115,7 @@ int CDummyBase::GetFTile(int PosX, int PosY)
 
 bool CDummyBase::IsFreezeTile(int PosX, int PosY)
 {
-	int Tile = GetTile(PosX, PosY);
-	int FTile = GetFTile(PosX, PosY);
-	return Tile == TILE_FREEZE || FTile == TILE_FREEZE || Tile == TILE_DFREEZE || FTile == TILE_DFREEZE;
+	return GameServer()->Collision()->IsFreeze(vec2(PosX, PosY));
 }
 
 void CDummyBase::AvoidTile(int Tile)
@@ -167,6 +165,12 @@ void CDummyBase::AvoidTile(int Tile)
 
 void CDummyBase::AvoidFreeze()
 {
+	// AvoidTile() probes at most 2 tiles to the sides and the current velocity downwards,
+	// nothing to avoid if the nearest freeze tile is further away than that
+	int Reach = max(2, (int)ceil(absolute(GetVel().y))) + 1;
+	if (GameServer()->Collision()->GetFreezeDistance(GetPos()) > Reach)
+		return;
+
 	AvoidTile(TILE_FREEZE);
 	AvoidTile(TILE_DFREEZE);
 }
@@ -23,7 +23,7 @@ void CEpicCircle::Tick()
 	CCharacter *pOwner = GameServer()->GetPlayerChar(m_Owner);
 	if(!pOwner || !pOwner->m_EpicCircle)
 	{
-		Reset();
+		DeferReset();
 		return;
 	}
 
@@ -17,7 +17,9 @@ public:
 
 	virtual void Reset();
 	virtual void Tick();
+	virtual bool TickThreadSafe() { return true; }
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 };
 
 #endif // GAME_SERVER_ENTITIES_SPECIAL_EPICCIRCLE_H
@@ -130,6 +130,7 @@ void CFlag::Drop(int Dir)
 	m_LastCarrier = m_Carrier;
 	m_Carrier = -1;
 	m_Vel = vec2(5 * Dir, Dir == 0 ? 0 : -5);
+	Wake();
 	UpdateSpectators(-1);
 }
 
@@ -151,6 +152,7 @@ void CFlag::TeleToPlot(int PlotID)
 	Drop();
 	m_Vel = vec2(0, 0);
 	m_Pos = m_PrevPos = GameServer()->m_aPlots[PlotID].m_ToTele;
+	Wake();
 }
 
 void CFlag::Tick()
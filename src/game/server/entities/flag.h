@@ -54,6 +54,7 @@ public:
 	virtual void TickPaused();
 	virtual void TickDeferred();
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 	virtual void Tick();
 };
 
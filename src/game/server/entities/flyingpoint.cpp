@@ -32,7 +32,7 @@ void CFlyingPoint::Tick()
 		CCharacter *pChr = GameServer()->GetPlayerChar(m_To);
 		if (!pChr)
 		{
-			Reset();
+			DeferReset();
 			return;
 		}
 
@@ -42,7 +42,7 @@ void CFlyingPoint::Tick()
 	float Dist = distance(m_Pos, ToPos);
 	if(Dist < 24.0f)
 	{
-		Reset();
+		DeferReset();
 		return;
 	}
 
@@ -53,7 +53,7 @@ void CFlyingPoint::Tick()
 
 	if (m_PortalBlocker && GameWorld()->IntersectLinePortalBlocker(m_Pos, m_PrevPos))
 	{
-		Reset();
+		DeferReset();
 		return;
 	}
 
@@ -22,7 +22,9 @@ public:
 	
 	virtual void Reset();
 	virtual void Tick();
+	virtual bool TickThreadSafe() { return true; }
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 };
 
 #endif
\ No newline at end of file
@@ -78,6 +78,7 @@ public:
 
 	virtual void Tick();
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 	virtual void Reset();
 
 	bool Mount(int ClientID);
@@ -30,7 +30,9 @@ public:
 
 	virtual void Reset();
 	virtual void Tick();
+	virtual bool TickThreadSafe() { return true; }
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 
 private:
 	float m_PosOffsetCharPoints;
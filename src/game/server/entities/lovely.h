@@ -28,6 +28,7 @@ public:
 	virtual void Reset();
 	virtual void Tick();
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 };
 
 #endif
@@ -3,15 +3,19 @@
 #include <engine/server.h>
 #include <game/server/gamecontext.h>
 #include <game/server/teams.h>
+#include <game/server/snapgrid.h>
 #include "money.h"
 
-CMoney::CMoney(CGameWorld *pGameWorld, vec2 Pos, int64 Amount, int Owner, float Direction)
+CMoney::CMoney(CGameWorld *pGameWorld, vec2 Pos, int64 Amount, int Owner, float Direction, int JournalID)
 : CAdvancedEntity(pGameWorld, CGameWorld::ENTTYPE_MONEY, Pos, vec2(GetRadius(Amount)*2, GetRadius(Amount)*2), Owner, false)
 {
 	m_Pos = Pos;
 	m_Amount = Amount;
 	m_Vel = vec2(5*Direction, Direction == 0 ? 0 : -5);
 	m_StartTick = Server()->Tick();
+	m_pClosestChr = 0;
+	m_pClosestMoney = 0;
+	m_JournalID = JournalID == -1 ? GameServer()->m_MoneyJournal.Create(m_Pos, m_Amount) : JournalID;
 	
 	m_Snap.m_Pos = m_Pos;
 	m_Snap.m_Time = 0.f;
@@ -29,6 +33,12 @@ CMoney::~CMoney()
 		Server()->SnapFreeID(m_aID[i]);
 }
 
+void CMoney::Reset()
+{
+	GameServer()->m_MoneyJournal.Remove(m_JournalID);
+	CAdvancedEntity::Reset();
+}
+
 bool CMoney::SecondsPassed(float Seconds)
 {
 	return m_StartTick < (Server()->Tick() - Server()->TickSpeed() * Seconds);
@@ -50,7 +60,7 @@ void CMoney::Tick()
 
 	m_Gravity = true;
 
-	CCharacter *pClosest = GameWorld()->ClosestCharacter(m_Pos, RADIUS_FIND_PLAYERS, SecondsPassed(2) ? 0 : GetOwner(), m_Owner, true, true);
+	CCharacter *pClosest = m_pClosestChr;
 	if (pClosest)
 	{
 		if (distance(m_Pos, pClosest->GetPos()) < GetRadius() + pClosest->GetProximityRadius())
@@ -70,23 +80,85 @@ void CMoney::Tick()
 		else
 			MoveTo(pClosest->GetPos(), RADIUS_FIND_PLAYERS);
 	}
+	else if (m_pClosestMoney)
+		MoveTo(m_pClosestMoney->GetPos(), RADIUS_FIND_MONEY);
 
-	CMoney *pMoney = (CMoney *)GameWorld()->ClosestEntity(m_Pos, RADIUS_FIND_MONEY, CGameWorld::ENTTYPE_MONEY, this, true);
-	if (pMoney)
+	// the position is only worth journaling once it came to rest
+	bool WasSleeping = m_Sleeping;
+	HandleDropped();
+	if (m_Sleeping && !WasSleeping)
+		GameServer()->m_MoneyJournal.Move(m_JournalID, m_Pos);
+
+	m_PrevPos = m_Pos;
+}
+
+void CMoney::FindClosest(const CSnapGrid *pGrid, std::vector<CEntity *> *pvpNearby)
+{
+	// the query only has to find the cells, the proximity radius of drops and characters is covered by the margin
+	const float Margin = 32.f;
+
+	// merge every drop that touches this one, the closest of the others draws it in. a sleeping drop had nothing
+	// in reach when it fell asleep and drops flying by merge into it themselves, so it only looks again once a
+	// second in case a door opened, spread over the ticks by id
+	m_pClosestMoney = 0;
+	float ClosestRange = RADIUS_FIND_MONEY * 2;
+	bool Merged = false;
+	pvpNearby->clear();
+	if (!m_Sleeping || (Server()->Tick() + GetID()) % Server()->TickSpeed() == 0)
+		pGrid->Query(CGameWorld::ENTTYPE_MONEY, m_Pos, vec2(RADIUS_FIND_MONEY + Margin, RADIUS_FIND_MONEY + Margin), pvpNearby);
+	for (unsigned i = 0; i < pvpNearby->size(); i++)
 	{
-		if (distance(m_Pos, pMoney->GetPos()) < GetRadius() + pMoney->GetRadius())
+		CMoney *pMoney = (CMoney *)(*pvpNearby)[i];
+		if (pMoney == this || pMoney->IsMarkedForDestroy())
+			continue;
+
+		float Len = distance(m_Pos, pMoney->m_Pos);
+		if (Len >= pMoney->GetProximityRadius() + RADIUS_FIND_MONEY)
+			continue;
+
+		bool Touching = Len < GetRadius() + pMoney->GetRadius();
+		if (!Touching && Len >= ClosestRange)
+			continue;
+		if (GameServer()->Collision()->IntersectLine(m_Pos, pMoney->m_Pos, 0, 0))
+			continue;
+
+		if (Touching)
 		{
 			m_Amount += pMoney->m_Amount;
+			GameServer()->m_MoneyJournal.Merge(m_JournalID, pMoney->m_JournalID, m_Amount);
 			pMoney->Reset();
-			GameServer()->CreateDeath(m_Pos, m_Owner, m_TeamMask);
+			Merged = true;
+		}
+		else
+		{
+			ClosestRange = Len;
+			m_pClosestMoney = pMoney;
 		}
-		else if (!pClosest)
-			MoveTo(pMoney->GetPos(), RADIUS_FIND_MONEY);
 	}
-
-	HandleDropped();
-
-	m_PrevPos = m_Pos;
+	if (Merged)
+		GameServer()->CreateDeath(m_Pos, m_Owner, m_TeamMask);
+
+	// same rules as CGameWorld::ClosestCharacter(), the owner can't pick it up again right away
+	m_pClosestChr = 0;
+	ClosestRange = RADIUS_FIND_PLAYERS * 2;
+	CCharacter *pNotThis = SecondsPassed(2) ? 0 : GetOwner();
+	pvpNearby->clear();
+	pGrid->Query(CGameWorld::ENTTYPE_CHARACTER, m_Pos, vec2(RADIUS_FIND_PLAYERS + Margin, RADIUS_FIND_PLAYERS + Margin), pvpNearby);
+	for (unsigned i = 0; i < pvpNearby->size(); i++)
+	{
+		CCharacter *pChr = (CCharacter *)(*pvpNearby)[i];
+		if (pChr == pNotThis || (m_Owner != -1 && !pChr->CanCollide(m_Owner, true)))
+			continue;
+
+		float Len = distance(m_Pos, pChr->GetPos());
+		if (Len >= pChr->GetProximityRadius() + RADIUS_FIND_PLAYERS || Len >= ClosestRange)
+			continue;
+		if (GameServer()->Collision()->IntersectLine(m_Pos, pChr->GetPos(), 0, 0))
+			continue;
+
+		ClosestRange = Len;
+		m_pClosestChr = pChr;
+	}
 }
 
 void CMoney::MoveTo(vec2 Pos, int Radius)
@@ -5,6 +5,10 @@
 
 #include "advanced_entity.h"
 
+#include <vector>
+
+class CSnapGrid;
+
 enum
 {
 	NUM_DOTS_SMALL = 4,
@@ -32,6 +36,12 @@ private:
 	int64 m_StartTick;
 	int m_aID[NUM_DOTS_BIG];
 
+	// found by FindClosest() right before the drops tick
+	CCharacter *m_pClosestChr;
+	CMoney *m_pClosestMoney;
+
+	int m_JournalID;
+
 	bool SecondsPassed(float Seconds);
 	void MoveTo(vec2 Pos, int Radius);
 	int GetRadius() { return GetRadius(m_Amount); }
@@ -39,12 +49,17 @@ private:
 	int GetNumDots() { return (m_Amount < SMALL_MONEY_AMOUNT) ? NUM_DOTS_SMALL : NUM_DOTS_BIG; }
 
 public:
-	CMoney(CGameWorld *pGameWorld, vec2 Pos, int64 Amount, int Owner = -1, float Direction = 0);
+	// JournalID is only set for drops loaded from the journal, new ones get journaled
+	CMoney(CGameWorld *pGameWorld, vec2 Pos, int64 Amount, int Owner = -1, float Direction = 0, int JournalID = -1);
 	virtual ~CMoney();
 
 	int GetAmount() { return m_Amount; }
+	int GetJournalID() { return m_JournalID; }
+	void FindClosest(const CSnapGrid *pGrid, std::vector<CEntity *> *pvpNearby);
+	virtual void Reset();
 	virtual void Tick();
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 };
 
 #endif // GAME_SERVER_ENTITIES_MONEY_H
@@ -19,6 +19,7 @@ public:
 	virtual void Tick();
 	virtual void TickPaused();
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 
 	int GetType() { return m_Type; }
 	int GetSubtype() { return m_Subtype; }
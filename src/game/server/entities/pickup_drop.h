@@ -15,6 +15,7 @@ public:
 	virtual void Reset() { Reset(false); }
 	virtual void Tick();
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 
 private:
 	static int const ms_PhysSize = 14;
@@ -34,6 +34,7 @@ public:
 	virtual void Reset();
 	virtual void Tick();
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 
 	void SetThroughPlotDoor(int PlotID) { m_ThroughPlotDoor = PlotID; }
 	int GetThroughPlotDoor() { return m_ThroughPlotDoor; }
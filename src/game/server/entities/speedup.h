@@ -40,6 +40,7 @@ public:
 	virtual void ResetCollision(bool Remove = false);
 	virtual void Tick();
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 
 	void SetAngle(int Angle);
 	int GetAngle() { return m_Angle; }
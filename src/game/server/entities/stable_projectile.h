@@ -24,6 +24,7 @@ public:
 	virtual void Reset();
 	virtual void TickDeferred();
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 
 	void SetPos(vec2 Pos) { m_Pos = Pos; };
 };
@@ -31,6 +31,7 @@ public:
 	virtual ~CTeleporter();
 	virtual void ResetCollision(bool Remove = false);
 	virtual void Snap(int SnappingClient);
+	virtual bool SnapClippedByPos() { return true; }
 	int GetType() { return m_Type; }
 };
 
@@ -18,6 +18,7 @@ CEntity::CEntity(CGameWorld *pGameWorld, int ObjType, vec2 Pos, int ProximityRad
 	m_ProximityRadius = ProximityRadius;
 
 	m_MarkedForDestroy = false;
+	m_ResetDeferred = false;
 	m_Pos = Pos;
 
 	// F-DDrace
@@ -43,17 +44,17 @@ int CEntity::NetworkClipped(int SnappingClient, vec2 CheckPos, bool CheckShowAll
 	if (SnappingClient == -1 || (CheckShowAll && GameServer()->m_apPlayers[SnappingClient]->m_ShowAll))
 		return 0;
 
-	// Border to also receive objects a bit off the screen so they dont pop up, 10 blocks should be okay
-	float Border = 32.f * 10.f;
-	vec2 ShowDistance = GameServer()->m_apPlayers[SnappingClient]->m_ShowDistance;
+	float Border = NETWORK_CLIP_BORDER;
+	CPlayer *pPlayer = GameServer()->m_apPlayers[SnappingClient];
+	vec2 ShowDistance = pPlayer->m_ShowDistance;
 	if (m_PlotID >= PLOT_START || DefaultRange)
-		ShowDistance = GameServer()->m_apPlayers[SnappingClient]->m_StandardShowDistance;
+		ShowDistance = pPlayer->m_StandardShowDistance;
 
-	float dx = GameServer()->m_apPlayers[SnappingClient]->m_ViewPos.x-CheckPos.x;
+	float dx = pPlayer->m_ViewPos.x-CheckPos.x;
 	if(absolute(dx) > ShowDistance.x/2.f + Border)
 		return 1;
 
-	float dy = GameServer()->m_apPlayers[SnappingClient]->m_ViewPos.y-CheckPos.y;
+	float dy = pPlayer->m_ViewPos.y-CheckPos.y;
 	if(absolute(dy) > ShowDistance.y/2.f + Border)
 		return 1;
 
@@ -37,6 +37,7 @@ private:
 
 	/* State */
 	bool m_MarkedForDestroy;
+	bool m_ResetDeferred;
 
 protected:
 	/* State */
@@ -50,6 +51,13 @@ protected:
 	/* Getters */
 	int GetID() const					{ return m_ID; }
 
+	/*
+		Function: DeferReset
+			Requests Reset() to be called once all thread safe ticks are done.
+			Use this instead of Reset() inside of a thread safe Tick().
+	*/
+	void DeferReset()					{ m_ResetDeferred = true; }
+
 public:
 	/* Constructor */
 	CEntity(CGameWorld *pGameWorld, int Objtype, vec2 Pos, int ProximityRadius = 0, bool Collision = true);
@@ -107,6 +115,14 @@ public:
 	*/
 	virtual void TickPaused() {}
 
+	/*
+		Function: TickThreadSafe
+			Whether Tick() can run on a worker thread next to other thread safe
+			entities. Such a Tick() may only read the world and change the entity
+			itself, everything else has to go through DeferReset().
+	*/
+	virtual bool TickThreadSafe() { return false; }
+
 	/*
 		Function: Snap
 			Called when a new snapshot is being generated for a specific
@@ -120,8 +136,22 @@ public:
 	*/
 	virtual void Snap(int SnappingClient) {}
 
+	/*
+		Function: SnapClippedByPos
+			Whether Snap() returns right away when NetworkClipped(SnappingClient)
+			is set. The world only snaps such entities for clients whose view
+			rectangle contains m_Pos.
+	*/
+	virtual bool SnapClippedByPos() { return false; }
+
 	virtual void PostSnap() {}
 
+	enum
+	{
+		// border to also receive objects a bit off the screen so they dont pop up, 10 blocks should be okay
+		NETWORK_CLIP_BORDER = 32 * 10,
+	};
+
 	/*
 		Function: networkclipped(int snapping_client)
 			Performs a series of test to see if a client can see the
@@ -72,6 +72,7 @@ void CGameContext::Construct(int Resetting)
 	m_NumVoteOptions = 0;
 	m_LastMapVote = 0;
 	m_LockTeams = 0;
+	VoteCountReset();
 
 	if(Resetting==NO_RESET)
 	{
@@ -930,6 +931,7 @@ void CGameContext::StartVote(const char *pDesc, const char *pCommand, const char
 			m_apPlayers[i]->m_VotePos = 0;
 		}
 	}
+	VoteCountResetVotes();
 
 	// start vote
 	m_VoteCloseTime = time_get() + time_freq()*VOTE_TIME;
@@ -1073,6 +1075,171 @@ void CGameContext::AbortVoteOnTeamChange(int ClientID)
 		m_VoteCloseTime = -1;
 }
 
+unsigned CGameContext::VoteAddrHash(const NETADDR *pAddr)
+{
+	unsigned Hash = 2166136261u^pAddr->type;
+	for(int i = 0; i < (int)sizeof(pAddr->ip); i++)
+		Hash = (Hash^pAddr->ip[i])*16777619u;
+	return Hash;
+}
+
+void CGameContext::VoteCountApply(int Index, int Sign)
+{
+	CVoteAddr *pVoteAddr = &m_aVoteAddrs[Index];
+	if(pVoteAddr->m_NumPlayers <= 0)
+		return;
+
+	m_VoteTotal += Sign;
+	if(pVoteAddr->m_Vote > 0)
+		m_VoteYes += Sign;
+	else if(pVoteAddr->m_Vote < 0)
+		m_VoteNo += Sign;
+}
+
+void CGameContext::VoteCountReset()
+{
+	mem_zero(m_aVoteAddrs, sizeof(m_aVoteAddrs));
+	for(int i = 0; i < MAX_CLIENTS*2; i++)
+		m_aVoteAddrHash[i] = -1;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		m_aVoteAddrIndex[i] = -1;
+		m_aVoteCountPlayer[i] = false;
+	}
+	m_VoteTotal = 0;
+	m_VoteYes = 0;
+	m_VoteNo = 0;
+}
+
+void CGameContext::VoteCountAddClient(int ClientID)
+{
+	if(m_aVoteAddrIndex[ClientID] != -1)
+		VoteCountRemoveClient(ClientID);
+
+	NETADDR Addr;
+	mem_zero(&Addr, sizeof(Addr));
+	Server()->GetClientAddr(ClientID, &Addr);
+	Addr.port = 0;
+
+	unsigned Hash = VoteAddrHash(&Addr)%(MAX_CLIENTS*2);
+	int Index = m_aVoteAddrHash[Hash];
+	while(Index != -1 && net_addr_comp(&m_aVoteAddrs[Index].m_Addr, &Addr, false) != 0)
+		Index = m_aVoteAddrs[Index].m_HashNext;
+
+	if(Index == -1)
+	{
+		// there are never more addresses than clients, so a free entry always exists
+		for(Index = 0; Index < MAX_CLIENTS; Index++)
+			if(m_aVoteAddrs[Index].m_NumClients == 0)
+				break;
+
+		mem_zero(&m_aVoteAddrs[Index], sizeof(m_aVoteAddrs[Index]));
+		m_aVoteAddrs[Index].m_Addr = Addr;
+		m_aVoteAddrs[Index].m_HashNext = m_aVoteAddrHash[Hash];
+		m_aVoteAddrHash[Hash] = Index;
+	}
+
+	CVoteAddr *pVoteAddr = &m_aVoteAddrs[Index];
+	CPlayer *pPlayer = m_apPlayers[ClientID];
+	VoteCountApply(Index, -1);
+	pVoteAddr->m_NumClients++;
+	m_aVoteCountPlayer[ClientID] = pPlayer->GetTeam() != TEAM_SPECTATORS;
+	if(m_aVoteCountPlayer[ClientID])
+		pVoteAddr->m_NumPlayers++;
+	if(pPlayer->m_Vote && (!pVoteAddr->m_Vote || pPlayer->m_VotePos < pVoteAddr->m_VotePos))
+	{
+		pVoteAddr->m_Vote = pPlayer->m_Vote;
+		pVoteAddr->m_VotePos = pPlayer->m_VotePos;
+	}
+	VoteCountApply(Index, 1);
+	m_aVoteAddrIndex[ClientID] = Index;
+}
+
+void CGameContext::VoteCountRemoveClient(int ClientID)
+{
+	int Index = m_aVoteAddrIndex[ClientID];
+	if(Index == -1)
+		return;
+
+	CVoteAddr *pVoteAddr = &m_aVoteAddrs[Index];
+	CPlayer *pPlayer = m_apPlayers[ClientID];
+	m_aVoteAddrIndex[ClientID] = -1;
+	VoteCountApply(Index, -1);
+	pVoteAddr->m_NumClients--;
+	if(m_aVoteCountPlayer[ClientID])
+		pVoteAddr->m_NumPlayers--;
+	m_aVoteCountPlayer[ClientID] = false;
+
+	if(pVoteAddr->m_NumClients == 0)
+	{
+		int *pIndex = &m_aVoteAddrHash[VoteAddrHash(&pVoteAddr->m_Addr)%(MAX_CLIENTS*2)];
+		while(*pIndex != Index)
+			pIndex = &m_aVoteAddrs[*pIndex].m_HashNext;
+		*pIndex = pVoteAddr->m_HashNext;
+		return;
+	}
+
+	// the vote of this address was ours, fall back to the next earliest vote
+	if(pVoteAddr->m_Vote && pPlayer && pPlayer->m_Vote && pPlayer->m_VotePos == pVoteAddr->m_VotePos)
+	{
+		pVoteAddr->m_Vote = 0;
+		pVoteAddr->m_VotePos = 0;
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(m_aVoteAddrIndex[i] != Index || !m_apPlayers[i] || !m_apPlayers[i]->m_Vote)
+				continue;
+			if(!pVoteAddr->m_Vote || m_apPlayers[i]->m_VotePos < pVoteAddr->m_VotePos)
+			{
+				pVoteAddr->m_Vote = m_apPlayers[i]->m_Vote;
+				pVoteAddr->m_VotePos = m_apPlayers[i]->m_VotePos;
+			}
+		}
+	}
+	VoteCountApply(Index, 1);
+}
+
+void CGameContext::VoteCountUpdateTeam(int ClientID)
+{
+	int Index = m_aVoteAddrIndex[ClientID];
+	bool Player = m_apPlayers[ClientID]->GetTeam() != TEAM_SPECTATORS;
+	if(Index == -1 || m_aVoteCountPlayer[ClientID] == Player)
+		return;
+
+	VoteCountApply(Index, -1);
+	m_aVoteAddrs[Index].m_NumPlayers += Player ? 1 : -1;
+	m_aVoteCountPlayer[ClientID] = Player;
+	VoteCountApply(Index, 1);
+	m_VoteUpdate = true;
+}
+
+void CGameContext::VoteCountAddVote(int ClientID)
+{
+	int Index = m_aVoteAddrIndex[ClientID];
+	CPlayer *pPlayer = m_apPlayers[ClientID];
+	if(Index == -1 || !pPlayer->m_Vote)
+		return;
+
+	CVoteAddr *pVoteAddr = &m_aVoteAddrs[Index];
+	if(pVoteAddr->m_Vote && pVoteAddr->m_VotePos < pPlayer->m_VotePos)
+		return;
+
+	VoteCountApply(Index, -1);
+	pVoteAddr->m_Vote = pPlayer->m_Vote;
+	pVoteAddr->m_VotePos = pPlayer->m_VotePos;
+	VoteCountApply(Index, 1);
+}
+
+void CGameContext::VoteCountResetVotes()
+{
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		m_aVoteAddrs[i].m_Vote = 0;
+		m_aVoteAddrs[i].m_VotePos = 0;
+	}
+	m_VoteYes = 0;
+	m_VoteNo = 0;
+}
+
 void CGameContext::SendTuningParams(int ClientID, int Zone)
 {
 	if (ClientID == -1)
@@ -1219,8 +1386,8 @@ void CGameContext::OnTick()
 			m_apPlayers[i]->PostTick();
 
 			// F-DDrace
-			for (int j = 0; j < NUM_HOUSES; j++)
-				m_pHouses[j]->Tick(i);
+			if (m_apPlayers[i]->GetCurrentHouse())
+				m_apPlayers[i]->GetCurrentHouse()->Tick(i);
 		}
 	}
 
@@ -1241,44 +1408,8 @@ void CGameContext::OnTick()
 		}
 		else
 		{
-			int Total = 0, Yes = 0, No = 0;
-			if(m_VoteUpdate)
-			{
-				// count votes
-				char aaBuf[MAX_CLIENTS][NETADDR_MAXSTRSIZE] = {{0}};
-				for(int i = 0; i < MAX_CLIENTS; i++)
-					if(m_apPlayers[i])
-						Server()->GetClientAddr(i, aaBuf[i], NETADDR_MAXSTRSIZE);
-				bool aVoteChecked[MAX_CLIENTS] = {0};
-				for(int i = 0; i < MAX_CLIENTS; i++)
-				{
-					if(!m_apPlayers[i] || m_apPlayers[i]->GetTeam() == TEAM_SPECTATORS || aVoteChecked[i])	// don't count in votes by spectators
-						continue;
-
-					int ActVote = m_apPlayers[i]->m_Vote;
-					int ActVotePos = m_apPlayers[i]->m_VotePos;
-
-					// check for more players with the same ip (only use the vote of the one who voted first)
-					for(int j = i+1; j < MAX_CLIENTS; ++j)
-					{
-						if(!m_apPlayers[j] || aVoteChecked[j] || str_comp(aaBuf[j], aaBuf[i]))
-							continue;
-
-						aVoteChecked[j] = true;
-						if(m_apPlayers[j]->m_Vote && (!ActVote || ActVotePos > m_apPlayers[j]->m_VotePos))
-						{
-							ActVote = m_apPlayers[j]->m_Vote;
-							ActVotePos = m_apPlayers[j]->m_VotePos;
-						}
-					}
-
-					Total++;
-					if(ActVote > 0)
-						Yes++;
-					else if(ActVote < 0)
-						No++;
-				}
-			}
+			// votes are counted as they come in, see VoteCountAddVote
+			int Total = m_VoteTotal, Yes = m_VoteYes, No = m_VoteNo;
 
 			if(m_VoteEnforce == VOTE_ENFORCE_YES || (m_VoteUpdate && Yes >= Total/2+1))
 			{
@@ -1338,34 +1469,7 @@ void CGameContext::OnTick()
 			SendChat(-1, CHAT_ALL, -1, Line, -1, CHAT_SEVEN|CHAT_SEVENDOWN|CHAT_NO_WEBHOOK);
 	}
 
-	if (Collision()->GetNumAllSwitchers() > 0)
-		for (int i = 0; i < Collision()->GetNumAllSwitchers() + 1; ++i)
-		{
-			for (int j = 0; j < VANILLA_MAX_CLIENTS; ++j)
-			{
-				// F-DDrace
-				// set current switcher client id to -1 if the player doesnt exist OR it is a non-timed switch and the player is not on the switch anymore
-				if ((Collision()->m_pSwitchers[i].m_ClientID[j] != -1 && !m_apPlayers[Collision()->m_pSwitchers[i].m_ClientID[j]])
-					|| (Collision()->m_pSwitchers[i].m_StartTick[j] < Server()->Tick() && Collision()->m_pSwitchers[i].m_EndTick[j] == 0))
-					Collision()->m_pSwitchers[i].m_ClientID[j] = -1;
-
-				// if it is a timed switch, the client id will be reset after the time is over here
-				if (Collision()->m_pSwitchers[i].m_EndTick[j] <= Server()->Tick() && Collision()->m_pSwitchers[i].m_Type[j] == TILE_SWITCHTIMEDOPEN)
-				{
-					Collision()->m_pSwitchers[i].m_Status[j] = false;
-					Collision()->m_pSwitchers[i].m_EndTick[j] = 0;
-					Collision()->m_pSwitchers[i].m_Type[j] = TILE_SWITCHCLOSE;
-					Collision()->m_pSwitchers[i].m_ClientID[j] = -1;
-				}
-				else if (Collision()->m_pSwitchers[i].m_EndTick[j] <= Server()->Tick() && Collision()->m_pSwitchers[i].m_Type[j] == TILE_SWITCHTIMEDCLOSE)
-				{
-					Collision()->m_pSwitchers[i].m_Status[j] = true;
-					Collision()->m_pSwitchers[i].m_EndTick[j] = 0;
-					Collision()->m_pSwitchers[i].m_Type[j] = TILE_SWITCHOPEN;
-					Collision()->m_pSwitchers[i].m_ClientID[j] = -1;
-				}
-			}
-		}
+	UpdateSwitchers();
 
 	if (m_pRandomMapResult && m_pRandomMapResult->m_Done)
 	{
@@ -1399,9 +1503,10 @@ void CGameContext::OnTick()
 			WriteAccountStats(i);
 		for (int i = 0; i < Collision()->m_NumPlots + 1; i++)
 			WritePlotStats(i);
-		WriteMoneyListFile();
 		m_LastDataSaveTick = Server()->Tick();
 	}
+	m_MoneyJournal.Update();
+	m_WhoIs.Tick();
 
 	// minigames
 	if (!m_aMinigameDisabled[MINIGAME_SURVIVAL])
@@ -1572,6 +1677,7 @@ void CGameContext::OnClientEnter(int ClientID)
 		m_apPlayers[ClientID]->m_Score = !Score()->PlayerData(ClientID)->m_BestTime ? -1 : Score()->PlayerData(ClientID)->m_BestTime;
 	}
 
+	VoteCountAddClient(ClientID);
 	m_VoteUpdate = true;
 
 	if(Server()->DemoRecorder_IsRecording())
@@ -1709,6 +1815,10 @@ void CGameContext::OnClientConnected(int ClientID, bool Dummy, bool AsSpec)
 
 	m_apPlayers[ClientID] = new(ClientID) CPlayer(this, ClientID, Dummy, AsSpec);
 
+	NETADDR Addr;
+	Server()->GetClientAddr(ClientID, &Addr);
+	m_World.OnClientConnected(ClientID, &Addr);
+
 	Server()->ExpireServerInfo();
 
 	if (Dummy)
@@ -1720,6 +1830,7 @@ void CGameContext::OnClientConnected(int ClientID, bool Dummy, bool AsSpec)
 
 void CGameContext::OnClientTeamChange(int ClientID)
 {
+	VoteCountUpdateTeam(ClientID);
 	if(m_apPlayers[ClientID]->GetTeam() == TEAM_SPECTATORS)
 		AbortVoteOnTeamChange(ClientID);
 }
@@ -1762,8 +1873,24 @@ void CGameContext::OnClientDrop(int ClientID, const char *pReason)
 		}
 	}
 
+	VoteCountRemoveClient(ClientID);
 	delete m_apPlayers[ClientID];
 	m_apPlayers[ClientID] = 0;
+	m_World.OnClientDropped(ClientID);
+	m_World.MarkPlayerMapDirty();
+
+	// only switches that are still waiting to forget their player can have one set
+	if (Collision()->m_pSwitchers)
+	{
+		const std::vector<CSwitchTracker::CSwitch> *apLists[] = { &m_SwitchTracker.Activations(), &m_SwitchTracker.Timeouts() };
+		for (int l = 0; l < 2; l++)
+			for (unsigned i = 0; i < apLists[l]->size(); i++)
+			{
+				CCollision::SSwitchers *pSwitcher = &Collision()->m_pSwitchers[(*apLists[l])[i].m_Number];
+				if (pSwitcher->m_ClientID[(*apLists[l])[i].m_Team] == ClientID)
+					pSwitcher->m_ClientID[(*apLists[l])[i].m_Team] = -1;
+			}
+	}
 
 	m_VoteUpdate = true;
 
@@ -2580,6 +2707,7 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 
 					pPlayer->m_Vote = pMsg->m_Vote;
 					pPlayer->m_VotePos = ++m_VotePos;
+					VoteCountAddVote(ClientID);
 					m_VoteUpdate = true;
 				}
 				else if(m_VoteCreator == pPlayer->GetCID())
@@ -2607,17 +2735,9 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 				}
 				else if (pChr)
 				{
-					bool InHouse = false;
-					for (int i = 0; i < NUM_HOUSES; i++)
-					{
-						if (m_pHouses[i]->IsInside(ClientID))
-						{
-							m_pHouses[i]->OnKeyPress(ClientID, pMsg->m_Vote);
-							InHouse = true;
-						}
-					}
-					
-					if (!InHouse)
+					if (pPlayer->GetCurrentHouse())
+						pPlayer->GetCurrentHouse()->OnKeyPress(ClientID, pMsg->m_Vote);
+					else
 						pChr->DropFlag();
 				}
 			}
@@ -2630,17 +2750,9 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 				}
 				else if (pChr)
 				{
-					bool InHouse = false;
-					for (int i = 0; i < NUM_HOUSES; i++)
-					{
-						if (m_pHouses[i]->IsInside(ClientID))
-						{
-							m_pHouses[i]->OnKeyPress(ClientID, pMsg->m_Vote);
-							InHouse = true;
-						}
-					}
-
-					if (!InHouse)
+					if (pPlayer->GetCurrentHouse())
+						pPlayer->GetCurrentHouse()->OnKeyPress(ClientID, pMsg->m_Vote);
+					else
 					{
 						if (pChr->m_pHelicopter)
 						{
@@ -4085,6 +4197,7 @@ void CGameContext::FDDraceInitPreMapInit()
 		m_aPlots[i].m_ToTele = vec2(-1, -1);
 		m_aPlots[i].m_vObjects.clear();
 	}
+	m_PlotOwnerIndex.Clear();
 }
 
 void CGameContext::FDDraceInit()
@@ -4099,6 +4212,7 @@ void CGameContext::FDDraceInit()
 	for (int i = 0; i < Collision()->m_NumPlots + 1; i++)
 			ReadPlotStats(i);
 	ExpirePlots();
+	InitPlotOwnerIndex();
 
 	if (Config()->m_SvBansFile[0])
 		Console()->ExecuteFile(Config()->m_SvBansFile);
@@ -4346,7 +4460,7 @@ void CGameContext::OnPreShutdown()
 	LogoutAllAccounts();
 	for (int i = 0; i < Collision()->m_NumPlots + 1; i++)
 		WritePlotStats(i);
-	WriteMoneyListFile();
+	CloseMoneyJournal();
 
 	if (Config()->m_SvBansFile[0])
 	{
@@ -4854,6 +4968,7 @@ void CGameContext::CallVote(int ClientID, const char *pDesc, const char *pCmd, c
 	StartVote(pDesc, pCmd, pReason, pSevendownDesc);
 	pPlayer->m_Vote = 1;
 	pPlayer->m_VotePos = m_VotePos = 1;
+	VoteCountAddVote(ClientID);
 	pPlayer->m_LastVoteCall = Now;
 }
 
@@ -4879,139 +4994,137 @@ void CGameContext::ConRandomUnfinishedMap(IConsole::IResult *pResult, void *pUse
 
 void CGameContext::ReadPlotStats(int ID)
 {
-	std::string data;
 	char aBuf[128];
 	str_format(aBuf, sizeof(aBuf), "%s/%s/%d.plot", Config()->m_SvPlotFilePath, Server()->GetCurrentMapName(), ID);
-	std::fstream PlotFile(aBuf);
-	if (!PlotFile.is_open())
+
+	CPlotFile::CInfo Info;
+	std::vector<CPlotFile::CObject> vObjects;
+	int Result = CPlotFile::Load(aBuf, &Info, &vObjects);
+	if (Result == CPlotFile::LOAD_FAILED)
 		return;
 
-	for (int i = 0; i < NUM_PLOT_VARIABLES; i++)
-	{
-		getline(PlotFile, data);
-		const char *pData = data.c_str();
+	str_copy(m_aPlots[ID].m_aOwner, Info.m_aOwner, sizeof(m_aPlots[ID].m_aOwner));
+	str_copy(m_aPlots[ID].m_aDisplayName, Info.m_aDisplayName, sizeof(m_aPlots[ID].m_aDisplayName));
+	m_aPlots[ID].m_ExpireDate = Info.m_ExpireDate;
+	SetPlotDoorStatus(ID, Info.m_DoorStatus);
 
-		switch (i)
-		{
-		case PLOT_OWNER_ACC_USERNAME:		str_copy(m_aPlots[ID].m_aOwner, pData, sizeof(m_aPlots[ID].m_aOwner)); break;
-		case PLOT_DISPLAY_NAME:				str_copy(m_aPlots[ID].m_aDisplayName, pData, sizeof(m_aPlots[ID].m_aDisplayName)); break;
-		case PLOT_EXPIRE_DATE:				m_aPlots[ID].m_ExpireDate = atoi(pData); break;
-		case PLOT_DOOR_STATUS:				SetPlotDoorStatus(ID, atoi(pData)); break;
-		case PLOT_OBJECTS:
-		{
-			std::vector<CEntity *> vEntities = ReadPlotObjects(pData, ID);
-			for (unsigned int j = 0; j < vEntities.size(); j++)
-			{
-				vEntities[j]->m_PlotID = ID;
-				m_aPlots[ID].m_vObjects.push_back(vEntities[j]);
-			}
-		} break;
-		}
+	std::vector<CEntity *> vEntities = CreatePlotObjects(vObjects, ID);
+	for (unsigned int j = 0; j < vEntities.size(); j++)
+	{
+		vEntities[j]->m_PlotID = ID;
+		m_aPlots[ID].m_vObjects.push_back(vEntities[j]);
 	}
+
+	// one time migration of the old text format
+	if (Result == CPlotFile::LOAD_TEXT)
+		WritePlotStats(ID);
 }
 
 void CGameContext::WritePlotStats(int ID)
 {
 	char aBuf[128];
 	str_format(aBuf, sizeof(aBuf), "%s/%s/%d.plot", Config()->m_SvPlotFilePath, Server()->GetCurrentMapName(), ID);
-	std::ofstream PlotFile(aBuf);
 
-	if (PlotFile.is_open())
-	{
-		int PlotDoorStatus = Collision()->m_pSwitchers ? Collision()->m_pSwitchers[Collision()->GetSwitchByPlot(ID)].m_Status[0] : 0;
-		PlotFile << m_aPlots[ID].m_aOwner << "\n";
-		PlotFile << m_aPlots[ID].m_aDisplayName << "\n";
-		PlotFile << m_aPlots[ID].m_ExpireDate << "\n";
-		PlotFile << PlotDoorStatus << "\n";
-		
-		for (unsigned int i = 0; i < m_aPlots[ID].m_vObjects.size(); i++)
-			WritePlotObject(m_aPlots[ID].m_vObjects[i], &PlotFile);
+	CPlotFile::CInfo Info;
+	str_copy(Info.m_aOwner, m_aPlots[ID].m_aOwner, sizeof(Info.m_aOwner));
+	str_copy(Info.m_aDisplayName, m_aPlots[ID].m_aDisplayName, sizeof(Info.m_aDisplayName));
+	Info.m_ExpireDate = m_aPlots[ID].m_ExpireDate;
+	Info.m_DoorStatus = Collision()->m_pSwitchers ? Collision()->m_pSwitchers[Collision()->GetSwitchByPlot(ID)].m_Status[0] : 0;
 
-		PlotFile << "\n";
+	std::vector<CPlotFile::CObject> vObjects;
+	for (unsigned int i = 0; i < m_aPlots[ID].m_vObjects.size(); i++)
+	{
+		CPlotFile::CObject Obj;
+		if (GetPlotObject(m_aPlots[ID].m_vObjects[i], &Obj))
+			vObjects.push_back(Obj);
 	}
+
+	CPlotFile::Save(aBuf, &Info, vObjects);
 }
 
-void CGameContext::WritePlotObject(CEntity *pEntity, std::ofstream *pFile, vec2 *pPos)
+bool CGameContext::GetPlotObject(CEntity *pEntity, CPlotFile::CObject *pObj, vec2 *pPos)
 {
-	vec2 Pos = pPos ? *pPos : pEntity->GetPos();
-	char aEntry[128];
+	mem_zero(pObj, sizeof(*pObj));
+	pObj->m_Type = pEntity->GetObjType();
+	pObj->m_Pos = pPos ? *pPos : pEntity->GetPos();
+	int *pArgs = pObj->m_aArgs;
 	switch (pEntity->GetObjType())
 	{
 		case CGameWorld::ENTTYPE_PICKUP:
 		{
 			CPickup *pPickup = (CPickup *)pEntity;
-			str_format(aEntry, sizeof(aEntry), "%d:%.2f/%.2f:%d:%d,", CGameWorld::ENTTYPE_PICKUP, Pos.x/32.f, Pos.y/32.f, pPickup->GetType(), pPickup->GetSubtype());
-			*pFile << aEntry;
-			break;
+			pArgs[0] = pPickup->GetType();
+			pArgs[1] = pPickup->GetSubtype();
+			return true;
 		}
 		case CGameWorld::ENTTYPE_DOOR:
 		{
 			CDoor *pDoor = (CDoor *)pEntity;
-			str_format(aEntry, sizeof(aEntry), "%d:%.2f/%.2f:%.2f:%d:%d:%d:%d:%d:%d,", CGameWorld::ENTTYPE_DOOR, Pos.x/32.f, Pos.y/32.f, pDoor->GetRotation(), pDoor->GetLength(), (int)pDoor->m_Collision, pDoor->GetThickness(), pDoor->m_Number, (int)Collision()->m_pSwitchers[pDoor->m_Number].m_Status[0], pDoor->GetColor());
-			*pFile << aEntry;
-			break;
+			pObj->m_Rotation = pDoor->GetRotation();
+			pArgs[0] = pDoor->GetLength();
+			pArgs[1] = (int)pDoor->m_Collision;
+			pArgs[2] = pDoor->GetThickness();
+			pArgs[3] = pDoor->m_Number;
+			pArgs[4] = (int)Collision()->m_pSwitchers[pDoor->m_Number].m_Status[0];
+			pArgs[5] = pDoor->GetColor();
+			return true;
 		}
 		case CGameWorld::ENTTYPE_BUTTON:
 		{
 			CButton *pButton = (CButton *)pEntity;
-			str_format(aEntry, sizeof(aEntry), "%d:%.2f/%.2f:%d,", CGameWorld::ENTTYPE_BUTTON, Pos.x/32.f, Pos.y/32.f, pButton->m_Number);
-			*pFile << aEntry;
-			break;
+			pArgs[0] = pButton->m_Number;
+			return true;
 		}
 		case CGameWorld::ENTTYPE_SPEEDUP:
 		{
 			CSpeedup *pSpeedup = (CSpeedup *)pEntity;
-			str_format(aEntry, sizeof(aEntry), "%d:%.2f/%.2f:%d:%d:%d,", CGameWorld::ENTTYPE_SPEEDUP, Pos.x/32.f, Pos.y/32.f, pSpeedup->GetAngle(), pSpeedup->GetForce(), pSpeedup->GetMaxSpeed());
-			*pFile << aEntry;
-			break;
+			pArgs[0] = pSpeedup->GetAngle();
+			pArgs[1] = pSpeedup->GetForce();
+			pArgs[2] = pSpeedup->GetMaxSpeed();
+			return true;
 		}
 		case CGameWorld::ENTTYPE_TELEPORTER:
 		{
 			CTeleporter *pTeleporter = (CTeleporter *)pEntity;
-			str_format(aEntry, sizeof(aEntry), "%d:%.2f/%.2f:%d:%d,", CGameWorld::ENTTYPE_TELEPORTER, Pos.x/32.f, Pos.y/32.f, pTeleporter->GetType(), pTeleporter->m_Number);
-			*pFile << aEntry;
-			break;
+			pArgs[0] = pTeleporter->GetType();
+			pArgs[1] = pTeleporter->m_Number;
+			return true;
 		}
 	}
+	return false;
 }
 
-std::vector<CEntity *> CGameContext::ReadPlotObjects(const char *pLine, int PlotID)
+std::vector<CEntity *> CGameContext::CreatePlotObjects(const std::vector<CPlotFile::CObject> &vObjects, int PlotID)
 {
-	const char *pData = pLine;
 	std::vector<CEntity *> vEntities;
 	std::vector< std::pair<int, int> > vNumbers;
-	while (1)
+	for (unsigned int o = 0; o < vObjects.size(); o++)
 	{
-		if (!pData)
-			break;
-
-		vec2 Pos = vec2(-1, -1);
-		int EntityType = -1;
+		const CPlotFile::CObject *pObj = &vObjects[o];
+		const int *pArgs = pObj->m_aArgs;
+		vec2 Pos = pObj->m_Pos;
 
-		sscanf(pData, "%d", &EntityType);
-		switch (EntityType)
+		switch (pObj->m_Type)
 		{
 			case CGameWorld::ENTTYPE_PICKUP:
 			{
-				int Type = -1;
-				int Subtype = -1;
-				sscanf(pData, "%d:%f/%f:%d:%d", &EntityType, &Pos.x, &Pos.y, &Type, &Subtype);
+				int Type = pArgs[0];
+				int Subtype = pArgs[1];
 				if (Type >= 0 && Subtype >= 0)
 				{
-					vEntities.push_back(new CPickup(&m_World, vec2(Pos.x*32.f, Pos.y*32.f), Type, Subtype));
+					vEntities.push_back(new CPickup(&m_World, Pos, Type, Subtype));
 				}
 				break;
 			}
 			case CGameWorld::ENTTYPE_DOOR:
 			{
-				float Rotation = -1.f;
-				int Length = -1;
-				int CollisionActive = -1;
-				int Thickness = -1;
-				int Number = -1;
-				int Status = -1;
-				int Color = LASERTYPE_DOOR;
-				sscanf(pData, "%d:%f/%f:%f:%d:%d:%d:%d:%d:%d", &EntityType, &Pos.x, &Pos.y, &Rotation, &Length, &CollisionActive, &Thickness, &Number, &Status, &Color);
+				float Rotation = pObj->m_Rotation;
+				int Length = pArgs[0];
+				int CollisionActive = pArgs[1];
+				int Thickness = pArgs[2];
+				int Number = pArgs[3];
+				int Status = pArgs[4];
+				int Color = pArgs[5];
 				if (Rotation >= 0 && Length >= 0 && CollisionActive >= 0 && Thickness >= 0 && Number >= 0 && Status >= 0)
 				{
 					int NewNumber = -1;
@@ -5040,14 +5153,13 @@ std::vector<CEntity *> CGameContext::ReadPlotObjects(const char *pLine, int Plot
 						}
 					}
 
-					vEntities.push_back(new CDoor(&m_World, vec2(Pos.x*32.f, Pos.y*32.f), Rotation, Length, NewNumber, CollisionActive, Thickness, Color));
+					vEntities.push_back(new CDoor(&m_World, Pos, Rotation, Length, NewNumber, CollisionActive, Thickness, Color));
 				}
 				break;
 			}
 			case CGameWorld::ENTTYPE_BUTTON:
 			{
-				int Number = -1;
-				sscanf(pData, "%d:%f/%f:%d", &EntityType, &Pos.x, &Pos.y, &Number);
+				int Number = pArgs[0];
 				if (Number >= 0)
 				{
 					int NewNumber = -1;
@@ -5067,27 +5179,25 @@ std::vector<CEntity *> CGameContext::ReadPlotObjects(const char *pLine, int Plot
 						vNumbers.push_back(Pair);
 					}
 
-					vEntities.push_back(new CButton(&m_World, vec2(Pos.x*32.f, Pos.y*32.f), NewNumber));
+					vEntities.push_back(new CButton(&m_World, Pos, NewNumber));
 				}
 				break;
 			}
 			case CGameWorld::ENTTYPE_SPEEDUP:
 			{
-				int Angle = -1;
-				int Force = -1;
-				int MaxSpeed = -1;
-				sscanf(pData, "%d:%f/%f:%d:%d:%d", &EntityType, &Pos.x, &Pos.y, &Angle, &Force, &MaxSpeed);
+				int Angle = pArgs[0];
+				int Force = pArgs[1];
+				int MaxSpeed = pArgs[2];
 				if (Angle >= 0 && Force > 0 && MaxSpeed >= 0)
 				{
-					vEntities.push_back(new CSpeedup(&m_World, vec2(Pos.x*32.f, Pos.y*32.f), Angle, Force, MaxSpeed));
+					vEntities.push_back(new CSpeedup(&m_World, Pos, Angle, Force, MaxSpeed));
 				}
 				break;
 			}
 			case CGameWorld::ENTTYPE_TELEPORTER:
 			{
-				int Type = 0;
-				int Number = -1;
-				sscanf(pData, "%d:%f/%f:%d:%d", &EntityType, &Pos.x, &Pos.y, &Type, &Number);
+				int Type = pArgs[0];
+				int Number = pArgs[1];
 				if (Type > 0 && Number >= 0)
 				{
 					int NewNumber = -1;
@@ -5107,15 +5217,11 @@ std::vector<CEntity *> CGameContext::ReadPlotObjects(const char *pLine, int Plot
 						vNumbers.push_back(Pair);
 					}
 
-					vEntities.push_back(new CTeleporter(&m_World, vec2(Pos.x*32.f, Pos.y*32.f), Type, NewNumber));
+					vEntities.push_back(new CTeleporter(&m_World, Pos, Type, NewNumber));
 				}
 				break;
 			}
 		}
-
-		// jump to next comma, if it exists skip it so we can start the next loop run with the next data
-		if ((pData = str_find(pData, ",")))
-			pData++;
 	}
 
 	return vEntities;
@@ -5162,6 +5268,7 @@ void CGameContext::SetPlotInfo(int PlotID, int AccID)
 	str_copy(m_aPlots[PlotID].m_aOwner, m_Accounts[AccID].m_Username, sizeof(m_aPlots[PlotID].m_aOwner));
 	str_copy(m_aPlots[PlotID].m_aDisplayName, m_Accounts[AccID].m_aLastPlayerName, sizeof(m_aPlots[PlotID].m_aDisplayName));
 	WritePlotStats(PlotID);
+	UpdatePlotOwnerIndex(PlotID, AccID);
 }
 
 void CGameContext::SetPlotExpire(int PlotID)
@@ -5175,27 +5282,40 @@ void CGameContext::SetPlotExpire(int PlotID)
 
 bool CGameContext::HasPlotByIP(int ClientID)
 {
-	bool HasPlot = false;
 	NETADDR Addr;
 	Server()->GetClientAddr(ClientID, &Addr);
+	return m_PlotOwnerIndex.HasPlot(&Addr);
+}
 
+void CGameContext::InitPlotOwnerIndex()
+{
+	// the only time we have to load the accounts of all plot owners, later on the index is kept up to date on purchase, transfer, expiry and login
+	m_PlotOwnerIndex.Clear();
 	for (int i = PLOT_START; i < Collision()->m_NumPlots + 1; i++)
 	{
+		if (!m_aPlots[i].m_aOwner[0])
+			continue;
+
 		int ID = GetAccount(m_aPlots[i].m_aOwner);
 		if (ID < ACC_START)
 			continue;
 
-		if (SameIP(ID, &Addr))
-			HasPlot = true;
+		UpdatePlotOwnerIndex(i, ID);
 
 		if (!IsAccLoggedInThisPort(ID))
 			FreeAccount(ID);
-
-		if (HasPlot)
-			break;
 	}
+}
+
+void CGameContext::UpdatePlotOwnerIndex(int PlotID, int AccID)
+{
+	if (PlotID < PLOT_START)
+		return;
 
-	return HasPlot;
+	if (AccID >= ACC_START)
+		m_PlotOwnerIndex.SetOwner(PlotID, &m_Accounts[AccID].m_Addr, &m_Accounts[AccID].m_LastAddr);
+	else
+		m_PlotOwnerIndex.RemoveOwner(PlotID);
 }
 
 unsigned int CGameContext::GetMaxPlotObjects(int PlotID)
@@ -5277,20 +5397,91 @@ void CGameContext::ExpirePlots()
 			m_aPlots[i].m_aOwner[0] = 0;
 			m_aPlots[i].m_aDisplayName[0] = 0;
 			m_aPlots[i].m_ExpireDate = 0;
+			m_PlotOwnerIndex.RemoveOwner(i);
 			ClearPlot(i);
 			SetPlotDoorStatus(i, true);
 		}
 	}
 }
 
+void CGameContext::SetSwitch(int Number, int Team, bool Status, int Type, int EndTick)
+{
+	CCollision::SSwitchers *pSwitcher = &Collision()->m_pSwitchers[Number];
+	if (pSwitcher->m_Status[Team] != Status)
+		m_SwitchTracker.OnStatusChange(Team);
+	pSwitcher->m_Status[Team] = Status;
+	pSwitcher->m_Type[Team] = Type;
+	pSwitcher->m_EndTick[Team] = EndTick;
+
+	// timed switches forget who set them once they flip back, all others when nobody is on them anymore
+	if (Type == TILE_SWITCHTIMEDOPEN || Type == TILE_SWITCHTIMEDCLOSE)
+		m_SwitchTracker.AddTimeout(Number, Team, EndTick);
+	else if (pSwitcher->m_ClientID[Team] != -1 && EndTick == 0)
+		m_SwitchTracker.AddActivation(Number, Team);
+}
+
+void CGameContext::SetSwitchActivator(int Number, int Team, int ClientID)
+{
+	CCollision::SSwitchers *pSwitcher = &Collision()->m_pSwitchers[Number];
+	pSwitcher->m_ClientID[Team] = ClientID;
+	pSwitcher->m_StartTick[Team] = Server()->Tick();
+	if (pSwitcher->m_EndTick[Team] == 0)
+		m_SwitchTracker.AddActivation(Number, Team);
+}
+
+void CGameContext::UpdateSwitchers()
+{
+	if (!Collision()->m_pSwitchers)
+		return;
+
+	// set current switcher client id to -1 if it is a non-timed switch and the player is not on the switch anymore
+	m_SwitchTracker.TakeActivations(&m_vSwitchActivations);
+	for (unsigned i = 0; i < m_vSwitchActivations.size(); i++)
+	{
+		int Number = m_vSwitchActivations[i].m_Number;
+		int Team = m_vSwitchActivations[i].m_Team;
+		CCollision::SSwitchers *pSwitcher = &Collision()->m_pSwitchers[Number];
+		if (pSwitcher->m_EndTick[Team] != 0)
+			continue;
+		if (pSwitcher->m_StartTick[Team] < Server()->Tick())
+			pSwitcher->m_ClientID[Team] = -1;
+		else
+			m_SwitchTracker.AddActivation(Number, Team);
+	}
+
+	// if it is a timed switch, the client id will be reset after the time is over here
+	CSwitchTracker::CSwitch Timeout;
+	while (m_SwitchTracker.PopTimeout(Server()->Tick(), &Timeout))
+	{
+		CCollision::SSwitchers *pSwitcher = &Collision()->m_pSwitchers[Timeout.m_Number];
+		int Type = pSwitcher->m_Type[Timeout.m_Team];
+		if (Type != TILE_SWITCHTIMEDOPEN && Type != TILE_SWITCHTIMEDCLOSE)
+			continue;
+
+		// someone stood on it since the timeout was added
+		if (pSwitcher->m_EndTick[Timeout.m_Team] > Server()->Tick())
+		{
+			m_SwitchTracker.AddTimeout(Timeout.m_Number, Timeout.m_Team, pSwitcher->m_EndTick[Timeout.m_Team]);
+			continue;
+		}
+
+		pSwitcher->m_ClientID[Timeout.m_Team] = -1;
+		if (Type == TILE_SWITCHTIMEDOPEN)
+			SetSwitch(Timeout.m_Number, Timeout.m_Team, false, TILE_SWITCHCLOSE, 0);
+		else
+			SetSwitch(Timeout.m_Number, Timeout.m_Team, true, TILE_SWITCHOPEN, 0);
+	}
+}
+
 void CGameContext::SetPlotDoorStatus(int PlotID, bool Close)
 {
 	if (PlotID <= 0 || PlotID > Collision()->m_NumPlots || !Collision()->m_pSwitchers)
 		return;
 
 	int Switch = Collision()->GetSwitchByPlot(PlotID);
+	CCollision::SSwitchers *pSwitcher = &Collision()->m_pSwitchers[Switch];
 	for (int i = 0; i < VANILLA_MAX_CLIENTS; i++)
-		Collision()->m_pSwitchers[Switch].m_Status[i] = Close;
+		SetSwitch(Switch, i, Close, pSwitcher->m_Type[i], pSwitcher->m_EndTick[i]);
 }
 
 void CGameContext::SetPlotDrawDoorStatus(int PlotID, int Door, bool Close)
@@ -5299,8 +5490,9 @@ void CGameContext::SetPlotDrawDoorStatus(int PlotID, int Door, bool Close)
 		return;
 
 	int Switch = Collision()->GetSwitchByPlotLaserDoor(PlotID, Door);
+	CCollision::SSwitchers *pSwitcher = &Collision()->m_pSwitchers[Switch];
 	for (int i = 0; i < VANILLA_MAX_CLIENTS; i++)
-		Collision()->m_pSwitchers[Switch].m_Status[i] = Close;
+		SetSwitch(Switch, i, Close, pSwitcher->m_Type[i], pSwitcher->m_EndTick[i]);
 }
 
 void CGameContext::ClearPlot(int PlotID)
@@ -5862,6 +6054,7 @@ bool CGameContext::Login(int ClientID, const char *pUsername, const char *pPassw
 		}
 
 		WriteAccountStats(ID);
+		UpdatePlotOwnerIndex(GetPlotID(ID), ID);
 	}
 
 	pPlayer->OnLogin(ForceDesignLoad);
@@ -6067,6 +6260,17 @@ void CGameContext::WriteDonationFile(int Type, int Amount, int ID, const char *p
 
 void CGameContext::ReadMoneyListFile()
 {
+	char aPath[IO_MAX_PATH_LENGTH];
+	str_format(aPath, sizeof(aPath), "%s/%s/moneydrops", Config()->m_SvMoneyDropsFilePath, Server()->GetCurrentMapName());
+	std::vector<CMoneyJournal::CDrop> vDrops;
+	if (m_MoneyJournal.Load(aPath, &vDrops))
+	{
+		for (unsigned i = 0; i < vDrops.size(); i++)
+			new CMoney(&m_World, vDrops[i].m_Pos, vDrops[i].m_Amount, -1, 0, vDrops[i].m_ID);
+		return;
+	}
+
+	// no journal yet, read the old text file once, the drops get journaled when they are created
 	std::string data;
 	char aBuf[128];
 	str_format(aBuf, sizeof(aBuf), "%s/%s/moneydrops.txt", Config()->m_SvMoneyDropsFilePath, Server()->GetCurrentMapName());
@@ -6092,50 +6296,55 @@ void CGameContext::ReadMoneyListFile()
 	}
 }
 
-void CGameContext::WriteMoneyListFile()
+void CGameContext::CloseMoneyJournal()
 {
-	char aFile[256];
-	str_format(aFile, sizeof(aFile), "%s/%s/moneydrops.txt", Config()->m_SvMoneyDropsFilePath, Server()->GetCurrentMapName());
-	std::ofstream MoneyDropsFile(aFile);
-
+	// resting drops are journaled already, only the ones still moving have a newer position
 	CMoney *pMoney = (CMoney *)m_World.FindFirst(CGameWorld::ENTTYPE_MONEY);
 	for (; pMoney; pMoney = (CMoney *)pMoney->TypeNext())
-	{
-		char aEntry[64];
-		str_format(aEntry, sizeof(aEntry), "%.2f/%.2f:%d,", pMoney->GetPos().x/32.f, pMoney->GetPos().y/32.f, pMoney->GetAmount());
-		MoneyDropsFile << aEntry;
-	}
+		if (!pMoney->IsSleeping())
+			m_MoneyJournal.Move(pMoney->GetJournalID(), pMoney->GetPos());
+	m_MoneyJournal.Close();
 }
 
 void CGameContext::ReadSavedPlayersFile()
 {
-	m_vSavedIdentities.clear();
+	m_SavedIdentities.Clear();
 	m_vSavedIdentitiesFiles.clear();
 
 	char aPath[IO_MAX_PATH_LENGTH];
-	str_format(aPath, sizeof(aPath), "dumps/%s/%s", Config()->m_SvSavedTeesFilePath, Server()->GetCurrentMapName());
-	Storage()->ListDirectory(IStorage::TYPE_ALL, aPath, LoadSavedPlayersCallback, this);
+	char aJournal[IO_MAX_PATH_LENGTH];
+	str_format(aPath, sizeof(aPath), "dumps/%s/%s/identities.journal", Config()->m_SvSavedTeesFilePath, Server()->GetCurrentMapName());
+	Storage()->GetCompletePath(IStorage::TYPE_SAVE, aPath, aJournal, sizeof(aJournal));
 
-	for (unsigned int i = 0; i < m_vSavedIdentitiesFiles.size(); i++)
+	if (!m_SavedIdentities.LoadJournal(aJournal))
 	{
-		str_format(aPath, sizeof(aPath), "dumps/%s/%s/%s.save", Config()->m_SvSavedTeesFilePath, Server()->GetCurrentMapName(), m_vSavedIdentitiesFiles[i].c_str());
-		CSaveTee SaveTee;
-		if (SaveTee.LoadFile(aPath, 0, this) && SaveTee.HasSavedIdentity())
+		// no journal yet, read all saves once and write them to a new journal
+		m_SavedIdentities.CompactJournal();
+
+		str_format(aPath, sizeof(aPath), "dumps/%s/%s", Config()->m_SvSavedTeesFilePath, Server()->GetCurrentMapName());
+		Storage()->ListDirectory(IStorage::TYPE_ALL, aPath, LoadSavedPlayersCallback, this);
+
+		for (unsigned int i = 0; i < m_vSavedIdentitiesFiles.size(); i++)
 		{
-			if (IsExpired(SaveTee.GetIdentity().m_ExpireDate))
+			str_format(aPath, sizeof(aPath), "dumps/%s/%s/%s.save", Config()->m_SvSavedTeesFilePath, Server()->GetCurrentMapName(), m_vSavedIdentitiesFiles[i].c_str());
+			CSaveTee SaveTee;
+			if (SaveTee.LoadFile(aPath, 0, this) && SaveTee.HasSavedIdentity())
 			{
-				RemoveSavedIdentityFile(SaveTee.GetIdentity());
-				continue;
-			}
+				if (IsExpired(SaveTee.GetIdentity().m_ExpireDate))
+				{
+					RemoveSavedIdentityFile(SaveTee.GetIdentity());
+					continue;
+				}
 
-			m_vSavedIdentities.push_back(SaveTee.GetIdentity());
+				m_SavedIdentities.Add(SaveTee.GetIdentity(), true);
+			}
 		}
-	}
 
-	// Clear
-	m_vSavedIdentitiesFiles.clear();
+		// Clear
+		m_vSavedIdentitiesFiles.clear();
+	}
 
-	// Check for redirect tile saves
+	// Check for redirect tile saves, they are written by other servers and only live until the tee arrived
 	str_format(aPath, sizeof(aPath), "dumps/%s/x_redirect_tile", Config()->m_SvSavedTeesFilePath);
 	Storage()->ListDirectory(IStorage::TYPE_ALL, aPath, LoadSavedPlayersCallback, this);
 
@@ -6153,7 +6362,7 @@ void CGameContext::ReadSavedPlayersFile()
 
 			if (SaveTee.GetIdentity().m_RedirectTilePort == Config()->m_SvPort)
 			{
-				m_vSavedIdentities.push_back(SaveTee.GetIdentity());
+				m_SavedIdentities.Add(SaveTee.GetIdentity(), false);
 			}
 		}
 	}
@@ -6175,13 +6384,13 @@ int CGameContext::LoadSavedPlayersCallback(const char *pName, int IsDir, int Sto
 
 void CGameContext::ExpireSavedIdentities()
 {
-	for (int i = 0; i < (int)m_vSavedIdentities.size(); i++)
+	for (int i = 0; i < m_SavedIdentities.NumSlots(); i++)
 	{
-		if (IsExpired(m_vSavedIdentities[i].m_ExpireDate))
+		const SSavedIdentity *pIdentity = m_SavedIdentities.Get(i);
+		if (pIdentity && IsExpired(pIdentity->m_ExpireDate))
 		{
-			RemoveSavedIdentityFile(m_vSavedIdentities[i]);
-			m_vSavedIdentities.erase(m_vSavedIdentities.begin() + i);
-			i--;
+			RemoveSavedIdentityFile(*pIdentity);
+			m_SavedIdentities.Remove(i);
 		}
 	}
 }
@@ -6244,7 +6453,7 @@ int CGameContext::SaveCharacter(int ClientID, int Flags, float Hours)
 	if (Hours != -1)
 		SetExpireDate(&Info.m_ExpireDate, Hours);
 	Info.m_RedirectTilePort = pChr->m_RedirectTilePort;
-	m_vSavedIdentities.push_back(Info);
+	int Index = m_SavedIdentities.Add(Info, !(Flags & SAVE_REDIRECT));
 
 	// create file and save the character
 	char aFilename[IO_MAX_PATH_LENGTH];
@@ -6260,7 +6469,7 @@ int CGameContext::SaveCharacter(int ClientID, int Flags, float Hours)
 	SaveTee.SaveFile(aFilename, pChr);
 	
 	// return index of newly added identity
-	return m_vSavedIdentities.size() - 1;
+	return Index;
 }
 
 int CGameContext::FindSavedPlayer(int ClientID)
@@ -6270,60 +6479,14 @@ int CGameContext::FindSavedPlayer(int ClientID)
 
 	NETADDR Addr;
 	Server()->GetClientAddr(ClientID, &Addr);
-
-	int Found = -1;
-	for (unsigned int i = 0; i < m_vSavedIdentities.size(); i++)
-	{
-		SSavedIdentity Info = m_vSavedIdentities[i];
-		bool SameAddrAndPort = net_addr_comp(&Addr, &Info.m_Addr, true) == 0;
-		if (Found != -1)
-		{
-			if (SameAddrAndPort)
-				Found = i; // for getting the correct savedidentity when shutting down or saving a tee for save drop
-			continue;
-		}
-
-		bool SameAddr = net_addr_comp(&Addr, &Info.m_Addr, false) == 0;
-		bool SameTimeoutCode = Info.m_aTimeoutCode[0] != '\0' && str_comp(Info.m_aTimeoutCode, m_apPlayers[ClientID]->m_TimeoutCode) == 0;
-		bool SameAcc = Info.m_aAccUsername[0] != '\0' && str_comp(Info.m_aAccUsername, m_Accounts[m_apPlayers[ClientID]->GetAccID()].m_Username) == 0;
-		bool SameName = str_comp(Info.m_aName, Server()->ClientName(ClientID)) == 0;
-		bool SameTeeInfo = mem_comp(&Info.m_TeeInfo, &m_apPlayers[ClientID]->m_TeeInfos, sizeof(CTeeInfo)) == 0;
-
-		// SameTeeInfo is not really used, since players with the same skin and ip would get fucked up otherwise, in CSaveTee::Save() the identity of e.g. dummy would get saved then
-		bool SameClientInfo = SameAddr && SameName;
-		SameAcc = SameAcc && (SameAddr || SameName || SameTeeInfo || SameTimeoutCode);
-		if (SameAddrAndPort || SameAcc || SameTimeoutCode || SameClientInfo)
-		{
-			Found = i;
-		}
-	}
-
-	return Found;
+	return m_SavedIdentities.Find(&Addr, m_apPlayers[ClientID]->m_TimeoutCode, m_Accounts[m_apPlayers[ClientID]->GetAccID()].m_Username,
+		Server()->ClientName(ClientID), &m_apPlayers[ClientID]->m_TeeInfos);
 }
 
 const char *CGameContext::GetSavedIdentityHash(SSavedIdentity Info)
 {
-	SHA256_CTX Sha256Ctx;
-	sha256_init(&Sha256Ctx);
-
-	// manually update sha256 to no get bytes after 0 bytes in or so
-	sha256_update(&Sha256Ctx, &Info.m_aAccUsername, str_length(Info.m_aAccUsername));
-	sha256_update(&Sha256Ctx, &Info.m_Addr, sizeof(Info.m_Addr));
-	sha256_update(&Sha256Ctx, &Info.m_aTimeoutCode, str_length(Info.m_aTimeoutCode));
-	sha256_update(&Sha256Ctx, &Info.m_aName, str_length(Info.m_aName));
-	for (int p = 0; p < NUM_SKINPARTS; p++)
-	{
-		sha256_update(&Sha256Ctx, Info.m_TeeInfo.GetSkinPartName(p), str_length(Info.m_TeeInfo.m_aaSkinPartNames[p]));
-		sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_aUseCustomColors[p], sizeof(Info.m_TeeInfo.m_aUseCustomColors[p]));
-		sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_aSkinPartColors[p], sizeof(Info.m_TeeInfo.m_aSkinPartColors[p]));
-	}
-	sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_Sevendown.m_SkinName, str_length(Info.m_TeeInfo.m_Sevendown.m_SkinName));
-	sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_Sevendown.m_UseCustomColor, sizeof(Info.m_TeeInfo.m_Sevendown.m_UseCustomColor));
-	sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_Sevendown.m_ColorBody, sizeof(Info.m_TeeInfo.m_Sevendown.m_ColorBody));
-	sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_Sevendown.m_ColorFeet, sizeof(Info.m_TeeInfo.m_Sevendown.m_ColorFeet));
-
 	static char aSha256[SHA256_MAXSTRSIZE];
-	sha256_str(sha256_finish(&Sha256Ctx), aSha256, sizeof(aSha256));
+	CSavedIdentities::GetHash(&Info, aSha256, sizeof(aSha256));
 	return aSha256;
 }
 
@@ -6344,12 +6507,38 @@ bool CGameContext::CheckLoadPlayer(int ClientID)
 		// Normal path didn't work, let's see if we can find the file in the redirect tile folder
 		Success = TryLoadPlayer(ClientID, Index, true);
 	}
+	if (!Success && !SavedPlayerFileExists(Index))
+	{
+		// the save got deleted outside of the server, drop the identity so the journal forgets it too
+		dbg_msg("save", "save file of %s is missing, removing saved identity", m_SavedIdentities.Get(Index)->m_aName);
+		m_SavedIdentities.Remove(Index);
+	}
 	return Success;
 }
 
+bool CGameContext::SavedPlayerFileExists(int Index)
+{
+	const char *pHash = m_SavedIdentities.GetHash(Index);
+	char aPath[IO_MAX_PATH_LENGTH];
+	for (int RedirectTile = 0; RedirectTile < 2; RedirectTile++)
+	{
+		if (RedirectTile)
+			str_format(aPath, sizeof(aPath), "dumps/%s/x_redirect_tile/%s.save", Config()->m_SvSavedTeesFilePath, pHash);
+		else
+			str_format(aPath, sizeof(aPath), "dumps/%s/%s/%s.save", Config()->m_SvSavedTeesFilePath, Server()->GetCurrentMapName(), pHash);
+		IOHANDLE File = Storage()->OpenFile(aPath, IOFLAG_READ, IStorage::TYPE_SAVE);
+		if (File)
+		{
+			io_close(File);
+			return true;
+		}
+	}
+	return false;
+}
+
 bool CGameContext::TryLoadPlayer(int ClientID, int Index, bool RedirectTile)
 {
-	const char *pHash = GetSavedIdentityHash(m_vSavedIdentities[Index]);
+	const char *pHash = m_SavedIdentities.GetHash(Index);
 	char aPath[IO_MAX_PATH_LENGTH];
 	if (RedirectTile)
 		str_format(aPath, sizeof(aPath), "dumps/%s/x_redirect_tile/%s.save", Config()->m_SvSavedTeesFilePath, pHash);
@@ -6362,7 +6551,7 @@ bool CGameContext::TryLoadPlayer(int ClientID, int Index, bool RedirectTile)
 		// Remove file, this save has been used now
 		dbg_msg("save", "%d:%s used his save, removing save file", ClientID, Server()->ClientName(ClientID));
 		Storage()->RemoveFile(aPath, IStorage::TYPE_SAVE);
-		m_vSavedIdentities.erase(m_vSavedIdentities.begin() + Index);
+		m_SavedIdentities.Remove(Index);
 		m_apPlayers[ClientID]->m_LoadedSavedPlayer = true;
 		return true;
 	}
@@ -6381,7 +6570,7 @@ void CGameContext::OnRedirectSaveTeeAdd(const char *pHash)
 	{
 		int Index = GetIdentityIndexByHash(pHash);
 		if (Index == -1)
-			m_vSavedIdentities.push_back(SaveTee.GetIdentity());
+			m_SavedIdentities.Add(SaveTee.GetIdentity(), false);
 	}
 }
 
@@ -6390,16 +6579,12 @@ void CGameContext::OnRedirectSaveTeeRemove(const char *pHash)
 	int Index = GetIdentityIndexByHash(pHash);
 	if (Index == -1)
 		return;
-	m_vSavedIdentities.erase(m_vSavedIdentities.begin() + Index);
+	m_SavedIdentities.Remove(Index);
 }
 
 int CGameContext::GetIdentityIndexByHash(const char *pHash)
 {
-	if (pHash[0])
-		for (unsigned int i = 0; i < m_vSavedIdentities.size(); i++)
-			if (str_comp(GetSavedIdentityHash(m_vSavedIdentities[i]), pHash) == 0)
-				return i;
-	return -1;
+	return m_SavedIdentities.FindByHash(pHash);
 }
 
 void CGameContext::CreateFolders()
@@ -23,6 +23,10 @@
 #include "gameworld.h"
 #include "whois.h"
 #include "rainbowname.h"
+#include "moneyjournal.h"
+#include "plotfile.h"
+#include "plotownerindex.h"
+#include "switchtracker.h"
 
 #include "teehistorian.h"
 
@@ -243,6 +247,13 @@ public:
 	void AbortVoteOnDisconnect(int ClientID);
 	void AbortVoteOnTeamChange(int ClientID);
 
+	// vote counting, players sharing an address only count once with the first vote among them
+	void VoteCountAddClient(int ClientID);
+	void VoteCountRemoveClient(int ClientID);
+	void VoteCountUpdateTeam(int ClientID);
+	void VoteCountAddVote(int ClientID);
+	void VoteCountResetVotes();
+
 	int m_VoteCreator;
 	int m_VoteType;
 	int64 m_VoteCloseTime;
@@ -256,6 +267,26 @@ public:
 	int m_VoteClientID;
 	int m_NumVoteOptions;
 	int m_VoteEnforce;
+
+	struct CVoteAddr
+	{
+		NETADDR m_Addr;
+		int m_NumClients;
+		int m_NumPlayers; // clients that are not spectating
+		int m_Vote;
+		int m_VotePos;
+		int m_HashNext;
+	};
+	CVoteAddr m_aVoteAddrs[MAX_CLIENTS];
+	int m_aVoteAddrHash[MAX_CLIENTS*2];
+	int m_aVoteAddrIndex[MAX_CLIENTS]; // -1 if the client isn't counted
+	bool m_aVoteCountPlayer[MAX_CLIENTS];
+	int m_VoteTotal;
+	int m_VoteYes;
+	int m_VoteNo;
+	static unsigned VoteAddrHash(const NETADDR *pAddr);
+	void VoteCountApply(int Index, int Sign);
+	void VoteCountReset();
 	char m_aaZoneEnterMsg[NUM_TUNEZONES][256]; // 0 is used for switching from or to area without tunings
 	char m_aaZoneLeaveMsg[NUM_TUNEZONES][256];
 	char m_aaTuneLockMsg[NUM_TUNEZONES][256];
@@ -405,12 +436,13 @@ public:
 	// draweditor preset list
 	static int LoadPresetListCallback(const char *pName, int IsDir, int StorageType, void *pUser);
 	std::vector<std::string> m_vPresetList;
+	CPlotPresetCache m_PresetCache;
 
 	// plots
 	void ReadPlotStats(int ID);
 	void WritePlotStats(int ID);
-	std::vector<CEntity *> ReadPlotObjects(const char *pLine, int PlotID);
-	void WritePlotObject(CEntity *pEntity, std::ofstream *pFile, vec2 *pPos = 0);
+	std::vector<CEntity *> CreatePlotObjects(const std::vector<CPlotFile::CObject> &vObjects, int PlotID);
+	bool GetPlotObject(CEntity *pEntity, CPlotFile::CObject *pObj, vec2 *pPos = 0);
 
 	void SetPlotInfo(int PlotID, int AccID);
 	void SetPlotExpire(int PlotID);
@@ -445,6 +477,13 @@ public:
 		NUM_PLOT_VARIABLES
 	};
 
+	// switchers are only written through these, so the tracker sees every change
+	CSwitchTracker m_SwitchTracker;
+	std::vector<CSwitchTracker::CSwitch> m_vSwitchActivations;
+	void SetSwitch(int Number, int Team, bool Status, int Type, int EndTick);
+	void SetSwitchActivator(int Number, int Team, int ClientID);
+	void UpdateSwitchers();
+
 	void SetPlotDoorStatus(int PlotID, bool Close);
 	void SetPlotDrawDoorStatus(int PlotID, int Door, bool Close);
 	void ClearPlot(int PlotID);
@@ -455,6 +494,9 @@ public:
 	int m_FullHourOffsetTicks;
 	bool IsFullHour() { return Server()->Tick() % (Server()->TickSpeed() * 60 * 60) == m_FullHourOffsetTicks; }
 	bool HasPlotByIP(int ClientID);
+	CPlotOwnerIndex m_PlotOwnerIndex;
+	void InitPlotOwnerIndex();
+	void UpdatePlotOwnerIndex(int PlotID, int AccID);
 
 	int IntersectedLineDoor(vec2 Pos0, vec2 Pos1, int Team, bool PlotDoorOnly, bool ClosedOnly = true);
 	void RemovePortalsFromPlot(int PlotID);
@@ -633,8 +675,9 @@ public:
 	};
 
 	// money drops
-	void WriteMoneyListFile();
+	CMoneyJournal m_MoneyJournal;
 	void ReadMoneyListFile();
+	void CloseMoneyJournal();
 
 	//motd
 	const char *FormatMotd(const char *pMsg);
@@ -752,9 +795,10 @@ public:
 	int FindSavedPlayer(int ClientID);
 	bool CheckLoadPlayer(int ClientID);
 	bool TryLoadPlayer(int ClientID, int Index, bool RedirectTile);
+	bool SavedPlayerFileExists(int Index);
 	const char *GetSavedIdentityHash(SSavedIdentity Info);
-	std::vector<SSavedIdentity> m_vSavedIdentities;
-	std::vector<std::string> m_vSavedIdentitiesFiles; // only for init, to read all saved identities structs to m_vSavedIdentities
+	CSavedIdentities m_SavedIdentities;
+	std::vector<std::string> m_vSavedIdentitiesFiles; // only for init, to migrate old saves without journal and to read redirect tile saves
 
 	void ReadSavedPlayersFile();
 	static int LoadSavedPlayersCallback(const char *pName, int IsDir, int StorageType, void *pUser);
@@ -36,6 +36,9 @@ IGameController::IGameController(CGameContext *pGameServer)
 	m_GameFlags = 0;
 	m_pGameType = "unknown";
 
+	for (int i = 0; i < VANILLA_MAX_CLIENTS; i++)
+		m_aSwitchStatus[i].m_Version = -1;
+
 	m_GameInfo.m_MatchCurrent = 0;
 	m_GameInfo.m_MatchNum = 0;
 	m_GameInfo.m_ScoreLimit = Config()->m_SvScorelimit;
@@ -618,20 +621,35 @@ void IGameController::Snap(int SnappingClient)
 				return;
 
 			pSwitchState->m_HighestSwitchNumber = clamp(GameServer()->Collision()->GetNumAllSwitchers(), 0, 255);
-			mem_zero(pSwitchState->m_Status, sizeof(pSwitchState->m_Status));
+
+			CSwitchStatus *pStatus = &m_aSwitchStatus[Team];
+			if(pStatus->m_Version != GameServer()->m_SwitchTracker.Version(Team))
+			{
+				pStatus->m_Version = GameServer()->m_SwitchTracker.Version(Team);
+				mem_zero(pStatus->m_aStatus, sizeof(pStatus->m_aStatus));
+				for(int i = 0; i < pSwitchState->m_HighestSwitchNumber + 1; i++)
+				{
+					int Status = (int)GameServer()->Collision()->m_pSwitchers[i].m_Status[Team];
+					pStatus->m_aStatus[i / 32] |= (Status << (i % 32));
+				}
+			}
+			mem_copy(pSwitchState->m_Status, pStatus->m_aStatus, sizeof(pSwitchState->m_Status));
 
 			std::vector<std::pair<int, int>> vEndTicks; // <EndTick, SwitchNumber>
 
-			for(int i = 0; i < pSwitchState->m_HighestSwitchNumber + 1; i++)
+			// only timed switches have an EndTick, and all of them wait for it in the tracker
+			const std::vector<CSwitchTracker::CSwitch> &vTimeouts = GameServer()->m_SwitchTracker.Timeouts();
+			for(unsigned i = 0; i < vTimeouts.size(); i++)
 			{
-				int Status = (int)GameServer()->Collision()->m_pSwitchers[i].m_Status[Team];
-				pSwitchState->m_Status[i / 32] |= (Status << (i % 32));
+				if(vTimeouts[i].m_Team != Team || !GameServer()->m_SwitchTracker.IsLive(vTimeouts[i]))
+					continue;
 
-				int EndTick = GameServer()->Collision()->m_pSwitchers[i].m_EndTick[Team];
-				if(EndTick > 0 && EndTick < Server()->Tick() + 3 * Server()->TickSpeed() && GameServer()->Collision()->m_pSwitchers[i].m_LastUpdateTick[Team] < Server()->Tick())
+				int Number = vTimeouts[i].m_Number;
+				int EndTick = GameServer()->Collision()->m_pSwitchers[Number].m_EndTick[Team];
+				if(Number <= pSwitchState->m_HighestSwitchNumber && EndTick > 0 && EndTick < Server()->Tick() + 3 * Server()->TickSpeed() && GameServer()->Collision()->m_pSwitchers[Number].m_LastUpdateTick[Team] < Server()->Tick())
 				{
 					// only keep track of EndTicks that have less than three second left and are not currently being updated by a player being present on a switch tile, to limit how often these are sent
-					vEndTicks.emplace_back(std::pair<int, int>(GameServer()->Collision()->m_pSwitchers[i].m_EndTick[Team], i));
+					vEndTicks.emplace_back(std::pair<int, int>(EndTick, Number));
 				}
 			}
 
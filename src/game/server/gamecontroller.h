@@ -43,6 +43,14 @@ class IGameController
 		float m_Score;
 	};
 
+	// status bits of the switchers per team, rebuilt when the team's switch version moved on
+	struct CSwitchStatus
+	{
+		int m_Version;
+		int m_aStatus[8];
+	};
+	CSwitchStatus m_aSwitchStatus[VANILLA_MAX_CLIENTS];
+
 	float EvaluateSpawnPos(CSpawnEval *pEval, vec2 Pos) const;
 	void EvaluateSpawnType(CSpawnEval* pEval, int MapIndex) const;
 
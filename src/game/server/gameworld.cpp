@@ -1,7 +1,9 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 
+#include "entities/advanced_entity.h"
 #include "entities/character.h"
+#include "entities/money.h"
 #include "entity.h"
 #include "gamecontext.h"
 #include "gamecontroller.h"
@@ -10,6 +12,8 @@
 #include <algorithm>
 #include <utility>
 #include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
+#include <engine/shared/profiler.h>
 #include "gamemodes/DDRace.h"
 
 void CSelectedArea::Init(CGameContext *pGameServer)
@@ -29,6 +33,12 @@ CSelectedArea::~CSelectedArea()
 //////////////////////////////////////////////////
 // game world
 //////////////////////////////////////////////////
+static const char *s_apEntTypeNames[CGameWorld::NUM_ENTTYPES] = {
+	"projectile", "laser", "pickup", "character", "flag",
+	"door", "dragger", "laser_gun", "light", "plasma",
+	"atom", "clock", "custom_projectile", "pickup_drop", "stable_projectile", "trail", "lightsaber", "lasertext", "portal", "money",
+	"helicopter", "flyingpoint", "speedup", "button", "teleporter", "lovely", "rotating_ball", "staff_ind", "portal_blocker", "lightning_laser"
+};
 CGameWorld::CGameWorld()
 {
 	m_pGameServer = 0x0;
@@ -39,6 +49,13 @@ CGameWorld::CGameWorld()
 	m_ResetRequested = false;
 	for(int i = 0; i < NUM_ENTTYPES; i++)
 		m_apFirstEntityTypes[i] = 0;
+
+	m_pTickJobPool = 0;
+	m_NumTickThreads = 0;
+	m_SnapGridTick = -1;
+	m_PlayersInRangeTick = -1;
+	m_SwitchVersion = 0;
+	sphore_init(&m_TickJobDone);
 }
 
 CGameWorld::~CGameWorld()
@@ -47,6 +64,9 @@ CGameWorld::~CGameWorld()
 	for(int i = 0; i < NUM_ENTTYPES; i++)
 		while(m_apFirstEntityTypes[i])
 			delete m_apFirstEntityTypes[i];
+
+	delete m_pTickJobPool;
+	sphore_destroy(&m_TickJobDone);
 }
 
 void CGameWorld::SetGameServer(CGameContext *pGameServer)
@@ -57,6 +77,16 @@ void CGameWorld::SetGameServer(CGameContext *pGameServer)
 
 	for (int i = 0; i < MAX_CLIENTS; i++)
 		m_aMap[i].Init(i, this);
+
+	char aName[64];
+	for (int i = 0; i < NUM_ENTTYPES; i++)
+	{
+		str_format(aName, sizeof(aName), "tick.%s", s_apEntTypeNames[i]);
+		m_aProfileTick[i] = Server()->Profiler()->AddSection(aName);
+		str_format(aName, sizeof(aName), "snap.%s", s_apEntTypeNames[i]);
+		m_aProfileSnap[i] = Server()->Profiler()->AddSection(aName);
+	}
+	m_ProfileTickThreadSafe = Server()->Profiler()->AddSection("tick.thread_safe");
 }
 
 CEntity *CGameWorld::FindFirst(int Type)
@@ -98,6 +128,7 @@ void CGameWorld::InsertEntity(CEntity *pEnt)
 	pEnt->m_pNextTypeEntity = m_apFirstEntityTypes[pEnt->m_ObjType];
 	pEnt->m_pPrevTypeEntity = 0x0;
 	m_apFirstEntityTypes[pEnt->m_ObjType] = pEnt;
+	m_SnapGridTick = -1;
 }
 
 void CGameWorld::DestroyEntity(CEntity *pEnt)
@@ -118,6 +149,7 @@ void CGameWorld::RemoveEntity(CEntity *pEnt)
 		m_apFirstEntityTypes[pEnt->m_ObjType] = pEnt->m_pNextTypeEntity;
 	if(pEnt->m_pNextTypeEntity)
 		pEnt->m_pNextTypeEntity->m_pPrevTypeEntity = pEnt->m_pPrevTypeEntity;
+	m_SnapGridTick = -1;
 
 	// keep list traversing valid
 	if(m_pNextTraverseEntity == pEnt)
@@ -128,32 +160,156 @@ void CGameWorld::RemoveEntity(CEntity *pEnt)
 }
 
 //
-void CGameWorld::Snap(int SnappingClient)
+void CGameWorld::UpdateSnapGrid()
 {
-	for(CEntity *pEnt = m_apFirstEntityTypes[ENTTYPE_CHARACTER]; pEnt;)
+	if (m_SnapGridTick == Server()->Tick())
+		return;
+	m_SnapGridTick = Server()->Tick();
+
+	m_SnapGrid.Init(GameServer()->Collision()->GetWidth() * 32.f, GameServer()->Collision()->GetHeight() * 32.f, NUM_ENTTYPES);
+	for(int i = 0; i < NUM_ENTTYPES; i++)
 	{
-		m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-		pEnt->Snap(SnappingClient);
-		pEnt = m_pNextTraverseEntity;
+		m_avpSnapAlways[i].clear();
+		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+		{
+			if (pEnt->SnapClippedByPos())
+				m_SnapGrid.Add(pEnt, i, pEnt->m_Pos);
+			else
+				m_avpSnapAlways[i].push_back(pEnt);
+		}
 	}
+	m_SnapGrid.Build();
+}
 
-	std::vector<CEntity *> vpPlotObjects;
-	for(int i = 0; i < NUM_ENTTYPES; i++)
+void CGameWorld::UpdatePlayersInRange()
+{
+	if (m_PlayersInRangeTick == Server()->Tick())
+		return;
+	m_PlayersInRangeTick = Server()->Tick();
+
+	m_CharacterGrid.Init(GameServer()->Collision()->GetWidth() * 32.f, GameServer()->Collision()->GetHeight() * 32.f, NUM_ENTTYPES);
+	for (int i = 0; i < MAX_CLIENTS; i++)
+		if (GameServer()->GetPlayerChar(i))
+			m_CharacterGrid.Add(GameServer()->GetPlayerChar(i), ENTTYPE_CHARACTER, GameServer()->GetPlayerChar(i)->GetPos());
+	m_CharacterGrid.Build();
+
+	for (int i = 0; i < MAX_CLIENTS; i++)
 	{
-		if(i == ENTTYPE_CHARACTER)
+		m_aPlayersInRange[i] = Mask128(-1);
+		CPlayer *pPlayer = GameServer()->m_apPlayers[i];
+		if (!pPlayer)
 			continue;
 
-		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
+		// same view rectangle as in Snap(), only the characters around it are asked whether they are clipped
+		vec2 ShowDistance = vec2(max(pPlayer->m_ShowDistance.x, pPlayer->m_StandardShowDistance.x), max(pPlayer->m_ShowDistance.y, pPlayer->m_StandardShowDistance.y));
+		vec2 Extent = ShowDistance / 2.f + vec2(CEntity::NETWORK_CLIP_BORDER, CEntity::NETWORK_CLIP_BORDER);
+		m_vpPlayersNearby.clear();
+		m_CharacterGrid.Query(ENTTYPE_CHARACTER, pPlayer->m_ViewPos, Extent, &m_vpPlayersNearby);
+		for (unsigned j = 0; j < m_vpPlayersNearby.size(); j++)
+		{
+			CCharacter *pChr = (CCharacter *)m_vpPlayersNearby[j];
+			if (!pChr->NetworkClipped(i))
+				m_aPlayersInRange[i] |= Mask128(pChr->GetPlayer()->GetCID());
+		}
+	}
+}
+
+void CGameWorld::UpdateMoney()
+{
+	if (!m_apFirstEntityTypes[ENTTYPE_MONEY])
+		return;
+
+	// characters have moved already this tick, the drops haven't
+	m_MoneyGrid.Init(GameServer()->Collision()->GetWidth() * 32.f, GameServer()->Collision()->GetHeight() * 32.f, NUM_ENTTYPES);
+	for (CEntity *pEnt = m_apFirstEntityTypes[ENTTYPE_MONEY]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+		if (!pEnt->IsMarkedForDestroy())
+			m_MoneyGrid.Add(pEnt, ENTTYPE_MONEY, pEnt->m_Pos);
+	for (CEntity *pEnt = m_apFirstEntityTypes[ENTTYPE_CHARACTER]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+		m_MoneyGrid.Add(pEnt, ENTTYPE_CHARACTER, pEnt->m_Pos);
+	m_MoneyGrid.Build();
+
+	// one sweep merges touching drops and remembers what each of the others is drawn to
+	for (CEntity *pEnt = m_apFirstEntityTypes[ENTTYPE_MONEY]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+		if (!pEnt->IsMarkedForDestroy())
+			((CMoney *)pEnt)->FindClosest(&m_MoneyGrid, &m_vpMoneyNearby);
+}
+
+void CGameWorld::WakeOnSwitchChange()
+{
+	static const int s_aTypes[] = { ENTTYPE_FLAG, ENTTYPE_PICKUP_DROP, ENTTYPE_MONEY, ENTTYPE_HELICOPTER };
+	static const int s_NumTypes = sizeof(s_aTypes) / sizeof(s_aTypes[0]);
+
+	int Version = GameServer()->m_SwitchTracker.Version();
+	if (Version == m_SwitchVersion)
+		return;
+	m_SwitchVersion = Version;
+
+	for (int i = 0; i < s_NumTypes; i++)
+		for (CEntity *pEnt = m_apFirstEntityTypes[s_aTypes[i]]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+			((CAdvancedEntity *)pEnt)->Wake();
+}
+
+void CGameWorld::Snap(int SnappingClient)
+{
+	{
+		CProfileScope Scope(Server()->Profiler(), m_aProfileSnap[ENTTYPE_CHARACTER]);
+		for(CEntity *pEnt = m_apFirstEntityTypes[ENTTYPE_CHARACTER]; pEnt;)
 		{
 			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-			if (pEnt->m_PlotID >= 0)
-				vpPlotObjects.push_back(pEnt);
-			else
-				pEnt->Snap(SnappingClient);
+			pEnt->Snap(SnappingClient);
 			pEnt = m_pNextTraverseEntity;
 		}
 	}
 
+	std::vector<CEntity *> vpPlotObjects;
+	if (SnappingClient == -1)
+	{
+		// demo snapshots contain everything
+		for(int i = 0; i < NUM_ENTTYPES; i++)
+		{
+			if(i == ENTTYPE_CHARACTER)
+				continue;
+
+			for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
+			{
+				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
+				if (pEnt->m_PlotID >= 0)
+					vpPlotObjects.push_back(pEnt);
+				else
+					pEnt->Snap(SnappingClient);
+				pEnt = m_pNextTraverseEntity;
+			}
+		}
+	}
+	else
+	{
+		UpdateSnapGrid();
+
+		// the view rectangle covers both show distances, NetworkClipped() picks the right one per entity
+		CPlayer *pPlayer = GameServer()->m_apPlayers[SnappingClient];
+		vec2 ShowDistance = vec2(max(pPlayer->m_ShowDistance.x, pPlayer->m_StandardShowDistance.x), max(pPlayer->m_ShowDistance.y, pPlayer->m_StandardShowDistance.y));
+		vec2 Extent = ShowDistance / 2.f + vec2(CEntity::NETWORK_CLIP_BORDER, CEntity::NETWORK_CLIP_BORDER);
+
+		for(int i = 0; i < NUM_ENTTYPES; i++)
+		{
+			if(i == ENTTYPE_CHARACTER)
+				continue;
+
+			CProfileScope Scope(Server()->Profiler(), m_aProfileSnap[i]);
+			m_vpSnapVisible.clear();
+			m_SnapGrid.Query(i, pPlayer->m_ViewPos, Extent, &m_vpSnapVisible);
+			m_vpSnapVisible.insert(m_vpSnapVisible.end(), m_avpSnapAlways[i].begin(), m_avpSnapAlways[i].end());
+			for (unsigned j = 0; j < m_vpSnapVisible.size(); j++)
+			{
+				CEntity *pEnt = m_vpSnapVisible[j];
+				if (pEnt->m_PlotID >= 0)
+					vpPlotObjects.push_back(pEnt);
+				else
+					pEnt->Snap(SnappingClient);
+			}
+		}
+	}
+
 	// snap plot objects after we got everything else, so we dont fill the snap with plot objects before everything important
 	for (unsigned int i = 0; i < vpPlotObjects.size(); i++)
 		vpPlotObjects[i]->Snap(SnappingClient);
@@ -242,11 +398,12 @@ void CGameWorld::UpdatePlayerMap(int ClientID)
 
 				m_aMap[i].UpdateSeeOthers();
 				m_aMap[i].m_UpdateTeamsState = true;
+				m_aMap[i].m_Dirty = true;
 			}
 
 			if (Update)
 			{
-				m_aMap[i].Update();
+				m_aMap[i].Tick();
 			}
 		}
 	}
@@ -256,6 +413,18 @@ void CGameWorld::UpdatePlayerMap(int ClientID)
 	}
 }
 
+void CGameWorld::MarkPlayerMapDirty(int ClientID)
+{
+	if (ClientID != -1)
+	{
+		m_aMap[ClientID].m_Dirty = true;
+		return;
+	}
+
+	for (int i = 0; i < MAX_CLIENTS; i++)
+		m_aMap[i].m_Dirty = true;
+}
+
 int CGameWorld::GetSeeOthersInd(int ClientID, int MapID)
 {
 	if (m_aMap[ClientID].m_TotalOverhang && MapID == GetSeeOthersID(ClientID))
@@ -350,6 +519,7 @@ void CGameWorld::PlayerMap::ResetSeeOthers()
 	for (int i = 0; i < MAX_CLIENTS; i++)
 		m_aWasSeeOthers[i] = false;
 	m_UpdateTeamsState = true;
+	m_Dirty = true;
 	UpdateSeeOthers();
 }
 
@@ -391,6 +561,9 @@ void CGameWorld::PlayerMap::Init(int ClientID, CGameWorld *pGameWorld)
 	m_pMap = m_pGameWorld->Server()->GetIdMap(m_ClientID);
 	m_pReverseMap = m_pGameWorld->Server()->GetReverseIdMap(m_ClientID);
 	m_UpdateTeamsState = false;
+	m_FreeSlots = ~(uint64_t)0;
+	m_ReservedSlots = 0;
+	m_InRange = Mask128(-1);
 	ResetSeeOthers();
 }
 
@@ -414,12 +587,20 @@ void CGameWorld::PlayerMap::InitPlayer(bool Rejoin)
 	for (int i = 0; i < MAX_CLIENTS; i++)
 		m_pReverseMap[i] = -1;
 
+	m_FreeSlots = ~(uint64_t)0;
+	m_ReservedSlots = 0;
+	m_InRange = Mask128(-1);
+
+	// from now on we count for the same ip checks of the others
+	m_pGameWorld->m_ClientAddrs.OnEntered(m_ClientID);
+
+	// a player joined or rejoined, everyone has to look at their map again
+	m_pGameWorld->MarkPlayerMapDirty();
+
 	if (GetPlayer()->m_IsDummy)
 		return; // just need to initialize the arrays
 
 	int NextFreeID = 0;
-	NETADDR OwnAddr, Addr;
-	m_pGameWorld->Server()->GetClientAddr(m_ClientID, &OwnAddr);
 	while (1)
 	{
 		bool Break = true;
@@ -428,8 +609,7 @@ void CGameWorld::PlayerMap::InitPlayer(bool Rejoin)
 			if (!m_pGameWorld->GameServer()->m_apPlayers[i] || m_pGameWorld->GameServer()->m_apPlayers[i]->m_IsDummy || i == m_ClientID)
 				continue;
 
-			m_pGameWorld->Server()->GetClientAddr(i, &Addr);
-			if (net_addr_comp(&OwnAddr, &Addr, false) == 0)
+			if (m_pGameWorld->m_ClientAddrs.SameAddr(m_ClientID, i))
 			{
 				if (m_pGameWorld->m_aMap[i].m_pReverseMap[i] == NextFreeID)
 				{
@@ -483,7 +663,7 @@ void CGameWorld::PlayerMap::InitPlayer(bool Rejoin)
 
 	if (NextFreeID < GetMapSize())
 	{
-		m_aReserved[m_ClientID] = true;
+		SetReserved(m_ClientID, true);
 		Add(NextFreeID, m_ClientID);
 	}
 
@@ -492,21 +672,20 @@ void CGameWorld::PlayerMap::InitPlayer(bool Rejoin)
 		if (!m_pGameWorld->GameServer()->m_apPlayers[i] || m_pGameWorld->GameServer()->m_apPlayers[i]->m_IsDummy || i == m_ClientID)
 			continue;
 
-		m_pGameWorld->Server()->GetClientAddr(i, &Addr);
-		if (net_addr_comp(&OwnAddr, &Addr, false) != 0)
+		if (!m_pGameWorld->m_ClientAddrs.SameAddr(m_ClientID, i))
 			continue;
 
 		// update us with other same ip player infos
 		if (m_pGameWorld->m_aMap[i].m_pReverseMap[i] < GetMapSize())
 		{
-			m_aReserved[i] = true;
+			SetReserved(i, true);
 			Add(m_pGameWorld->m_aMap[i].m_pReverseMap[i], i);
 		}
 
 		// update other same ip players with our info
 		if (NextFreeID < m_pGameWorld->m_aMap[i].GetMapSize())
 		{
-			m_pGameWorld->m_aMap[i].m_aReserved[m_ClientID] = true;
+			m_pGameWorld->m_aMap[i].SetReserved(m_ClientID, true);
 			m_pGameWorld->m_aMap[i].Add(NextFreeID, m_ClientID);
 		}
 	}
@@ -534,6 +713,10 @@ void CGameWorld::PlayerMap::Add(int MapID, int ClientID)
 
 	m_pMap[MapID] = ClientID;
 	m_pReverseMap[ClientID] = MapID;
+	m_FreeSlots &= ~((uint64_t)1<<MapID);
+	if (m_aReserved[ClientID])
+		m_ReservedSlots |= (uint64_t)1<<MapID;
+	m_Dirty = true;
 	GetPlayer()->SendConnect(MapID, ClientID);
 }
 
@@ -554,10 +737,69 @@ int CGameWorld::PlayerMap::Remove(int MapID)
 		GetPlayer()->SendDisconnect(MapID);
 		m_pReverseMap[ClientID] = -1;
 		m_pMap[MapID] = -1;
+		m_FreeSlots |= (uint64_t)1<<MapID;
+		m_ReservedSlots &= ~((uint64_t)1<<MapID);
+		m_Dirty = true;
 	}
 	return ClientID;
 }
 
+void CGameWorld::PlayerMap::SetReserved(int ClientID, bool Reserved)
+{
+	if (m_aReserved[ClientID] == Reserved)
+		return;
+
+	m_aReserved[ClientID] = Reserved;
+	m_Dirty = true;
+
+	int MapID = m_pReverseMap[ClientID];
+	if (MapID == -1)
+		return;
+	if (Reserved)
+		m_ReservedSlots |= (uint64_t)1<<MapID;
+	else
+		m_ReservedSlots &= ~((uint64_t)1<<MapID);
+}
+
+static int FirstSlot(uint64_t Mask)
+{
+	if (!Mask)
+		return -1;
+#if defined(__GNUC__)
+	return __builtin_ctzll(Mask);
+#else
+	int Slot = 0;
+	while (!(Mask & 1))
+	{
+		Mask >>= 1;
+		Slot++;
+	}
+	return Slot;
+#endif
+}
+
+bool CGameWorld::PlayerMap::ClippingChanged()
+{
+	// network range only decides who gets the remaining slots, so there is nothing to check while everyone has one
+	bool Unmapped = false;
+	for (int i = 0; i < MAX_CLIENTS && !Unmapped; i++)
+		Unmapped = i != m_ClientID && m_pReverseMap[i] == -1 && m_pGameWorld->GameServer()->m_apPlayers[i] && m_pGameWorld->Server()->ClientIngame(i);
+	if (!Unmapped)
+		return false;
+
+	Mask128 InRange = m_pGameWorld->PlayersInRange(m_ClientID);
+	if (InRange == m_InRange)
+		return false;
+	m_InRange = InRange;
+	return true;
+}
+
+void CGameWorld::PlayerMap::Tick()
+{
+	if (m_Dirty || m_UpdateTeamsState || ClippingChanged())
+		Update();
+}
+
 void CGameWorld::PlayerMap::Update()
 {
 	if (!m_pGameWorld->Server()->ClientIngame(m_ClientID) || !GetPlayer() || GetPlayer()->m_IsDummy)
@@ -565,7 +807,10 @@ void CGameWorld::PlayerMap::Update()
 
 	bool ResortReserved = m_ResortReserved;
 	m_ResortReserved = false;
+	// a resort pass skips all unreserved players, so the next pass has to run in any case
+	m_Dirty = ResortReserved;
 
+	uint64_t Range = SlotRange(GetMapSize()-m_NumSeeOthers);
 	for (int i = 0; i < MAX_CLIENTS; i++)
 	{
 		if (i == m_ClientID)
@@ -576,19 +821,16 @@ void CGameWorld::PlayerMap::Update()
 		if (!m_pGameWorld->Server()->ClientIngame(i) || !pPlayer)
 		{
 			Remove(m_pReverseMap[i]);
-			m_aReserved[i] = false;
+			SetReserved(i, false);
 			continue;
 		}
 
 		if (m_aReserved[i])
 		{
-			NETADDR OwnAddr, Addr;
-			m_pGameWorld->Server()->GetClientAddr(m_ClientID, &OwnAddr);
-			m_pGameWorld->Server()->GetClientAddr(i, &Addr);
-			if (net_addr_comp(&OwnAddr, &Addr, false) != 0)
+			if (!m_pGameWorld->m_ClientAddrs.SameAddr(m_ClientID, i))
 			{
 				if (ResortReserved || !m_pGameWorld->GameServer()->GetDDRaceTeam(i)) // condition to unset reserved slot
-					m_aReserved[i] = false;
+					SetReserved(i, false);
 			}
 			continue;
 		}
@@ -598,16 +840,9 @@ void CGameWorld::PlayerMap::Update()
 		int Insert = -1;
 		if (m_pGameWorld->GameServer()->GetDDRaceTeam(i))
 		{
-			for (int j = 0; j < GetMapSize()-m_NumSeeOthers; j++)
-			{
-				int CID = m_pMap[j];
-				if (CID == -1 || !m_aReserved[CID])
-				{
-					Insert = j;
-					m_aReserved[i] = true;
-					break;
-				}
-			}
+			Insert = FirstSlot(~m_ReservedSlots & Range);
+			if (Insert != -1)
+				SetReserved(i, true);
 		}
 		else if (m_pReverseMap[i] != -1)
 		{
@@ -615,12 +850,7 @@ void CGameWorld::PlayerMap::Update()
 		}
 		else
 		{
-			for (int j = 0; j < GetMapSize()-m_NumSeeOthers; j++)
-				if (m_pMap[j] == -1)
-				{
-					Insert = j;
-					break;
-				}
+			Insert = FirstSlot(m_FreeSlots & Range);
 		}
 
 		if (Insert != -1)
@@ -645,12 +875,10 @@ void CGameWorld::PlayerMap::InsertNextEmpty(int ClientID)
 	if (ClientID == -1 || m_pReverseMap[ClientID] != -1)
 		return;
 
-	for (int i = 0; i < GetMapSize()-m_NumSeeOthers; i++)
+	uint64_t Slots = ~m_ReservedSlots & SlotRange(GetMapSize()-m_NumSeeOthers);
+	for (int i = FirstSlot(Slots); i != -1; Slots &= Slots - 1, i = FirstSlot(Slots))
 	{
 		int CID = m_pMap[i];
-		if (CID != -1 && m_aReserved[CID])
-			continue;
-
 		if (CID == -1 || (!m_pGameWorld->GameServer()->GetPlayerChar(CID) || m_pGameWorld->GameServer()->GetPlayerChar(CID)->NetworkClipped(m_ClientID)))
 		{
 			Add(i, ClientID);
@@ -659,6 +887,77 @@ void CGameWorld::PlayerMap::InsertNextEmpty(int ClientID)
 	}
 }
 
+class CEntityTickJob : public IJob
+{
+	CEntity **m_ppEntities;
+	int m_NumEntities;
+	SEMAPHORE *m_pDone;
+
+	void Run()
+	{
+		for(int i = 0; i < m_NumEntities; i++)
+			m_ppEntities[i]->Tick();
+		sphore_signal(m_pDone);
+	}
+
+public:
+	CEntityTickJob(CEntity **ppEntities, int NumEntities, SEMAPHORE *pDone)
+	{
+		m_ppEntities = ppEntities;
+		m_NumEntities = NumEntities;
+		m_pDone = pDone;
+	}
+};
+
+void CGameWorld::TickThreadSafeEntities()
+{
+	int Num = m_vpThreadSafeEntities.size();
+	if(!Num)
+		return;
+
+	if(m_NumTickThreads != Config()->m_SvTickThreads)
+	{
+		delete m_pTickJobPool;
+		m_pTickJobPool = 0;
+		m_NumTickThreads = Config()->m_SvTickThreads;
+		if(m_NumTickThreads)
+		{
+			m_pTickJobPool = new CJobPool();
+			m_pTickJobPool->Init(m_NumTickThreads);
+		}
+	}
+
+	// one batch per worker and one for the main thread, but don't wake workers for a handful of entities
+	int NumBatches = m_pTickJobPool ? clamp(Num / (int)MIN_TICK_BATCH, 1, m_NumTickThreads + 1) : 1;
+	int BatchSize = (Num + NumBatches - 1) / NumBatches;
+	int NumJobs = 0;
+	for(int Begin = BatchSize; Begin < Num; Begin += BatchSize)
+	{
+		int End = min(Begin + BatchSize, Num);
+		m_pTickJobPool->Add(std::make_shared<CEntityTickJob>(&m_vpThreadSafeEntities[Begin], End - Begin, &m_TickJobDone));
+		NumJobs++;
+	}
+
+	for(int i = 0; i < min(BatchSize, Num); i++)
+		m_vpThreadSafeEntities[i]->Tick();
+
+	for(int i = 0; i < NumJobs; i++)
+		sphore_wait(&m_TickJobDone);
+
+	// apply everything that touches shared state in the usual order
+	for(unsigned i = 0; i < m_vpThreadSafeEntities.size(); i++)
+	{
+		CEntity *pEnt = m_vpThreadSafeEntities[i];
+		if(pEnt->m_ResetDeferred)
+		{
+			pEnt->m_ResetDeferred = false;
+			pEnt->Reset();
+		}
+	}
+
+	m_vpThreadSafeEntities.clear();
+}
+
 void CGameWorld::Tick()
 {
 	if(m_ResetRequested)
@@ -678,13 +977,18 @@ void CGameWorld::Tick()
 	else
 	{
 		// process lightning laser before character, so that vel set to vec2(0, 0) will make a chr fall slowly, and make him slightly movable
-		for(CEntity *pEnt = m_apFirstEntityTypes[ENTTYPE_LIGHTNING_LASER]; pEnt; )
 		{
-			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-			pEnt->Tick();
-			pEnt = m_pNextTraverseEntity;
+			CProfileScope Scope(Server()->Profiler(), m_aProfileTick[ENTTYPE_LIGHTNING_LASER]);
+			for(CEntity *pEnt = m_apFirstEntityTypes[ENTTYPE_LIGHTNING_LASER]; pEnt; )
+			{
+				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
+				pEnt->Tick();
+				pEnt = m_pNextTraverseEntity;
+			}
 		}
 
+		WakeOnSwitchChange();
+
 		// update all objects
 		for(int i = 0; i < NUM_ENTTYPES; i++)
 		{
@@ -692,14 +996,25 @@ void CGameWorld::Tick()
 			if (i == ENTTYPE_LIGHTNING_LASER)
 				continue;
 
+			CProfileScope Scope(Server()->Profiler(), m_aProfileTick[i]);
+			if (i == ENTTYPE_MONEY)
+				UpdateMoney();
 			for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
 			{
 				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-				pEnt->Tick();
+				if (pEnt->TickThreadSafe())
+					m_vpThreadSafeEntities.push_back(pEnt);
+				else
+					pEnt->Tick();
 				pEnt = m_pNextTraverseEntity;
 			}
 		}
 
+		{
+			CProfileScope Scope(Server()->Profiler(), m_ProfileTickThreadSafe);
+			TickThreadSafeEntities();
+		}
+
 		// we need to do this between core tick and Move of all the players, because otherwise its getting jiggly for those whose coretick didnt happen yet
 		for (CCharacter *pChr = (CCharacter *)FindFirst(ENTTYPE_CHARACTER); pChr; pChr = (CCharacter *)pChr->TypeNext())
 		{
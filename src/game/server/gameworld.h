@@ -6,6 +6,12 @@
 #include <game/gamecore.h>
 
 #include <list>
+#include <stdint.h>
+#include <vector>
+
+#include "clientaddrs.h"
+#include "mask128.h"
+#include "snapgrid.h"
 
 class CEntity;
 class CCharacter;
@@ -78,6 +84,49 @@ public:
 private:
 	void Reset();
 	void RemoveEntities();
+	void TickThreadSafeEntities();
+
+	enum
+	{
+		MIN_TICK_BATCH = 32,
+	};
+
+	// collected during the main tick loop and ticked afterwards, optionally by m_pTickJobPool
+	std::vector<CEntity *> m_vpThreadSafeEntities;
+	class CJobPool *m_pTickJobPool;
+	int m_NumTickThreads;
+
+	// entities that are clipped by their position get bucketed once per tick, everything else is snapped from m_avpSnapAlways
+	void UpdateSnapGrid();
+	CSnapGrid m_SnapGrid;
+	int m_SnapGridTick;
+	std::vector<CEntity *> m_avpSnapAlways[NUM_ENTTYPES];
+	std::vector<CEntity *> m_vpSnapVisible;
+
+	// money drops and characters bucketed right before the money ticks, so every drop only looks at its neighbourhood
+	void UpdateMoney();
+	CSnapGrid m_MoneyGrid;
+	std::vector<CEntity *> m_vpMoneyNearby;
+
+	// per client the players whose character is inside its network range, computed once per tick for the player maps
+	void UpdatePlayersInRange();
+	CSnapGrid m_CharacterGrid;
+	int m_PlayersInRangeTick;
+	Mask128 m_aPlayersInRange[MAX_CLIENTS];
+	std::vector<CEntity *> m_vpPlayersNearby;
+
+	// the address of every connected client for the same ip checks of the player maps
+	CClientAddrs m_ClientAddrs;
+
+	// a switch flipping anywhere may have opened the floor below resting entities, so all of them wake up
+	void WakeOnSwitchChange();
+	int m_SwitchVersion;
+
+	// profiler sections per entity type
+	int m_aProfileTick[NUM_ENTTYPES];
+	int m_aProfileSnap[NUM_ENTTYPES];
+	int m_ProfileTickThreadSafe;
+	SEMAPHORE m_TickJobDone;
 
 	CEntity *m_pNextTraverseEntity;
 	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
@@ -107,6 +156,17 @@ private:
 		bool m_ResortReserved;
 		int *m_pMap;
 		int *m_pReverseMap;
+		// slot bitmasks: ids without a player and ids held by a reserved player
+		uint64_t m_FreeSlots;
+		uint64_t m_ReservedSlots;
+		// set by join/leave, team and see others changes, and by updates that still changed something
+		bool m_Dirty;
+		// players that had a character inside our network range at the last check
+		Mask128 m_InRange;
+		void SetReserved(int ClientID, bool Reserved);
+		uint64_t SlotRange(int Size) { return Size >= VANILLA_MAX_CLIENTS ? ~(uint64_t)0 : ((uint64_t)1<<Size) - 1; }
+		bool ClippingChanged();
+		void Tick();
 		void Update();
 		void Add(int MapID, int ClientID);
 		int Remove(int MapID);
@@ -136,7 +196,11 @@ public:
 	// F-DDrace
 	void InitPlayerMap(int ClientID, bool Rejoin = false) { m_aMap[ClientID].InitPlayer(Rejoin); }
 	void UpdateTeamsState(int ClientID) { m_aMap[ClientID].m_UpdateTeamsState = true; }
+	void MarkPlayerMapDirty(int ClientID = -1);
 	void ForceInsertPlayer(int Insert, int ClientID) { m_aMap[ClientID].InsertNextEmpty(Insert); }
+	void OnClientConnected(int ClientID, const NETADDR *pAddr) { m_ClientAddrs.OnConnected(ClientID, pAddr); }
+	void OnClientDropped(int ClientID) { m_ClientAddrs.OnDropped(ClientID); }
+	Mask128 PlayersInRange(int ClientID) { UpdatePlayersInRange(); return m_aPlayersInRange[ClientID]; }
 
 	enum
 	{
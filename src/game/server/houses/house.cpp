@@ -23,9 +23,19 @@ CHouse::CHouse(CGameContext *pGameServer, int Type)
 		Reset(i);
 }
 
+int CHouse::TileToHouse(int Index)
+{
+	switch (Index)
+	{
+	case TILE_SHOP: return HOUSE_SHOP;
+	case TILE_PLOT_SHOP: return HOUSE_PLOT_SHOP;
+	case TILE_BANK: return HOUSE_BANK;
+	}
+	return -1;
+}
+
 void CHouse::Reset(int ClientID)
 {
-	m_aClients[ClientID].m_Inside = false;
 	m_aClients[ClientID].m_LastMotd = 0;
 	m_aClients[ClientID].m_NextMsg = Server()->Tick();
 	m_aClients[ClientID].m_Page = PAGE_NONE;
@@ -57,27 +67,35 @@ void CHouse::SendWindow(int ClientID, const char *pMsg, const char *pFooterMsg,
 	GameServer()->SendMotd(GameServer()->AppendMotdFooter(aMsg, aFooter), ClientID);
 }
 
+bool CHouse::IsInside(int ClientID)
+{
+	CPlayer *pPlayer = GameServer()->m_apPlayers[ClientID];
+	return pPlayer && pPlayer->m_CurrentHouse == m_Type;
+}
+
 void CHouse::Tick(int ClientID)
 {
+	if (Server()->Tick() % 50 == 0)
+		GameServer()->SendBroadcast(m_pHeadline, ClientID, false);
+}
+
+void CHouse::CheckWindowTimeout(int ClientID)
+{
+	// the motd closes on its own after a while and when the scoreboard is opened, so the window is forgotten the next
+	// time it would be used
 	if (m_aClients[ClientID].m_LastMotd < Server()->Tick() - Server()->TickSpeed() * 10)
 	{
 		m_aClients[ClientID].m_Page = PAGE_NONE;
 		m_aClients[ClientID].m_State = STATE_NONE;
 	}
-
-	if (m_aClients[ClientID].m_Inside)
-	{
-		if (Server()->Tick() % 50 == 0)
-			GameServer()->SendBroadcast(m_pHeadline, ClientID, false);
-	}
 }
 
 void CHouse::OnEnter(int ClientID)
 {
-	if (m_aClients[ClientID].m_Inside)
+	if (IsInside(ClientID))
 		return;
 
-	m_aClients[ClientID].m_Inside = true;
+	GameServer()->m_apPlayers[ClientID]->m_CurrentHouse = m_Type;
 
 	if (GameServer()->IsHouseDummy(ClientID, m_Type))
 		return;
@@ -92,10 +110,10 @@ void CHouse::OnEnter(int ClientID)
 
 void CHouse::OnLeave(int ClientID)
 {
-	if (!m_aClients[ClientID].m_Inside)
+	if (!IsInside(ClientID))
 		return;
 
-	m_aClients[ClientID].m_Inside = false;
+	GameServer()->m_apPlayers[ClientID]->m_CurrentHouse = -1;
 
 	if (GameServer()->IsHouseDummy(ClientID, m_Type))
 		return;
@@ -118,6 +136,7 @@ void CHouse::OnLeave(int ClientID)
 
 void CHouse::OnKeyPress(int ClientID, int Dir)
 {
+	CheckWindowTimeout(ClientID);
 	if (m_Type == HOUSE_BANK && m_aClients[ClientID].m_State == STATE_OPENED_WINDOW)
 	{
 		m_aClients[ClientID].m_State = STATE_CHOSE_ASSIGNMENT;
@@ -177,6 +196,7 @@ void CHouse::EndSession(int ClientID, bool Cancelled)
 
 bool CHouse::CanChangePage(int ClientID)
 {
+	CheckWindowTimeout(ClientID);
 	return m_aClients[ClientID].m_Page != PAGE_NONE && m_aClients[ClientID].m_State >= STATE_OPENED_WINDOW && m_aClients[ClientID].m_State != STATE_CONFIRM;
 }
 
@@ -42,7 +42,6 @@ protected:
 
 	struct
 	{
-		bool m_Inside;
 		int m_Page;
 		int m_State;
 		int64 m_NextMsg;
@@ -50,6 +49,7 @@ protected:
 	} m_aClients[MAX_CLIENTS];
 
 	void SetPage(int ClientID, int Page);
+	void CheckWindowTimeout(int ClientID);
 	virtual void SendWindow(int ClientID, const char *pMsg, const char *pFooterMsg = "", int Page = -1);
 
 	virtual int FirstPage() { return PAGE_MAIN; }
@@ -61,10 +61,14 @@ public:
 	CHouse(CGameContext *pGameServer, int Type);
 	virtual ~CHouse() {};
 
+	// the house standing on that tile, -1 for none
+	static int TileToHouse(int Index);
+
+	// only called for the players inside
 	void Tick(int ClientID);
 	void Reset(int ClientID);
 
-	bool IsInside(int ClientID) { return m_aClients[ClientID].m_Inside; }
+	bool IsInside(int ClientID);
 
 	void ResetLastMotd(int ClientID) { m_aClients[ClientID].m_LastMotd = 0; }
 	void OnEnter(int ClientID);
@@ -0,0 +1,355 @@
+#include "moneyjournal.h"
+
+#include <base/math.h>
+
+#include <algorithm>
+
+static const char s_aJournalMagic[4] = {'F', 'D', 'M', 'J'};
+
+struct CJournalHeader
+{
+	char m_aMagic[4];
+	int m_Version;
+	int m_RecordSize;
+};
+
+CMoneyJournal::CMoneyJournal()
+{
+	m_NextID = 1;
+	m_aSnapshotFile[0] = 0;
+	m_aJournalFile[0] = 0;
+	m_aOldJournalFile[0] = 0;
+	m_JournalFile = 0;
+	m_NumRecords = 0;
+	m_Dirty = false;
+	m_CompactFailed = false;
+	m_pCompactJob = 0;
+	m_pCompactThread = 0;
+}
+
+CMoneyJournal::~CMoneyJournal()
+{
+	Close();
+}
+
+void CMoneyJournal::Apply(const CRecord &Record)
+{
+	m_NextID = max(m_NextID, max(Record.m_ID, Record.m_OtherID) + 1);
+	std::unordered_map<int, CDrop>::iterator It = m_Drops.find(Record.m_ID);
+	if (Record.m_Op == JOURNAL_CREATE)
+	{
+		CDrop Drop;
+		Drop.m_ID = Record.m_ID;
+		Drop.m_Pos = vec2(Record.m_X, Record.m_Y);
+		Drop.m_Amount = Record.m_Amount;
+		m_Drops[Record.m_ID] = Drop;
+	}
+	else if (Record.m_Op == JOURNAL_MOVE)
+	{
+		if (It != m_Drops.end())
+			It->second.m_Pos = vec2(Record.m_X, Record.m_Y);
+	}
+	else if (Record.m_Op == JOURNAL_MERGE)
+	{
+		if (It != m_Drops.end())
+			It->second.m_Amount = Record.m_Amount;
+		m_Drops.erase(Record.m_OtherID);
+	}
+	else if (Record.m_Op == JOURNAL_REMOVE)
+	{
+		if (It != m_Drops.end())
+			m_Drops.erase(It);
+	}
+}
+
+int CMoneyJournal::Replay(const char *pFilename, bool *pTorn)
+{
+	IOHANDLE File = io_open(pFilename, IOFLAG_READ);
+	if (!File)
+		return -1;
+
+	CJournalHeader Header;
+	if (io_read(File, &Header, sizeof(Header)) != sizeof(Header) || mem_comp(Header.m_aMagic, s_aJournalMagic, sizeof(s_aJournalMagic)) != 0
+		|| Header.m_Version != JOURNAL_VERSION || Header.m_RecordSize != (int)sizeof(CRecord))
+	{
+		io_close(File);
+		return -1;
+	}
+
+	int NumRecords = 0;
+	CRecord Record;
+	unsigned Read;
+	while ((Read = io_read(File, &Record, sizeof(Record))) == sizeof(Record))
+	{
+		Apply(Record);
+		NumRecords++;
+	}
+	io_close(File);
+
+	// a crash in the middle of a write leaves a torn record at the end
+	if (Read)
+		*pTorn = true;
+	return NumRecords;
+}
+
+void CMoneyJournal::GetSnapshot(std::vector<CRecord> *pvRecords) const
+{
+	pvRecords->reserve(m_Drops.size());
+	for (std::unordered_map<int, CDrop>::const_iterator It = m_Drops.begin(); It != m_Drops.end(); ++It)
+	{
+		CRecord Record;
+		mem_zero(&Record, sizeof(Record));
+		Record.m_Op = JOURNAL_CREATE;
+		Record.m_ID = It->first;
+		Record.m_X = It->second.m_Pos.x;
+		Record.m_Y = It->second.m_Pos.y;
+		Record.m_Amount = It->second.m_Amount;
+		pvRecords->push_back(Record);
+	}
+}
+
+bool CMoneyJournal::OpenJournal(bool Truncate)
+{
+	if (!Truncate)
+	{
+		m_JournalFile = io_open(m_aJournalFile, IOFLAG_APPEND);
+		return m_JournalFile != 0;
+	}
+
+	m_JournalFile = io_open(m_aJournalFile, IOFLAG_WRITE);
+	if (!m_JournalFile)
+		return false;
+
+	CJournalHeader Header;
+	mem_copy(Header.m_aMagic, s_aJournalMagic, sizeof(s_aJournalMagic));
+	Header.m_Version = JOURNAL_VERSION;
+	Header.m_RecordSize = sizeof(CRecord);
+	if (io_write(m_JournalFile, &Header, sizeof(Header)) != sizeof(Header))
+	{
+		io_close(m_JournalFile);
+		m_JournalFile = 0;
+		return false;
+	}
+	io_flush(m_JournalFile);
+	return true;
+}
+
+bool CMoneyJournal::Load(const char *pPath, std::vector<CDrop> *pvDrops)
+{
+	Close();
+	m_Drops.clear();
+	m_NextID = 1;
+	m_NumRecords = 0;
+	m_CompactFailed = false;
+	str_format(m_aSnapshotFile, sizeof(m_aSnapshotFile), "%s.snapshot", pPath);
+	str_format(m_aJournalFile, sizeof(m_aJournalFile), "%s.journal", pPath);
+	str_format(m_aOldJournalFile, sizeof(m_aOldJournalFile), "%s.journal.old", pPath);
+
+	// the old journal is only left when a compaction didn't finish, its records come before the current journal
+	bool Torn = false;
+	int NumSnapshot = Replay(m_aSnapshotFile, &Torn);
+	int NumOld = Replay(m_aOldJournalFile, &Torn);
+	int NumJournal = Replay(m_aJournalFile, &Torn);
+
+	if (NumOld >= 0 || Torn)
+	{
+		// start over from a clean snapshot, appending to a torn journal would shift every record after it
+		std::vector<CRecord> vRecords;
+		GetSnapshot(&vRecords);
+		if (WriteSnapshot(m_aSnapshotFile, vRecords) && OpenJournal(true))
+		{
+			fs_remove(m_aOldJournalFile);
+			m_NumRecords = vRecords.size();
+		}
+		else
+		{
+			dbg_msg("money", "failed to write snapshot '%s', not journaling money drops", m_aSnapshotFile);
+			m_CompactFailed = true;
+		}
+	}
+	else
+	{
+		if (!OpenJournal(NumJournal < 0))
+			dbg_msg("money", "failed to open journal '%s'", m_aJournalFile);
+		m_NumRecords = max(NumSnapshot, 0) + max(NumJournal, 0);
+	}
+
+	pvDrops->clear();
+	for (std::unordered_map<int, CDrop>::iterator It = m_Drops.begin(); It != m_Drops.end(); ++It)
+		pvDrops->push_back(It->second);
+	std::sort(pvDrops->begin(), pvDrops->end(), [](const CDrop &a, const CDrop &b) { return a.m_ID < b.m_ID; });
+
+	return NumSnapshot >= 0 || NumOld >= 0 || NumJournal >= 0;
+}
+
+void CMoneyJournal::Close()
+{
+	if (m_pCompactJob)
+		FinishCompaction(true);
+	if (m_JournalFile)
+	{
+		io_close(m_JournalFile);
+		m_JournalFile = 0;
+	}
+	m_Dirty = false;
+}
+
+void CMoneyJournal::Append(const CRecord &Record)
+{
+	Apply(Record);
+	m_NumRecords++;
+	if (!m_JournalFile)
+		return;
+
+	if (io_write(m_JournalFile, &Record, sizeof(Record)) != sizeof(Record))
+		dbg_msg("money", "failed to write to journal '%s'", m_aJournalFile);
+	m_Dirty = true;
+}
+
+void CMoneyJournal::Update()
+{
+	if (m_Dirty)
+	{
+		io_flush(m_JournalFile);
+		m_Dirty = false;
+	}
+
+	if (m_pCompactJob)
+		FinishCompaction(false);
+	else if (m_JournalFile && !m_CompactFailed && m_NumRecords > Num() * 2 + MIN_COMPACT_RECORDS)
+		StartCompaction();
+}
+
+void CMoneyJournal::StartCompaction()
+{
+	// the journal so far becomes the old journal, the new snapshot replaces it once it's written
+	io_close(m_JournalFile);
+	m_JournalFile = 0;
+	if (fs_rename(m_aJournalFile, m_aOldJournalFile) != 0)
+	{
+		dbg_msg("money", "failed to rotate journal '%s'", m_aJournalFile);
+		m_CompactFailed = true;
+		OpenJournal(false);
+		return;
+	}
+	if (!OpenJournal(true))
+		dbg_msg("money", "failed to open journal '%s'", m_aJournalFile);
+
+	m_pCompactJob = new CCompactJob();
+	str_copy(m_pCompactJob->m_aSnapshotFile, m_aSnapshotFile, sizeof(m_pCompactJob->m_aSnapshotFile));
+	str_copy(m_pCompactJob->m_aOldJournalFile, m_aOldJournalFile, sizeof(m_pCompactJob->m_aOldJournalFile));
+	GetSnapshot(&m_pCompactJob->m_vRecords);
+	m_pCompactJob->m_Success = false;
+	m_pCompactJob->m_Done = false;
+	m_pCompactThread = thread_init(CompactThread, m_pCompactJob, "money journal");
+	m_NumRecords = m_Drops.size();
+}
+
+void CMoneyJournal::FinishCompaction(bool Wait)
+{
+	if (!Wait && !m_pCompactJob->m_Done)
+		return;
+
+	thread_wait(m_pCompactThread);
+	if (!m_pCompactJob->m_Success)
+	{
+		// the old journal stays until the next load, rotating again would overwrite it
+		dbg_msg("money", "failed to write snapshot '%s'", m_aSnapshotFile);
+		m_CompactFailed = true;
+	}
+	delete m_pCompactJob;
+	m_pCompactJob = 0;
+	m_pCompactThread = 0;
+}
+
+void CMoneyJournal::CompactThread(void *pUser)
+{
+	CCompactJob *pJob = (CCompactJob *)pUser;
+	pJob->m_Success = WriteSnapshot(pJob->m_aSnapshotFile, pJob->m_vRecords);
+	if (pJob->m_Success)
+		fs_remove(pJob->m_aOldJournalFile);
+	pJob->m_Done = true;
+}
+
+bool CMoneyJournal::WriteSnapshot(const char *pFilename, const std::vector<CRecord> &vRecords)
+{
+	char aTmpFile[IO_MAX_PATH_LENGTH];
+	str_format(aTmpFile, sizeof(aTmpFile), "%s.tmp", pFilename);
+	IOHANDLE File = io_open(aTmpFile, IOFLAG_WRITE);
+	if (!File)
+		return false;
+
+	CJournalHeader Header;
+	mem_copy(Header.m_aMagic, s_aJournalMagic, sizeof(s_aJournalMagic));
+	Header.m_Version = JOURNAL_VERSION;
+	Header.m_RecordSize = sizeof(CRecord);
+	bool Success = io_write(File, &Header, sizeof(Header)) == sizeof(Header);
+	if (Success && vRecords.size())
+		Success = io_write(File, &vRecords[0], sizeof(CRecord) * vRecords.size()) == sizeof(CRecord) * vRecords.size();
+	io_close(File);
+
+	if (!Success)
+	{
+		fs_remove(aTmpFile);
+		return false;
+	}
+
+	if (fs_rename(aTmpFile, pFilename) != 0)
+	{
+		fs_remove(pFilename);
+		if (fs_rename(aTmpFile, pFilename) != 0)
+			return false;
+	}
+	return true;
+}
+
+int CMoneyJournal::Create(vec2 Pos, int64 Amount)
+{
+	CRecord Record;
+	mem_zero(&Record, sizeof(Record));
+	Record.m_Op = JOURNAL_CREATE;
+	Record.m_ID = m_NextID;
+	Record.m_X = Pos.x;
+	Record.m_Y = Pos.y;
+	Record.m_Amount = Amount;
+	Append(Record);
+	return Record.m_ID;
+}
+
+void CMoneyJournal::Move(int ID, vec2 Pos)
+{
+	std::unordered_map<int, CDrop>::iterator It = m_Drops.find(ID);
+	if (It == m_Drops.end() || distance(It->second.m_Pos, Pos) < 1.0f)
+		return;
+
+	CRecord Record;
+	mem_zero(&Record, sizeof(Record));
+	Record.m_Op = JOURNAL_MOVE;
+	Record.m_ID = ID;
+	Record.m_X = Pos.x;
+	Record.m_Y = Pos.y;
+	Append(Record);
+}
+
+void CMoneyJournal::Merge(int ID, int OtherID, int64 Amount)
+{
+	CRecord Record;
+	mem_zero(&Record, sizeof(Record));
+	Record.m_Op = JOURNAL_MERGE;
+	Record.m_ID = ID;
+	Record.m_OtherID = OtherID;
+	Record.m_Amount = Amount;
+	Append(Record);
+}
+
+void CMoneyJournal::Remove(int ID)
+{
+	if (m_Drops.find(ID) == m_Drops.end())
+		return;
+
+	CRecord Record;
+	mem_zero(&Record, sizeof(Record));
+	Record.m_Op = JOURNAL_REMOVE;
+	Record.m_ID = ID;
+	Append(Record);
+}
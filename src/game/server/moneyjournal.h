@@ -0,0 +1,106 @@
+#ifndef GAME_SERVER_MONEYJOURNAL_H
+#define GAME_SERVER_MONEYJOURNAL_H
+
+#include <base/system.h>
+#include <base/vmath.h>
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+// money drops of a map, persisted as a snapshot file plus an append-only journal of the changes since then. so the
+// game thread only ever writes what changed, and once the journal grew too long the current drops are written into a
+// new snapshot on a background thread. every record sets absolute values, so replaying a journal over a newer snapshot
+// after a crash mid compaction ends up with the same drops
+class CMoneyJournal
+{
+public:
+	struct CDrop
+	{
+		int m_ID;
+		vec2 m_Pos;
+		int64 m_Amount;
+	};
+
+private:
+	enum
+	{
+		JOURNAL_VERSION = 1,
+		JOURNAL_CREATE = 1,
+		JOURNAL_MOVE,
+		JOURNAL_MERGE,
+		JOURNAL_REMOVE,
+
+		// compact when the journal has that many more records than drops
+		MIN_COMPACT_RECORDS = 256,
+	};
+
+	struct CRecord
+	{
+		int m_Op;
+		int m_ID;
+		int m_OtherID;
+		float m_X;
+		float m_Y;
+		int64 m_Amount;
+	};
+
+	struct CCompactJob
+	{
+		char m_aSnapshotFile[IO_MAX_PATH_LENGTH];
+		char m_aOldJournalFile[IO_MAX_PATH_LENGTH];
+		std::vector<CRecord> m_vRecords;
+		bool m_Success;
+		std::atomic<bool> m_Done;
+	};
+
+	std::unordered_map<int, CDrop> m_Drops;
+	int m_NextID;
+
+	char m_aSnapshotFile[IO_MAX_PATH_LENGTH];
+	char m_aJournalFile[IO_MAX_PATH_LENGTH];
+	char m_aOldJournalFile[IO_MAX_PATH_LENGTH];
+	IOHANDLE m_JournalFile;
+	int m_NumRecords; // since the last snapshot
+	bool m_Dirty;
+	bool m_CompactFailed;
+
+	CCompactJob *m_pCompactJob;
+	void *m_pCompactThread;
+
+	void Apply(const CRecord &Record);
+	int Replay(const char *pFilename, bool *pTorn);
+	void GetSnapshot(std::vector<CRecord> *pvRecords) const;
+	void Append(const CRecord &Record);
+	bool OpenJournal(bool Truncate);
+	void StartCompaction();
+	void FinishCompaction(bool Wait);
+
+	static bool WriteSnapshot(const char *pFilename, const std::vector<CRecord> &vRecords);
+	static void CompactThread(void *pUser);
+
+public:
+	CMoneyJournal();
+	~CMoneyJournal();
+
+	// reads the snapshot and the journals at pPath + ".snapshot"/".journal", returns false if none of them existed.
+	// further changes go to that journal either way
+	bool Load(const char *pPath, std::vector<CDrop> *pvDrops);
+	// waits for a running compaction and stops journaling
+	void Close();
+
+	// flushes the changes of this tick and starts or finishes a compaction
+	void Update();
+	bool IsCompacting() const { return m_pCompactJob != 0; }
+
+	int Create(vec2 Pos, int64 Amount);
+	// positions only get journaled once a drop came to rest, small shifts are ignored
+	void Move(int ID, vec2 Pos);
+	void Merge(int ID, int OtherID, int64 Amount);
+	void Remove(int ID);
+
+	int Num() const { return m_Drops.size(); }
+	int NumRecords() const { return m_NumRecords; }
+};
+
+#endif // GAME_SERVER_MONEYJOURNAL_H
@@ -178,6 +178,7 @@ void CPlayer::Reset()
 		m_aMuted[i] = false;
 	}
 
+	m_CurrentHouse = -1;
 	for (int i = 0; i < NUM_HOUSES; i++)
 		if (GameServer()->m_pHouses[i]) // if a bot is created by a tile the shops are not yet created
 			GameServer()->m_pHouses[i]->Reset(m_ClientID);
@@ -336,8 +337,8 @@ void CPlayer::Tick()
 	{
 		if (m_PlayerFlags&PLAYERFLAG_SCOREBOARD)
 		{
-			for (int i = 0; i < NUM_HOUSES; i++)
-				GameServer()->m_pHouses[i]->ResetLastMotd(m_ClientID);
+			if (GetCurrentHouse())
+				GetCurrentHouse()->ResetLastMotd(m_ClientID);
 		}
 		else
 			m_pCharacter->m_TabDoubleClickCount = 0;
@@ -1168,6 +1169,11 @@ CCharacter *CPlayer::GetCharacter()
 	return 0;
 }
 
+CHouse *CPlayer::GetCurrentHouse()
+{
+	return m_CurrentHouse >= 0 ? GameServer()->m_pHouses[m_CurrentHouse] : 0;
+}
+
 void CPlayer::ThreadKillCharacter(int Weapon)
 {
 	m_KillMe = Weapon;
@@ -1198,6 +1204,7 @@ CCharacter* CPlayer::ForceSpawn(vec2 Pos)
 	m_pCharacter = new(m_ClientID) CCharacter(&GameServer()->m_World);
 	m_pCharacter->Spawn(this, Pos);
 	m_Team = 0;
+	GameServer()->VoteCountUpdateTeam(m_ClientID);
 	return m_pCharacter;
 }
 
@@ -340,6 +340,10 @@ public:
 	//room key
 	bool m_HasRoomKey;
 
+	// house the character stands in, updated once per character tick
+	int m_CurrentHouse;
+	class CHouse *GetCurrentHouse();
+
 	//score
 	int m_ScoreMode;
 	int m_InstagibScore;
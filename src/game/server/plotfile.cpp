@@ -0,0 +1,289 @@
+#include "plotfile.h"
+#include "gameworld.h"
+
+#include <generated/protocol.h>
+
+#include <stdio.h>
+
+static const char s_aPlotMagic[4] = {'F', 'D', 'P', 'L'};
+
+enum
+{
+	// ints following the magic and the two name strings
+	HEADER_VERSION = 0,
+	HEADER_EXPIRE_LOW,
+	HEADER_EXPIRE_HIGH,
+	HEADER_DOOR_STATUS,
+	HEADER_NUM_TYPES,
+	HEADER_NUM_OBJECTS,
+	NUM_HEADER_INTS,
+
+	OBJECT_TYPE = 0,
+	OBJECT_POS_X,
+	OBJECT_POS_Y,
+	OBJECT_ROTATION,
+	OBJECT_ARGS,
+	NUM_OBJECT_INTS = OBJECT_ARGS + CPlotFile::NUM_OBJECT_ARGS,
+
+	NAME_SIZE = 32,
+	STRINGS_SIZE = sizeof(s_aPlotMagic) + NAME_SIZE * 2,
+};
+
+static int FloatToInt(float Value)
+{
+	int Result;
+	mem_copy(&Result, &Value, sizeof(Result));
+	return Result;
+}
+
+static float IntToFloat(int Value)
+{
+	float Result;
+	mem_copy(&Result, &Value, sizeof(Result));
+	return Result;
+}
+
+bool CPlotFile::Save(const char *pFilename, const CInfo *pInfo, const std::vector<CObject> &vObjects)
+{
+	// object type counts, so readers know what to expect before going through the records
+	std::vector<int> vTypeCounts;
+	for(unsigned i = 0; i < vObjects.size(); i++)
+	{
+		unsigned j = 0;
+		for(; j < vTypeCounts.size(); j += 2)
+			if(vTypeCounts[j] == vObjects[i].m_Type)
+				break;
+		if(j == vTypeCounts.size())
+		{
+			vTypeCounts.push_back(vObjects[i].m_Type);
+			vTypeCounts.push_back(0);
+		}
+		vTypeCounts[j + 1]++;
+	}
+
+	int NumInts = NUM_HEADER_INTS + vTypeCounts.size() + vObjects.size() * NUM_OBJECT_INTS;
+	std::vector<int> vData(NumInts);
+	int *pData = &vData[0];
+
+	pData[HEADER_VERSION] = VERSION;
+	pData[HEADER_EXPIRE_LOW] = pInfo ? (int)(pInfo->m_ExpireDate & 0xffffffff) : 0;
+	pData[HEADER_EXPIRE_HIGH] = pInfo ? (int)(pInfo->m_ExpireDate >> 32) : 0;
+	pData[HEADER_DOOR_STATUS] = pInfo ? pInfo->m_DoorStatus : 0;
+	pData[HEADER_NUM_TYPES] = vTypeCounts.size() / 2;
+	pData[HEADER_NUM_OBJECTS] = vObjects.size();
+	pData += NUM_HEADER_INTS;
+
+	for(unsigned i = 0; i < vTypeCounts.size(); i++)
+		*pData++ = vTypeCounts[i];
+
+	for(unsigned i = 0; i < vObjects.size(); i++)
+	{
+		const CObject *pObj = &vObjects[i];
+		pData[OBJECT_TYPE] = pObj->m_Type;
+		pData[OBJECT_POS_X] = FloatToInt(pObj->m_Pos.x);
+		pData[OBJECT_POS_Y] = FloatToInt(pObj->m_Pos.y);
+		pData[OBJECT_ROTATION] = FloatToInt(pObj->m_Rotation);
+		for(int a = 0; a < NUM_OBJECT_ARGS; a++)
+			pData[OBJECT_ARGS + a] = pObj->m_aArgs[a];
+		pData += NUM_OBJECT_INTS;
+	}
+
+#if defined(CONF_ARCH_ENDIAN_BIG)
+	swap_endian(&vData[0], sizeof(int), NumInts);
+#endif
+
+	char aStrings[STRINGS_SIZE];
+	mem_zero(aStrings, sizeof(aStrings));
+	mem_copy(aStrings, s_aPlotMagic, sizeof(s_aPlotMagic));
+	if(pInfo)
+	{
+		str_copy(aStrings + sizeof(s_aPlotMagic), pInfo->m_aOwner, NAME_SIZE);
+		str_copy(aStrings + sizeof(s_aPlotMagic) + NAME_SIZE, pInfo->m_aDisplayName, NAME_SIZE);
+	}
+
+	IOHANDLE File = io_open(pFilename, IOFLAG_WRITE);
+	if(!File)
+		return false;
+
+	bool Success = io_write(File, aStrings, sizeof(aStrings)) == sizeof(aStrings)
+		&& io_write(File, &vData[0], NumInts * sizeof(int)) == NumInts * sizeof(int);
+	io_close(File);
+	return Success;
+}
+
+int CPlotFile::Load(const char *pFilename, CInfo *pInfo, std::vector<CObject> *pvObjects)
+{
+	IOHANDLE File = io_open(pFilename, IOFLAG_READ);
+	if(!File)
+		return LOAD_FAILED;
+
+	long Length = io_length(File);
+	if(Length < 0)
+	{
+		io_close(File);
+		return LOAD_FAILED;
+	}
+	std::vector<char> vBuf(Length + 1);
+	Length = io_read(File, &vBuf[0], Length);
+	vBuf[Length] = 0;
+	io_close(File);
+
+	if(pInfo)
+	{
+		mem_zero(pInfo, sizeof(*pInfo));
+	}
+
+	if(Length < (long)sizeof(s_aPlotMagic) || mem_comp(&vBuf[0], s_aPlotMagic, sizeof(s_aPlotMagic)) != 0)
+	{
+		// old text file, a plot has four info lines before the objects, a preset only the objects
+		char *pLine = &vBuf[0];
+		for(int i = 0; pInfo && i < 4 && pLine; i++)
+		{
+			char *pEnd = (char *)str_find(pLine, "\n");
+			if(pEnd)
+				*pEnd = 0;
+
+			switch(i)
+			{
+			case 0: str_copy(pInfo->m_aOwner, pLine, sizeof(pInfo->m_aOwner)); break;
+			case 1: str_copy(pInfo->m_aDisplayName, pLine, sizeof(pInfo->m_aDisplayName)); break;
+			case 2: pInfo->m_ExpireDate = str_toint(pLine); break;
+			case 3: pInfo->m_DoorStatus = str_toint(pLine); break;
+			}
+			pLine = pEnd ? pEnd + 1 : 0;
+		}
+		if(pLine)
+			ParseTextObjects(pLine, pvObjects);
+		return LOAD_TEXT;
+	}
+
+	if(Length < STRINGS_SIZE + NUM_HEADER_INTS * (long)sizeof(int))
+		return LOAD_FAILED;
+
+	int NumInts = (Length - STRINGS_SIZE) / sizeof(int);
+	std::vector<int> vData(NumInts);
+	mem_copy(&vData[0], &vBuf[STRINGS_SIZE], NumInts * sizeof(int));
+#if defined(CONF_ARCH_ENDIAN_BIG)
+	swap_endian(&vData[0], sizeof(int), NumInts);
+#endif
+	const int *pData = &vData[0];
+
+	int NumTypes = pData[HEADER_NUM_TYPES];
+	int NumObjects = pData[HEADER_NUM_OBJECTS];
+	if(pData[HEADER_VERSION] != VERSION || NumTypes < 0 || NumObjects < 0
+		|| NUM_HEADER_INTS + NumTypes * 2 + (int64)NumObjects * NUM_OBJECT_INTS > NumInts)
+		return LOAD_FAILED;
+
+	if(pInfo)
+	{
+		str_copy(pInfo->m_aOwner, &vBuf[sizeof(s_aPlotMagic)], NAME_SIZE);
+		str_copy(pInfo->m_aDisplayName, &vBuf[sizeof(s_aPlotMagic) + NAME_SIZE], NAME_SIZE);
+		pInfo->m_ExpireDate = ((int64)pData[HEADER_EXPIRE_HIGH] << 32) | (unsigned)pData[HEADER_EXPIRE_LOW];
+		pInfo->m_DoorStatus = pData[HEADER_DOOR_STATUS];
+	}
+
+	// type counts are only needed by readers that want to skip types, we take the records as they are
+	pData += NUM_HEADER_INTS + NumTypes * 2;
+
+	pvObjects->reserve(pvObjects->size() + NumObjects);
+	for(int i = 0; i < NumObjects; i++)
+	{
+		CObject Obj;
+		Obj.m_Type = pData[OBJECT_TYPE];
+		Obj.m_Pos = vec2(IntToFloat(pData[OBJECT_POS_X]), IntToFloat(pData[OBJECT_POS_Y]));
+		Obj.m_Rotation = IntToFloat(pData[OBJECT_ROTATION]);
+		for(int a = 0; a < NUM_OBJECT_ARGS; a++)
+			Obj.m_aArgs[a] = pData[OBJECT_ARGS + a];
+		pvObjects->push_back(Obj);
+		pData += NUM_OBJECT_INTS;
+	}
+
+	return LOAD_BINARY;
+}
+
+void CPlotFile::ParseTextObjects(const char *pLine, std::vector<CObject> *pvObjects)
+{
+	const char *pData = pLine;
+	while(pData && *pData && *pData != '\n')
+	{
+		CObject Obj;
+		mem_zero(&Obj, sizeof(Obj));
+		Obj.m_Type = -1;
+		for(int a = 0; a < NUM_OBJECT_ARGS; a++)
+			Obj.m_aArgs[a] = -1;
+
+		int *pArgs = Obj.m_aArgs;
+		int Num = 0;
+		sscanf(pData, "%d", &Obj.m_Type);
+		switch(Obj.m_Type)
+		{
+		case CGameWorld::ENTTYPE_PICKUP:
+			// type, subtype
+			Num = sscanf(pData, "%d:%f/%f:%d:%d", &Obj.m_Type, &Obj.m_Pos.x, &Obj.m_Pos.y, &pArgs[0], &pArgs[1]);
+			break;
+		case CGameWorld::ENTTYPE_DOOR:
+			// length, collision, thickness, number, status, color
+			pArgs[5] = LASERTYPE_DOOR;
+			Obj.m_Rotation = -1.f;
+			Num = sscanf(pData, "%d:%f/%f:%f:%d:%d:%d:%d:%d:%d", &Obj.m_Type, &Obj.m_Pos.x, &Obj.m_Pos.y, &Obj.m_Rotation, &pArgs[0], &pArgs[1], &pArgs[2], &pArgs[3], &pArgs[4], &pArgs[5]);
+			break;
+		case CGameWorld::ENTTYPE_BUTTON:
+			// number
+			Num = sscanf(pData, "%d:%f/%f:%d", &Obj.m_Type, &Obj.m_Pos.x, &Obj.m_Pos.y, &pArgs[0]);
+			break;
+		case CGameWorld::ENTTYPE_SPEEDUP:
+			// angle, force, max speed
+			Num = sscanf(pData, "%d:%f/%f:%d:%d:%d", &Obj.m_Type, &Obj.m_Pos.x, &Obj.m_Pos.y, &pArgs[0], &pArgs[1], &pArgs[2]);
+			break;
+		case CGameWorld::ENTTYPE_TELEPORTER:
+			// type, number
+			pArgs[0] = 0;
+			Num = sscanf(pData, "%d:%f/%f:%d:%d", &Obj.m_Type, &Obj.m_Pos.x, &Obj.m_Pos.y, &pArgs[0], &pArgs[1]);
+			break;
+		}
+
+		// text files store tile positions
+		if(Num >= 3)
+		{
+			Obj.m_Pos *= 32.f;
+			pvObjects->push_back(Obj);
+		}
+
+		// jump to next comma, if it exists skip it so we can start the next loop run with the next data
+		if((pData = str_find(pData, ",")))
+			pData++;
+	}
+}
+
+const std::vector<CPlotFile::CObject> *CPlotPresetCache::Find(const char *pName)
+{
+	for(std::list<CEntry>::iterator It = m_lEntries.begin(); It != m_lEntries.end(); ++It)
+	{
+		if(It->m_Name == pName)
+		{
+			// move to the front, the back is dropped first
+			m_lEntries.splice(m_lEntries.begin(), m_lEntries, It);
+			return &m_lEntries.front().m_vObjects;
+		}
+	}
+	return 0;
+}
+
+void CPlotPresetCache::Add(const char *pName, const std::vector<CPlotFile::CObject> &vObjects)
+{
+	for(std::list<CEntry>::iterator It = m_lEntries.begin(); It != m_lEntries.end(); ++It)
+	{
+		if(It->m_Name == pName)
+		{
+			m_lEntries.erase(It);
+			break;
+		}
+	}
+
+	CEntry Entry;
+	Entry.m_Name = pName;
+	Entry.m_vObjects = vObjects;
+	m_lEntries.push_front(Entry);
+	while(m_lEntries.size() > m_MaxEntries)
+		m_lEntries.pop_back();
+}
@@ -0,0 +1,73 @@
+#ifndef GAME_SERVER_PLOTFILE_H
+#define GAME_SERVER_PLOTFILE_H
+
+#include <base/system.h>
+#include <base/vmath.h>
+
+#include <list>
+#include <string>
+#include <vector>
+
+// plot and preset files, stored as a versioned binary blob. old text files are still read so they can be migrated
+class CPlotFile
+{
+public:
+	enum
+	{
+		VERSION = 1,
+		NUM_OBJECT_ARGS = 6,
+	};
+
+	// plain data of a plot object, the meaning of the args depends on the entity type
+	struct CObject
+	{
+		int m_Type;
+		vec2 m_Pos;
+		float m_Rotation;
+		int m_aArgs[NUM_OBJECT_ARGS];
+	};
+
+	struct CInfo
+	{
+		char m_aOwner[32];
+		char m_aDisplayName[32];
+		int64 m_ExpireDate;
+		int m_DoorStatus;
+	};
+
+	enum
+	{
+		LOAD_FAILED = 0,
+		LOAD_BINARY,
+		LOAD_TEXT,
+	};
+
+	// pInfo can be 0 for presets, which only consist of objects
+	static bool Save(const char *pFilename, const CInfo *pInfo, const std::vector<CObject> &vObjects);
+	static int Load(const char *pFilename, CInfo *pInfo, std::vector<CObject> *pvObjects);
+
+	// old comma separated text format
+	static void ParseTextObjects(const char *pLine, std::vector<CObject> *pvObjects);
+};
+
+// keeps the decoded objects of the most recently used presets
+class CPlotPresetCache
+{
+	struct CEntry
+	{
+		std::string m_Name;
+		std::vector<CPlotFile::CObject> m_vObjects;
+	};
+	std::list<CEntry> m_lEntries;
+	unsigned m_MaxEntries;
+
+public:
+	CPlotPresetCache(unsigned MaxEntries = 16) { m_MaxEntries = MaxEntries; }
+
+	const std::vector<CPlotFile::CObject> *Find(const char *pName);
+	void Add(const char *pName, const std::vector<CPlotFile::CObject> &vObjects);
+	void Clear() { m_lEntries.clear(); }
+	unsigned Size() const { return m_lEntries.size(); }
+};
+
+#endif // GAME_SERVER_PLOTFILE_H
@@ -0,0 +1,76 @@
+#include "plotownerindex.h"
+
+size_t CPlotOwnerIndex::CAddrHash::operator()(const NETADDR &Addr) const
+{
+	// fnv-1a over type and ip, the port is not part of the key
+	unsigned Hash = 2166136261u ^ Addr.type;
+	Hash *= 16777619u;
+	int Size = Addr.type == NETTYPE_IPV4 ? NETADDR_SIZE_IPV4 : NETADDR_SIZE_IPV6;
+	for(int i = 0; i < Size; i++)
+	{
+		Hash ^= Addr.ip[i];
+		Hash *= 16777619u;
+	}
+	return Hash;
+}
+
+void CPlotOwnerIndex::Clear()
+{
+	m_vOwners.clear();
+	m_NumPlots.clear();
+}
+
+void CPlotOwnerIndex::AddAddr(COwner *pOwner, const NETADDR *pAddr)
+{
+	if(!pAddr || (pAddr->type != NETTYPE_IPV4 && pAddr->type != NETTYPE_IPV6))
+		return;
+
+	// current and last address can be the same with a different port
+	for(int i = 0; i < pOwner->m_NumAddrs; i++)
+		if(net_addr_comp(&pOwner->m_aAddr[i], pAddr, false) == 0)
+			return;
+
+	NETADDR Addr = *pAddr;
+	Addr.port = 0;
+	Addr.reserved = 0;
+	pOwner->m_aAddr[pOwner->m_NumAddrs++] = Addr;
+	m_NumPlots[Addr]++;
+}
+
+void CPlotOwnerIndex::SetOwner(int PlotID, const NETADDR *pAddr, const NETADDR *pLastAddr)
+{
+	if(PlotID < 0)
+		return;
+
+	RemoveOwner(PlotID);
+	if(PlotID >= (int)m_vOwners.size())
+	{
+		COwner Empty;
+		Empty.m_NumAddrs = 0;
+		m_vOwners.resize(PlotID + 1, Empty);
+	}
+
+	AddAddr(&m_vOwners[PlotID], pAddr);
+	AddAddr(&m_vOwners[PlotID], pLastAddr);
+}
+
+void CPlotOwnerIndex::RemoveOwner(int PlotID)
+{
+	if(PlotID < 0 || PlotID >= (int)m_vOwners.size())
+		return;
+
+	COwner *pOwner = &m_vOwners[PlotID];
+	for(int i = 0; i < pOwner->m_NumAddrs; i++)
+	{
+		auto It = m_NumPlots.find(pOwner->m_aAddr[i]);
+		if(It != m_NumPlots.end() && --It->second <= 0)
+			m_NumPlots.erase(It);
+	}
+	pOwner->m_NumAddrs = 0;
+}
+
+int CPlotOwnerIndex::NumPlots(const NETADDR *pAddr) const
+{
+	auto It = m_NumPlots.find(*pAddr);
+	return It == m_NumPlots.end() ? 0 : It->second;
+}
@@ -0,0 +1,48 @@
+#ifndef GAME_SERVER_PLOTOWNERINDEX_H
+#define GAME_SERVER_PLOTOWNERINDEX_H
+
+#include <base/system.h>
+
+#include <unordered_map>
+#include <vector>
+
+// remembers the current and last address of each plot owner, so that plot lookups by address
+// don't have to load the owner accounts from disk
+class CPlotOwnerIndex
+{
+	enum
+	{
+		NUM_OWNER_ADDRS = 2,
+	};
+
+	struct COwner
+	{
+		NETADDR m_aAddr[NUM_OWNER_ADDRS];
+		int m_NumAddrs;
+	};
+
+	struct CAddrHash
+	{
+		size_t operator()(const NETADDR &Addr) const;
+	};
+
+	struct CAddrEqual
+	{
+		bool operator()(const NETADDR &Addr1, const NETADDR &Addr2) const { return net_addr_comp(&Addr1, &Addr2, false) == 0; }
+	};
+
+	std::vector<COwner> m_vOwners;
+	std::unordered_map<NETADDR, int, CAddrHash, CAddrEqual> m_NumPlots;
+
+	void AddAddr(COwner *pOwner, const NETADDR *pAddr);
+
+public:
+	void Clear();
+	// pAddr and pLastAddr can be unset (NETTYPE_INVALID or -1), they are ignored then
+	void SetOwner(int PlotID, const NETADDR *pAddr, const NETADDR *pLastAddr);
+	void RemoveOwner(int PlotID);
+	int NumPlots(const NETADDR *pAddr) const;
+	bool HasPlot(const NETADDR *pAddr) const { return NumPlots(pAddr) > 0; }
+};
+
+#endif // GAME_SERVER_PLOTOWNERINDEX_H
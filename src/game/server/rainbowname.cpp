@@ -17,8 +17,11 @@ void CRainbowName::Init(CGameContext *pGameServer)
 	{
 		m_aInfo[i].m_UpdateTeams = false;
 		m_aInfo[i].m_ResetChatColor = false;
-		mem_zero(&m_aInfo[i].m_aTeam, sizeof(m_aInfo[i].m_aTeam));
+		for (int j = 0; j < VANILLA_MAX_CLIENTS; j++)
+			m_aInfo[i].m_aTeam[j] = -1;
+		m_aInfo[i].m_ColoredIDs = 0;
 	}
+	m_NumRainbow = 0;
 }
 
 void CRainbowName::OnChatMessage(int ClientID)
@@ -46,6 +49,27 @@ void CRainbowName::Tick()
 
 	m_Color = m_Color % (VANILLA_MAX_CLIENTS-1) + 1;
 
+	// collect the rainbow names once and who can see them, instead of checking every pair of players
+	Mask128 Candidates = CmaskNone();
+	m_NumRainbow = 0;
+	for (int i = 0; i < MAX_CLIENTS; i++)
+	{
+		CPlayer *pPlayer = GameServer()->m_apPlayers[i];
+		if (!pPlayer || !pPlayer->m_RainbowName)
+			continue;
+
+		m_aRainbowIDs[m_NumRainbow++] = i;
+		m_aInRange[i] = CmaskNone();
+		CCharacter *pChr = pPlayer->GetCharacter();
+		if (pChr)
+		{
+			for (int j = 0; j < MAX_CLIENTS; j++)
+				if (GameServer()->m_apPlayers[j] && pChr->CanSnapCharacter(j) && !pChr->NetworkClipped(j))
+					m_aInRange[i] |= CmaskOne(j);
+		}
+		Candidates |= m_aInfo[i].m_ResetChatColor ? CmaskAll() : m_aInRange[i];
+	}
+
 	for (int i = 0; i < MAX_CLIENTS; i++)
 	{
 		if (!GameServer()->m_apPlayers[i])
@@ -53,15 +77,20 @@ void CRainbowName::Tick()
 		if (Server()->IsSevendown(i) && GameServer()->GetClientDDNetVersion(i) < VERSION_DDNET_SUPER_PREDICTION)
 			continue;
 
+		// nothing to color, nothing to reset and nothing to send
+		SInfo *pInfo = &m_aInfo[i];
+		if (!CmaskIsSet(Candidates, i) && !pInfo->m_UpdateTeams && !pInfo->m_ColoredIDs && !pInfo->m_ResetChatColor)
+			continue;
+
 		// reset everything, keep track whether we had an update last run, so after that we update one more time
-		bool UpdatedLastRun = m_aInfo[i].m_UpdateTeams;
-		m_aInfo[i].m_UpdateTeams = false;
+		bool UpdatedLastRun = pInfo->m_UpdateTeams;
+		pInfo->m_UpdateTeams = false;
 
 		// process rainbow name
 		Update(i);
 
 		// send and enjoy
-		if (m_aInfo[i].m_UpdateTeams || UpdatedLastRun)
+		if (pInfo->m_UpdateTeams || UpdatedLastRun)
 			((CGameControllerDDRace *)GameServer()->m_pController)->m_Teams.SendTeamsState(i);
 	}
 
@@ -81,34 +110,26 @@ void CRainbowName::Update(int ClientID)
 		OwnMapID = -1;
 
 	SInfo *pInfo = &m_aInfo[ClientID];
-	if (OwnMapID != -1)
-		pInfo->m_aTeam[OwnMapID] = -1; // reset ourselves here so we dont override reset us when our id is greater than another and we got processed already
+	for (int i = 0; i < VANILLA_MAX_CLIENTS; i++)
+		if (pInfo->m_ColoredIDs & ((uint64_t)1<<i))
+			pInfo->m_aTeam[i] = -1;
+	pInfo->m_ColoredIDs = 0;
 
 	int DummyID = Server()->GetDummy(ClientID);
 	CTeamsCore *pCore = &((CGameControllerDDRace *)GameServer()->m_pController)->m_Teams.m_Core;
 
-	for (int i = 0; i < VANILLA_MAX_CLIENTS; i++)
+	for (int r = 0; r < m_NumRainbow && !(pPlayer->m_PlayerFlags&PLAYERFLAG_SCOREBOARD); r++)
 	{
-		if (i == OwnMapID)
-			continue;
-
-		pInfo->m_aTeam[i] = -1;
-
-		if (pPlayer->m_PlayerFlags&PLAYERFLAG_SCOREBOARD)
+		int ID = m_aRainbowIDs[r];
+		int MapID = ID;
+		if (!Server()->Translate(MapID, ClientID) || MapID == OwnMapID)
 			continue;
 
-		int ID = i;
-		if (!Server()->ReverseTranslate(ID, ClientID))
-			continue;
-
-		CPlayer *pOther = GameServer()->m_apPlayers[ID];
-		if (!pOther || !pOther->m_RainbowName)
-			continue;
-
-		bool InRange = pOther->GetCharacter() && pOther->GetCharacter()->CanSnapCharacter(ClientID) && !pOther->GetCharacter()->NetworkClipped(ClientID);
+		bool InRange = CmaskIsSet(m_aInRange[ID], ClientID);
 		if (InRange || m_aInfo[ID].m_ResetChatColor)
 		{
-			pInfo->m_aTeam[i] = m_Color;
+			pInfo->m_aTeam[MapID] = m_Color;
+			pInfo->m_ColoredIDs |= (uint64_t)1<<MapID;
 			pInfo->m_UpdateTeams = true;
 		}
 
@@ -118,13 +139,17 @@ void CRainbowName::Update(int ClientID)
 		int SpectatorID = pPlayer->GetSpectatorID();
 		bool NoSpecOrFollow = (pPlayer->GetTeam() != TEAM_SPECTATORS && !pPlayer->IsPaused()) || (SpectatorID != -1 && GameServer()->m_apPlayers[SpectatorID]);
 		if (NoSpecOrFollow)
+		{
 			pInfo->m_aTeam[OwnMapID] = VANILLA_MAX_CLIENTS; // TEAM_SUPER, but it's 128 due to increased client capability
+			pInfo->m_ColoredIDs |= (uint64_t)1<<OwnMapID;
+		}
 	}
 
 	// if a player close to a rainbow name player sent a chat message, we send himself to t0 for one run, cuz that resets the chat color from TEAM_SUPER to grey
 	if (pInfo->m_ResetChatColor && OwnMapID != -1)
 	{
 		pInfo->m_aTeam[OwnMapID] = pPlayer->m_RainbowName ? m_Color : pCore->Team(ClientID);
+		pInfo->m_ColoredIDs |= (uint64_t)1<<OwnMapID;
 		pInfo->m_UpdateTeams = true;
 	}
 
@@ -6,6 +6,10 @@
 #include <engine/shared/protocol.h>
 #include <generated/protocol.h>
 
+#include <stdint.h>
+
+#include "mask128.h"
+
 class CGameContext;
 class IServer;
 
@@ -22,8 +26,15 @@ class CRainbowName
 		bool m_UpdateTeams;
 		bool m_ResetChatColor;
 		int m_aTeam[VANILLA_MAX_CLIENTS];
+		// map ids with m_aTeam != -1, so only those have to be reset
+		uint64_t m_ColoredIDs;
 	} m_aInfo[MAX_CLIENTS];
 
+	// players with rainbow name this run and the clients that can see each of them
+	int m_aRainbowIDs[MAX_CLIENTS];
+	int m_NumRainbow;
+	Mask128 m_aInRange[MAX_CLIENTS];
+
 	void Update(int ClientID);
 
 public:
@@ -220,7 +220,7 @@ void CSaveTee::Save(CCharacter *pChr)
 	{
 		int Index = pChr->GameServer()->FindSavedPlayer(pChr->GetPlayer()->GetCID());
 		if (Index != -1)
-			m_Identity = pChr->GameServer()->m_vSavedIdentities[Index];
+			m_Identity = *pChr->GameServer()->m_SavedIdentities.Get(Index);
 	}
 
 	// '$' is not a valid username character, thats why we use it here (str_check_special_chars)
@@ -771,10 +771,10 @@ int CSaveTeam::load(int Team)
 	if(m_pController->GameServer()->Collision()->m_HighestSwitchNumber)
 		for(int i=1; i < m_pController->GameServer()->Collision()->m_HighestSwitchNumber+1; i++)
 		{
-			m_pController->GameServer()->Collision()->m_pSwitchers[i].m_Status[Team] = m_Switchers[i].m_Status;
+			int EndTick = m_pController->GameServer()->Collision()->m_pSwitchers[i].m_EndTick[Team];
 			if(m_Switchers[i].m_EndTime)
-				m_pController->GameServer()->Collision()->m_pSwitchers[i].m_EndTick[Team] = m_pController->Server()->Tick() - m_Switchers[i].m_EndTime;
-			m_pController->GameServer()->Collision()->m_pSwitchers[i].m_Type[Team] = m_Switchers[i].m_Type;
+				EndTick = m_pController->Server()->Tick() - m_Switchers[i].m_EndTime;
+			m_pController->GameServer()->SetSwitch(i, Team, m_Switchers[i].m_Status, m_Switchers[i].m_Type, EndTick);
 		}
 	return 0;
 }
@@ -5,25 +5,13 @@
 //#include "./entities/character.h"
 #include <engine/shared/protocol.h>
 #include <game/server/gamecontroller.h>
+#include "savedidentities.h"
 #include "teeinfo.h"
 
 class CCharacter;
 class CGameContext;
 
 // F-DDrace
-struct SSavedIdentity
-{
-	char m_aAccUsername[32];
-	NETADDR m_Addr;
-	char m_aTimeoutCode[64];
-
-	char m_aName[MAX_NAME_LENGTH];
-	CTeeInfo m_TeeInfo;
-
-	time_t m_ExpireDate;
-	int m_RedirectTilePort;
-};
-
 enum
 {
 	SAVE_WALLET = 1<<0, // saves and loads wallet money
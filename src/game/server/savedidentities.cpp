@@ -0,0 +1,333 @@
+#include "savedidentities.h"
+
+#include <base/hash_ctxt.h>
+
+#include <algorithm>
+
+static const char s_aJournalMagic[4] = {'F', 'D', 'S', 'I'};
+
+struct CJournalHeader
+{
+	char m_aMagic[4];
+	int m_Version;
+	int m_RecordSize;
+};
+
+struct CJournalRecord
+{
+	int m_Op;
+	SSavedIdentity m_Identity;
+};
+
+CSavedIdentities::CSavedIdentities()
+{
+	m_aJournalFile[0] = 0;
+	Clear();
+}
+
+void CSavedIdentities::GetHash(const SSavedIdentity *pIdentity, char *pBuf, int BufSize)
+{
+	SSavedIdentity Info = *pIdentity;
+	SHA256_CTX Sha256Ctx;
+	sha256_init(&Sha256Ctx);
+
+	// manually update sha256 to no get bytes after 0 bytes in or so
+	sha256_update(&Sha256Ctx, &Info.m_aAccUsername, str_length(Info.m_aAccUsername));
+	sha256_update(&Sha256Ctx, &Info.m_Addr, sizeof(Info.m_Addr));
+	sha256_update(&Sha256Ctx, &Info.m_aTimeoutCode, str_length(Info.m_aTimeoutCode));
+	sha256_update(&Sha256Ctx, &Info.m_aName, str_length(Info.m_aName));
+	for (int p = 0; p < NUM_SKINPARTS; p++)
+	{
+		sha256_update(&Sha256Ctx, Info.m_TeeInfo.GetSkinPartName(p), str_length(Info.m_TeeInfo.m_aaSkinPartNames[p]));
+		sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_aUseCustomColors[p], sizeof(Info.m_TeeInfo.m_aUseCustomColors[p]));
+		sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_aSkinPartColors[p], sizeof(Info.m_TeeInfo.m_aSkinPartColors[p]));
+	}
+	sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_Sevendown.m_SkinName, str_length(Info.m_TeeInfo.m_Sevendown.m_SkinName));
+	sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_Sevendown.m_UseCustomColor, sizeof(Info.m_TeeInfo.m_Sevendown.m_UseCustomColor));
+	sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_Sevendown.m_ColorBody, sizeof(Info.m_TeeInfo.m_Sevendown.m_ColorBody));
+	sha256_update(&Sha256Ctx, &Info.m_TeeInfo.m_Sevendown.m_ColorFeet, sizeof(Info.m_TeeInfo.m_Sevendown.m_ColorFeet));
+
+	sha256_str(sha256_finish(&Sha256Ctx), pBuf, BufSize);
+}
+
+void CSavedIdentities::GetKeys(const SSavedIdentity *pIdentity, const char *pHash, std::vector<std::string> *pvKeys)
+{
+	char aAddr[NETADDR_MAXSTRSIZE];
+	net_addr_str(&pIdentity->m_Addr, aAddr, sizeof(aAddr), false);
+
+	pvKeys->push_back(std::string("h:") + pHash);
+	pvKeys->push_back(std::string("a:") + aAddr);
+	if (pIdentity->m_aTimeoutCode[0])
+		pvKeys->push_back(std::string("t:") + pIdentity->m_aTimeoutCode);
+	if (pIdentity->m_aAccUsername[0])
+		pvKeys->push_back(std::string("u:") + pIdentity->m_aAccUsername);
+}
+
+void CSavedIdentities::Clear()
+{
+	m_vEntries.clear();
+	m_vFreeIndices.clear();
+	m_Keys.clear();
+	m_NextSeq = 0;
+	m_Num = 0;
+	m_NumPersistent = 0;
+	m_NumJournalRecords = 0;
+}
+
+int CSavedIdentities::Insert(const SSavedIdentity &Identity, bool Persistent)
+{
+	int Index;
+	if (m_vFreeIndices.size())
+	{
+		Index = m_vFreeIndices.back();
+		m_vFreeIndices.pop_back();
+	}
+	else
+	{
+		Index = m_vEntries.size();
+		m_vEntries.push_back(CEntry());
+	}
+
+	CEntry *pEntry = &m_vEntries[Index];
+	pEntry->m_Identity = Identity;
+	GetHash(&Identity, pEntry->m_aHash, sizeof(pEntry->m_aHash));
+	pEntry->m_Seq = m_NextSeq++;
+	pEntry->m_Used = true;
+	pEntry->m_Persistent = Persistent;
+
+	std::vector<std::string> vKeys;
+	GetKeys(&Identity, pEntry->m_aHash, &vKeys);
+	for (unsigned i = 0; i < vKeys.size(); i++)
+		m_Keys.insert(std::make_pair(vKeys[i], Index));
+
+	m_Num++;
+	if (Persistent)
+		m_NumPersistent++;
+	return Index;
+}
+
+int CSavedIdentities::Add(const SSavedIdentity &Identity, bool Persistent)
+{
+	int Index = Insert(Identity, Persistent);
+	if (Persistent)
+		AppendJournal(JOURNAL_ADD, &Identity);
+	return Index;
+}
+
+void CSavedIdentities::Remove(int Index)
+{
+	if (!IsUsed(Index))
+		return;
+
+	CEntry *pEntry = &m_vEntries[Index];
+	std::vector<std::string> vKeys;
+	GetKeys(&pEntry->m_Identity, pEntry->m_aHash, &vKeys);
+	for (unsigned i = 0; i < vKeys.size(); i++)
+	{
+		auto Range = m_Keys.equal_range(vKeys[i]);
+		for (auto It = Range.first; It != Range.second; ++It)
+		{
+			if (It->second == Index)
+			{
+				m_Keys.erase(It);
+				break;
+			}
+		}
+	}
+
+	pEntry->m_Used = false;
+	m_vFreeIndices.push_back(Index);
+	m_Num--;
+
+	if (pEntry->m_Persistent)
+	{
+		m_NumPersistent--;
+		AppendJournal(JOURNAL_REMOVE, &pEntry->m_Identity);
+		if (m_NumJournalRecords > m_NumPersistent * 2 + MIN_COMPACT_RECORDS)
+			CompactJournal();
+	}
+}
+
+void CSavedIdentities::CollectCandidates(const std::string &Key, std::vector<int> *pvCandidates) const
+{
+	auto Range = m_Keys.equal_range(Key);
+	for (auto It = Range.first; It != Range.second; ++It)
+		pvCandidates->push_back(It->second);
+}
+
+int CSavedIdentities::FindByHash(const char *pHash) const
+{
+	if (!pHash[0])
+		return -1;
+
+	std::vector<int> vCandidates;
+	CollectCandidates(std::string("h:") + pHash, &vCandidates);
+
+	// same identity saved multiple times, take the oldest one
+	int Found = -1;
+	for (unsigned i = 0; i < vCandidates.size(); i++)
+		if (Found == -1 || m_vEntries[vCandidates[i]].m_Seq < m_vEntries[Found].m_Seq)
+			Found = vCandidates[i];
+	return Found;
+}
+
+int CSavedIdentities::Find(const NETADDR *pAddr, const char *pTimeoutCode, const char *pAccUsername, const char *pName, const CTeeInfo *pTeeInfo) const
+{
+	// every match needs the same address, timeout code or account, so only those identities have to be checked
+	char aAddr[NETADDR_MAXSTRSIZE];
+	net_addr_str(pAddr, aAddr, sizeof(aAddr), false);
+
+	std::vector<int> vCandidates;
+	CollectCandidates(std::string("a:") + aAddr, &vCandidates);
+	if (pTimeoutCode[0])
+		CollectCandidates(std::string("t:") + pTimeoutCode, &vCandidates);
+	if (pAccUsername[0])
+		CollectCandidates(std::string("u:") + pAccUsername, &vCandidates);
+
+	// check them in the order they have been saved in
+	std::sort(vCandidates.begin(), vCandidates.end(), [this](int a, int b) { return m_vEntries[a].m_Seq < m_vEntries[b].m_Seq; });
+	vCandidates.erase(std::unique(vCandidates.begin(), vCandidates.end()), vCandidates.end());
+
+	int Found = -1;
+	for (unsigned int i = 0; i < vCandidates.size(); i++)
+	{
+		const SSavedIdentity *pInfo = &m_vEntries[vCandidates[i]].m_Identity;
+		bool SameAddrAndPort = net_addr_comp(pAddr, &pInfo->m_Addr, true) == 0;
+		if (Found != -1)
+		{
+			if (SameAddrAndPort)
+				Found = vCandidates[i]; // for getting the correct savedidentity when shutting down or saving a tee for save drop
+			continue;
+		}
+
+		bool SameAddr = net_addr_comp(pAddr, &pInfo->m_Addr, false) == 0;
+		bool SameTimeoutCode = pInfo->m_aTimeoutCode[0] != '\0' && str_comp(pInfo->m_aTimeoutCode, pTimeoutCode) == 0;
+		bool SameAcc = pInfo->m_aAccUsername[0] != '\0' && str_comp(pInfo->m_aAccUsername, pAccUsername) == 0;
+		bool SameName = str_comp(pInfo->m_aName, pName) == 0;
+		bool SameTeeInfo = mem_comp(&pInfo->m_TeeInfo, pTeeInfo, sizeof(CTeeInfo)) == 0;
+
+		// SameTeeInfo is not really used, since players with the same skin and ip would get fucked up otherwise, in CSaveTee::Save() the identity of e.g. dummy would get saved then
+		bool SameClientInfo = SameAddr && SameName;
+		SameAcc = SameAcc && (SameAddr || SameName || SameTeeInfo || SameTimeoutCode);
+		if (SameAddrAndPort || SameAcc || SameTimeoutCode || SameClientInfo)
+		{
+			Found = vCandidates[i];
+		}
+	}
+
+	return Found;
+}
+
+bool CSavedIdentities::AppendJournal(int Op, const SSavedIdentity *pIdentity)
+{
+	if (!m_aJournalFile[0])
+		return false;
+
+	IOHANDLE File = io_open(m_aJournalFile, IOFLAG_APPEND);
+	if (!File)
+		return false;
+
+	CJournalRecord Record;
+	mem_zero(&Record, sizeof(Record));
+	Record.m_Op = Op;
+	Record.m_Identity = *pIdentity;
+	bool Success = io_write(File, &Record, sizeof(Record)) == sizeof(Record);
+	io_close(File);
+
+	m_NumJournalRecords++;
+	return Success;
+}
+
+bool CSavedIdentities::LoadJournal(const char *pFilename)
+{
+	str_copy(m_aJournalFile, pFilename, sizeof(m_aJournalFile));
+
+	IOHANDLE File = io_open(pFilename, IOFLAG_READ);
+	if (!File)
+		return false;
+
+	CJournalHeader Header;
+	if (io_read(File, &Header, sizeof(Header)) != sizeof(Header) || mem_comp(Header.m_aMagic, s_aJournalMagic, sizeof(s_aJournalMagic)) != 0
+		|| Header.m_Version != JOURNAL_VERSION || Header.m_RecordSize != (int)sizeof(CJournalRecord))
+	{
+		io_close(File);
+		return false;
+	}
+
+	// a torn record at the end from a crash is dropped
+	CJournalRecord Record;
+	while (io_read(File, &Record, sizeof(Record)) == sizeof(Record))
+	{
+		m_NumJournalRecords++;
+		if (Record.m_Op == JOURNAL_ADD)
+		{
+			Insert(Record.m_Identity, true);
+		}
+		else if (Record.m_Op == JOURNAL_REMOVE)
+		{
+			char aHash[SHA256_MAXSTRSIZE];
+			GetHash(&Record.m_Identity, aHash, sizeof(aHash));
+			int Index = FindByHash(aHash);
+			if (Index != -1)
+			{
+				// without journaling it again
+				m_vEntries[Index].m_Persistent = false;
+				m_NumPersistent--;
+				Remove(Index);
+			}
+		}
+	}
+	io_close(File);
+	return true;
+}
+
+bool CSavedIdentities::CompactJournal()
+{
+	if (!m_aJournalFile[0])
+		return false;
+
+	char aTmpFile[IO_MAX_PATH_LENGTH];
+	str_format(aTmpFile, sizeof(aTmpFile), "%s.tmp", m_aJournalFile);
+	IOHANDLE File = io_open(aTmpFile, IOFLAG_WRITE);
+	if (!File)
+		return false;
+
+	CJournalHeader Header;
+	mem_copy(Header.m_aMagic, s_aJournalMagic, sizeof(s_aJournalMagic));
+	Header.m_Version = JOURNAL_VERSION;
+	Header.m_RecordSize = sizeof(CJournalRecord);
+	bool Success = io_write(File, &Header, sizeof(Header)) == sizeof(Header);
+
+	// keep the save order, matching players relies on it
+	std::vector<int> vIndices;
+	for (unsigned i = 0; i < m_vEntries.size(); i++)
+		if (m_vEntries[i].m_Used && m_vEntries[i].m_Persistent)
+			vIndices.push_back(i);
+	std::sort(vIndices.begin(), vIndices.end(), [this](int a, int b) { return m_vEntries[a].m_Seq < m_vEntries[b].m_Seq; });
+
+	for (unsigned i = 0; i < vIndices.size() && Success; i++)
+	{
+		CJournalRecord Record;
+		mem_zero(&Record, sizeof(Record));
+		Record.m_Op = JOURNAL_ADD;
+		Record.m_Identity = m_vEntries[vIndices[i]].m_Identity;
+		Success = io_write(File, &Record, sizeof(Record)) == sizeof(Record);
+	}
+	io_close(File);
+
+	if (!Success)
+	{
+		fs_remove(aTmpFile);
+		return false;
+	}
+
+	if (fs_rename(aTmpFile, m_aJournalFile) != 0)
+	{
+		fs_remove(m_aJournalFile);
+		if (fs_rename(aTmpFile, m_aJournalFile) != 0)
+			return false;
+	}
+
+	m_NumJournalRecords = vIndices.size();
+	return true;
+}
@@ -0,0 +1,91 @@
+#ifndef GAME_SERVER_SAVEDIDENTITIES_H
+#define GAME_SERVER_SAVEDIDENTITIES_H
+
+#include <base/hash.h>
+#include <base/system.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "teeinfo.h"
+
+#include <time.h>
+
+struct SSavedIdentity
+{
+	char m_aAccUsername[32];
+	NETADDR m_Addr;
+	char m_aTimeoutCode[64];
+
+	char m_aName[MAX_NAME_LENGTH];
+	CTeeInfo m_TeeInfo;
+
+	time_t m_ExpireDate;
+	int m_RedirectTilePort;
+};
+
+// saved identities indexed by hash, address, timeout code and account, so a joining player can be matched without
+// going through all of them. persistent identities are written to an append-only journal, which is read on startup
+// instead of every .save file. indices stay valid until the identity is removed
+class CSavedIdentities
+{
+	enum
+	{
+		JOURNAL_VERSION = 1,
+		JOURNAL_ADD = 1,
+		JOURNAL_REMOVE,
+
+		// compact when the journal has that many more records than identities
+		MIN_COMPACT_RECORDS = 64,
+	};
+
+	struct CEntry
+	{
+		SSavedIdentity m_Identity;
+		char m_aHash[SHA256_MAXSTRSIZE];
+		int64 m_Seq;
+		bool m_Used;
+		bool m_Persistent;
+	};
+
+	std::vector<CEntry> m_vEntries;
+	std::vector<int> m_vFreeIndices;
+	std::unordered_multimap<std::string, int> m_Keys;
+	int64 m_NextSeq;
+	int m_Num;
+	int m_NumPersistent;
+
+	char m_aJournalFile[IO_MAX_PATH_LENGTH];
+	int m_NumJournalRecords;
+
+	static void GetKeys(const SSavedIdentity *pIdentity, const char *pHash, std::vector<std::string> *pvKeys);
+	void CollectCandidates(const std::string &Key, std::vector<int> *pvCandidates) const;
+	int Insert(const SSavedIdentity &Identity, bool Persistent);
+	bool AppendJournal(int Op, const SSavedIdentity *pIdentity);
+
+public:
+	CSavedIdentities();
+
+	static void GetHash(const SSavedIdentity *pIdentity, char *pBuf, int BufSize);
+
+	void Clear();
+	// returns false if there was no usable journal. the file is used for all further changes either way
+	bool LoadJournal(const char *pFilename);
+	bool CompactJournal();
+
+	int Add(const SSavedIdentity &Identity, bool Persistent);
+	void Remove(int Index);
+
+	int NumSlots() const { return m_vEntries.size(); }
+	int Num() const { return m_Num; }
+	int NumJournalRecords() const { return m_NumJournalRecords; }
+	bool IsUsed(int Index) const { return Index >= 0 && Index < (int)m_vEntries.size() && m_vEntries[Index].m_Used; }
+	const SSavedIdentity *Get(int Index) const { return IsUsed(Index) ? &m_vEntries[Index].m_Identity : 0; }
+	const char *GetHash(int Index) const { return IsUsed(Index) ? m_vEntries[Index].m_aHash : ""; }
+
+	int FindByHash(const char *pHash) const;
+	int Find(const NETADDR *pAddr, const char *pTimeoutCode, const char *pAccUsername, const char *pName, const CTeeInfo *pTeeInfo) const;
+};
+
+#endif // GAME_SERVER_SAVEDIDENTITIES_H
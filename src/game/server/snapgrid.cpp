@@ -0,0 +1,78 @@
+#include "snapgrid.h"
+
+#include <base/math.h>
+
+CSnapGrid::CSnapGrid()
+{
+	m_Width = 0;
+	m_Height = 0;
+	m_NumTypes = 0;
+}
+
+void CSnapGrid::Init(float Width, float Height, int NumTypes)
+{
+	m_Width = max(1, (int)ceilf(Width / CELL_SIZE));
+	m_Height = max(1, (int)ceilf(Height / CELL_SIZE));
+	m_NumTypes = NumTypes;
+	Clear();
+}
+
+void CSnapGrid::Clear()
+{
+	m_vItems.clear();
+	m_vpEntities.clear();
+}
+
+int CSnapGrid::CellX(float x) const
+{
+	// everything outside of the map ends up in the border cells
+	return clamp((int)floorf(x / CELL_SIZE), 0, m_Width - 1);
+}
+
+int CSnapGrid::CellY(float y) const
+{
+	return clamp((int)floorf(y / CELL_SIZE), 0, m_Height - 1);
+}
+
+void CSnapGrid::Add(CEntity *pEntity, int Type, vec2 Pos)
+{
+	CItem Item;
+	Item.m_pEntity = pEntity;
+	Item.m_Key = (Type * m_Height + CellY(Pos.y)) * m_Width + CellX(Pos.x);
+	m_vItems.push_back(Item);
+}
+
+void CSnapGrid::Build()
+{
+	// counting sort by key, keeps the insertion order inside of a cell
+	m_vCellStart.assign(m_Width * m_Height * m_NumTypes + 1, 0);
+	for(unsigned i = 0; i < m_vItems.size(); i++)
+		m_vCellStart[m_vItems[i].m_Key + 1]++;
+	for(unsigned i = 1; i < m_vCellStart.size(); i++)
+		m_vCellStart[i] += m_vCellStart[i - 1];
+
+	std::vector<int> vNext(m_vCellStart.begin(), m_vCellStart.end() - 1);
+	m_vpEntities.resize(m_vItems.size());
+	for(unsigned i = 0; i < m_vItems.size(); i++)
+		m_vpEntities[vNext[m_vItems[i].m_Key]++] = m_vItems[i].m_pEntity;
+	m_vItems.clear();
+}
+
+void CSnapGrid::Query(int Type, vec2 Center, vec2 Extent, std::vector<CEntity *> *pvpOut) const
+{
+	if(Type < 0 || Type >= m_NumTypes || m_vpEntities.empty())
+		return;
+
+	int StartX = CellX(Center.x - Extent.x);
+	int EndX = CellX(Center.x + Extent.x);
+	int StartY = CellY(Center.y - Extent.y);
+	int EndY = CellY(Center.y + Extent.y);
+	for(int y = StartY; y <= EndY; y++)
+	{
+		// the cells of a row are next to each other
+		int Row = (Type * m_Height + y) * m_Width;
+		int Start = m_vCellStart[Row + StartX];
+		int End = m_vCellStart[Row + EndX + 1];
+		pvpOut->insert(pvpOut->end(), m_vpEntities.begin() + Start, m_vpEntities.begin() + End);
+	}
+}
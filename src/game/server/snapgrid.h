@@ -0,0 +1,51 @@
+#ifndef GAME_SERVER_SNAPGRID_H
+#define GAME_SERVER_SNAPGRID_H
+
+#include <base/vmath.h>
+
+#include <vector>
+
+class CEntity;
+
+// buckets entities by type and coarse world cell, so that a snapshot only has to visit the
+// entities around a client's view instead of asking every entity of the world whether it is clipped
+class CSnapGrid
+{
+	struct CItem
+	{
+		CEntity *m_pEntity;
+		int m_Key;
+	};
+
+	int m_Width;
+	int m_Height;
+	int m_NumTypes;
+	std::vector<CItem> m_vItems;
+	// sorted by key, m_vCellStart[Key] to m_vCellStart[Key+1] are the entities of that type and cell
+	std::vector<CEntity *> m_vpEntities;
+	std::vector<int> m_vCellStart;
+
+	int CellX(float x) const;
+	int CellY(float y) const;
+
+public:
+	enum
+	{
+		CELL_SIZE = 32 * 32,
+	};
+
+	CSnapGrid();
+
+	// world size in world units
+	void Init(float Width, float Height, int NumTypes);
+	void Clear();
+	void Add(CEntity *pEntity, int Type, vec2 Pos);
+	// has to be called after adding and before querying
+	void Build();
+	int Size() const { return m_vpEntities.size(); }
+
+	// appends all entities of the type whose cell touches the rectangle Center +- Extent
+	void Query(int Type, vec2 Center, vec2 Extent, std::vector<CEntity *> *pvpOut) const;
+};
+
+#endif // GAME_SERVER_SNAPGRID_H
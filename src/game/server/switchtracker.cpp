@@ -0,0 +1,86 @@
+#include "switchtracker.h"
+
+#include <algorithm>
+
+static bool CompareTimeouts(const CSwitchTracker::CSwitch &a, const CSwitchTracker::CSwitch &b)
+{
+	// std heaps keep the largest on top
+	return a.m_Tick > b.m_Tick;
+}
+
+CSwitchTracker::CSwitchTracker()
+{
+	for (int i = 0; i < VANILLA_MAX_CLIENTS; i++)
+		m_aVersions[i] = 0;
+	m_Version = 0;
+}
+
+void CSwitchTracker::Reserve(int Slot)
+{
+	if (Slot < (int)m_vTimeoutTicks.size())
+		return;
+	m_vTimeoutTicks.resize(Slot + VANILLA_MAX_CLIENTS, -1);
+	m_vActivated.resize(Slot + VANILLA_MAX_CLIENTS, false);
+}
+
+void CSwitchTracker::OnStatusChange(int Team)
+{
+	m_aVersions[Team]++;
+	m_Version++;
+}
+
+void CSwitchTracker::AddTimeout(int Number, int Team, int Tick)
+{
+	int Index = Slot(Number, Team);
+	Reserve(Index);
+	if (m_vTimeoutTicks[Index] != -1 && m_vTimeoutTicks[Index] <= Tick)
+		return;
+
+	m_vTimeoutTicks[Index] = Tick;
+	CSwitch Timeout;
+	Timeout.m_Number = Number;
+	Timeout.m_Team = Team;
+	Timeout.m_Tick = Tick;
+	m_vTimeouts.push_back(Timeout);
+	std::push_heap(m_vTimeouts.begin(), m_vTimeouts.end(), CompareTimeouts);
+}
+
+bool CSwitchTracker::PopTimeout(int Tick, CSwitch *pTimeout)
+{
+	while (!m_vTimeouts.empty() && m_vTimeouts.front().m_Tick <= Tick)
+	{
+		std::pop_heap(m_vTimeouts.begin(), m_vTimeouts.end(), CompareTimeouts);
+		CSwitch Timeout = m_vTimeouts.back();
+		m_vTimeouts.pop_back();
+		if (!IsLive(Timeout))
+			continue;
+
+		m_vTimeoutTicks[Slot(Timeout.m_Number, Timeout.m_Team)] = -1;
+		*pTimeout = Timeout;
+		return true;
+	}
+	return false;
+}
+
+void CSwitchTracker::AddActivation(int Number, int Team)
+{
+	int Index = Slot(Number, Team);
+	Reserve(Index);
+	if (m_vActivated[Index])
+		return;
+
+	m_vActivated[Index] = true;
+	CSwitch Activation;
+	Activation.m_Number = Number;
+	Activation.m_Team = Team;
+	Activation.m_Tick = 0;
+	m_vActivations.push_back(Activation);
+}
+
+void CSwitchTracker::TakeActivations(std::vector<CSwitch> *pvActivations)
+{
+	pvActivations->clear();
+	pvActivations->swap(m_vActivations);
+	for (unsigned i = 0; i < pvActivations->size(); i++)
+		m_vActivated[Slot((*pvActivations)[i].m_Number, (*pvActivations)[i].m_Team)] = false;
+}
@@ -0,0 +1,54 @@
+#ifndef GAME_SERVER_SWITCHTRACKER_H
+#define GAME_SERVER_SWITCHTRACKER_H
+
+#include <engine/shared/protocol.h>
+
+#include <vector>
+
+// what the switchers of all teams are up to, so nothing has to walk every switch number of every team each tick. timed
+// switches wait in a min-heap until they flip back, switches that just got set by a player are remembered until the
+// player left them, and every status change bumps the version of its team
+class CSwitchTracker
+{
+public:
+	struct CSwitch
+	{
+		int m_Number;
+		int m_Team;
+		int m_Tick;
+	};
+
+private:
+	std::vector<CSwitch> m_vTimeouts; // min-heap on m_Tick
+	std::vector<int> m_vTimeoutTicks; // per switch and team, the tick of its live entry in m_vTimeouts or -1
+	std::vector<CSwitch> m_vActivations;
+	std::vector<bool> m_vActivated;
+	int m_aVersions[VANILLA_MAX_CLIENTS];
+	int m_Version;
+
+	int Slot(int Number, int Team) const { return Number * VANILLA_MAX_CLIENTS + Team; }
+	void Reserve(int Slot);
+
+public:
+	CSwitchTracker();
+
+	void OnStatusChange(int Team);
+	// of all teams or one team, changes whenever a status changed
+	int Version() const { return m_Version; }
+	int Version(int Team) const { return m_aVersions[Team]; }
+
+	// an earlier tick replaces a later one, a later one is left to whoever pops the earlier one
+	void AddTimeout(int Number, int Team, int Tick);
+	// takes the earliest timeout that is due at Tick, returns false if there is none
+	bool PopTimeout(int Tick, CSwitch *pTimeout);
+	// in heap order, includes replaced entries that IsLive() tells apart
+	const std::vector<CSwitch> &Timeouts() const { return m_vTimeouts; }
+	bool IsLive(const CSwitch &Timeout) const { return m_vTimeoutTicks[Slot(Timeout.m_Number, Timeout.m_Team)] == Timeout.m_Tick; }
+
+	// added once until taken
+	void AddActivation(int Number, int Team);
+	void TakeActivations(std::vector<CSwitch> *pvActivations);
+	const std::vector<CSwitch> &Activations() const { return m_vActivations; }
+};
+
+#endif // GAME_SERVER_SWITCHTRACKER_H
@@ -285,6 +285,7 @@ void CGameTeams::SetForceCharacterTeam(int ClientID, int Team)
 void CGameTeams::SetForceCharacterNewTeam(int ClientID, int Team)
 {
 	m_Core.Team(ClientID, Team);
+	GameServer()->m_World.MarkPlayerMapDirty();
 
 	if (m_Core.Team(ClientID) != TEAM_SUPER)
 		m_MembersCount[m_Core.Team(ClientID)]++;
@@ -296,9 +297,7 @@ void CGameTeams::SetForceCharacterNewTeam(int ClientID, int Team)
 		if (GameServer()->Collision()->m_HighestSwitchNumber > 0) {
 			for (int i = 0; i < GameServer()->Collision()->m_HighestSwitchNumber+1; ++i)
 			{
-				GameServer()->Collision()->m_pSwitchers[i].m_Status[Team] = GameServer()->Collision()->m_pSwitchers[i].m_Initial;
-				GameServer()->Collision()->m_pSwitchers[i].m_EndTick[Team] = 0;
-				GameServer()->Collision()->m_pSwitchers[i].m_Type[Team] = TILE_SWITCHOPEN;
+				GameServer()->SetSwitch(i, Team, GameServer()->Collision()->m_pSwitchers[i].m_Initial, TILE_SWITCHOPEN, 0);
 			}
 		}
 	}
@@ -6,37 +6,61 @@
 #include <generated/protocol.h>
 #include <engine/server.h>
 
+#include "whoisindex.h"
+
+#include <atomic>
+#include <vector>
+
 class CGameContext;
 
 class CWhoIs
 {
+	enum
+	{
+		MODE_IP = 0,
+		MODE_NAME,
+		MODE_SIMILAR,
+
+		MAX_SIMILAR_NAMES = 10,
+	};
+
 	CGameContext *m_pGameServer;
 	CGameContext *GameServer() const { return m_pGameServer; }
 	IServer *Server() const;
 
-	#define NAMEC 50
-	struct player
+	// whois.txt is indexed on a background thread, only the part that existed when loading started is read
+	struct CLoadJob
 	{
-		char name[16];
-		struct nameaa
-		{
-			char addr[16];
-			int count;
-			int first3;
-		} names[NAMEC];
-		int numn, count, first3;
+		IOHANDLE m_File;
+		int64 m_Size;
+		CWhoIsIndex *m_pIndex;
+		std::atomic<bool> m_Done;
 	};
 
-	int num_ips, num_nms;
-	struct player *ipplayers, *nmplayers;
+	struct CPendingEntry
+	{
+		char m_aName[CWhoIsIndex::MAX_KEY_LENGTH + 1];
+		char m_aAddr[CWhoIsIndex::MAX_KEY_LENGTH + 1];
+	};
+
+	CWhoIsIndex *m_pIndex;
+	CLoadJob *m_pLoadJob;
+	void *m_pLoadThread;
+	// connects while loading, added once the index is ready
+	std::vector<CPendingEntry> m_vPending;
 
-	struct player *FindEntry(struct player *src, int num, const char *name);
-	int AddName(struct player *src, const char *name);
-	int AddGeneric(struct player *names, struct player *addrs, int *ppl, int *ppl1, const char *name_buf, const char *addr_buf);
-	int AddEntry(const char *name, const char *addr);
+	void Clear();
+	void FinishLoading(bool Wait);
+	static void LoadThread(void *pUser);
+
+	void PrintEntry(int Table, int Entry);
 
 public:
+	CWhoIs();
+	~CWhoIs();
+
 	void Init(CGameContext *pGameServer);
+	void Tick();
 	void Run(const char *pName, int Mode, int Cutoff);
 	void AddEntry(int ClientID);
 };
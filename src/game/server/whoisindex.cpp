@@ -0,0 +1,336 @@
+#include "whoisindex.h"
+
+#include <base/math.h>
+
+#include <algorithm>
+#include <string.h>
+
+CWhoIsIndex::CWhoIsIndex()
+{
+	m_MaxEntries = -1;
+}
+
+void CWhoIsIndex::Clear()
+{
+	m_vStrings.clear();
+	m_vLinks.clear();
+	for (int i = 0; i < NUM_TABLES; i++)
+	{
+		m_aTables[i].m_vEntries.clear();
+		m_aTables[i].m_vSlots.clear();
+	}
+	m_Prefixes.m_vEntries.clear();
+	m_Prefixes.m_vSlots.clear();
+	m_Trigrams.clear();
+	m_vNumTrigrams.clear();
+}
+
+unsigned CWhoIsIndex::Hash(const char *pStr)
+{
+	// fnv-1a
+	unsigned Hash = 2166136261u;
+	for (; *pStr; pStr++)
+	{
+		Hash ^= (unsigned char)*pStr;
+		Hash *= 16777619u;
+	}
+	return Hash;
+}
+
+int CWhoIsIndex::GetTrigrams(const char *pStr, bool Suffix, unsigned *pTrigrams)
+{
+	// case insensitive, padded like "  name " so that short names and the start of a name have trigrams too
+	unsigned char aBuf[MAX_KEY_LENGTH + 3];
+	int Length = 0;
+	aBuf[Length++] = ' ';
+	aBuf[Length++] = ' ';
+	for (int i = 0; pStr[i] && i < MAX_KEY_LENGTH; i++)
+	{
+		unsigned char c = pStr[i];
+		aBuf[Length++] = c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+	}
+	if (Length == 2)
+		return 0;
+	if (Suffix)
+		aBuf[Length++] = ' ';
+
+	int Num = 0;
+	for (int i = 0; i + 3 <= Length; i++)
+		pTrigrams[Num++] = (aBuf[i] << 16) | (aBuf[i + 1] << 8) | aBuf[i + 2];
+	std::sort(pTrigrams, pTrigrams + Num);
+	return std::unique(pTrigrams, pTrigrams + Num) - pTrigrams;
+}
+
+int CWhoIsIndex::Find(const CTable *pTable, const char *pKey) const
+{
+	if (pTable->m_vSlots.empty())
+		return -1;
+
+	unsigned Mask = pTable->m_vSlots.size() - 1;
+	for (unsigned Slot = Hash(pKey) & Mask;; Slot = (Slot + 1) & Mask)
+	{
+		int Entry = pTable->m_vSlots[Slot];
+		if (Entry < 0 || str_comp(GetString(pTable->m_vEntries[Entry].m_Key), pKey) == 0)
+			return Entry;
+	}
+}
+
+void CWhoIsIndex::Grow(CTable *pTable)
+{
+	pTable->m_vSlots.assign(max((int)pTable->m_vSlots.size() * 2, 64), -1);
+	unsigned Mask = pTable->m_vSlots.size() - 1;
+	for (int i = 0; i < (int)pTable->m_vEntries.size(); i++)
+	{
+		unsigned Slot = Hash(GetString(pTable->m_vEntries[i].m_Key)) & Mask;
+		while (pTable->m_vSlots[Slot] >= 0)
+			Slot = (Slot + 1) & Mask;
+		pTable->m_vSlots[Slot] = i;
+	}
+}
+
+int CWhoIsIndex::Insert(CTable *pTable, const char *pKey)
+{
+	// at most half full, so probe sequences stay short
+	if ((pTable->m_vEntries.size() + 1) * 2 > pTable->m_vSlots.size())
+		Grow(pTable);
+
+	CEntry Entry;
+	Entry.m_Key = m_vStrings.size();
+	Entry.m_Count = 0;
+	Entry.m_NumLinks = 0;
+	Entry.m_FirstLink = -1;
+	Entry.m_LastLink = -1;
+	m_vStrings.insert(m_vStrings.end(), pKey, pKey + str_length(pKey) + 1);
+
+	int Index = pTable->m_vEntries.size();
+	pTable->m_vEntries.push_back(Entry);
+	unsigned Mask = pTable->m_vSlots.size() - 1;
+	unsigned Slot = Hash(pKey) & Mask;
+	while (pTable->m_vSlots[Slot] >= 0)
+		Slot = (Slot + 1) & Mask;
+	pTable->m_vSlots[Slot] = Index;
+	return Index;
+}
+
+void CWhoIsIndex::AddLink(CTable *pTable, int Entry, int Other, bool Capped)
+{
+	CEntry *pEntry = &pTable->m_vEntries[Entry];
+	if (Capped)
+	{
+		for (int Link = pEntry->m_FirstLink; Link >= 0; Link = m_vLinks[Link].m_Next)
+		{
+			if (m_vLinks[Link].m_Other == Other)
+			{
+				m_vLinks[Link].m_Count++;
+				return;
+			}
+		}
+		if (pEntry->m_NumLinks >= MAX_LINKS)
+			return;
+	}
+
+	CLink Link;
+	Link.m_Other = Other;
+	Link.m_Count = 1;
+	Link.m_Next = -1;
+	int Index = m_vLinks.size();
+	m_vLinks.push_back(Link);
+	if (pEntry->m_LastLink >= 0)
+		m_vLinks[pEntry->m_LastLink].m_Next = Index;
+	else
+		pEntry->m_FirstLink = Index;
+	pEntry->m_LastLink = Index;
+	pEntry->m_NumLinks++;
+}
+
+void CWhoIsIndex::AddPrefixes(int Addr, const char *pAddr)
+{
+	// the /24 and /16 of ipv4 addresses
+	char aPrefix[MAX_KEY_LENGTH + 1];
+	str_copy(aPrefix, pAddr, sizeof(aPrefix));
+	for (int i = 0; i < 2; i++)
+	{
+		char *pDot = strrchr(aPrefix, '.');
+		if (!pDot)
+			break;
+		*pDot = 0;
+		if (!str_find(aPrefix, "."))
+			break;
+
+		int Prefix = Find(&m_Prefixes, aPrefix);
+		if (Prefix < 0)
+			Prefix = Insert(&m_Prefixes, aPrefix);
+		AddLink(&m_Prefixes, Prefix, Addr, false);
+	}
+}
+
+void CWhoIsIndex::AddTrigrams(int Name, const char *pName)
+{
+	unsigned aTrigrams[MAX_KEY_LENGTH + 1];
+	int Num = GetTrigrams(pName, true, aTrigrams);
+	for (int i = 0; i < Num; i++)
+		m_Trigrams[aTrigrams[i]].push_back(Name);
+	m_vNumTrigrams.push_back(Num);
+}
+
+bool CWhoIsIndex::Add(const char *pName, const char *pAddr)
+{
+	int NameLength = str_length(pName);
+	int AddrLength = str_length(pAddr);
+	if (!NameLength || !AddrLength || NameLength > MAX_KEY_LENGTH || AddrLength > MAX_KEY_LENGTH)
+		return false;
+
+	int Addr = Find(TABLE_ADDR, pAddr);
+	int Name = Find(TABLE_NAME, pName);
+	if (m_MaxEntries >= 0 && ((Addr < 0 && Num(TABLE_ADDR) >= m_MaxEntries) || (Name < 0 && Num(TABLE_NAME) >= m_MaxEntries)))
+		return false;
+
+	if (Addr < 0)
+	{
+		Addr = Insert(&m_aTables[TABLE_ADDR], pAddr);
+		AddPrefixes(Addr, pAddr);
+	}
+	if (Name < 0)
+	{
+		Name = Insert(&m_aTables[TABLE_NAME], pName);
+		AddTrigrams(Name, pName);
+	}
+
+	m_aTables[TABLE_ADDR].m_vEntries[Addr].m_Count++;
+	m_aTables[TABLE_NAME].m_vEntries[Name].m_Count++;
+	AddLink(&m_aTables[TABLE_ADDR], Addr, Name, true);
+	AddLink(&m_aTables[TABLE_NAME], Name, Addr, true);
+	return true;
+}
+
+int CWhoIsIndex::AddLines(const char *pData, int Size)
+{
+	int Pos = 0;
+	while (Pos < Size)
+	{
+		const char *pLine = pData + Pos;
+		const char *pEnd = (const char *)memchr(pLine, '\n', Size - Pos);
+		if (!pEnd)
+			break;
+		Pos = pEnd - pData + 1;
+
+		// "(%16s): %s\n", the address is padded with spaces
+		const char *pOpen = (const char *)memchr(pLine, '(', pEnd - pLine);
+		const char *pClose = pOpen ? (const char *)memchr(pOpen, ')', pEnd - pOpen) : 0;
+		if (!pClose || pEnd - pClose < 3 || pClose[1] != ':' || pClose[2] != ' ')
+			continue;
+
+		const char *pAddr = pOpen + 1;
+		while (pAddr < pClose && *pAddr == ' ')
+			pAddr++;
+		char aAddr[MAX_KEY_LENGTH + 1];
+		char aName[MAX_KEY_LENGTH + 1];
+		int AddrLength = pClose - pAddr;
+		int NameLength = min((int)(pEnd - pClose - 3), (int)MAX_KEY_LENGTH);
+		if (AddrLength > MAX_KEY_LENGTH)
+			continue;
+		mem_copy(aAddr, pAddr, AddrLength);
+		aAddr[AddrLength] = 0;
+		mem_copy(aName, pClose + 3, NameLength);
+		aName[NameLength] = 0;
+		Add(aName, aAddr);
+	}
+	return Pos;
+}
+
+void CWhoIsIndex::FindAddrPrefix(const char *pPrefix, std::vector<int> *pvAddrs) const
+{
+	pvAddrs->clear();
+	if (!str_find(pPrefix, "."))
+	{
+		// only /24 and /16 are indexed
+		int Length = str_length(pPrefix);
+		const std::vector<CEntry> &vEntries = m_aTables[TABLE_ADDR].m_vEntries;
+		for (int i = 0; i < (int)vEntries.size(); i++)
+		{
+			const char *pAddr = GetString(vEntries[i].m_Key);
+			if (str_startswith(pAddr, pPrefix) && pAddr[Length] == '.')
+				pvAddrs->push_back(i);
+		}
+		return;
+	}
+
+	int Prefix = Find(&m_Prefixes, pPrefix);
+	if (Prefix < 0)
+		return;
+	for (int Link = m_Prefixes.m_vEntries[Prefix].m_FirstLink; Link >= 0; Link = m_vLinks[Link].m_Next)
+		pvAddrs->push_back(m_vLinks[Link].m_Other);
+}
+
+void CWhoIsIndex::FindNamePrefix(const char *pPrefix, std::vector<int> *pvNames) const
+{
+	// every name with the prefix has all its trigrams, the rarest one has the fewest candidates
+	pvNames->clear();
+	unsigned aTrigrams[MAX_KEY_LENGTH + 1];
+	int Num = GetTrigrams(pPrefix, false, aTrigrams);
+	const std::vector<int> *pvCandidates = 0;
+	for (int i = 0; i < Num; i++)
+	{
+		std::unordered_map<unsigned, std::vector<int> >::const_iterator It = m_Trigrams.find(aTrigrams[i]);
+		if (It == m_Trigrams.end())
+			return;
+		if (!pvCandidates || It->second.size() < pvCandidates->size())
+			pvCandidates = &It->second;
+	}
+	if (!pvCandidates)
+		return;
+
+	for (unsigned i = 0; i < pvCandidates->size(); i++)
+		if (str_startswith(GetKey(TABLE_NAME, (*pvCandidates)[i]), pPrefix))
+			pvNames->push_back((*pvCandidates)[i]);
+}
+
+void CWhoIsIndex::FindSimilarNames(const char *pName, int MaxResults, std::vector<int> *pvNames) const
+{
+	pvNames->clear();
+	unsigned aTrigrams[MAX_KEY_LENGTH + 1];
+	int NumTrigrams = GetTrigrams(pName, true, aTrigrams);
+
+	// shared trigrams per name, the names that got touched are collected to go through them afterwards
+	std::vector<unsigned char> vShared(Num(TABLE_NAME), 0);
+	std::vector<int> vCandidates;
+	for (int i = 0; i < NumTrigrams; i++)
+	{
+		std::unordered_map<unsigned, std::vector<int> >::const_iterator It = m_Trigrams.find(aTrigrams[i]);
+		if (It == m_Trigrams.end())
+			continue;
+		const std::vector<int> &vNames = It->second;
+		for (unsigned j = 0; j < vNames.size(); j++)
+			if (!vShared[vNames[j]]++)
+				vCandidates.push_back(vNames[j]);
+	}
+
+	struct CMatch
+	{
+		int m_Name;
+		float m_Similarity;
+	};
+	std::vector<CMatch> vMatches;
+	for (unsigned i = 0; i < vCandidates.size(); i++)
+	{
+		int Name = vCandidates[i];
+		int Shared = vShared[Name];
+		int Total = NumTrigrams + m_vNumTrigrams[Name] - Shared;
+		if (Shared * 100 < Total * MIN_SIMILARITY)
+			continue;
+		CMatch Match;
+		Match.m_Name = Name;
+		Match.m_Similarity = Shared / (float)Total;
+		vMatches.push_back(Match);
+	}
+
+	std::sort(vMatches.begin(), vMatches.end(), [this](const CMatch &a, const CMatch &b) {
+		if (a.m_Similarity != b.m_Similarity)
+			return a.m_Similarity > b.m_Similarity;
+		if (GetCount(TABLE_NAME, a.m_Name) != GetCount(TABLE_NAME, b.m_Name))
+			return GetCount(TABLE_NAME, a.m_Name) > GetCount(TABLE_NAME, b.m_Name);
+		return a.m_Name < b.m_Name;
+	});
+	for (int i = 0; i < (int)vMatches.size() && i < MaxResults; i++)
+		pvNames->push_back(vMatches[i].m_Name);
+}
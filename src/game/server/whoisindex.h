@@ -0,0 +1,104 @@
+#ifndef GAME_SERVER_WHOISINDEX_H
+#define GAME_SERVER_WHOISINDEX_H
+
+#include <base/system.h>
+
+#include <unordered_map>
+#include <vector>
+
+// which names connected from which ips and the other way round. keys live in one string arena and are found through
+// open addressing hash tables, the names and ips of an entry are a linked list in one shared pool. addresses are also
+// indexed by their /24 and /16 prefix and names by their trigrams, so none of the lookups has to scan all entries
+class CWhoIsIndex
+{
+public:
+	enum
+	{
+		TABLE_ADDR = 0,
+		TABLE_NAME,
+		NUM_TABLES,
+
+		MAX_KEY_LENGTH = 15,
+		// names per ip and ips per name
+		MAX_LINKS = 50,
+	};
+
+private:
+	enum
+	{
+		// in percent of the trigrams of both names, about where names stop looking alike
+		MIN_SIMILARITY = 30,
+	};
+
+	struct CEntry
+	{
+		int m_Key; // offset into the string arena
+		int m_Count;
+		int m_NumLinks;
+		int m_FirstLink;
+		int m_LastLink;
+	};
+
+	struct CLink
+	{
+		int m_Other; // entry in the other table
+		int m_Count;
+		int m_Next;
+	};
+
+	struct CTable
+	{
+		std::vector<CEntry> m_vEntries;
+		std::vector<int> m_vSlots; // entry or -1, the size is a power of two
+	};
+
+	std::vector<char> m_vStrings;
+	std::vector<CLink> m_vLinks;
+	CTable m_aTables[NUM_TABLES];
+	CTable m_Prefixes; // links to every address with that prefix, not capped
+	std::unordered_map<unsigned, std::vector<int> > m_Trigrams;
+	std::vector<unsigned char> m_vNumTrigrams; // per name
+	int m_MaxEntries;
+
+	static unsigned Hash(const char *pStr);
+	static int GetTrigrams(const char *pStr, bool Suffix, unsigned *pTrigrams);
+
+	const char *GetString(int Offset) const { return &m_vStrings[Offset]; }
+	int Find(const CTable *pTable, const char *pKey) const;
+	int Insert(CTable *pTable, const char *pKey);
+	void Grow(CTable *pTable);
+	void AddLink(CTable *pTable, int Entry, int Other, bool Capped);
+	void AddPrefixes(int Addr, const char *pAddr);
+	void AddTrigrams(int Name, const char *pName);
+
+public:
+	CWhoIsIndex();
+
+	void Clear();
+	// new ips and names are ignored once a table has that many
+	void SetMaxEntries(int MaxEntries) { m_MaxEntries = MaxEntries; }
+
+	bool Add(const char *pName, const char *pAddr);
+	// adds the complete "(<ip>): <name>" lines and returns the bytes read, a partial line at the end is left over
+	int AddLines(const char *pData, int Size);
+
+	int Num(int Table) const { return m_aTables[Table].m_vEntries.size(); }
+	int Find(int Table, const char *pKey) const { return Find(&m_aTables[Table], pKey); }
+	// addresses in the subnet of a prefix like "1.2.3" and names starting with pPrefix
+	void FindAddrPrefix(const char *pPrefix, std::vector<int> *pvAddrs) const;
+	void FindNamePrefix(const char *pPrefix, std::vector<int> *pvNames) const;
+	// names sharing the most trigrams with pName, best first
+	void FindSimilarNames(const char *pName, int MaxResults, std::vector<int> *pvNames) const;
+
+	const char *GetKey(int Table, int Entry) const { return GetString(m_aTables[Table].m_vEntries[Entry].m_Key); }
+	int GetCount(int Table, int Entry) const { return m_aTables[Table].m_vEntries[Entry].m_Count; }
+	int GetNumLinks(int Table, int Entry) const { return m_aTables[Table].m_vEntries[Entry].m_NumLinks; }
+
+	// the other side of an entry in the order it was first seen, -1 ends the list
+	int FirstLink(int Table, int Entry) const { return m_aTables[Table].m_vEntries[Entry].m_FirstLink; }
+	int NextLink(int Link) const { return m_vLinks[Link].m_Next; }
+	int GetLinkEntry(int Link) const { return m_vLinks[Link].m_Other; }
+	int GetLinkCount(int Link) const { return m_vLinks[Link].m_Count; }
+};
+
+#endif // GAME_SERVER_WHOISINDEX_H
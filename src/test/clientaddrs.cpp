@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <game/server/clientaddrs.h>
+
+static NETADDR MakeAddr(const char *pAddr)
+{
+	NETADDR Addr;
+	net_addr_from_str(&Addr, pAddr);
+	return Addr;
+}
+
+TEST(ClientAddrs, SameAddr)
+{
+	CClientAddrs Addrs;
+	NETADDR First = MakeAddr("1.2.3.4:8303");
+	NETADDR Second = MakeAddr("1.2.3.4:8304");
+	NETADDR Other = MakeAddr("5.6.7.8:8303");
+
+	// both connected from the same ip, only one of them entered
+	Addrs.OnConnected(0, &First);
+	Addrs.OnEntered(0);
+	Addrs.OnConnected(1, &Second);
+	EXPECT_FALSE(Addrs.SameAddr(0, 1));
+	EXPECT_FALSE(Addrs.SameAddr(1, 0));
+
+	Addrs.OnEntered(1);
+	EXPECT_TRUE(Addrs.SameAddr(0, 1));
+	EXPECT_TRUE(Addrs.SameAddr(1, 0));
+
+	// the slot is taken over by someone else, nothing of the old address is left
+	Addrs.OnDropped(1);
+	EXPECT_FALSE(Addrs.SameAddr(0, 1));
+	Addrs.OnConnected(1, &Other);
+	Addrs.OnEntered(1);
+	EXPECT_FALSE(Addrs.SameAddr(0, 1));
+
+	// entering without a connect doesn't match the zeroed address of two empty slots
+	Addrs.OnEntered(2);
+	Addrs.OnEntered(3);
+	EXPECT_FALSE(Addrs.HasEntered(2));
+	EXPECT_FALSE(Addrs.SameAddr(2, 3));
+}
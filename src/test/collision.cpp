@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+#include <base/system.h>
+#include <game/collision.h>
+
+#include <vector>
+
+static const int WIDTH = 512;
+static const int HEIGHT = 256;
+
+static std::vector<unsigned char> RandomFreeze(int Width, int Height, unsigned Seed)
+{
+	std::vector<unsigned char> vFreeze(Width * Height);
+	for(int i = 0; i < Width * Height; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		vFreeze[i] = (Seed >> 16) % 37 == 0;
+	}
+	return vFreeze;
+}
+
+TEST(Collision, FreezeDistance)
+{
+	std::vector<unsigned char> vFreeze = RandomFreeze(WIDTH, HEIGHT, 1);
+	std::vector<unsigned char> vDist(WIDTH * HEIGHT);
+	CCollision::ComputeFreezeDistance(&vFreeze[0], WIDTH, HEIGHT, &vDist[0]);
+
+	// compare against a brute force search on a slice of the map
+	for(int y = 0; y < 8; y++)
+	{
+		for(int x = 0; x < 16; x++)
+		{
+			int Best = 255;
+			for(int j = 0; j < HEIGHT; j++)
+				for(int i = 0; i < WIDTH; i++)
+					if(vFreeze[j * WIDTH + i])
+						Best = min(Best, max(absolute(i - x), absolute(j - y)));
+			ASSERT_EQ(vDist[y * WIDTH + x], Best);
+		}
+	}
+
+	std::vector<unsigned char> vNone(WIDTH * HEIGHT, 0);
+	CCollision::ComputeFreezeDistance(&vNone[0], WIDTH, HEIGHT, &vDist[0]);
+	EXPECT_EQ(vDist[0], 255);
+	EXPECT_EQ(vDist[WIDTH * HEIGHT - 1], 255);
+}
+
+TEST(Collision, FreezeDistanceProbes)
+{
+	std::vector<unsigned char> vFreeze = RandomFreeze(WIDTH, HEIGHT, 2);
+	std::vector<unsigned char> vDist(WIDTH * HEIGHT);
+	CCollision::ComputeFreezeDistance(&vFreeze[0], WIDTH, HEIGHT, &vDist[0]);
+
+	// the field is a superset of the probes, it never misses a freeze tile they would find
+	unsigned Seed = 3;
+	for(int i = 0; i < 100000; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		int Index = (Seed >> 8) % (WIDTH * HEIGHT);
+		if(CCollision::ProbeFreeze(&vFreeze[0], WIDTH, HEIGHT, Index % WIDTH, Index / WIDTH, i % 4))
+		{
+			ASSERT_LE(vDist[Index], max(2, i % 4));
+		}
+	}
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <engine/config.h>
+#include <engine/console.h>
+#include <engine/kernel.h>
+#include <engine/shared/config.h>
+#include <engine/shared/protocol.h>
+
+static void Nothing(IConsole::IResult *pResult, void *pUserData)
+{
+}
+
+TEST(Console, FindCommand)
+{
+	IConsole *pConsole = CreateConsole(CFGFLAG_SERVER);
+	pConsole->Register("zeta", "", CFGFLAG_SERVER, Nothing, 0, "", AUTHED_ADMIN);
+	pConsole->Register("alpha", "", CFGFLAG_SERVER, Nothing, 0, "", AUTHED_ADMIN);
+	pConsole->Register("Beta", "", CFGFLAG_SERVER, Nothing, 0, "", AUTHED_ADMIN);
+
+	EXPECT_TRUE(pConsole->GetCommandInfo("zeta", CFGFLAG_SERVER, false));
+	EXPECT_TRUE(pConsole->GetCommandInfo("ALPHA", CFGFLAG_SERVER, false));
+	EXPECT_TRUE(pConsole->GetCommandInfo("beta", CFGFLAG_SERVER, false));
+	EXPECT_FALSE(pConsole->GetCommandInfo("beta", CFGFLAG_CHAT, false));
+	EXPECT_FALSE(pConsole->GetCommandInfo("gamma", CFGFLAG_SERVER, false));
+
+	// all commands are still listed
+	int Found = 0;
+	for(const IConsole::CCommandInfo *pInfo = pConsole->FirstCommandInfo(IConsole::ACCESS_LEVEL_ADMIN, CFGFLAG_SERVER); pInfo; pInfo = pInfo->NextCommandInfo(IConsole::ACCESS_LEVEL_ADMIN, CFGFLAG_SERVER))
+		if(!str_comp(pInfo->m_pName, "zeta") || !str_comp(pInfo->m_pName, "alpha") || !str_comp(pInfo->m_pName, "Beta"))
+			Found++;
+	EXPECT_EQ(Found, 3);
+
+	delete pConsole;
+}
+
+TEST(Console, TempCommands)
+{
+	IConsole *pConsole = CreateConsole(CFGFLAG_SERVER);
+	pConsole->RegisterTemp("temp_one", "", CFGFLAG_SERVER, "");
+	pConsole->RegisterTemp("temp_two", "", CFGFLAG_SERVER, "");
+	EXPECT_TRUE(pConsole->GetCommandInfo("temp_one", CFGFLAG_SERVER, true));
+	EXPECT_TRUE(pConsole->GetCommandInfo("TEMP_TWO", CFGFLAG_SERVER, true));
+
+	pConsole->DeregisterTemp("temp_one");
+	EXPECT_FALSE(pConsole->GetCommandInfo("temp_one", CFGFLAG_SERVER, true));
+	EXPECT_TRUE(pConsole->GetCommandInfo("temp_two", CFGFLAG_SERVER, true));
+
+	// recycled entry gets a new name
+	pConsole->RegisterTemp("temp_three", "", CFGFLAG_SERVER, "");
+	EXPECT_TRUE(pConsole->GetCommandInfo("temp_three", CFGFLAG_SERVER, true));
+	EXPECT_FALSE(pConsole->GetCommandInfo("temp_one", CFGFLAG_SERVER, true));
+
+	pConsole->DeregisterTempAll();
+	EXPECT_FALSE(pConsole->GetCommandInfo("temp_two", CFGFLAG_SERVER, true));
+	EXPECT_FALSE(pConsole->GetCommandInfo("temp_three", CFGFLAG_SERVER, true));
+
+	delete pConsole;
+}
+
+static void CountArgs(IConsole::IResult *pResult, void *pUserData)
+{
+	int *pCount = (int *)pUserData;
+	if(pResult->NumArguments() == 2 && !str_comp(pResult->GetString(0), "foo") && pResult->GetInteger(1) == 42)
+		(*pCount)++;
+}
+
+TEST(Console, RepeatedLines)
+{
+	IKernel *pKernel = IKernel::Create();
+	IConsole *pConsole = CreateConsole(CFGFLAG_SERVER);
+	IConfigManager *pConfigManager = CreateConfigManager();
+	pKernel->RegisterInterface(pConsole);
+	pKernel->RegisterInterface(pConfigManager);
+	pConfigManager->Init(CFGFLAG_SERVER);
+	pConsole->Init();
+
+	int Count = 0;
+	pConsole->Register("count", "s[str] i[num]", CFGFLAG_SERVER, CountArgs, &Count, "", AUTHED_ADMIN);
+
+	for(int i = 0; i < 5; i++)
+		pConsole->ExecuteLine("count \"foo\" 42; count foo 42");
+	EXPECT_EQ(Count, 10);
+
+	// a changed format has to be picked up
+	pConsole->Register("count", "s[str]", CFGFLAG_SERVER, CountArgs, &Count, "", AUTHED_ADMIN);
+	pConsole->ExecuteLine("count foo 42");
+	EXPECT_EQ(Count, 10);
+
+	delete pConsole;
+	delete pConfigManager;
+	delete pKernel;
+}
@@ -0,0 +1,212 @@
+#include "test.h"
+
+#include <gtest/gtest.h>
+
+#include <engine/console.h>
+#include <engine/shared/compression.h>
+#include <engine/shared/config.h>
+#include <engine/shared/demo.h>
+#include <engine/shared/huffman.h>
+#include <engine/storage.h>
+
+#include <vector>
+
+enum
+{
+	NUM_TICKS=600,
+	MESSAGE_INTERVAL=7,
+};
+
+// the chunk layout, see demo.cpp
+enum
+{
+	CHUNKTYPEFLAG_TICKMARKER=0x80,
+	CHUNKTICKFLAG_KEYFRAME=0x40,
+	CHUNKMASK_TICK=0x3f,
+	CHUNKMASK_TYPE=0x60,
+	CHUNKMASK_SIZE=0x1f,
+
+	CHUNKTYPE_SNAPSHOT=1,
+	CHUNKTYPE_MESSAGE=2,
+	CHUNKTYPE_DELTA=3,
+};
+
+struct CRecordedSnapshot
+{
+	int m_Tick;
+	int m_NumItems;
+	int m_Crc;
+};
+
+// a few moving items, one that never changes and one that shows up every other second.
+// item lookups expect sorted keys and unpacking appends new items, so that one comes last
+static int BuildSnapshot(int Tick, void *pData)
+{
+	CSnapshotBuilder Builder;
+	Builder.Init();
+	for(int i = 0; i < 8; i++)
+	{
+		int *pItem = (int *)Builder.NewItem(1, i, sizeof(int)*4);
+		pItem[0] = Tick * (i + 1);
+		pItem[1] = i;
+		pItem[2] = Tick / 25;
+		pItem[3] = -i;
+	}
+	int *pStatic = (int *)Builder.NewItem(2, 0, sizeof(int));
+	pStatic[0] = 1337;
+	if((Tick / 50) % 2)
+	{
+		int *pItem = (int *)Builder.NewItem(3, 0, sizeof(int)*2);
+		pItem[0] = Tick;
+		pItem[1] = 1;
+	}
+	return Builder.Finish(pData);
+}
+
+TEST(Demo, RecordRoundTrip)
+{
+	CTestInfo Info;
+	char aMapName[128];
+	char aMapFilename[128];
+	char aDemoFilename[128];
+	Info.Filename(aMapName, sizeof(aMapName), "-map");
+	str_format(aMapFilename, sizeof(aMapFilename), "maps/%s.map", aMapName);
+	Info.Filename(aDemoFilename, sizeof(aDemoFilename), ".demo");
+
+	IStorage *pStorage = CreateTestStorage();
+	IConsole *pConsole = CreateConsole(CFGFLAG_SERVER);
+
+	// the recorder embeds the map, any file will do
+	static const char s_aMapData[] = "not really a map";
+	fs_makedir("maps");
+	IOHANDLE MapFile = pStorage->OpenFile(aMapFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	ASSERT_TRUE(MapFile);
+	io_write(MapFile, s_aMapData, sizeof(s_aMapData));
+	io_close(MapFile);
+
+	CSnapshotDelta SnapshotDelta;
+	CDemoRecorder *pRecorder = new CDemoRecorder(&SnapshotDelta);
+	ASSERT_EQ(pRecorder->Start(pStorage, pConsole, aDemoFilename, "0.6", aMapName, sha256(s_aMapData, sizeof(s_aMapData)), 0, "server"), 0);
+	EXPECT_TRUE(pRecorder->IsRecording());
+
+	std::vector<CRecordedSnapshot> vSnapshots;
+	std::vector<int> vMessages;
+	static char s_aData[CSnapshot::MAX_SIZE];
+	for(int Tick = 1; Tick <= NUM_TICKS; Tick++)
+	{
+		if(Tick % MESSAGE_INTERVAL == 0)
+		{
+			int aMessage[3] = { Tick, -Tick, 42 };
+			pRecorder->RecordMessage(aMessage, sizeof(aMessage));
+			vMessages.push_back(Tick);
+		}
+
+		if(!pRecorder->WantSnapshot())
+			continue;
+		int Size = BuildSnapshot(Tick, s_aData);
+		pRecorder->RecordSnapshot(Tick, s_aData, Size);
+		CSnapshot *pSnap = (CSnapshot *)s_aData;
+		CRecordedSnapshot Snapshot = { Tick, pSnap->NumItems(), pSnap->Crc() };
+		vSnapshots.push_back(Snapshot);
+	}
+	EXPECT_EQ(pRecorder->Length(), (NUM_TICKS - 1) / SERVER_TICK_SPEED);
+	EXPECT_EQ(pRecorder->Stop(), 0);
+	EXPECT_FALSE(pRecorder->IsRecording());
+	delete pRecorder;
+
+	// read it back the way the demo player does
+	IOHANDLE File = pStorage->OpenFile(aDemoFilename, IOFLAG_READ, IStorage::TYPE_SAVE);
+	ASSERT_TRUE(File);
+	CDemoHeader Header;
+	ASSERT_EQ(io_read(File, &Header, sizeof(Header)), sizeof(Header));
+	EXPECT_EQ(bytes_be_to_uint(Header.m_aLength), (NUM_TICKS - 1) / SERVER_TICK_SPEED);
+	EXPECT_EQ(bytes_be_to_uint(Header.m_aMapSize), sizeof(s_aMapData));
+	io_skip(File, bytes_be_to_uint(Header.m_aMapSize));
+
+	CHuffman Huffman;
+	Huffman.Init();
+	static char s_aCompressed[CSnapshot::MAX_SIZE];
+	static char s_aDecompressed[CSnapshot::MAX_SIZE];
+	static char s_aLast[CSnapshot::MAX_SIZE];
+	static char s_aNew[CSnapshot::MAX_SIZE];
+	int Tick = 0;
+	int NumKeyFrames = 0;
+	unsigned NumSnapshots = 0;
+	unsigned NumMessages = 0;
+	unsigned char Chunk;
+	while(io_read(File, &Chunk, 1) == 1)
+	{
+		if(Chunk&CHUNKTYPEFLAG_TICKMARKER)
+		{
+			if(Chunk&CHUNKTICKFLAG_KEYFRAME)
+				NumKeyFrames++;
+			if(Chunk&CHUNKMASK_TICK)
+				Tick += Chunk&CHUNKMASK_TICK;
+			else
+			{
+				unsigned char aTick[4];
+				ASSERT_EQ(io_read(File, aTick, sizeof(aTick)), sizeof(aTick));
+				Tick = bytes_be_to_uint(aTick);
+			}
+			continue;
+		}
+
+		int Type = (Chunk&CHUNKMASK_TYPE)>>5;
+		int Size = Chunk&CHUNKMASK_SIZE;
+		if(Size >= 30)
+		{
+			unsigned char aSize[2] = { 0, 0 };
+			ASSERT_EQ(io_read(File, aSize, Size - 29), (unsigned)Size - 29);
+			Size = aSize[0] | (aSize[1]<<8);
+		}
+		ASSERT_EQ(io_read(File, s_aCompressed, Size), (unsigned)Size);
+		int DataSize = Huffman.Decompress(s_aCompressed, Size, s_aDecompressed, sizeof(s_aDecompressed));
+		ASSERT_GE(DataSize, 0);
+		DataSize = CVariableInt::Decompress(s_aDecompressed, DataSize, s_aData, sizeof(s_aData));
+		ASSERT_GE(DataSize, 0);
+
+		if(Type == CHUNKTYPE_MESSAGE)
+		{
+			ASSERT_LT(NumMessages, vMessages.size());
+			const int *pMessage = (const int *)s_aData;
+			EXPECT_EQ(pMessage[0], vMessages[NumMessages]);
+			EXPECT_EQ(pMessage[1], -vMessages[NumMessages]);
+			EXPECT_EQ(pMessage[2], 42);
+			NumMessages++;
+			continue;
+		}
+
+		if(Type == CHUNKTYPE_SNAPSHOT)
+		{
+			CSnapshotBuilder Builder;
+			ASSERT_TRUE(Builder.UnserializeSnap(s_aData, DataSize));
+			Builder.Finish(s_aNew);
+		}
+		else
+		{
+			ASSERT_EQ(Type, (int)CHUNKTYPE_DELTA);
+			ASSERT_GE(SnapshotDelta.UnpackDelta((CSnapshot *)s_aLast, (CSnapshot *)s_aNew, s_aData, DataSize), 0);
+		}
+		mem_copy(s_aLast, s_aNew, sizeof(s_aLast));
+
+		// snapshots that didn't change since the last one aren't written
+		CSnapshot *pSnap = (CSnapshot *)s_aNew;
+		while(NumSnapshots < vSnapshots.size() && vSnapshots[NumSnapshots].m_Tick < Tick)
+			NumSnapshots++;
+		ASSERT_LT(NumSnapshots, vSnapshots.size());
+		EXPECT_EQ(vSnapshots[NumSnapshots].m_Tick, Tick);
+		EXPECT_EQ(vSnapshots[NumSnapshots].m_NumItems, pSnap->NumItems());
+		EXPECT_EQ(vSnapshots[NumSnapshots].m_Crc, pSnap->Crc());
+		NumSnapshots++;
+	}
+	io_close(File);
+
+	EXPECT_EQ(NumMessages, vMessages.size());
+	EXPECT_EQ(NumSnapshots, vSnapshots.size());
+	EXPECT_GE(NumKeyFrames, 2);
+
+	pStorage->RemoveFile(aDemoFilename, IStorage::TYPE_SAVE);
+	pStorage->RemoveFile(aMapFilename, IStorage::TYPE_SAVE);
+	delete pConsole;
+	delete pStorage;
+}
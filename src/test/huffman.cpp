@@ -0,0 +1,373 @@
+#include <gtest/gtest.h>
+
+#include <base/hash.h>
+#include <base/system.h>
+#include <engine/shared/compression.h>
+#include <engine/shared/huffman.h>
+
+#include <vector>
+
+// the bit by bit implementation the table driven one replaced, the wire format must not change
+class CHuffmanReference
+{
+	enum
+	{
+		EOF_SYMBOL = 256,
+		MAX_SYMBOLS = EOF_SYMBOL+1,
+		MAX_NODES = MAX_SYMBOLS*2-1,
+		LUTBITS = 10,
+		LUTSIZE = 1<<LUTBITS,
+		LUTMASK = LUTSIZE-1
+	};
+
+	struct CNode
+	{
+		unsigned m_Bits;
+		unsigned m_NumBits;
+		unsigned short m_aLeafs[2];
+		unsigned char m_Symbol;
+	};
+
+	struct CConstructNode
+	{
+		unsigned short m_NodeId;
+		int m_Frequency;
+	};
+
+	CNode m_aNodes[MAX_NODES];
+	CNode *m_apDecodeLut[LUTSIZE];
+	CNode *m_pStartNode;
+	int m_NumNodes;
+
+	void Setbits_r(CNode *pNode, int Bits, unsigned Depth)
+	{
+		if(pNode->m_aLeafs[1] != 0xffff)
+			Setbits_r(&m_aNodes[pNode->m_aLeafs[1]], Bits|(1<<Depth), Depth+1);
+		if(pNode->m_aLeafs[0] != 0xffff)
+			Setbits_r(&m_aNodes[pNode->m_aLeafs[0]], Bits, Depth+1);
+		if(pNode->m_NumBits)
+		{
+			pNode->m_Bits = Bits;
+			pNode->m_NumBits = Depth;
+		}
+	}
+
+	static void BubbleSort(CConstructNode **ppList, int Size)
+	{
+		int Changed = 1;
+		while(Changed)
+		{
+			Changed = 0;
+			for(int i = 0; i < Size-1; i++)
+			{
+				if(ppList[i]->m_Frequency < ppList[i+1]->m_Frequency)
+				{
+					CConstructNode *pTemp = ppList[i];
+					ppList[i] = ppList[i+1];
+					ppList[i+1] = pTemp;
+					Changed = 1;
+				}
+			}
+			Size--;
+		}
+	}
+
+public:
+	void Init(const unsigned *pFrequencies)
+	{
+		mem_zero(this, sizeof(*this));
+
+		CConstructNode aNodesLeftStorage[MAX_SYMBOLS];
+		CConstructNode *apNodesLeft[MAX_SYMBOLS];
+		int NumNodesLeft = MAX_SYMBOLS;
+		for(int i = 0; i < MAX_SYMBOLS; i++)
+		{
+			m_aNodes[i].m_NumBits = 0xFFFFFFFF;
+			m_aNodes[i].m_Symbol = i;
+			m_aNodes[i].m_aLeafs[0] = 0xffff;
+			m_aNodes[i].m_aLeafs[1] = 0xffff;
+			aNodesLeftStorage[i].m_Frequency = i == EOF_SYMBOL ? 1 : pFrequencies[i];
+			aNodesLeftStorage[i].m_NodeId = i;
+			apNodesLeft[i] = &aNodesLeftStorage[i];
+		}
+		m_NumNodes = MAX_SYMBOLS;
+		while(NumNodesLeft > 1)
+		{
+			BubbleSort(apNodesLeft, NumNodesLeft);
+			m_aNodes[m_NumNodes].m_NumBits = 0;
+			m_aNodes[m_NumNodes].m_aLeafs[0] = apNodesLeft[NumNodesLeft-1]->m_NodeId;
+			m_aNodes[m_NumNodes].m_aLeafs[1] = apNodesLeft[NumNodesLeft-2]->m_NodeId;
+			apNodesLeft[NumNodesLeft-2]->m_NodeId = m_NumNodes;
+			apNodesLeft[NumNodesLeft-2]->m_Frequency = apNodesLeft[NumNodesLeft-1]->m_Frequency + apNodesLeft[NumNodesLeft-2]->m_Frequency;
+			m_NumNodes++;
+			NumNodesLeft--;
+		}
+		m_pStartNode = &m_aNodes[m_NumNodes-1];
+		Setbits_r(m_pStartNode, 0, 0);
+
+		for(int i = 0; i < LUTSIZE; i++)
+		{
+			unsigned Bits = i;
+			int k;
+			CNode *pNode = m_pStartNode;
+			for(k = 0; k < LUTBITS; k++)
+			{
+				pNode = &m_aNodes[pNode->m_aLeafs[Bits&1]];
+				Bits >>= 1;
+				if(pNode->m_NumBits)
+				{
+					m_apDecodeLut[i] = pNode;
+					break;
+				}
+			}
+			if(k == LUTBITS)
+				m_apDecodeLut[i] = pNode;
+		}
+	}
+
+	int Compress(const void *pInput, int InputSize, void *pOutput, int OutputSize)
+	{
+		const unsigned char *pSrc = (const unsigned char *)pInput;
+		unsigned char *pDst = (unsigned char *)pOutput;
+		unsigned char *pDstEnd = pDst + OutputSize;
+		unsigned Bits = 0;
+		unsigned Bitcount = 0;
+		for(int i = 0; i <= InputSize; i++)
+		{
+			int Symbol = i < InputSize ? pSrc[i] : (int)EOF_SYMBOL;
+			Bits |= m_aNodes[Symbol].m_Bits << Bitcount;
+			Bitcount += m_aNodes[Symbol].m_NumBits;
+			while(Bitcount >= 8)
+			{
+				*pDst++ = (unsigned char)(Bits&0xff);
+				if(pDst == pDstEnd)
+					return -1;
+				Bits >>= 8;
+				Bitcount -= 8;
+			}
+		}
+		*pDst++ = Bits;
+		return (int)(pDst - (const unsigned char *)pOutput);
+	}
+
+	int Decompress(const void *pInput, int InputSize, void *pOutput, int OutputSize)
+	{
+		unsigned char *pDst = (unsigned char *)pOutput;
+		unsigned char *pSrc = (unsigned char *)pInput;
+		unsigned char *pDstEnd = pDst + OutputSize;
+		unsigned char *pSrcEnd = pSrc + InputSize;
+		unsigned Bits = 0;
+		unsigned Bitcount = 0;
+		CNode *pEof = &m_aNodes[EOF_SYMBOL];
+		while(1)
+		{
+			CNode *pNode = 0;
+			if(Bitcount >= LUTBITS)
+				pNode = m_apDecodeLut[Bits&LUTMASK];
+			while(Bitcount < 24 && pSrc != pSrcEnd)
+			{
+				Bits |= (*pSrc++) << Bitcount;
+				Bitcount += 8;
+			}
+			if(!pNode)
+				pNode = m_apDecodeLut[Bits&LUTMASK];
+			if(pNode->m_NumBits)
+			{
+				Bits >>= pNode->m_NumBits;
+				Bitcount -= pNode->m_NumBits;
+			}
+			else
+			{
+				Bits >>= LUTBITS;
+				Bitcount -= LUTBITS;
+				while(1)
+				{
+					pNode = &m_aNodes[pNode->m_aLeafs[Bits&1]];
+					Bitcount--;
+					Bits >>= 1;
+					if(pNode->m_NumBits)
+						break;
+					if(Bitcount == 0)
+						return -1;
+				}
+			}
+			if(pNode == pEof)
+				break;
+			if(pDst == pDstEnd)
+				return -1;
+			*pDst++ = pNode->m_Symbol;
+		}
+		return (int)(pDst - (const unsigned char *)pOutput);
+	}
+};
+
+static unsigned Rand(unsigned *pSeed)
+{
+	*pSeed = *pSeed * 1103515245 + 12345;
+	return *pSeed >> 8;
+}
+
+// varint packed fields of a fake snapshot delta, which is what the network layer compresses most
+static std::vector<unsigned char> SnapshotLikeData(int NumInts, unsigned Seed)
+{
+	std::vector<unsigned char> vData(NumInts * 5);
+	unsigned char *pDst = &vData[0];
+	for(int i = 0; i < NumInts; i++)
+	{
+		unsigned Value = Rand(&Seed);
+		int Kind = Value % 10;
+		int Int = Kind < 6 ? 0 : Kind < 9 ? (int)(Value >> 4) % 64 - 32 : (int)(Value >> 4) % 100000;
+		pDst = CVariableInt::Pack(pDst, Int);
+	}
+	vData.resize(pDst - &vData[0]);
+	return vData;
+}
+
+static void RandomFrequencies(unsigned *pFrequencies, unsigned Seed)
+{
+	for(int i = 0; i < 256; i++)
+	{
+		// skewed, so some codes end up a lot longer than the primary table
+		unsigned Value = Rand(&Seed);
+		pFrequencies[i] = Value % 4 == 0 ? Value % 100000 : Value % 16 + 1;
+	}
+}
+
+TEST(Huffman, DefaultTableUnchanged)
+{
+	// output of the bit by bit encoder with the default frequencies
+	CHuffman Huffman;
+	Huffman.Init();
+	std::vector<unsigned char> vData = SnapshotLikeData(20000, 1);
+	std::vector<unsigned char> vCompressed(vData.size() * 2 + 16);
+	int Size = Huffman.Compress(&vData[0], vData.size(), &vCompressed[0], vCompressed.size());
+	ASSERT_GT(Size, 0);
+
+	char aHash[SHA256_MAXSTRSIZE];
+	sha256_str(sha256(&vCompressed[0], Size), aHash, sizeof(aHash));
+	EXPECT_EQ(Size, 14794);
+	EXPECT_STREQ(aHash, "13156df0f861f2512c4682a2c85c3723528120997c2175137785676821f572d4");
+
+	std::vector<unsigned char> vDecompressed(vData.size());
+	EXPECT_EQ(Huffman.Decompress(&vCompressed[0], Size, &vDecompressed[0], vDecompressed.size()), (int)vData.size());
+	EXPECT_TRUE(vDecompressed == vData);
+}
+
+TEST(Huffman, MatchesReference)
+{
+	unsigned aFrequencies[256];
+	for(unsigned Seed = 1; Seed <= 20; Seed++)
+	{
+		RandomFrequencies(aFrequencies, Seed);
+		CHuffman Huffman;
+		Huffman.Init(aFrequencies);
+		static CHuffmanReference s_Reference;
+		s_Reference.Init(aFrequencies);
+
+		unsigned DataSeed = Seed;
+		for(int Round = 0; Round < 50; Round++)
+		{
+			int Size = Rand(&DataSeed) % 2000;
+			std::vector<unsigned char> vData(Size + 1);
+			for(int i = 0; i < Size; i++)
+				vData[i] = Rand(&DataSeed) % (Round % 2 ? 256 : 16);
+
+			unsigned char aExpected[8192];
+			unsigned char aGot[8192];
+			int ExpectedSize = s_Reference.Compress(&vData[0], Size, aExpected, sizeof(aExpected));
+			int GotSize = Huffman.Compress(&vData[0], Size, aGot, sizeof(aGot));
+			ASSERT_EQ(GotSize, ExpectedSize);
+			ASSERT_EQ(mem_comp(aGot, aExpected, GotSize), 0);
+
+			unsigned char aDecompressed[2048];
+			ASSERT_EQ(Huffman.Decompress(aGot, GotSize, aDecompressed, sizeof(aDecompressed)), Size);
+			ASSERT_EQ(mem_comp(aDecompressed, &vData[0], Size), 0);
+			int ExpectedDecompressed = s_Reference.Decompress(aExpected, ExpectedSize, aDecompressed, sizeof(aDecompressed));
+			if(ExpectedDecompressed >= 0) // the old decoder gave up on codes longer than 24 bits
+			{
+				ASSERT_EQ(ExpectedDecompressed, Size);
+			}
+
+			// the output buffer is too small by one byte
+			ASSERT_EQ(Huffman.Compress(&vData[0], Size, aGot, ExpectedSize - 1), -1);
+			ASSERT_EQ(s_Reference.Compress(&vData[0], Size, aExpected, ExpectedSize - 1), -1);
+		}
+	}
+}
+
+TEST(Huffman, Fuzz)
+{
+	CHuffman Huffman;
+	Huffman.Init();
+
+	unsigned Seed = 5;
+	for(int Round = 0; Round < 20000; Round++)
+	{
+		unsigned char aInput[256];
+		int Size = Rand(&Seed) % sizeof(aInput);
+		for(int i = 0; i < Size; i++)
+			aInput[i] = Rand(&Seed);
+
+		// whatever comes in, the decoder stays inside both buffers and is deterministic
+		unsigned char aOutput[512];
+		unsigned char aOutput2[512];
+		int OutputSize = Rand(&Seed) % sizeof(aOutput);
+		int Result = Huffman.Decompress(aInput, Size, aOutput, OutputSize);
+		ASSERT_GE(Result, -1);
+		ASSERT_LE(Result, OutputSize);
+		ASSERT_EQ(Huffman.Decompress(aInput, Size, aOutput2, OutputSize), Result);
+		if(Result > 0)
+		{
+			ASSERT_EQ(mem_comp(aOutput, aOutput2, Result), 0);
+		}
+	}
+}
+
+TEST(Huffman, FuzzAgainstReference)
+{
+	// damaged streams decode the same as before, truncated ones never produce wrong data
+	CHuffman Huffman;
+	unsigned aFrequencies[256];
+	RandomFrequencies(aFrequencies, 3);
+	Huffman.Init(aFrequencies);
+	static CHuffmanReference s_Reference;
+	s_Reference.Init(aFrequencies);
+
+	unsigned Seed = 17;
+	for(int Round = 0; Round < 2000; Round++)
+	{
+		unsigned char aData[300];
+		int Size = Rand(&Seed) % sizeof(aData);
+		for(int i = 0; i < Size; i++)
+			aData[i] = Rand(&Seed) % 64;
+
+		unsigned char aCompressed[4096];
+		int CompressedSize = Huffman.Compress(aData, Size, aCompressed, sizeof(aCompressed));
+		ASSERT_GT(CompressedSize, 0);
+
+		// flip a bit now and then
+		if(Round % 3 == 0)
+			aCompressed[Rand(&Seed) % CompressedSize] ^= 1 << (Rand(&Seed) % 8);
+
+		unsigned char aExpected[512];
+		unsigned char aGot[512];
+		int Expected = s_Reference.Decompress(aCompressed, CompressedSize, aExpected, sizeof(aExpected));
+		int Got = Huffman.Decompress(aCompressed, CompressedSize, aGot, sizeof(aGot));
+		if(Round % 3 != 0)
+		{
+			ASSERT_EQ(Got, Size);
+		}
+		if(Got >= 0 && Expected >= 0)
+		{
+			ASSERT_EQ(Got, Expected);
+			ASSERT_EQ(mem_comp(aGot, aExpected, Got), 0);
+		}
+
+		int Truncated = Rand(&Seed) % CompressedSize;
+		int GotTruncated = Huffman.Decompress(aCompressed, Truncated, aGot, sizeof(aGot));
+		if(GotTruncated >= 0 && Round % 3 != 0)
+		{
+			ASSERT_EQ(mem_comp(aGot, aData, GotTruncated), 0);
+		}
+	}
+}
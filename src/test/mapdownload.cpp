@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+#include <base/system.h>
+#include <engine/server/mapdownload.h>
+
+#include <deque>
+
+enum
+{
+	NUM_DOWNLOADERS=100,
+	CHUNK_SIZE=1400,
+	MAP_CHUNKS=64,
+	MAX_CHUNKS_PER_REQUEST=16,
+	RATE=2*1024*1024,
+};
+
+// 0.7 style downloads over a loopback with a fixed latency: every client asks for the
+// next batch once it got the whole previous one, the server loop runs every 10ms
+class CDownloadSimulation
+{
+public:
+	struct CDownloader
+	{
+		int m_BatchSize;
+		int m_NumSent;
+		int m_NumReceived;
+		int m_NumRequested;
+		int64 m_RequestArrival;
+		int64 m_FinishTime;
+		std::deque<int64> m_Arrivals;
+	};
+
+	CMapDownloadScheduler m_Scheduler;
+	CDownloader m_aDownloaders[NUM_DOWNLOADERS];
+	int64 m_Start;
+	int64 m_Now;
+	int64 m_Latency;
+	int m_SnapshotRate;
+	int64 m_SnapshotBytes;
+
+	static int SendChunk(int ClientID, void *pUser)
+	{
+		CDownloadSimulation *pThis = (CDownloadSimulation *)pUser;
+		CDownloader *pDownloader = &pThis->m_aDownloaders[ClientID];
+		if(pDownloader->m_NumSent == MAP_CHUNKS)
+			return 0;
+		EXPECT_LT(pDownloader->m_NumSent, pDownloader->m_NumRequested);
+		pDownloader->m_NumSent++;
+		pDownloader->m_Arrivals.push_back(pThis->m_Now + pThis->m_Latency);
+		return CHUNK_SIZE;
+	}
+
+	CDownloadSimulation(int Rate, int64 Latency)
+	{
+		m_Scheduler.Init(SendChunk, this);
+		m_Scheduler.SetLimits(Rate, MAX_CHUNKS_PER_REQUEST, CHUNK_SIZE);
+		m_Start = m_Now = time_freq();
+		m_Latency = Latency;
+		m_SnapshotRate = 0;
+		m_SnapshotBytes = 0;
+		for(int i = 0; i < NUM_DOWNLOADERS; i++)
+		{
+			CDownloader *pDownloader = &m_aDownloaders[i];
+			pDownloader->m_BatchSize = 0;
+			pDownloader->m_NumSent = 0;
+			pDownloader->m_NumReceived = 0;
+			pDownloader->m_NumRequested = 0;
+			pDownloader->m_RequestArrival = 0;
+			pDownloader->m_FinishTime = 0;
+		}
+	}
+
+	void Connect(int ClientID)
+	{
+		// the batch size is fixed with the map change, the first request follows right away
+		CDownloader *pDownloader = &m_aDownloaders[ClientID];
+		pDownloader->m_BatchSize = m_Scheduler.ChunksPerRequest();
+		pDownloader->m_NumRequested = pDownloader->m_BatchSize;
+		pDownloader->m_RequestArrival = m_Now + m_Latency;
+	}
+
+	void Step()
+	{
+		int64 StepTime = time_freq() / 100;
+		m_Now += StepTime;
+
+		for(int i = 0; i < NUM_DOWNLOADERS; i++)
+		{
+			CDownloader *pDownloader = &m_aDownloaders[i];
+			while(!pDownloader->m_Arrivals.empty() && pDownloader->m_Arrivals.front() <= m_Now)
+			{
+				pDownloader->m_Arrivals.pop_front();
+				if(++pDownloader->m_NumReceived == MAP_CHUNKS)
+				{
+					// the client is ready, the server ends the download
+					pDownloader->m_FinishTime = m_Now;
+					m_Scheduler.Stop(i);
+				}
+				else if(pDownloader->m_NumReceived == pDownloader->m_NumRequested)
+				{
+					pDownloader->m_NumRequested += pDownloader->m_BatchSize;
+					pDownloader->m_RequestArrival = m_Now + m_Latency;
+				}
+			}
+
+			if(pDownloader->m_RequestArrival && pDownloader->m_RequestArrival <= m_Now)
+			{
+				pDownloader->m_RequestArrival = 0;
+				m_Scheduler.Request(i, pDownloader->m_BatchSize, m_Now);
+			}
+		}
+
+		int Snapshots = m_SnapshotRate * StepTime / time_freq();
+		m_SnapshotBytes += Snapshots;
+		m_Scheduler.AddTraffic(Snapshots);
+		m_Scheduler.Update(m_Now);
+	}
+
+	bool Done() const
+	{
+		for(int i = 0; i < NUM_DOWNLOADERS; i++)
+			if(!m_aDownloaders[i].m_FinishTime)
+				return false;
+		return true;
+	}
+
+	// runs until everyone got the map, returns the seconds that took
+	double Run()
+	{
+		for(int i = 0; i < 60 * 100 && !Done(); i++)
+			Step();
+		EXPECT_TRUE(Done());
+		return (m_Now - m_Start) / (double)time_freq();
+	}
+};
+
+TEST(MapDownload, MassReconnect)
+{
+	CDownloadSimulation Sim(RATE, time_freq() / 20);
+	for(int i = 0; i < NUM_DOWNLOADERS; i++)
+		Sim.Connect(i);
+
+	// halfway through everyone should have about the same part of the map
+	double Expected = NUM_DOWNLOADERS * MAP_CHUNKS * CHUNK_SIZE / (double)RATE;
+	while((Sim.m_Now - Sim.m_Start) / (double)time_freq() < Expected / 2)
+		Sim.Step();
+	int MinReceived = MAP_CHUNKS;
+	int MaxReceived = 0;
+	for(int i = 0; i < NUM_DOWNLOADERS; i++)
+	{
+		MinReceived = min(MinReceived, Sim.m_aDownloaders[i].m_NumReceived);
+		MaxReceived = max(MaxReceived, Sim.m_aDownloaders[i].m_NumReceived);
+	}
+	EXPECT_GT(MinReceived, MAP_CHUNKS / 4);
+	EXPECT_LE(MaxReceived - MinReceived, MAX_CHUNKS_PER_REQUEST);
+
+	// the rate is kept and used up
+	double Time = Sim.Run();
+	EXPECT_GE(Time, Expected * 0.95);
+	EXPECT_LE(Time, Expected * 1.2);
+
+	int64 FirstFinish = Sim.m_Now;
+	for(int i = 0; i < NUM_DOWNLOADERS; i++)
+		FirstFinish = min(FirstFinish, Sim.m_aDownloaders[i].m_FinishTime);
+	EXPECT_GE((FirstFinish - Sim.m_Start) / (double)time_freq(), Time * 0.8);
+	EXPECT_EQ(Sim.m_Scheduler.NumDownloads(), 0);
+}
+
+TEST(MapDownload, ChunksPerRequest)
+{
+	CDownloadSimulation Sim(RATE, time_freq() / 20);
+	EXPECT_EQ(Sim.m_Scheduler.ChunksPerRequest(), (int)MAX_CHUNKS_PER_REQUEST);
+	for(int i = 0; i < NUM_DOWNLOADERS; i++)
+		Sim.Connect(i);
+	for(int i = 0; i < 200; i++)
+		Sim.Step();
+
+	// the first batches took a while to go out to everyone, with a hundred downloads on 100ms round trips a few chunks per request are plenty
+	int Chunks = Sim.m_Scheduler.ChunksPerRequest();
+	EXPECT_GE(Chunks, 1);
+	EXPECT_LT(Chunks, (int)MAX_CHUNKS_PER_REQUEST);
+
+	// and a single one should ask for as much as it may
+	Sim.Run();
+	EXPECT_EQ(Sim.m_Scheduler.ChunksPerRequest(), (int)MAX_CHUNKS_PER_REQUEST);
+
+	CDownloadSimulation Unlimited(0, time_freq() / 20);
+	EXPECT_EQ(Unlimited.m_Scheduler.ChunksPerRequest(), (int)MAX_CHUNKS_PER_REQUEST);
+}
+
+TEST(MapDownload, SnapshotsFirst)
+{
+	CDownloadSimulation Sim(RATE, time_freq() / 20);
+	for(int i = 0; i < NUM_DOWNLOADERS; i++)
+		Sim.Connect(i);
+	Sim.m_SnapshotRate = RATE / 2;
+
+	// downloads get what the snapshots leave plus the small reserve
+	double Time = Sim.Run();
+	double Expected = NUM_DOWNLOADERS * MAP_CHUNKS * CHUNK_SIZE / (double)RATE;
+	EXPECT_GE(Time, Expected * 1.6);
+	EXPECT_LE(Time, Expected * 2.2);
+}
+
+TEST(MapDownload, NoStallOnFullServer)
+{
+	CDownloadSimulation Sim(RATE, time_freq() / 20);
+	for(int i = 0; i < 10; i++)
+		Sim.Connect(i);
+	Sim.m_SnapshotRate = RATE * 2;
+
+	// only the reserve is left, still every download moves on
+	for(int i = 0; i < 100; i++)
+		Sim.Step();
+	for(int i = 0; i < 10; i++)
+		EXPECT_GT(Sim.m_aDownloaders[i].m_NumReceived, 0);
+}
+
+TEST(MapDownload, Unlimited)
+{
+	CDownloadSimulation Sim(0, time_freq() / 20);
+	for(int i = 0; i < NUM_DOWNLOADERS; i++)
+		Sim.Connect(i);
+
+	// only the round trips count: one per batch plus the last arrival
+	double Time = Sim.Run();
+	int RoundTrips = (MAP_CHUNKS + MAX_CHUNKS_PER_REQUEST - 1) / MAX_CHUNKS_PER_REQUEST;
+	EXPECT_LE(Time, RoundTrips * 0.1 + 0.1);
+}
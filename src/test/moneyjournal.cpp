@@ -0,0 +1,174 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <game/server/moneyjournal.h>
+
+#include <vector>
+
+static void RemoveFiles(const char *pPath)
+{
+	static const char *s_apSuffixes[] = { ".snapshot", ".journal", ".journal.old" };
+	char aFilename[IO_MAX_PATH_LENGTH];
+	for (unsigned i = 0; i < sizeof(s_apSuffixes) / sizeof(s_apSuffixes[0]); i++)
+	{
+		str_format(aFilename, sizeof(aFilename), "%s%s", pPath, s_apSuffixes[i]);
+		fs_remove(aFilename);
+	}
+}
+
+static void AppendBytes(const char *pFilename, const void *pData, unsigned Size)
+{
+	IOHANDLE File = io_open(pFilename, IOFLAG_APPEND);
+	ASSERT_TRUE(File);
+	io_write(File, pData, Size);
+	io_close(File);
+}
+
+TEST(MoneyJournal, RoundTrip)
+{
+	CTestInfo Info;
+	int A, B, C;
+	{
+		CMoneyJournal Journal;
+		std::vector<CMoneyJournal::CDrop> vDrops;
+		EXPECT_FALSE(Journal.Load(Info.m_aFilename, &vDrops));
+		EXPECT_TRUE(vDrops.empty());
+
+		A = Journal.Create(vec2(10, 20), 100);
+		B = Journal.Create(vec2(30, 40), 50);
+		C = Journal.Create(vec2(50, 60), 7);
+		Journal.Move(A, vec2(11, 25));
+		Journal.Merge(A, B, 150);
+		Journal.Remove(C);
+		Journal.Update();
+		EXPECT_EQ(Journal.Num(), 1);
+
+		// small shifts aren't worth a record
+		int NumRecords = Journal.NumRecords();
+		Journal.Move(A, vec2(11.5f, 25));
+		Journal.Remove(C);
+		EXPECT_EQ(Journal.NumRecords(), NumRecords);
+	}
+
+	CMoneyJournal Journal;
+	std::vector<CMoneyJournal::CDrop> vDrops;
+	EXPECT_TRUE(Journal.Load(Info.m_aFilename, &vDrops));
+	ASSERT_EQ(vDrops.size(), 1u);
+	EXPECT_EQ(vDrops[0].m_ID, A);
+	EXPECT_EQ(vDrops[0].m_Pos, vec2(11, 25));
+	EXPECT_EQ(vDrops[0].m_Amount, 150);
+
+	// ids are never handed out twice
+	int D = Journal.Create(vec2(0, 0), 1);
+	EXPECT_GT(D, C);
+	Journal.Close();
+	RemoveFiles(Info.m_aFilename);
+}
+
+TEST(MoneyJournal, Compaction)
+{
+	CTestInfo Info;
+	{
+		CMoneyJournal Journal;
+		std::vector<CMoneyJournal::CDrop> vDrops;
+		Journal.Load(Info.m_aFilename, &vDrops);
+
+		// drops that come and go until the journal gets compacted in the background
+		std::vector<int> vIDs;
+		for (int i = 0; i < 1000; i++)
+		{
+			vIDs.push_back(Journal.Create(vec2(i, i), i + 1));
+			if (i % 4)
+			{
+				Journal.Remove(vIDs.back());
+				vIDs.pop_back();
+			}
+			Journal.Update();
+		}
+		EXPECT_EQ(Journal.Num(), 250);
+
+		// the journal kept growing while the snapshot was written, one more round catches up with that
+		for (int Round = 0; Round < 2; Round++)
+		{
+			Journal.Update();
+			for (int i = 0; i < 1000 && Journal.IsCompacting(); i++)
+			{
+				thread_sleep(1);
+				Journal.Update();
+			}
+			EXPECT_FALSE(Journal.IsCompacting());
+		}
+		EXPECT_LE(Journal.NumRecords(), 250 * 2 + 256);
+	}
+
+	char aOld[IO_MAX_PATH_LENGTH];
+	str_format(aOld, sizeof(aOld), "%s.journal.old", Info.m_aFilename);
+	EXPECT_TRUE(fs_remove(aOld));
+
+	CMoneyJournal Journal;
+	std::vector<CMoneyJournal::CDrop> vDrops;
+	EXPECT_TRUE(Journal.Load(Info.m_aFilename, &vDrops));
+	ASSERT_EQ(vDrops.size(), 250u);
+	for (unsigned i = 0; i < vDrops.size(); i++)
+		EXPECT_EQ(vDrops[i].m_Amount, (int64)i * 4 + 1);
+	Journal.Close();
+	RemoveFiles(Info.m_aFilename);
+}
+
+TEST(MoneyJournal, CrashRecovery)
+{
+	CTestInfo Info;
+	char aJournal[IO_MAX_PATH_LENGTH];
+	char aOld[IO_MAX_PATH_LENGTH];
+	str_format(aJournal, sizeof(aJournal), "%s.journal", Info.m_aFilename);
+	str_format(aOld, sizeof(aOld), "%s.journal.old", Info.m_aFilename);
+	{
+		CMoneyJournal Journal;
+		std::vector<CMoneyJournal::CDrop> vDrops;
+		Journal.Load(Info.m_aFilename, &vDrops);
+		int A = Journal.Create(vec2(1, 1), 10);
+		int B = Journal.Create(vec2(2, 2), 20);
+		Journal.Merge(A, B, 30);
+		Journal.Create(vec2(3, 3), 40);
+	}
+
+	// the journal got rotated, but we crashed before the snapshot was written
+	ASSERT_FALSE(fs_rename(aJournal, aOld));
+	{
+		CMoneyJournal Journal;
+		std::vector<CMoneyJournal::CDrop> vDrops;
+		EXPECT_TRUE(Journal.Load(Info.m_aFilename, &vDrops));
+		EXPECT_EQ(vDrops.size(), 2u);
+		Journal.Create(vec2(4, 4), 50);
+	}
+	EXPECT_TRUE(fs_remove(aOld)); // gone after the recovery
+
+	// we crashed after the snapshot was written but before the old journal got removed, so its records are replayed
+	// twice. and the current journal ends in the middle of a record
+	void *pData;
+	unsigned Size;
+	ASSERT_FALSE(fs_read(aJournal, &pData, &Size));
+	AppendBytes(aOld, pData, Size);
+	free(pData);
+	static const char s_aTorn[5] = { 1, 2, 3, 4, 5 };
+	AppendBytes(aJournal, s_aTorn, sizeof(s_aTorn));
+	{
+		CMoneyJournal Journal;
+		std::vector<CMoneyJournal::CDrop> vDrops;
+		EXPECT_TRUE(Journal.Load(Info.m_aFilename, &vDrops));
+		ASSERT_EQ(vDrops.size(), 3u);
+		EXPECT_EQ(vDrops[0].m_Amount, 30);
+		EXPECT_EQ(vDrops[1].m_Amount, 40);
+		EXPECT_EQ(vDrops[2].m_Amount, 50);
+		Journal.Remove(vDrops[1].m_ID);
+	}
+
+	CMoneyJournal Journal;
+	std::vector<CMoneyJournal::CDrop> vDrops;
+	EXPECT_TRUE(Journal.Load(Info.m_aFilename, &vDrops));
+	ASSERT_EQ(vDrops.size(), 2u);
+	EXPECT_EQ(vDrops[0].m_Amount, 30);
+	EXPECT_EQ(vDrops[1].m_Amount, 50);
+	Journal.Close();
+	RemoveFiles(Info.m_aFilename);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <engine/console.h>
+#include <engine/shared/config.h>
+#include <engine/shared/netban.h>
+
+class NetBan : public ::testing::Test
+{
+protected:
+	IConsole *m_pConsole;
+	CConfig m_Config;
+	CNetBan m_NetBan;
+
+	NetBan()
+	{
+		m_pConsole = CreateConsole(CFGFLAG_SERVER);
+		m_NetBan.Init(m_pConsole, 0, &m_Config);
+	}
+
+	~NetBan()
+	{
+		delete m_pConsole;
+	}
+
+	static NETADDR Addr(const char *pStr)
+	{
+		NETADDR Addr;
+		net_addr_from_str(&Addr, pStr);
+		return Addr;
+	}
+
+	bool IsBanned(const char *pStr)
+	{
+		NETADDR Addr = NetBan::Addr(pStr);
+		char aBuf[256];
+		int LastInfoQuery;
+		return m_NetBan.IsBanned(&Addr, aBuf, sizeof(aBuf), &LastInfoQuery);
+	}
+};
+
+TEST_F(NetBan, Addr)
+{
+	NETADDR Addr = NetBan::Addr("1.2.3.4");
+	EXPECT_EQ(m_NetBan.BanAddr(&Addr, 0, "test"), 0);
+	EXPECT_EQ(m_NetBan.BanAddr(&Addr, 60, "test"), 1);
+	EXPECT_TRUE(IsBanned("1.2.3.4"));
+	EXPECT_TRUE(IsBanned("1.2.3.4:8303"));
+	EXPECT_FALSE(IsBanned("1.2.3.5"));
+	EXPECT_FALSE(IsBanned("4.3.2.1"));
+
+	EXPECT_EQ(m_NetBan.UnbanByAddr(&Addr), 0);
+	EXPECT_FALSE(IsBanned("1.2.3.4"));
+	EXPECT_EQ(m_NetBan.UnbanByAddr(&Addr), -1);
+}
+
+TEST_F(NetBan, Range)
+{
+	CNetRange Range;
+	Range.m_LB = Addr("10.1.0.0");
+	Range.m_UB = Addr("10.1.255.255");
+	EXPECT_EQ(m_NetBan.BanRange(&Range, 0, "test"), 0);
+
+	Range.m_LB = Addr("20.0.0.5");
+	Range.m_UB = Addr("20.0.1.10");
+	EXPECT_EQ(m_NetBan.BanRange(&Range, 0, "test"), 0);
+
+	EXPECT_TRUE(IsBanned("10.1.0.0"));
+	EXPECT_TRUE(IsBanned("10.1.42.42"));
+	EXPECT_TRUE(IsBanned("10.1.255.255"));
+	EXPECT_FALSE(IsBanned("10.2.0.0"));
+	EXPECT_FALSE(IsBanned("10.0.255.255"));
+
+	EXPECT_TRUE(IsBanned("20.0.0.5"));
+	EXPECT_TRUE(IsBanned("20.0.0.200"));
+	EXPECT_TRUE(IsBanned("20.0.1.10"));
+	EXPECT_FALSE(IsBanned("20.0.0.4"));
+	EXPECT_FALSE(IsBanned("20.0.1.11"));
+
+	EXPECT_EQ(m_NetBan.UnbanByRange(&Range), 0);
+	EXPECT_FALSE(IsBanned("20.0.0.200"));
+	EXPECT_TRUE(IsBanned("10.1.42.42"));
+}
+
+TEST_F(NetBan, ManyBans)
+{
+	// more than the old fixed pool size of 1024
+	char aBuf[NETADDR_MAXSTRSIZE];
+	for(int i = 0; i < 5000; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "30.%d.%d.1", i / 256, i % 256);
+		NETADDR Addr = NetBan::Addr(aBuf);
+		EXPECT_EQ(m_NetBan.BanAddr(&Addr, (i % 7) * 60, "test"), 0);
+
+		CNetRange Range;
+		str_format(aBuf, sizeof(aBuf), "40.%d.%d.0", i / 256, i % 256);
+		Range.m_LB = NetBan::Addr(aBuf);
+		str_format(aBuf, sizeof(aBuf), "40.%d.%d.127", i / 256, i % 256);
+		Range.m_UB = NetBan::Addr(aBuf);
+		EXPECT_EQ(m_NetBan.BanRange(&Range, (i % 5) * 60, "test"), 0);
+	}
+
+	for(int i = 0; i < 5000; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "30.%d.%d.1", i / 256, i % 256);
+		EXPECT_TRUE(IsBanned(aBuf));
+		str_format(aBuf, sizeof(aBuf), "30.%d.%d.2", i / 256, i % 256);
+		EXPECT_FALSE(IsBanned(aBuf));
+		str_format(aBuf, sizeof(aBuf), "40.%d.%d.100", i / 256, i % 256);
+		EXPECT_TRUE(IsBanned(aBuf));
+		str_format(aBuf, sizeof(aBuf), "40.%d.%d.200", i / 256, i % 256);
+		EXPECT_FALSE(IsBanned(aBuf));
+	}
+
+	m_NetBan.UnbanAll();
+	EXPECT_FALSE(IsBanned("30.0.0.1"));
+	EXPECT_FALSE(IsBanned("40.0.0.100"));
+}
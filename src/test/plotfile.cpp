@@ -0,0 +1,107 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <game/server/gameworld.h>
+#include <game/server/plotfile.h>
+
+static CPlotFile::CObject MakeObject(int i)
+{
+	CPlotFile::CObject Obj;
+	mem_zero(&Obj, sizeof(Obj));
+	Obj.m_Type = i % 2 ? CGameWorld::ENTTYPE_DOOR : CGameWorld::ENTTYPE_SPEEDUP;
+	Obj.m_Pos = vec2(i * 32.f + 0.5f, -i * 16.f);
+	Obj.m_Rotation = i / 100.f;
+	for(int a = 0; a < CPlotFile::NUM_OBJECT_ARGS; a++)
+		Obj.m_aArgs[a] = i * CPlotFile::NUM_OBJECT_ARGS + a;
+	return Obj;
+}
+
+TEST(PlotFile, RoundTrip)
+{
+	CTestInfo TestInfo;
+	const int NumObjects = 10000;
+
+	CPlotFile::CInfo Info;
+	str_copy(Info.m_aOwner, "owner", sizeof(Info.m_aOwner));
+	str_copy(Info.m_aDisplayName, "display name", sizeof(Info.m_aDisplayName));
+	Info.m_ExpireDate = 1700000000LL + (1LL << 33);
+	Info.m_DoorStatus = 1;
+
+	std::vector<CPlotFile::CObject> vObjects;
+	for(int i = 0; i < NumObjects; i++)
+		vObjects.push_back(MakeObject(i));
+
+	ASSERT_TRUE(CPlotFile::Save(TestInfo.m_aFilename, &Info, vObjects));
+
+	CPlotFile::CInfo Loaded;
+	std::vector<CPlotFile::CObject> vLoaded;
+	EXPECT_EQ(CPlotFile::Load(TestInfo.m_aFilename, &Loaded, &vLoaded), (int)CPlotFile::LOAD_BINARY);
+
+	EXPECT_STREQ(Loaded.m_aOwner, "owner");
+	EXPECT_STREQ(Loaded.m_aDisplayName, "display name");
+	EXPECT_EQ(Loaded.m_ExpireDate, Info.m_ExpireDate);
+	EXPECT_EQ(Loaded.m_DoorStatus, 1);
+	ASSERT_EQ((int)vLoaded.size(), NumObjects);
+	for(int i = 0; i < NumObjects; i++)
+		EXPECT_EQ(mem_comp(&vLoaded[i], &vObjects[i], sizeof(vObjects[i])), 0);
+
+	EXPECT_FALSE(fs_remove(TestInfo.m_aFilename));
+}
+
+TEST(PlotFile, TextMigration)
+{
+	CTestInfo TestInfo;
+	IOHANDLE File = io_open(TestInfo.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "owner\nname\n1234\n1\n%d:1.00/2.50:90:5:2,%d:3.00/4.00:1.50:3:1:4:7:0:2,\n", (int)CGameWorld::ENTTYPE_SPEEDUP, (int)CGameWorld::ENTTYPE_DOOR);
+	io_write(File, aBuf, str_length(aBuf));
+	io_close(File);
+
+	CPlotFile::CInfo Info;
+	std::vector<CPlotFile::CObject> vObjects;
+	EXPECT_EQ(CPlotFile::Load(TestInfo.m_aFilename, &Info, &vObjects), (int)CPlotFile::LOAD_TEXT);
+	EXPECT_STREQ(Info.m_aOwner, "owner");
+	EXPECT_STREQ(Info.m_aDisplayName, "name");
+	EXPECT_EQ(Info.m_ExpireDate, 1234);
+	EXPECT_EQ(Info.m_DoorStatus, 1);
+	ASSERT_EQ((int)vObjects.size(), 2);
+	EXPECT_EQ(vObjects[0].m_Type, (int)CGameWorld::ENTTYPE_SPEEDUP);
+	EXPECT_EQ(vObjects[0].m_Pos, vec2(32.f, 80.f));
+	EXPECT_EQ(vObjects[0].m_aArgs[0], 90);
+	EXPECT_EQ(vObjects[0].m_aArgs[1], 5);
+	EXPECT_EQ(vObjects[0].m_aArgs[2], 2);
+	EXPECT_EQ(vObjects[1].m_Type, (int)CGameWorld::ENTTYPE_DOOR);
+	EXPECT_EQ(vObjects[1].m_Rotation, 1.5f);
+	EXPECT_EQ(vObjects[1].m_aArgs[3], 7);
+	EXPECT_EQ(vObjects[1].m_aArgs[5], 2);
+
+	// migrate
+	ASSERT_TRUE(CPlotFile::Save(TestInfo.m_aFilename, &Info, vObjects));
+	std::vector<CPlotFile::CObject> vMigrated;
+	EXPECT_EQ(CPlotFile::Load(TestInfo.m_aFilename, &Info, &vMigrated), (int)CPlotFile::LOAD_BINARY);
+	ASSERT_EQ(vMigrated.size(), vObjects.size());
+	EXPECT_EQ(mem_comp(&vMigrated[0], &vObjects[0], sizeof(vObjects[0]) * vObjects.size()), 0);
+
+	EXPECT_FALSE(fs_remove(TestInfo.m_aFilename));
+}
+
+TEST(PlotFile, PresetCache)
+{
+	CPlotPresetCache Cache(2);
+	std::vector<CPlotFile::CObject> vObjects;
+	vObjects.push_back(MakeObject(1));
+
+	EXPECT_FALSE(Cache.Find("a"));
+	Cache.Add("a", vObjects);
+	Cache.Add("b", vObjects);
+	ASSERT_TRUE(Cache.Find("a"));
+	EXPECT_EQ(Cache.Find("a")->size(), 1u);
+
+	// b is the least recently used now
+	Cache.Add("c", vObjects);
+	EXPECT_EQ(Cache.Size(), 2u);
+	EXPECT_TRUE(Cache.Find("a"));
+	EXPECT_FALSE(Cache.Find("b"));
+	EXPECT_TRUE(Cache.Find("c"));
+}
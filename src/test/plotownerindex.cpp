@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <game/server/plotownerindex.h>
+
+static NETADDR Addr(const char *pStr)
+{
+	NETADDR Addr;
+	net_addr_from_str(&Addr, pStr);
+	return Addr;
+}
+
+TEST(PlotOwnerIndex, SetRemove)
+{
+	CPlotOwnerIndex Index;
+	NETADDR Addr1 = Addr("1.2.3.4:8303");
+	NETADDR Addr2 = Addr("5.6.7.8");
+	NETADDR Addr3 = Addr("1.2.3.4:1234");
+	NETADDR Addr4 = Addr("5.6.7.8:1");
+	NETADDR Addr5 = Addr("[::1]:8303");
+	NETADDR Addr6 = Addr("[::1]");
+	NETADDR Unset;
+	mem_zero(&Unset, sizeof(Unset));
+
+	Index.SetOwner(1, &Addr1, &Unset);
+	EXPECT_TRUE(Index.HasPlot(&Addr1));
+	EXPECT_TRUE(Index.HasPlot(&Addr3));
+	EXPECT_FALSE(Index.HasPlot(&Addr2));
+
+	// same address with a different port only counts once
+	Index.SetOwner(2, &Addr2, &Addr4);
+	EXPECT_EQ(Index.NumPlots(&Addr2), 1);
+
+	// transfer
+	Index.SetOwner(1, &Addr2, &Addr1);
+	EXPECT_EQ(Index.NumPlots(&Addr1), 1);
+	EXPECT_EQ(Index.NumPlots(&Addr2), 2);
+
+	Index.RemoveOwner(1);
+	EXPECT_FALSE(Index.HasPlot(&Addr1));
+	EXPECT_EQ(Index.NumPlots(&Addr2), 1);
+	Index.RemoveOwner(2);
+	EXPECT_FALSE(Index.HasPlot(&Addr2));
+
+	Index.SetOwner(3, &Addr5, 0);
+	EXPECT_TRUE(Index.HasPlot(&Addr6));
+	Index.Clear();
+	EXPECT_FALSE(Index.HasPlot(&Addr6));
+}
+
+TEST(PlotOwnerIndex, ManyPlots)
+{
+	CPlotOwnerIndex Index;
+	char aBuf[NETADDR_MAXSTRSIZE];
+	for(int i = 0; i < 4096; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "10.0.%d.%d", i / 256, i % 256);
+		NETADDR Cur = Addr(aBuf);
+		str_format(aBuf, sizeof(aBuf), "11.0.%d.%d", i / 256, i % 256);
+		NETADDR Last = Addr(aBuf);
+		Index.SetOwner(i + 1, &Cur, &Last);
+	}
+
+	NETADDR Miss = Addr("12.0.0.1");
+	NETADDR Hit = Addr("11.0.0.1");
+	NETADDR LastHit = Addr("10.0.15.255");
+	EXPECT_FALSE(Index.HasPlot(&Miss));
+	EXPECT_TRUE(Index.HasPlot(&Hit));
+	EXPECT_TRUE(Index.HasPlot(&LastHit));
+	EXPECT_EQ(Index.NumPlots(&Hit), 1);
+}
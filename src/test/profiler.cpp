@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/profiler.h>
+
+TEST(Profiler, Sections)
+{
+	CProfiler Profiler;
+	int A = Profiler.AddSection("a");
+	int B = Profiler.AddSection("b");
+	EXPECT_NE(A, B);
+	EXPECT_EQ(Profiler.AddSection("a"), A);
+	EXPECT_EQ(Profiler.NumSections(), 2);
+	EXPECT_STREQ(Profiler.SectionName(B), "b");
+}
+
+TEST(Profiler, Stats)
+{
+	CProfiler Profiler;
+	int A = Profiler.AddSection("a");
+	int B = Profiler.AddSection("b");
+	for(int i = 1; i <= 100; i++)
+	{
+		// two calls per tick are summed up
+		Profiler.Add(A, i * 500);
+		Profiler.Add(A, i * 500);
+		Profiler.EndTick();
+	}
+
+	CProfiler::CStats Stats;
+	ASSERT_TRUE(Profiler.GetStats(A, &Stats));
+	EXPECT_EQ(Stats.m_NumSamples, 100);
+	EXPECT_EQ(Stats.m_Max, 100000);
+	EXPECT_NEAR(Stats.m_P50, 50000, 1000);
+	EXPECT_NEAR(Stats.m_P99, 99000, 1000);
+
+	// sections that were not entered do not record empty ticks
+	EXPECT_FALSE(Profiler.GetStats(B, &Stats));
+
+	// only the most recent ticks are kept
+	for(int i = 0; i < CProfiler::NUM_SAMPLES; i++)
+	{
+		Profiler.Add(A, 7);
+		Profiler.EndTick();
+	}
+	ASSERT_TRUE(Profiler.GetStats(A, &Stats));
+	EXPECT_EQ(Stats.m_NumSamples, (int)CProfiler::NUM_SAMPLES);
+	EXPECT_EQ(Stats.m_Max, 7);
+
+	Profiler.Reset();
+	EXPECT_FALSE(Profiler.GetStats(A, &Stats));
+}
+
+TEST(Profiler, Scope)
+{
+	CProfiler Profiler;
+	int A = Profiler.AddSection("a");
+	CProfiler::CStats Stats;
+
+	{
+		CProfileScope Scope(&Profiler, A);
+	}
+	Profiler.EndTick();
+	EXPECT_FALSE(Profiler.GetStats(A, &Stats));
+
+	Profiler.SetEnabled(true);
+	{
+		CProfileScope Scope(&Profiler, A);
+		thread_sleep(1);
+	}
+	{
+		CProfileScope Scope(&Profiler, -1);
+	}
+	Profiler.EndTick();
+	ASSERT_TRUE(Profiler.GetStats(A, &Stats));
+	EXPECT_GE(Stats.m_Max, 1000000);
+}
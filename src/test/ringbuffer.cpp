@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <engine/shared/ringbuffer.h>
+
+typedef TGrowingRingBuffer<int, 1024, 1024*16> CGrowingBuffer;
+
+static int Count(CGrowingBuffer *pBuffer)
+{
+	int Num = 0;
+	for(int *pItem = pBuffer->First(); pItem; pItem = pBuffer->Next(pItem))
+		Num++;
+	return Num;
+}
+
+TEST(RingBuffer, LazyAllocation)
+{
+	CGrowingBuffer Buffer;
+	EXPECT_EQ(Buffer.BufferSize(), 0);
+	EXPECT_FALSE(Buffer.First());
+	EXPECT_FALSE(Buffer.PopFirst());
+
+	int *pItem = Buffer.Allocate(sizeof(int));
+	ASSERT_TRUE(pItem);
+	*pItem = 42;
+	EXPECT_EQ(Buffer.BufferSize(), 1024);
+	EXPECT_EQ(*Buffer.First(), 42);
+
+	Buffer.Init();
+	EXPECT_EQ(Buffer.BufferSize(), 0);
+	EXPECT_FALSE(Buffer.First());
+}
+
+TEST(RingBuffer, GrowKeepsOrder)
+{
+	CGrowingBuffer Buffer;
+	for(int i = 0; i < 500; i++)
+	{
+		int *pItem = Buffer.Allocate(16);
+		ASSERT_TRUE(pItem);
+		*pItem = i;
+
+		// pop now and then so the items wrap around before growing
+		if(i % 3 == 0)
+			Buffer.PopFirst();
+	}
+	EXPECT_GT(Buffer.BufferSize(), 1024);
+
+	int Expected = 167;
+	for(int *pItem = Buffer.First(); pItem; pItem = Buffer.Next(pItem))
+		EXPECT_EQ(*pItem, Expected++);
+	EXPECT_EQ(Expected, 500);
+}
+
+TEST(RingBuffer, MaxSize)
+{
+	CGrowingBuffer Buffer;
+	int Num = 0;
+	while(Buffer.Allocate(100))
+		Num++;
+	EXPECT_EQ(Buffer.BufferSize(), 1024*16);
+	EXPECT_EQ(Count(&Buffer), Num);
+	EXPECT_GT(Num, 100);
+	EXPECT_FALSE(Buffer.Allocate(1024*16));
+
+	// space frees up again once the oldest items are gone
+	Buffer.PopFirst();
+	Buffer.PopFirst();
+	EXPECT_TRUE(Buffer.Allocate(100));
+}
+
+TEST(RingBuffer, TakeFrom)
+{
+	CGrowingBuffer Buffer;
+	for(int i = 0; i < 10; i++)
+		*Buffer.Allocate(sizeof(int)) = i;
+
+	CGrowingBuffer Other;
+	*Other.Allocate(sizeof(int)) = -1;
+	Other.TakeFrom(&Buffer);
+	EXPECT_EQ(Buffer.BufferSize(), 0);
+	EXPECT_FALSE(Buffer.First());
+	EXPECT_EQ(Count(&Other), 10);
+	EXPECT_EQ(*Other.First(), 0);
+	EXPECT_EQ(*Other.Last(), 9);
+}
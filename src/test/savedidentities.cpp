@@ -0,0 +1,94 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <game/server/savedidentities.h>
+
+static SSavedIdentity MakeIdentity(const char *pAddr, const char *pName, const char *pTimeoutCode = "", const char *pAcc = "")
+{
+	SSavedIdentity Identity;
+	mem_zero(&Identity, sizeof(Identity));
+	net_addr_from_str(&Identity.m_Addr, pAddr);
+	str_copy(Identity.m_aName, pName, sizeof(Identity.m_aName));
+	str_copy(Identity.m_aTimeoutCode, pTimeoutCode, sizeof(Identity.m_aTimeoutCode));
+	str_copy(Identity.m_aAccUsername, pAcc, sizeof(Identity.m_aAccUsername));
+	return Identity;
+}
+
+TEST(SavedIdentities, Find)
+{
+	CSavedIdentities Identities;
+	CTeeInfo TeeInfo;
+	NETADDR Addr;
+
+	int A = Identities.Add(MakeIdentity("1.2.3.4:1000", "a"), false);
+	int B = Identities.Add(MakeIdentity("5.6.7.8:2000", "b", "code"), false);
+	int C = Identities.Add(MakeIdentity("9.9.9.9:3000", "c", "", "acc"), false);
+	EXPECT_EQ(Identities.Num(), 3);
+
+	// same address and name
+	net_addr_from_str(&Addr, "1.2.3.4:1111");
+	EXPECT_EQ(Identities.Find(&Addr, "", "", "a", &TeeInfo), A);
+	EXPECT_EQ(Identities.Find(&Addr, "", "", "other", &TeeInfo), -1);
+
+	// timeout code from anywhere
+	net_addr_from_str(&Addr, "10.0.0.1:1");
+	EXPECT_EQ(Identities.Find(&Addr, "code", "", "x", &TeeInfo), B);
+
+	// account needs a second match
+	EXPECT_EQ(Identities.Find(&Addr, "", "acc", "x", &TeeInfo), -1);
+	EXPECT_EQ(Identities.Find(&Addr, "", "acc", "c", &TeeInfo), C);
+
+	EXPECT_EQ(Identities.FindByHash(Identities.GetHash(B)), B);
+	Identities.Remove(B);
+	EXPECT_FALSE(Identities.IsUsed(B));
+	EXPECT_EQ(Identities.FindByHash(Identities.GetHash(B)), -1);
+	EXPECT_EQ(Identities.Find(&Addr, "code", "", "x", &TeeInfo), -1);
+	EXPECT_EQ(Identities.Num(), 2);
+
+	// freed index gets reused, but the newer identity stays behind older ones when matching
+	int D = Identities.Add(MakeIdentity("1.2.3.4:1000", "a"), false);
+	EXPECT_EQ(D, B);
+	net_addr_from_str(&Addr, "1.2.3.4:1000");
+	EXPECT_EQ(Identities.Find(&Addr, "", "", "a", &TeeInfo), D);
+	net_addr_from_str(&Addr, "1.2.3.4:1111");
+	EXPECT_EQ(Identities.Find(&Addr, "", "", "a", &TeeInfo), A);
+}
+
+TEST(SavedIdentities, Journal)
+{
+	CTestInfo Info;
+	char aHash[SHA256_MAXSTRSIZE];
+	{
+		CSavedIdentities Identities;
+		EXPECT_FALSE(Identities.LoadJournal(Info.m_aFilename));
+		EXPECT_TRUE(Identities.CompactJournal());
+
+		char aName[16];
+		for (int i = 0; i < 200; i++)
+		{
+			str_format(aName, sizeof(aName), "tee%d", i);
+			Identities.Add(MakeIdentity("1.1.1.1:1", aName), true);
+		}
+		Identities.Add(MakeIdentity("2.2.2.2:2", "redirect"), false);
+		for (int i = 0; i < 150; i++)
+			Identities.Remove(i);
+		str_copy(aHash, Identities.GetHash(199), sizeof(aHash));
+
+		// removals got compacted away
+		EXPECT_EQ(Identities.Num(), 51);
+		EXPECT_LT(Identities.NumJournalRecords(), 350);
+	}
+
+	CSavedIdentities Identities;
+	EXPECT_TRUE(Identities.LoadJournal(Info.m_aFilename));
+	EXPECT_EQ(Identities.Num(), 50);
+	int Index = Identities.FindByHash(aHash);
+	ASSERT_NE(Index, -1);
+	EXPECT_STREQ(Identities.Get(Index)->m_aName, "tee199");
+
+	char aTmp[IO_MAX_PATH_LENGTH];
+	str_format(aTmp, sizeof(aTmp), "%s.tmp", Info.m_aFilename);
+	// fs_remove returns 0 on success, the temporary file of the compaction is renamed away already
+	EXPECT_NE(fs_remove(aTmp), 0);
+	EXPECT_EQ(fs_remove(Info.m_aFilename), 0);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+#include <base/system.h>
+#include <game/server/snapgrid.h>
+
+#include <algorithm>
+#include <vector>
+
+// the grid never dereferences its entities, so the tests hand it addresses into an array of positions
+static CEntity *Entity(std::vector<vec2> &vPos, int Index)
+{
+	return (CEntity *)&vPos[Index];
+}
+
+static bool Clipped(vec2 View, vec2 Extent, vec2 Pos)
+{
+	return absolute(View.x - Pos.x) > Extent.x || absolute(View.y - Pos.y) > Extent.y;
+}
+
+static std::vector<vec2> RandomPositions(int Num, float Width, float Height)
+{
+	std::vector<vec2> vPos(Num);
+	unsigned Seed = 1;
+	for(int i = 0; i < Num; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		float x = (Seed >> 8) % (int)Width;
+		Seed = Seed * 1103515245 + 12345;
+		float y = (Seed >> 8) % (int)Height;
+		vPos[i] = vec2(x, y);
+	}
+	return vPos;
+}
+
+TEST(SnapGrid, Query)
+{
+	const float Width = 200 * 32, Height = 100 * 32;
+	std::vector<vec2> vPos = RandomPositions(2000, Width, Height);
+	// some objects outside of the map
+	vPos.push_back(vec2(-500, -500));
+	vPos.push_back(vec2(Width + 500, Height + 500));
+
+	CSnapGrid Grid;
+	Grid.Init(Width, Height, 2);
+	for(unsigned i = 0; i < vPos.size(); i++)
+		Grid.Add(Entity(vPos, i), i % 2, vPos[i]);
+	Grid.Build();
+	EXPECT_EQ(Grid.Size(), (int)vPos.size());
+
+	const vec2 aViews[] = {vec2(0, 0), vec2(Width / 2, Height / 2), vec2(Width, Height), vec2(-2000, 300)};
+	vec2 Extent(800, 600);
+	for(unsigned v = 0; v < sizeof(aViews) / sizeof(aViews[0]); v++)
+	{
+		for(int Type = 0; Type < 2; Type++)
+		{
+			std::vector<CEntity *> vpFound;
+			Grid.Query(Type, aViews[v], Extent, &vpFound);
+			// every visible entity has to be found, but nothing twice
+			for(unsigned i = Type; i < vPos.size(); i += 2)
+			{
+				if(!Clipped(aViews[v], Extent, vPos[i]))
+				{
+					EXPECT_EQ(std::count(vpFound.begin(), vpFound.end(), Entity(vPos, i)), 1);
+				}
+			}
+			std::sort(vpFound.begin(), vpFound.end());
+			EXPECT_TRUE(std::adjacent_find(vpFound.begin(), vpFound.end()) == vpFound.end());
+			EXPECT_LT(vpFound.size(), vPos.size() / 2);
+		}
+	}
+
+	Grid.Clear();
+	std::vector<CEntity *> vpFound;
+	Grid.Query(0, aViews[1], Extent, &vpFound);
+	EXPECT_TRUE(vpFound.empty());
+}
+
+TEST(SnapGrid, Crowded)
+{
+	// a crowded 1000x1000 tiles map with 64 snapping clients
+	const float Width = 1000 * 32, Height = 1000 * 32;
+	const int NumEntities = 50000;
+	const int NumClients = 64;
+	std::vector<vec2> vPos = RandomPositions(NumEntities, Width, Height);
+	std::vector<vec2> vViews = RandomPositions(NumClients, Width, Height);
+	vec2 Extent(1000 / 2 + 320, 800 / 2 + 320);
+
+	int NumBrute = 0;
+	for(int c = 0; c < NumClients; c++)
+		for(int i = 0; i < NumEntities; i++)
+			NumBrute += !Clipped(vViews[c], Extent, vPos[i]);
+
+	CSnapGrid Grid;
+	Grid.Init(Width, Height, 1);
+	for(int i = 0; i < NumEntities; i++)
+		Grid.Add(Entity(vPos, i), 0, vPos[i]);
+	Grid.Build();
+	int NumGrid = 0;
+	std::vector<CEntity *> vpFound;
+	for(int c = 0; c < NumClients; c++)
+	{
+		vpFound.clear();
+		Grid.Query(0, vViews[c], Extent, &vpFound);
+		for(unsigned i = 0; i < vpFound.size(); i++)
+			NumGrid += !Clipped(vViews[c], Extent, *(vec2 *)vpFound[i]);
+	}
+	EXPECT_EQ(NumGrid, NumBrute);
+}
@@ -124,3 +124,11 @@ TEST(Str, PathUnsafe)
 	EXPECT_FALSE(str_path_unsafe("abc/def\\ghi.txt"));
 	EXPECT_FALSE(str_path_unsafe("любовь"));
 }
+
+TEST(Str, QuickhashNocase)
+{
+	EXPECT_EQ(str_quickhash_nocase("rcon_auth"), str_quickhash_nocase("RCON_Auth"));
+	EXPECT_NE(str_quickhash_nocase(""), str_quickhash_nocase("a"));
+	EXPECT_NE(str_quickhash_nocase("ban"), str_quickhash_nocase("bans"));
+	EXPECT_EQ(str_quickhash_nocase("ABC"), str_quickhash("ABC"));
+}
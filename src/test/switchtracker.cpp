@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <game/server/switchtracker.h>
+
+#include <vector>
+
+TEST(SwitchTracker, Timeouts)
+{
+	CSwitchTracker Tracker;
+	Tracker.AddTimeout(3, 0, 100);
+	Tracker.AddTimeout(1, 5, 50);
+	Tracker.AddTimeout(2, 0, 75);
+	// a later tick is left to whoever pops the earlier one, an earlier one replaces it
+	Tracker.AddTimeout(3, 0, 120);
+	Tracker.AddTimeout(2, 0, 60);
+
+	CSwitchTracker::CSwitch Timeout;
+	EXPECT_FALSE(Tracker.PopTimeout(49, &Timeout));
+	ASSERT_TRUE(Tracker.PopTimeout(80, &Timeout));
+	EXPECT_EQ(Timeout.m_Number, 1);
+	EXPECT_EQ(Timeout.m_Team, 5);
+	EXPECT_EQ(Timeout.m_Tick, 50);
+	ASSERT_TRUE(Tracker.PopTimeout(80, &Timeout));
+	EXPECT_EQ(Timeout.m_Number, 2);
+	EXPECT_EQ(Timeout.m_Tick, 60);
+	EXPECT_FALSE(Tracker.PopTimeout(80, &Timeout));
+
+	int NumLive = 0;
+	for(unsigned i = 0; i < Tracker.Timeouts().size(); i++)
+		NumLive += Tracker.IsLive(Tracker.Timeouts()[i]);
+	EXPECT_EQ(NumLive, 1);
+
+	ASSERT_TRUE(Tracker.PopTimeout(200, &Timeout));
+	EXPECT_EQ(Timeout.m_Number, 3);
+	EXPECT_EQ(Timeout.m_Tick, 100);
+	EXPECT_FALSE(Tracker.PopTimeout(200, &Timeout));
+	EXPECT_TRUE(Tracker.Timeouts().empty());
+
+	// popped switches can wait again
+	Tracker.AddTimeout(3, 0, 300);
+	ASSERT_TRUE(Tracker.PopTimeout(300, &Timeout));
+	EXPECT_EQ(Timeout.m_Tick, 300);
+}
+
+TEST(SwitchTracker, Activations)
+{
+	CSwitchTracker Tracker;
+	Tracker.AddActivation(255, VANILLA_MAX_CLIENTS - 1);
+	Tracker.AddActivation(4, 2);
+	Tracker.AddActivation(4, 2);
+	Tracker.AddActivation(4, 3);
+	EXPECT_EQ(Tracker.Activations().size(), 3u);
+
+	std::vector<CSwitchTracker::CSwitch> vActivations;
+	Tracker.TakeActivations(&vActivations);
+	EXPECT_EQ(vActivations.size(), 3u);
+	EXPECT_TRUE(Tracker.Activations().empty());
+
+	Tracker.AddActivation(4, 2);
+	Tracker.TakeActivations(&vActivations);
+	ASSERT_EQ(vActivations.size(), 1u);
+	EXPECT_EQ(vActivations[0].m_Number, 4);
+	EXPECT_EQ(vActivations[0].m_Team, 2);
+}
+
+TEST(SwitchTracker, Versions)
+{
+	CSwitchTracker Tracker;
+	int Version = Tracker.Version();
+	Tracker.OnStatusChange(7);
+	Tracker.OnStatusChange(7);
+	EXPECT_NE(Tracker.Version(), Version);
+	EXPECT_EQ(Tracker.Version(7), 2);
+	EXPECT_EQ(Tracker.Version(0), 0);
+}
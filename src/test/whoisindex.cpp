@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <game/server/whoisindex.h>
+
+#include <vector>
+
+static std::vector<const char *> Keys(const CWhoIsIndex &Index, int Table, const std::vector<int> &vEntries)
+{
+	std::vector<const char *> vKeys;
+	for(unsigned i = 0; i < vEntries.size(); i++)
+		vKeys.push_back(Index.GetKey(Table, vEntries[i]));
+	return vKeys;
+}
+
+TEST(WhoIsIndex, Links)
+{
+	CWhoIsIndex Index;
+	EXPECT_TRUE(Index.Add("alice", "1.2.3.4"));
+	EXPECT_TRUE(Index.Add("bob", "1.2.3.4"));
+	EXPECT_TRUE(Index.Add("alice", "1.2.3.4"));
+	EXPECT_TRUE(Index.Add("alice", "5.6.7.8"));
+	EXPECT_FALSE(Index.Add("", "5.6.7.8"));
+	EXPECT_FALSE(Index.Add("a name too long!", "5.6.7.8"));
+	EXPECT_EQ(Index.Num(CWhoIsIndex::TABLE_ADDR), 2);
+	EXPECT_EQ(Index.Num(CWhoIsIndex::TABLE_NAME), 2);
+
+	int Addr = Index.Find(CWhoIsIndex::TABLE_ADDR, "1.2.3.4");
+	ASSERT_GE(Addr, 0);
+	EXPECT_EQ(Index.GetCount(CWhoIsIndex::TABLE_ADDR, Addr), 3);
+	EXPECT_EQ(Index.GetNumLinks(CWhoIsIndex::TABLE_ADDR, Addr), 2);
+	int Link = Index.FirstLink(CWhoIsIndex::TABLE_ADDR, Addr);
+	EXPECT_STREQ(Index.GetKey(CWhoIsIndex::TABLE_NAME, Index.GetLinkEntry(Link)), "alice");
+	EXPECT_EQ(Index.GetLinkCount(Link), 2);
+	Link = Index.NextLink(Link);
+	EXPECT_STREQ(Index.GetKey(CWhoIsIndex::TABLE_NAME, Index.GetLinkEntry(Link)), "bob");
+	EXPECT_EQ(Index.NextLink(Link), -1);
+
+	int Name = Index.Find(CWhoIsIndex::TABLE_NAME, "alice");
+	ASSERT_GE(Name, 0);
+	EXPECT_EQ(Index.GetCount(CWhoIsIndex::TABLE_NAME, Name), 3);
+	EXPECT_EQ(Index.GetNumLinks(CWhoIsIndex::TABLE_NAME, Name), 2);
+	EXPECT_EQ(Index.Find(CWhoIsIndex::TABLE_NAME, "alic"), -1);
+	EXPECT_EQ(Index.Find(CWhoIsIndex::TABLE_ADDR, "1.2.3"), -1);
+
+	// an entry keeps counting after its list is full
+	char aAddr[16];
+	for(int i = 0; i < CWhoIsIndex::MAX_LINKS + 10; i++)
+	{
+		str_format(aAddr, sizeof(aAddr), "10.0.%d.%d", i / 256, i % 256);
+		Index.Add("bob", aAddr);
+	}
+	Name = Index.Find(CWhoIsIndex::TABLE_NAME, "bob");
+	EXPECT_EQ(Index.GetCount(CWhoIsIndex::TABLE_NAME, Name), CWhoIsIndex::MAX_LINKS + 11);
+	EXPECT_EQ(Index.GetNumLinks(CWhoIsIndex::TABLE_NAME, Name), (int)CWhoIsIndex::MAX_LINKS);
+
+	Index.SetMaxEntries(Index.Num(CWhoIsIndex::TABLE_ADDR));
+	EXPECT_FALSE(Index.Add("bob", "9.9.9.9"));
+	EXPECT_TRUE(Index.Add("bob", "5.6.7.8"));
+}
+
+TEST(WhoIsIndex, Lines)
+{
+	char aData[256];
+	str_format(aData, sizeof(aData), "(%16s): %s\n(%16s): %s\ngarbage\n(%16s): %s\n(%16s): par",
+		"1.2.3.4", "alice", "1.2.3.4", "some name (1)", "5.6.7.8", "bob", "9.9.9.9");
+
+	CWhoIsIndex Index;
+	int Size = str_length(aData);
+	int Read = Index.AddLines(aData, Size);
+	EXPECT_EQ(Read, Size - (int)sizeof("(         9.9.9.9): par") + 1);
+	EXPECT_EQ(Index.Num(CWhoIsIndex::TABLE_ADDR), 2);
+	EXPECT_EQ(Index.Num(CWhoIsIndex::TABLE_NAME), 3);
+	EXPECT_GE(Index.Find(CWhoIsIndex::TABLE_NAME, "some name (1)"), 0);
+	EXPECT_GE(Index.Find(CWhoIsIndex::TABLE_ADDR, "5.6.7.8"), 0);
+}
+
+TEST(WhoIsIndex, Prefix)
+{
+	CWhoIsIndex Index;
+	Index.Add("alice", "1.2.3.4");
+	Index.Add("Alfred", "1.2.3.5");
+	Index.Add("bob", "1.2.30.4");
+	Index.Add("malice", "1.20.3.4");
+	Index.Add("al", "2.2.3.4");
+
+	std::vector<int> vEntries;
+	Index.FindAddrPrefix("1.2.3", &vEntries);
+	std::vector<const char *> vKeys = Keys(Index, CWhoIsIndex::TABLE_ADDR, vEntries);
+	ASSERT_EQ(vKeys.size(), 2u);
+	EXPECT_STREQ(vKeys[0], "1.2.3.4");
+	EXPECT_STREQ(vKeys[1], "1.2.3.5");
+
+	Index.FindAddrPrefix("1.2", &vEntries);
+	EXPECT_EQ(vEntries.size(), 3u);
+	Index.FindAddrPrefix("1", &vEntries);
+	EXPECT_EQ(vEntries.size(), 4u);
+	Index.FindAddrPrefix("1.3", &vEntries);
+	EXPECT_TRUE(vEntries.empty());
+
+	Index.FindNamePrefix("al", &vEntries);
+	vKeys = Keys(Index, CWhoIsIndex::TABLE_NAME, vEntries);
+	ASSERT_EQ(vKeys.size(), 2u);
+	EXPECT_STREQ(vKeys[0], "alice");
+	EXPECT_STREQ(vKeys[1], "al");
+	Index.FindNamePrefix("Al", &vEntries);
+	vKeys = Keys(Index, CWhoIsIndex::TABLE_NAME, vEntries);
+	ASSERT_EQ(vKeys.size(), 1u);
+	EXPECT_STREQ(vKeys[0], "Alfred");
+	Index.FindNamePrefix("x", &vEntries);
+	EXPECT_TRUE(vEntries.empty());
+}
+
+TEST(WhoIsIndex, SimilarNames)
+{
+	CWhoIsIndex Index;
+	Index.Add("fokkonaut", "1.1.1.1");
+	Index.Add("fokkonaut2", "1.1.1.1");
+	Index.Add("Fokko", "1.1.1.2");
+	Index.Add("nameless tee", "1.1.1.3");
+	Index.Add("fokkonaut2", "1.1.1.4");
+
+	std::vector<int> vEntries;
+	Index.FindSimilarNames("FokkoNaut", 10, &vEntries);
+	std::vector<const char *> vKeys = Keys(Index, CWhoIsIndex::TABLE_NAME, vEntries);
+	ASSERT_EQ(vKeys.size(), 3u);
+	EXPECT_STREQ(vKeys[0], "fokkonaut");
+	EXPECT_STREQ(vKeys[1], "fokkonaut2");
+	EXPECT_STREQ(vKeys[2], "Fokko");
+
+	Index.FindSimilarNames("fokkonut", 1, &vEntries);
+	vKeys = Keys(Index, CWhoIsIndex::TABLE_NAME, vEntries);
+	ASSERT_EQ(vKeys.size(), 1u);
+	EXPECT_STREQ(vKeys[0], "fokkonaut");
+
+	Index.FindSimilarNames("zzz", 10, &vEntries);
+	EXPECT_TRUE(vEntries.empty());
+}
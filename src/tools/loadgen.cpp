@@ -0,0 +1,725 @@
+#include <base/math.h>
+#include <base/system.h>
+
+#include <math.h>
+
+#include <engine/message.h>
+#include <engine/shared/config.h>
+#include <engine/shared/network.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/protocol_ex.h>
+#include <engine/shared/uuid_manager.h>
+
+#include <game/version.h>
+#include <generated/protocol.h>
+
+// drives a server with synthetic 0.6 and 0.7 clients over loopback. every bot binds its own
+// 127.x.y.z address so the per ip limits of the server don't get in the way.
+
+static const char *s_pUsage =
+	"usage: loadgen [options]\n"
+	"  -s <addr>      server address (default 127.0.0.1:8303)\n"
+	"  -n <num>       number of clients (default 16)\n"
+	"  -p <0.6|0.7|mixed> protocol of the clients (default mixed)\n"
+	"  -t <seconds>   duration of the run (default 60)\n"
+	"  -r <num>       connects per second (default 10)\n"
+	"  -c <seconds>   chat interval per client, 0 disables chat (default 10)\n"
+	"  -m <0|1>       download the map like a real client (default 0)\n"
+	"  -w <password>  server password\n"
+	"  -e <port>      econ port of the server, enables server tick times\n"
+	"  -k <password>  econ password\n"
+	"  -f <filter>    profiler sections to print (default server.)\n"
+	"  -o <file>      write per client results as csv\n";
+
+enum
+{
+	PROTOCOL_SEVENDOWN = 0,
+	PROTOCOL_SEVEN,
+	PROTOCOL_MIXED,
+
+	STATUS_INTERVAL = 5,
+};
+
+static CConfig s_Config;
+static NETADDR s_ServerAddr;
+static const char *s_pPassword = "";
+static int s_ChatInterval = 10;
+static bool s_DownloadMap = false;
+
+class CBot
+{
+public:
+	enum
+	{
+		STATE_OFFLINE = 0,
+		STATE_CONNECTING,
+		STATE_LOADING,
+		STATE_READY,
+		STATE_STARTINFO,
+		STATE_INGAME,
+		STATE_ERROR,
+	};
+
+	CNetClient m_NetClient;
+	int m_ID;
+	bool m_Sevendown;
+	int m_State;
+	float m_Phase;
+
+	int m_GameTick;
+	int m_NumSnaps;
+	int m_Fire;
+	int64 m_NextChat;
+	int m_NumChat;
+
+	int m_MapSize;
+	int m_MapReceived;
+	int m_MapChunk;
+	int m_MapChunksPerRequest;
+	int64 m_MapStart;
+	int64 m_MapTime;
+
+	int64 m_BytesRecv;
+	int64 m_BytesSent;
+	int64 m_IngameSince;
+	int64 m_IngameTime;
+	char m_aError[128];
+
+	static const char *StateName(int State)
+	{
+		static const char *s_apNames[] = { "offline", "connecting", "loading", "ready", "startinfo", "ingame", "error" };
+		return s_apNames[State];
+	}
+
+	bool Open(int ID, bool Sevendown)
+	{
+		m_ID = ID;
+		m_Sevendown = Sevendown;
+		m_State = STATE_OFFLINE;
+		m_Phase = (ID * 0.618034f - (int)(ID * 0.618034f)) * 10.0f;
+		m_GameTick = -1;
+		m_NumSnaps = 0;
+		m_Fire = 0;
+		m_NumChat = 0;
+		m_MapSize = 0;
+		m_MapReceived = 0;
+		m_MapChunk = 0;
+		m_MapChunksPerRequest = 1;
+		m_MapStart = 0;
+		m_MapTime = 0;
+		m_BytesRecv = 0;
+		m_BytesSent = 0;
+		m_IngameSince = 0;
+		m_IngameTime = 0;
+		m_aError[0] = 0;
+
+		NETADDR BindAddr;
+		mem_zero(&BindAddr, sizeof(BindAddr));
+		BindAddr.type = NETTYPE_IPV4;
+		BindAddr.ip[0] = 127;
+		BindAddr.ip[1] = 1 + ID / (250 * 250);
+		BindAddr.ip[2] = ID / 250 % 250;
+		BindAddr.ip[3] = 2 + ID % 250;
+		return m_NetClient.Open(BindAddr, &s_Config, 0, 0, 0);
+	}
+
+	void Connect()
+	{
+		m_State = STATE_CONNECTING;
+		if(m_Sevendown)
+			m_NetClient.ConnectSevendown(&s_ServerAddr);
+		else
+			m_NetClient.Connect(&s_ServerAddr);
+	}
+
+	void SendMsg(CMsgPacker *pMsg, int Flags)
+	{
+		int MsgID = pMsg->m_MsgID;
+		if(m_Sevendown)
+		{
+			// inverse of MsgFromSevendown() in the server
+			if(pMsg->m_System && MsgID >= NETMSG_READY && MsgID <= NETMSG_REQUEST_MAP_DATA)
+				MsgID = 14 + MsgID - NETMSG_READY;
+			else if(!pMsg->m_System && MsgID >= NETMSGTYPE_CL_SAY && MsgID <= NETMSGTYPE_CL_STARTINFO)
+				MsgID = 17 + MsgID - NETMSGTYPE_CL_SAY;
+		}
+
+		CPacker Packer;
+		Packer.Reset();
+		if(MsgID < OFFSET_UUID)
+			Packer.AddInt((MsgID<<1)|(pMsg->m_System?1:0));
+		else
+		{
+			Packer.AddInt(pMsg->m_System?1:0); // NETMSG_EX, NETMSGTYPE_EX
+			g_UuidManager.PackUuid(MsgID, &Packer);
+		}
+		Packer.AddRaw(pMsg->Data(), pMsg->Size());
+
+		CNetChunk Packet;
+		mem_zero(&Packet, sizeof(Packet));
+		Packet.m_ClientID = 0;
+		Packet.m_pData = Packer.Data();
+		Packet.m_DataSize = Packer.Size();
+		if(Flags&MSGFLAG_VITAL)
+			Packet.m_Flags |= NETSENDFLAG_VITAL;
+		if(Flags&MSGFLAG_FLUSH)
+			Packet.m_Flags |= NETSENDFLAG_FLUSH;
+		m_NetClient.Send(&Packet);
+		m_BytesSent += Packet.m_DataSize;
+	}
+
+	void SendInfo()
+	{
+		if(m_Sevendown)
+		{
+			// old clients get dropped without the ddnet version
+			CMsgPacker Ver(NETMSG_CLIENTVER, true);
+			CUuid ConnectionID = RandomUuid();
+			Ver.AddRaw(&ConnectionID, sizeof(ConnectionID));
+			Ver.AddInt(VERSION_DDNET_ZOOM_CURSOR);
+			Ver.AddString("loadgen", 0);
+			SendMsg(&Ver, MSGFLAG_VITAL);
+		}
+
+		CMsgPacker Msg(NETMSG_INFO, true);
+		Msg.AddString(m_Sevendown ? GAME_NETVERSION_SEVENDOWN : GAME_NETVERSION, 0);
+		Msg.AddString(s_pPassword, 0);
+		if(!m_Sevendown)
+			Msg.AddInt(CLIENT_VERSION);
+		SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+	}
+
+	void SendReady()
+	{
+		CMsgPacker Ready(NETMSG_READY, true);
+		SendMsg(&Ready, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+		m_State = STATE_READY;
+	}
+
+	void RequestMapData()
+	{
+		// 0.6 clients ask for every chunk, 0.7 ones for the next batch
+		CMsgPacker Msg(NETMSG_REQUEST_MAP_DATA, true);
+		if(m_Sevendown)
+			Msg.AddInt(m_MapChunk);
+		SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+	}
+
+	void SendStartInfo()
+	{
+		char aName[16];
+		str_format(aName, sizeof(aName), "loadgen%d", m_ID);
+		CMsgPacker Msg(NETMSGTYPE_CL_STARTINFO);
+		Msg.AddString(aName, -1);
+		Msg.AddString("loadgen", -1);
+		Msg.AddInt(-1);
+		if(m_Sevendown)
+		{
+			Msg.AddString("default", -1);
+			Msg.AddInt(0);
+			Msg.AddInt(0);
+			Msg.AddInt(0);
+		}
+		else
+		{
+			static const char *s_apSkinParts[] = { "standard", "", "", "standard", "standard", "standard" };
+			for(int p = 0; p < 6; p++)
+				Msg.AddString(s_apSkinParts[p], -1);
+			for(int p = 0; p < 6; p++)
+				Msg.AddInt(0);
+			for(int p = 0; p < 6; p++)
+				Msg.AddInt(0);
+		}
+		SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+	}
+
+	void SendInput(int64 Now)
+	{
+		// walk back and forth, jump and hook periodically and aim around in circles
+		float t = (Now - m_IngameSince) / (float)time_freq() + m_Phase;
+		CNetObj_PlayerInput Input;
+		mem_zero(&Input, sizeof(Input));
+		Input.m_Direction = sinf(t * 0.7f) > 0.0f ? 1 : -1;
+		Input.m_TargetX = (int)(cosf(t * 1.3f) * 200.0f);
+		Input.m_TargetY = (int)(sinf(t * 1.3f) * 200.0f) - 50;
+		Input.m_Jump = fmodf(t, 1.5f) < 0.1f;
+		Input.m_Hook = fmodf(t, 3.0f) < 0.8f;
+		bool Firing = fmodf(t, 2.0f) < 0.1f;
+		if(Firing != ((m_Fire&1) != 0))
+			m_Fire++;
+		Input.m_Fire = m_Fire;
+
+		CMsgPacker Msg(NETMSG_INPUT, true);
+		Msg.AddInt(m_GameTick);
+		Msg.AddInt(m_GameTick + 2);
+		Msg.AddInt(sizeof(Input));
+		int *pData = (int *)&Input;
+		for(unsigned i = 0; i < sizeof(Input) / sizeof(int); i++)
+			Msg.AddInt(pData[i]);
+		SendMsg(&Msg, MSGFLAG_FLUSH);
+
+		if(s_ChatInterval > 0 && Now >= m_NextChat)
+		{
+			char aBuf[64];
+			str_format(aBuf, sizeof(aBuf), "loadgen message %d", m_NumChat++);
+			CMsgPacker Chat(NETMSGTYPE_CL_SAY);
+			if(m_Sevendown)
+				Chat.AddInt(0);
+			else
+			{
+				Chat.AddInt(CHAT_ALL);
+				Chat.AddInt(-1);
+			}
+			Chat.AddString(aBuf, -1);
+			SendMsg(&Chat, MSGFLAG_VITAL);
+			m_NextChat = Now + s_ChatInterval * time_freq();
+		}
+	}
+
+	void OnMessage(CNetChunk *pPacket, int64 Now)
+	{
+		CUnpacker Unpacker;
+		Unpacker.Reset(pPacket->m_pData, pPacket->m_DataSize);
+		int Msg = Unpacker.GetInt();
+		bool Sys = Msg&1;
+		Msg >>= 1;
+		if(Unpacker.Error())
+			return;
+
+		if(Sys && m_Sevendown && Msg >= NETMSG_CON_READY-1 && Msg <= NETMSG_INPUTTIMING-1)
+			Msg++;
+
+		if(Sys)
+		{
+			if(Msg == NETMSG_MAP_CHANGE && m_State == STATE_LOADING)
+			{
+				// the server doesn't care whether the map was downloaded
+				if(!s_DownloadMap)
+				{
+					SendReady();
+					return;
+				}
+
+				Unpacker.GetString(); // name
+				Unpacker.GetInt(); // crc
+				m_MapSize = Unpacker.GetInt();
+				m_MapChunksPerRequest = m_Sevendown ? 1 : max(1, Unpacker.GetInt());
+				m_MapReceived = 0;
+				m_MapChunk = 0;
+				m_MapStart = Now;
+				RequestMapData();
+			}
+			else if(Msg == NETMSG_MAP_DATA && m_State == STATE_LOADING && m_MapStart)
+			{
+				bool Last;
+				if(m_Sevendown)
+				{
+					Last = Unpacker.GetInt() != 0;
+					Unpacker.GetInt(); // crc
+					Unpacker.GetInt(); // chunk
+					m_MapReceived += Unpacker.GetInt();
+				}
+				else
+				{
+					// only the raw data follows the single byte message id
+					m_MapReceived += Unpacker.CompleteSize() - 1;
+					Last = m_MapReceived >= m_MapSize;
+				}
+				m_MapChunk++;
+
+				if(Last)
+				{
+					m_MapTime = Now - m_MapStart;
+					SendReady();
+				}
+				else if(m_Sevendown || m_MapChunk % m_MapChunksPerRequest == 0)
+					RequestMapData();
+			}
+			else if(Msg == NETMSG_CON_READY && m_State == STATE_READY)
+			{
+				SendStartInfo();
+				m_State = STATE_STARTINFO;
+			}
+			else if(Msg == NETMSG_SNAP || Msg == NETMSG_SNAPEMPTY || Msg == NETMSG_SNAPSINGLE || Msg == NETMSG_SNAPSMALL)
+			{
+				int GameTick = Unpacker.GetInt();
+				if(!Unpacker.Error() && GameTick > m_GameTick)
+				{
+					m_GameTick = GameTick;
+					m_NumSnaps++;
+				}
+			}
+		}
+		else if(Msg == NETMSGTYPE_SV_READYTOENTER && m_State == STATE_STARTINFO)
+		{
+			CMsgPacker Enter(NETMSG_ENTERGAME, true);
+			SendMsg(&Enter, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+			m_State = STATE_INGAME;
+			m_IngameSince = Now;
+			m_NextChat = Now + (int64)(m_Phase / 10.0f * s_ChatInterval * time_freq());
+		}
+	}
+
+	void Update(int64 Now)
+	{
+		if(m_State == STATE_OFFLINE || m_State == STATE_ERROR)
+			return;
+
+		m_NetClient.Update();
+		if(m_NetClient.State() == NETSTATE_OFFLINE)
+		{
+			str_copy(m_aError, m_NetClient.ErrorString(), sizeof(m_aError));
+			Leave(Now, STATE_ERROR);
+			return;
+		}
+
+		if(m_State == STATE_CONNECTING && m_NetClient.State() == NETSTATE_ONLINE)
+		{
+			SendInfo();
+			m_State = STATE_LOADING;
+		}
+
+		CNetChunk Packet;
+		while(m_NetClient.Recv(&Packet))
+		{
+			if(Packet.m_ClientID == -1)
+				continue;
+			m_BytesRecv += Packet.m_DataSize;
+			OnMessage(&Packet, Now);
+		}
+	}
+
+	void Leave(int64 Now, int State)
+	{
+		if(m_State == STATE_INGAME)
+			m_IngameTime += Now - m_IngameSince;
+		m_State = State;
+	}
+
+	float IngameSeconds(int64 Now) const
+	{
+		return (m_IngameTime + (m_State == STATE_INGAME ? Now - m_IngameSince : 0)) / (float)time_freq();
+	}
+};
+
+// minimal econ client to read the server side profiler
+class CEconClient
+{
+	NETSOCKET m_Socket;
+	bool m_Online;
+	bool m_Authed;
+	char m_aBuffer[8192];
+	int m_BufferSize;
+
+public:
+	CEconClient() : m_Online(false), m_Authed(false), m_BufferSize(0) {}
+
+	bool Open(const NETADDR *pAddr, const char *pPassword)
+	{
+		NETADDR BindAddr;
+		mem_zero(&BindAddr, sizeof(BindAddr));
+		BindAddr.type = NETTYPE_IPV4;
+		m_Socket = net_tcp_create(BindAddr);
+		if(net_tcp_connect(m_Socket, pAddr) != 0)
+		{
+			net_tcp_close(m_Socket);
+			return false;
+		}
+		net_set_non_blocking(m_Socket);
+		m_Online = true;
+		Send(pPassword);
+		return true;
+	}
+
+	void Close()
+	{
+		if(m_Online)
+			net_tcp_close(m_Socket);
+		m_Online = false;
+	}
+
+	bool Online() const { return m_Online; }
+	bool Authed() const { return m_Authed; }
+
+	void Send(const char *pLine)
+	{
+		if(!m_Online)
+			return;
+		net_tcp_send(m_Socket, pLine, str_length(pLine));
+		net_tcp_send(m_Socket, "\n", 1);
+	}
+
+	// prints every complete line that arrived, returns the number of lines
+	int Pump(bool Print)
+	{
+		if(!m_Online)
+			return 0;
+
+		int Bytes = net_tcp_recv(m_Socket, m_aBuffer + m_BufferSize, sizeof(m_aBuffer) - 1 - m_BufferSize);
+		if(Bytes == 0 || (Bytes < 0 && !net_would_block()))
+		{
+			dbg_msg("econ", "connection lost");
+			Close();
+			return 0;
+		}
+		if(Bytes > 0)
+			m_BufferSize += Bytes;
+
+		// lines end with a mix of \r, \n and zero bytes
+		int NumLines = 0;
+		int Start = 0;
+		for(int i = 0; i < m_BufferSize; i++)
+		{
+			char c = m_aBuffer[i];
+			if(c != '\n' && c != '\r' && c != 0)
+				continue;
+
+			m_aBuffer[i] = 0;
+			const char *pLine = m_aBuffer + Start;
+			if(pLine[0])
+			{
+				if(str_find(pLine, "Authentication successful"))
+					m_Authed = true;
+				if(Print)
+					dbg_msg("econ", "%s", pLine);
+				NumLines++;
+			}
+			Start = i + 1;
+		}
+		m_BufferSize -= Start;
+		mem_move(m_aBuffer, m_aBuffer + Start, m_BufferSize);
+		if(m_BufferSize == (int)sizeof(m_aBuffer) - 1)
+			m_BufferSize = 0;
+		return NumLines;
+	}
+};
+
+static void PrintStatus(CBot *paBots, int NumBots, int64 Now, int64 Interval, int64 *pLastRecv, int64 *pLastSent)
+{
+	int aStates[CBot::STATE_ERROR + 1] = {0};
+	int64 Recv = 0, Sent = 0;
+	for(int i = 0; i < NumBots; i++)
+	{
+		aStates[paBots[i].m_State]++;
+		Recv += paBots[i].m_BytesRecv;
+		Sent += paBots[i].m_BytesSent;
+	}
+
+	float Seconds = Interval / (float)time_freq();
+	dbg_msg("loadgen", "ingame=%d connecting=%d error=%d in=%.1fkbit/s out=%.1fkbit/s",
+		aStates[CBot::STATE_INGAME], aStates[CBot::STATE_CONNECTING] + aStates[CBot::STATE_LOADING] + aStates[CBot::STATE_READY] + aStates[CBot::STATE_STARTINFO],
+		aStates[CBot::STATE_ERROR], (Recv - *pLastRecv) * 8 / 1000.0f / Seconds, (Sent - *pLastSent) * 8 / 1000.0f / Seconds);
+	*pLastRecv = Recv;
+	*pLastSent = Sent;
+}
+
+static void PrintResults(CBot *paBots, int NumBots, int64 Now, const char *pCsvFile)
+{
+	IOHANDLE File = pCsvFile ? io_open(pCsvFile, IOFLAG_WRITE) : 0;
+	if(pCsvFile && !File)
+		dbg_msg("loadgen", "failed to open '%s' for writing", pCsvFile);
+	if(File)
+	{
+		const char *pHeader = "id,protocol,state,ingame_seconds,recv_bytes,sent_bytes,recv_kbits,sent_kbits,snaps_per_second,error\n";
+		io_write(File, pHeader, str_length(pHeader));
+	}
+
+	char aBuf[256];
+	for(int i = 0; i < NumBots; i++)
+	{
+		CBot *pBot = &paBots[i];
+		float Seconds = pBot->IngameSeconds(Now);
+		float Div = Seconds > 0.0f ? Seconds : 1.0f;
+		dbg_msg("loadgen", "client=%d %s %s map=%.1fs ingame=%.1fs in=%.1fkbit/s out=%.1fkbit/s snaps=%.1f/s %s",
+			pBot->m_ID, pBot->m_Sevendown ? "0.6" : "0.7", CBot::StateName(pBot->m_State), pBot->m_MapTime / (float)time_freq(), Seconds,
+			pBot->m_BytesRecv * 8 / 1000.0f / Div, pBot->m_BytesSent * 8 / 1000.0f / Div, pBot->m_NumSnaps / Div, pBot->m_aError);
+		if(File)
+		{
+			str_format(aBuf, sizeof(aBuf), "%d,%s,%s,%.2f,%lld,%lld,%.2f,%.2f,%.2f,\"%s\"\n",
+				pBot->m_ID, pBot->m_Sevendown ? "0.6" : "0.7", CBot::StateName(pBot->m_State), Seconds,
+				pBot->m_BytesRecv, pBot->m_BytesSent, pBot->m_BytesRecv * 8 / 1000.0f / Div, pBot->m_BytesSent * 8 / 1000.0f / Div,
+				pBot->m_NumSnaps / Div, pBot->m_aError);
+			io_write(File, aBuf, str_length(aBuf));
+		}
+	}
+
+	NETSTATS Stats;
+	net_stats(&Stats);
+	dbg_msg("loadgen", "socket totals: sent=%d packets/%d bytes recv=%d packets/%d bytes",
+		Stats.sent_packets, Stats.sent_bytes, Stats.recv_packets, Stats.recv_bytes);
+
+	if(File)
+		io_close(File);
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+	if(secure_random_init() != 0)
+	{
+		dbg_msg("secure", "could not initialize secure RNG");
+		return -1;
+	}
+
+	const char *pServer = "127.0.0.1:8303";
+	const char *pEconPassword = "";
+	const char *pFilter = "server.";
+	const char *pCsvFile = 0;
+	int NumBots = 16;
+	int Protocol = PROTOCOL_MIXED;
+	int Duration = 60;
+	int ConnectRate = 10;
+	int EconPort = 0;
+
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		const char *pArg = argv[i]; // ignore_convention
+		const char *pValue = i + 1 < argc ? argv[i + 1] : 0; // ignore_convention
+		if(pArg[0] != '-' || !pArg[1] || pArg[2] || !pValue)
+		{
+			dbg_msg("loadgen", "%s", s_pUsage);
+			return -1;
+		}
+		i++;
+
+		switch(pArg[1])
+		{
+		case 's': pServer = pValue; break;
+		case 'n': NumBots = str_toint(pValue); break;
+		case 't': Duration = str_toint(pValue); break;
+		case 'r': ConnectRate = max(1, str_toint(pValue)); break;
+		case 'c': s_ChatInterval = str_toint(pValue); break;
+		case 'm': s_DownloadMap = str_toint(pValue) != 0; break;
+		case 'w': s_pPassword = pValue; break;
+		case 'e': EconPort = str_toint(pValue); break;
+		case 'k': pEconPassword = pValue; break;
+		case 'f': pFilter = pValue; break;
+		case 'o': pCsvFile = pValue; break;
+		case 'p':
+			if(str_comp(pValue, "0.6") == 0)
+				Protocol = PROTOCOL_SEVENDOWN;
+			else if(str_comp(pValue, "0.7") == 0)
+				Protocol = PROTOCOL_SEVEN;
+			else
+				Protocol = PROTOCOL_MIXED;
+			break;
+		default:
+			dbg_msg("loadgen", "%s", s_pUsage);
+			return -1;
+		}
+	}
+
+	if(NumBots <= 0 || net_host_lookup(pServer, &s_ServerAddr, NETTYPE_IPV4) != 0)
+	{
+		dbg_msg("loadgen", "%s", s_pUsage);
+		return -1;
+	}
+	if(!s_ServerAddr.port)
+		s_ServerAddr.port = 8303;
+
+	mem_zero(&s_Config, sizeof(s_Config));
+	s_Config.m_ConnTimeout = 100;
+	s_Config.m_ConnTimeoutProtection = 1000;
+
+	CBot *paBots = new CBot[NumBots];
+	for(int i = 0; i < NumBots; i++)
+	{
+		bool Sevendown = Protocol == PROTOCOL_SEVENDOWN || (Protocol == PROTOCOL_MIXED && i % 2);
+		if(!paBots[i].Open(i, Sevendown))
+		{
+			dbg_msg("loadgen", "failed to open a socket for client %d", i);
+			delete[] paBots;
+			return -1;
+		}
+	}
+
+	CEconClient Econ;
+	if(EconPort)
+	{
+		NETADDR EconAddr = s_ServerAddr;
+		EconAddr.port = EconPort;
+		if(!Econ.Open(&EconAddr, pEconPassword))
+			dbg_msg("loadgen", "failed to connect to econ");
+	}
+
+	char aAddrStr[NETADDR_MAXSTRSIZE];
+	net_addr_str(&s_ServerAddr, aAddrStr, sizeof(aAddrStr), true);
+	dbg_msg("loadgen", "starting %d clients against %s for %d seconds", NumBots, aAddrStr, Duration);
+
+	int64 Start = time_get();
+	int64 End = Start + Duration * time_freq();
+	int64 TickTime = time_freq() / SERVER_TICK_SPEED;
+	int64 NextTick = Start;
+	int64 NextStatus = Start + STATUS_INTERVAL * time_freq();
+	int64 LastRecv = 0, LastSent = 0;
+	int NumConnected = 0;
+	bool ProfilerStarted = false;
+
+	while(1)
+	{
+		int64 Now = time_get();
+		if(Now >= End)
+			break;
+
+		while(NumConnected < NumBots && Now >= Start + NumConnected * time_freq() / ConnectRate)
+			paBots[NumConnected++].Connect();
+
+		for(int i = 0; i < NumConnected; i++)
+			paBots[i].Update(Now);
+
+		if(Now >= NextTick)
+		{
+			for(int i = 0; i < NumConnected; i++)
+				if(paBots[i].m_State == CBot::STATE_INGAME)
+					paBots[i].SendInput(Now);
+			NextTick += TickTime;
+			if(NextTick < Now)
+				NextTick = Now + TickTime;
+		}
+
+		Econ.Pump(false);
+		if(Econ.Authed() && !ProfilerStarted)
+		{
+			// only measure while all clients are connecting or ingame
+			Econ.Send("sv_profiler 1");
+			Econ.Send("profiler_reset");
+			ProfilerStarted = true;
+		}
+
+		if(Now >= NextStatus)
+		{
+			PrintStatus(paBots, NumBots, Now, STATUS_INTERVAL * time_freq(), &LastRecv, &LastSent);
+			NextStatus += STATUS_INTERVAL * time_freq();
+		}
+
+		thread_sleep(1);
+	}
+
+	int64 Now = time_get();
+	PrintResults(paBots, NumBots, Now, pCsvFile);
+
+	if(Econ.Online())
+	{
+		if(!ProfilerStarted)
+			dbg_msg("loadgen", "econ authentication failed");
+		else
+		{
+			char aCmd[128];
+			str_format(aCmd, sizeof(aCmd), "profiler \"%s\"", pFilter);
+			Econ.Send(aCmd);
+			int64 Wait = time_get() + time_freq() / 2;
+			while(time_get() < Wait && Econ.Online())
+			{
+				Econ.Pump(true);
+				thread_sleep(10);
+			}
+		}
+		Econ.Close();
+	}
+
+	for(int i = 0; i < NumBots; i++)
+		paBots[i].m_NetClient.Close();
+	delete[] paBots;
+	return 0;
+}